@@ -0,0 +1,130 @@
+/*
+ * 6510idle.h - Opcode classes for the busy loop detection of the 6510 cores.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_6510IDLE_H
+#define VICE_6510IDLE_H
+
+#include "types.h"
+
+/* A loop can only be skipped if it consists of the opcodes below, which
+   change nothing but the registers and only read memory.  The CPU cores
+   check the addresses they read themselves.  */
+
+enum {
+    IDLE_OP_NONE,       /* anything with side effects */
+    IDLE_OP_IMPLIED,
+    IDLE_OP_IMMEDIATE,
+    IDLE_OP_ZERO,
+    IDLE_OP_ZERO_INDEXED,
+    IDLE_OP_ABS,
+    IDLE_OP_ABS_INDEXED,
+    IDLE_OP_BRANCH,
+    IDLE_OP_JMP
+};
+
+/* Return how `opcode' accesses memory, or IDLE_OP_NONE if it must not be
+   part of a loop that is skipped.  */
+inline static int mos6510_idle_opcode(uint8_t opcode)
+{
+    switch (opcode) {
+        case 0x18:      /* CLC */
+        case 0x38:      /* SEC */
+        case 0x78:      /* SEI */
+        case 0x8a:      /* TXA */
+        case 0x98:      /* TYA */
+        case 0xa8:      /* TAY */
+        case 0xaa:      /* TAX */
+        case 0xba:      /* TSX */
+        case 0xd8:      /* CLD */
+        case 0xea:      /* NOP */
+            return IDLE_OP_IMPLIED;
+        case 0x09:      /* ORA #$nn */
+        case 0x29:      /* AND #$nn */
+        case 0x49:      /* EOR #$nn */
+        case 0xa0:      /* LDY #$nn */
+        case 0xa2:      /* LDX #$nn */
+        case 0xa9:      /* LDA #$nn */
+        case 0xc0:      /* CPY #$nn */
+        case 0xc9:      /* CMP #$nn */
+        case 0xe0:      /* CPX #$nn */
+            return IDLE_OP_IMMEDIATE;
+        case 0x05:      /* ORA $nn */
+        case 0x24:      /* BIT $nn */
+        case 0x25:      /* AND $nn */
+        case 0x45:      /* EOR $nn */
+        case 0xa4:      /* LDY $nn */
+        case 0xa5:      /* LDA $nn */
+        case 0xa6:      /* LDX $nn */
+        case 0xc4:      /* CPY $nn */
+        case 0xc5:      /* CMP $nn */
+        case 0xe4:      /* CPX $nn */
+            return IDLE_OP_ZERO;
+        case 0x15:      /* ORA $nn,X */
+        case 0x35:      /* AND $nn,X */
+        case 0x55:      /* EOR $nn,X */
+        case 0xb4:      /* LDY $nn,X */
+        case 0xb5:      /* LDA $nn,X */
+        case 0xb6:      /* LDX $nn,Y */
+        case 0xd5:      /* CMP $nn,X */
+            return IDLE_OP_ZERO_INDEXED;
+        case 0x0d:      /* ORA $nnnn */
+        case 0x2c:      /* BIT $nnnn */
+        case 0x2d:      /* AND $nnnn */
+        case 0x4d:      /* EOR $nnnn */
+        case 0xac:      /* LDY $nnnn */
+        case 0xad:      /* LDA $nnnn */
+        case 0xae:      /* LDX $nnnn */
+        case 0xcc:      /* CPY $nnnn */
+        case 0xcd:      /* CMP $nnnn */
+        case 0xec:      /* CPX $nnnn */
+            return IDLE_OP_ABS;
+        case 0x19:      /* ORA $nnnn,Y */
+        case 0x1d:      /* ORA $nnnn,X */
+        case 0x39:      /* AND $nnnn,Y */
+        case 0x3d:      /* AND $nnnn,X */
+        case 0x59:      /* EOR $nnnn,Y */
+        case 0x5d:      /* EOR $nnnn,X */
+        case 0xb9:      /* LDA $nnnn,Y */
+        case 0xbc:      /* LDY $nnnn,X */
+        case 0xbd:      /* LDA $nnnn,X */
+        case 0xbe:      /* LDX $nnnn,Y */
+        case 0xd9:      /* CMP $nnnn,Y */
+        case 0xdd:      /* CMP $nnnn,X */
+            return IDLE_OP_ABS_INDEXED;
+        case 0x10:      /* BPL */
+        case 0x30:      /* BMI */
+        case 0x90:      /* BCC */
+        case 0xb0:      /* BCS */
+        case 0xd0:      /* BNE */
+        case 0xf0:      /* BEQ */
+            /* BVC and BVS are left out, the byte ready line of the
+               drives sets the V flag */
+            return IDLE_OP_BRANCH;
+        case 0x4c:      /* JMP $nnnn */
+            return IDLE_OP_JMP;
+        default:
+            return IDLE_OP_NONE;
+    }
+}
+
+#endif
@@ -92,8 +92,6 @@ typedef struct alarm_context_s alarm_context_t;
 extern alarm_context_t *alarm_context_new(const char *name);
 extern void alarm_context_init(alarm_context_t *context, const char *name);
 extern void alarm_context_destroy(alarm_context_t *context);
-extern void alarm_context_time_warp(alarm_context_t *context, CLOCK warp_amount,
-                                    int warp_direction);
 extern alarm_t *alarm_new(alarm_context_t *context, const char *name,
                           alarm_callback_t callback, void *data);
 extern void alarm_destroy(alarm_t *alarm);
@@ -35,6 +35,7 @@
 #include "resources.h"
 #include "videoarch.h"
 #include "video.h"
+#include "videoshm.h"
 
 
 /** \brief  Command line options related to generic video output
@@ -59,6 +60,8 @@ static const resource_int_t resources_int[] =
 void video_arch_canvas_init(struct video_canvas_s *canvas)
 {
     /* printf("%s\n", __func__); */
+
+    videoshm_canvas_init(canvas);
 }
 
 
@@ -71,6 +74,9 @@ int video_arch_cmdline_options_init(void)
     /* printf("%s\n", __func__); */
 
     if (machine_class != VICE_MACHINE_VSID) {
+        if (videoshm_cmdline_options_init() < 0) {
+            return -1;
+        }
         return cmdline_register_options(cmdline_options);
     }
     return 0;
@@ -86,6 +92,9 @@ int video_arch_resources_init(void)
     /* printf("%s\n", __func__); */
 
     if (machine_class != VICE_MACHINE_VSID) {
+        if (videoshm_resources_init() < 0) {
+            return -1;
+        }
         return resources_register_int(resources_int);
     }
     return 0;
@@ -95,6 +104,8 @@ int video_arch_resources_init(void)
 void video_arch_resources_shutdown(void)
 {
     /* printf("%s\n", __func__); */
+
+    videoshm_resources_shutdown();
 }
 
 /** \brief Query whether a canvas is resizable.
@@ -137,6 +148,8 @@ video_canvas_t *video_canvas_create(video_canvas_t *canvas,
 void video_canvas_destroy(struct video_canvas_s *canvas)
 {
     /* printf("%s\n", __func__); */
+
+    videoshm_canvas_destroy(canvas);
 }
 
 /** \brief Update the display on a video canvas to reflect the machine
@@ -155,6 +168,9 @@ void video_canvas_refresh(struct video_canvas_s *canvas,
                           unsigned int w, unsigned int h)
 {
     /* printf("%s\n", __func__); */
+
+    /* called once at the end of each drawn frame */
+    videoshm_publish(canvas);
 }
 
 /** \brief Update canvas size to match the draw buffer size requested
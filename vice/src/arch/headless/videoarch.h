@@ -60,6 +60,9 @@ typedef struct video_canvas_s {
     /** \brief Methods for managing the draw buffer when the core
      *         rasterizer handles it. */
     struct video_draw_buffer_callback_s *video_draw_buffer_callback;
+
+    /** \brief Shared memory frame export state, see videoshm.c */
+    struct videoshm_s *videoshm;
 } video_canvas_t;
 
 typedef struct vice_renderer_backend_s {
@@ -0,0 +1,388 @@
+/**
+ * \file videoshm.c
+ * \brief Headless frame export through POSIX shared memory
+ *
+ * Each canvas gets its own segment, named after the VideoShmName resource.
+ * The first canvas uses the name as is, further canvases (the VDC of x128)
+ * get "-1", "-2", ... appended.  See videoshm.h for the layout.
+ */
+
+/* This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "videoarch.h"
+#include "videoshm.h"
+
+#ifdef HAVE_SHM_OPEN
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cmdline.h"
+#include "lib.h"
+#include "log.h"
+#include "maincpu.h"
+#include "palette.h"
+#include "resources.h"
+#include "util.h"
+#include "video.h"
+#include "viewport.h"
+
+
+#if defined(__GNUC__)
+#define VIDEOSHM_BARRIER() __sync_synchronize()
+#else
+#define VIDEOSHM_BARRIER()
+#endif
+
+/** \brief  Alignment of slots and pixel data inside the segment */
+#define VIDEOSHM_ALIGN(x)   (((x) + 63) & ~(size_t)63)
+
+/** \brief  Per-canvas export state */
+struct videoshm_s {
+    int index;          /**< canvas number, used to build the name */
+    char *name;         /**< name of the segment, NULL if none */
+    int fd;
+    uint8_t *base;      /**< mapping of the segment */
+    size_t size;        /**< size of the mapping */
+    int generation;     /**< shm_generation the segment was made for */
+    int failed;         /**< generation that failed to open, or -1 */
+    uint64_t frames;    /**< frames published by this canvas */
+};
+
+static char *shm_name = NULL;
+static int shm_slots = 3;
+
+/* Bumped whenever the resources change, so segments get recreated.  */
+static int shm_generation = 0;
+
+static int canvas_count = 0;
+
+
+/*-----------------------------------------------------------------------*/
+
+static int set_shm_name(const char *val, void *param)
+{
+    if (util_string_set(&shm_name, val) == 0) {
+        shm_generation++;
+    }
+    return 0;
+}
+
+static int set_shm_slots(int val, void *param)
+{
+    if (val < VIDEOSHM_SLOTS_MIN || val > VIDEOSHM_SLOTS_MAX) {
+        return -1;
+    }
+    if (val != shm_slots) {
+        shm_generation++;
+    }
+    shm_slots = val;
+
+    return 0;
+}
+
+static const resource_string_t resources_string[] = {
+    { "VideoShmName", "", RES_EVENT_NO, NULL,
+      &shm_name, set_shm_name, NULL },
+    RESOURCE_STRING_LIST_END
+};
+
+static const resource_int_t resources_int[] = {
+    { "VideoShmSlots", 3, RES_EVENT_NO, NULL,
+      &shm_slots, set_shm_slots, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+/** \brief  Register frame export resources
+ *
+ * \return  0 on success, -1 on error
+ */
+int videoshm_resources_init(void)
+{
+    if (resources_register_string(resources_string) < 0) {
+        return -1;
+    }
+    return resources_register_int(resources_int);
+}
+
+/** \brief  Free memory used by frame export resources
+ */
+void videoshm_resources_shutdown(void)
+{
+    lib_free(shm_name);
+    shm_name = NULL;
+}
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-videoshm", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "VideoShmName", NULL,
+      "<Name>", "Publish every rendered frame in POSIX shared memory segment <Name>" },
+    { "-videoshmslots", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "VideoShmSlots", NULL,
+      "<value>", "Set number of frame slots in the shared memory segment (2-16)" },
+    CMDLINE_LIST_END
+};
+
+/** \brief  Register frame export command line options
+ *
+ * \return  0 on success, -1 on error
+ */
+int videoshm_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+
+/*-----------------------------------------------------------------------*/
+
+static void videoshm_close(struct videoshm_s *shm)
+{
+    videoshm_header_t *header;
+
+    if (shm->base != NULL) {
+        /* tell readers still mapping the old segment to reopen */
+        header = (videoshm_header_t *)shm->base;
+        header->stale = 1;
+        VIDEOSHM_BARRIER();
+        munmap(shm->base, shm->size);
+        shm->base = NULL;
+    }
+    if (shm->fd >= 0) {
+        close(shm->fd);
+        shm->fd = -1;
+    }
+    if (shm->name != NULL) {
+        shm_unlink(shm->name);
+        lib_free(shm->name);
+        shm->name = NULL;
+    }
+}
+
+static int videoshm_open(struct videoshm_s *shm, size_t pixels_size)
+{
+    videoshm_header_t *header;
+    size_t slot_offset, pixel_offset, slot_size;
+
+    videoshm_close(shm);
+
+    if (shm->index == 0) {
+        shm->name = lib_msprintf("%s%s", shm_name[0] == '/' ? "" : "/", shm_name);
+    } else {
+        shm->name = lib_msprintf("%s%s-%d", shm_name[0] == '/' ? "" : "/",
+                                 shm_name, shm->index);
+    }
+
+    slot_offset = VIDEOSHM_ALIGN(sizeof(videoshm_header_t));
+    pixel_offset = VIDEOSHM_ALIGN(sizeof(videoshm_slot_t));
+    slot_size = pixel_offset + VIDEOSHM_ALIGN(pixels_size);
+    shm->size = slot_offset + slot_size * (size_t)shm_slots;
+
+    shm->fd = shm_open(shm->name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (shm->fd < 0) {
+        log_error(LOG_DEFAULT, "videoshm: cannot create `%s': %s.",
+                  shm->name, strerror(errno));
+        goto fail;
+    }
+    if (ftruncate(shm->fd, (off_t)shm->size) < 0) {
+        log_error(LOG_DEFAULT, "videoshm: cannot resize `%s': %s.",
+                  shm->name, strerror(errno));
+        goto fail;
+    }
+    shm->base = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     shm->fd, 0);
+    if (shm->base == MAP_FAILED) {
+        shm->base = NULL;
+        log_error(LOG_DEFAULT, "videoshm: cannot map `%s': %s.",
+                  shm->name, strerror(errno));
+        goto fail;
+    }
+
+    /* ftruncate() zero-filled the segment, so all slots start out with an
+       even sequence and no frames.  */
+    header = (videoshm_header_t *)shm->base;
+    header->version = VIDEOSHM_VERSION;
+    header->header_size = (uint32_t)sizeof(videoshm_header_t);
+    header->num_slots = (uint32_t)shm_slots;
+    header->slot_offset = (uint32_t)slot_offset;
+    header->slot_size = (uint32_t)slot_size;
+    header->pixel_offset = (uint32_t)pixel_offset;
+    VIDEOSHM_BARRIER();
+    header->frames = shm->frames;
+    VIDEOSHM_BARRIER();
+    header->magic = VIDEOSHM_MAGIC;
+
+    shm->generation = shm_generation;
+    log_message(LOG_DEFAULT, "videoshm: publishing frames in `%s' (%d slots of %u bytes).",
+                shm->name, shm_slots, (unsigned int)slot_size);
+    return 0;
+
+fail:
+    videoshm_close(shm);
+    shm->failed = shm_generation;
+    return -1;
+}
+
+/** \brief  Set up frame export state for a new canvas
+ *
+ * \param[in,out]   canvas  canvas
+ */
+void videoshm_canvas_init(struct video_canvas_s *canvas)
+{
+    struct videoshm_s *shm = lib_calloc(1, sizeof(struct videoshm_s));
+
+    shm->index = canvas_count++;
+    shm->fd = -1;
+    shm->failed = -1;
+    canvas->videoshm = shm;
+}
+
+/** \brief  Remove the shared memory segment of a canvas
+ *
+ * \param[in,out]   canvas  canvas
+ */
+void videoshm_canvas_destroy(struct video_canvas_s *canvas)
+{
+    if (canvas->videoshm != NULL) {
+        videoshm_close(canvas->videoshm);
+        lib_free(canvas->videoshm);
+        canvas->videoshm = NULL;
+    }
+}
+
+/** \brief  Copy the current frame of a canvas into the next slot
+ *
+ * \param[in]   canvas  canvas
+ */
+void videoshm_publish(struct video_canvas_s *canvas)
+{
+    struct videoshm_s *shm = canvas->videoshm;
+    draw_buffer_t *db = canvas->draw_buffer;
+    videoshm_header_t *header;
+    videoshm_slot_t *slot;
+    geometry_t *geometry;
+    palette_t *palette;
+    size_t pixels_size;
+    unsigned int i;
+
+    if (shm == NULL || db == NULL || db->draw_buffer == NULL) {
+        return;
+    }
+
+    if (shm_name == NULL || *shm_name == '\0') {
+        if (shm->base != NULL) {
+            videoshm_close(shm);
+        }
+        return;
+    }
+
+    pixels_size = (size_t)db->draw_buffer_pitch * db->draw_buffer_height;
+
+    if (shm->base == NULL || shm->generation != shm_generation
+        || pixels_size > ((videoshm_header_t *)shm->base)->slot_size
+                         - ((videoshm_header_t *)shm->base)->pixel_offset) {
+        if (shm->failed == shm_generation
+            || videoshm_open(shm, pixels_size) < 0) {
+            return;
+        }
+    }
+
+    header = (videoshm_header_t *)shm->base;
+    slot = (videoshm_slot_t *)(shm->base + header->slot_offset
+                               + (size_t)header->slot_size
+                                 * (size_t)(shm->frames % header->num_slots));
+
+    slot->seq++;
+    VIDEOSHM_BARRIER();
+
+    slot->width = db->draw_buffer_width;
+    slot->height = db->draw_buffer_height;
+    slot->pitch = db->draw_buffer_pitch;
+    /* same area a screenshot would contain, there is no window to fit */
+    geometry = canvas->geometry;
+    slot->visible_x = geometry->extra_offscreen_border_left;
+    slot->visible_y = geometry->first_displayed_line;
+    slot->visible_width = geometry->screen_size.width;
+    slot->visible_height = geometry->last_displayed_line
+                           - geometry->first_displayed_line + 1;
+    slot->frame = shm->frames;
+    slot->clock = maincpu_clk;
+
+    palette = canvas->palette;
+    slot->num_colors = 0;
+    if (palette != NULL) {
+        slot->num_colors = palette->num_entries < 256 ? palette->num_entries : 256;
+        for (i = 0; i < slot->num_colors; i++) {
+            slot->palette[i * 3 + 0] = palette->entries[i].red;
+            slot->palette[i * 3 + 1] = palette->entries[i].green;
+            slot->palette[i * 3 + 2] = palette->entries[i].blue;
+        }
+    }
+
+    memcpy((uint8_t *)slot + header->pixel_offset, db->draw_buffer, pixels_size);
+
+    VIDEOSHM_BARRIER();
+    slot->seq++;
+
+    /* readers that see the new count must also see the finished slot */
+    shm->frames++;
+    VIDEOSHM_BARRIER();
+    header->frames = shm->frames;
+}
+
+#else /* !HAVE_SHM_OPEN */
+
+int videoshm_resources_init(void)
+{
+    return 0;
+}
+
+void videoshm_resources_shutdown(void)
+{
+}
+
+int videoshm_cmdline_options_init(void)
+{
+    return 0;
+}
+
+void videoshm_canvas_init(struct video_canvas_s *canvas)
+{
+    canvas->videoshm = NULL;
+}
+
+void videoshm_canvas_destroy(struct video_canvas_s *canvas)
+{
+}
+
+void videoshm_publish(struct video_canvas_s *canvas)
+{
+}
+
+#endif
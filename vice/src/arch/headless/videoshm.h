@@ -0,0 +1,97 @@
+/**
+ * \file videoshm.h
+ * \brief Headless frame export through POSIX shared memory
+ *
+ * The segment starts with a videoshm_header_t, followed by \c num_slots
+ * slots of \c slot_size bytes each.  Every slot starts with a
+ * videoshm_slot_t, the palettized pixels follow at \c pixel_offset.
+ *
+ * Frames are written round-robin: frame \c n goes into slot
+ * <tt>n % num_slots</tt>.  A slot's \c seq is odd while the slot is being
+ * written and even when the slot is consistent, so a reader can take a
+ * frame without locking:
+ *
+ * \code
+ *  do {
+ *      s1 = slot->seq;  (retry while odd)
+ *      read barrier; copy what is needed; read barrier;
+ *  } while (slot->seq != s1);
+ * \endcode
+ *
+ * When the draw buffer grows beyond the slot size the segment is
+ * replaced by a larger one; \c stale is set in the old header so readers
+ * know they have to reopen the segment.
+ */
+
+/* This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_VIDEOSHM_H
+#define VICE_VIDEOSHM_H
+
+#include "types.h"
+
+/** \brief  "VSHM" in little endian */
+#define VIDEOSHM_MAGIC      0x4d485356
+#define VIDEOSHM_VERSION    1
+
+#define VIDEOSHM_SLOTS_MIN  2
+#define VIDEOSHM_SLOTS_MAX  16
+
+/** \brief  Segment header, at offset 0 */
+typedef struct videoshm_header_s {
+    uint32_t magic;         /**< VIDEOSHM_MAGIC */
+    uint32_t version;       /**< VIDEOSHM_VERSION */
+    uint32_t header_size;   /**< sizeof(videoshm_header_t) */
+    uint32_t num_slots;     /**< number of frame slots */
+    uint32_t slot_offset;   /**< offset of the first slot */
+    uint32_t slot_size;     /**< size of one slot, including its header */
+    uint32_t pixel_offset;  /**< offset of the pixels inside a slot */
+    volatile uint32_t stale;    /**< nonzero when the segment was replaced */
+    volatile uint64_t frames;   /**< number of frames published so far */
+} videoshm_header_t;
+
+/** \brief  Slot header, at the start of each slot */
+typedef struct videoshm_slot_s {
+    volatile uint32_t seq;  /**< odd while the slot is being written */
+    uint32_t width;         /**< draw buffer width in pixels */
+    uint32_t height;        /**< draw buffer height in lines */
+    uint32_t pitch;         /**< bytes per line */
+    uint32_t visible_x;     /**< visible area inside the draw buffer */
+    uint32_t visible_y;
+    uint32_t visible_width;
+    uint32_t visible_height;
+    uint64_t frame;         /**< frame number, starting at 0 */
+    uint64_t clock;         /**< emulated main CPU clock of the frame */
+    uint32_t num_colors;    /**< valid palette entries */
+    uint8_t palette[256 * 3];   /**< RGB triplets */
+} videoshm_slot_t;
+
+struct video_canvas_s;
+
+extern int videoshm_resources_init(void);
+extern void videoshm_resources_shutdown(void);
+extern int videoshm_cmdline_options_init(void);
+
+extern void videoshm_canvas_init(struct video_canvas_s *canvas);
+extern void videoshm_canvas_destroy(struct video_canvas_s *canvas);
+extern void videoshm_publish(struct video_canvas_s *canvas);
+
+#endif
@@ -45,6 +45,7 @@
 #include "cartridge.h"
 #include "charset.h"
 #include "cmdline.h"
+#include "crc32.h"
 #include "datasette.h"
 #include "diskimage.h"
 #include "drive.h"
@@ -165,6 +166,8 @@ static int AutostartDelayRandom = 0;
 
 static int AutostartPrgMode = AUTOSTART_PRG_MODE_VFS;
 
+static int AutostartWarmBoot = 0;
+
 static char *AutostartPrgDiskImage = NULL;
 
 static const char * const AutostartRunCommandsAvailable[] = {
@@ -181,6 +184,16 @@ static char *autostart_default_diskimage = NULL;
 
 static const char * AutostartRunCommand = NULL;
 
+/* Warm boot cache file for the current machine configuration, NULL if the
+   current autostart does not use warm boot.  */
+static char *warmboot_file = NULL;
+
+/* Flag: restore the warm boot snapshot once the reset has happened */
+static int warmboot_restore = 0;
+
+/* Flag: save the warm boot snapshot when READY. shows up */
+static int warmboot_capture = 0;
+
 
 static void set_handle_true_drive_emulation_state(void)
 {
@@ -275,6 +288,13 @@ static int set_autostart_prg_mode(int val, void *param)
     return 0;
 }
 
+static int set_autostart_warmboot(int val, void *param)
+{
+    AutostartWarmBoot = val ? 1 : 0;
+
+    return 0;
+}
+
 /*! \internal \brief set disk image name of autostart prg mode */
 
 static int set_autostart_prg_disk_image(const char *val, void *param)
@@ -309,6 +329,8 @@ static const resource_int_t resources_int[] = {
       &AutostartDelay, set_autostart_delay, NULL },
     { "AutostartDelayRandom", 1, RES_EVENT_NO, (resource_value_t)0,
       &AutostartDelayRandom, set_autostart_delayrandom, NULL },
+    { "AutostartWarmBoot", 0, RES_EVENT_NO, (resource_value_t)0,
+      &AutostartWarmBoot, set_autostart_warmboot, NULL },
     RESOURCE_INT_LIST_END
 };
 
@@ -335,6 +357,8 @@ void autostart_resources_shutdown(void)
 {
     lib_free(AutostartPrgDiskImage);
     lib_free(autostart_default_diskimage);
+    lib_free(warmboot_file);
+    warmboot_file = NULL;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -380,6 +404,12 @@ static const cmdline_option_t cmdline_options[] =
     { "+autostart-delay-random", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
       NULL, NULL, "AutostartDelayRandom", (resource_value_t)0,
       NULL, "Disable random initial autostart delay." },
+    { "-autostart-warmboot", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "AutostartWarmBoot", (resource_value_t)1,
+      NULL, "Restore a cached snapshot of the machine at the READY prompt instead of resetting on autostart" },
+    { "+autostart-warmboot", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "AutostartWarmBoot", (resource_value_t)0,
+      NULL, "Always reset the machine on autostart" },
     CMDLINE_LIST_END
 };
 
@@ -651,6 +681,218 @@ static void load_snapshot_trap(uint16_t unused_addr, void *unused_data)
 
 /* ------------------------------------------------------------------------- */
 
+/* Warm boot: instead of resetting the machine and waiting for the KERNAL
+   to reach the READY prompt, restore a snapshot taken at that point by an
+   earlier autostart.  The snapshot is cached per machine configuration:
+   the file name contains a CRC over the machine name, the contents of the
+   ROM images, all resources that affect emulation (model, drives,
+   cartridge type, ...) and the cartridge file and its contents.  A
+   configuration change therefore simply leads to a cache miss and a cold
+   boot.  Only the WARMBOOT_CACHE_MAX most recently used snapshots are
+   kept.  */
+
+#define WARMBOOT_CACHE_MAX      16
+#define WARMBOOT_INDEX_NAME     "autostart-warmboot.idx"
+
+static char *warmboot_cache_file(void)
+{
+    char *fingerprint, *line, *name, *path;
+    const char *cartfile;
+    uint32_t crc;
+
+    fingerprint = lib_msprintf("%s\n", machine_get_name());
+    util_addline_free(&fingerprint, machine_romset_file_crc_list());
+    util_addline_free(&fingerprint, resources_write_event_relevant_to_string("\n"));
+    if (resources_query_type("CartridgeFile") == RES_STRING) {
+        line = resources_write_item_to_string("CartridgeFile", "\n");
+        if (line != NULL) {
+            util_addline_free(&fingerprint, line);
+        }
+        if (resources_get_string("CartridgeFile", &cartfile) == 0
+            && cartfile != NULL && *cartfile != '\0') {
+            util_addline_free(&fingerprint,
+                              lib_msprintf("%08x", crc32_file(cartfile)));
+        }
+    }
+
+    crc = crc32_buf(fingerprint, (unsigned int)strlen(fingerprint));
+    lib_free(fingerprint);
+
+    name = lib_msprintf("autostart-%s-%08x.vsf", machine_get_name(), crc);
+    path = archdep_join_paths(archdep_user_cache_path(), name, NULL);
+    lib_free(name);
+
+    return path;
+}
+
+static int warmboot_cache_is_snapshot(const char *name)
+{
+    size_t len = strlen(name);
+
+    return len > 14 && strncmp(name, "autostart-", 10) == 0
+           && strcmp(name + len - 4, ".vsf") == 0;
+}
+
+/* Add `name' to the list of cache entries unless it's already there or
+   the file is gone.  */
+static void warmboot_cache_add(char ***names, int *num, const char *dir,
+                               const char *name)
+{
+    char *path;
+    int i;
+
+    if (!warmboot_cache_is_snapshot(name)) {
+        return;
+    }
+    for (i = 0; i < *num; i++) {
+        if (strcmp((*names)[i], name) == 0) {
+            return;
+        }
+    }
+
+    path = archdep_join_paths(dir, name, NULL);
+    if (util_file_exists(path)) {
+        *names = lib_realloc(*names, sizeof(char *) * (size_t)(*num + 1));
+        (*names)[(*num)++] = lib_strdup(name);
+    }
+    lib_free(path);
+}
+
+/* Mark the snapshot `file' as the most recently used one and remove the
+   least recently used ones beyond WARMBOOT_CACHE_MAX.  The order is kept
+   in an index file next to the snapshots, snapshots it doesn't know about
+   count as the oldest.  */
+static void warmboot_cache_touch(const char *file)
+{
+    const char *dir = archdep_user_cache_path();
+    char *index_path, *path, *name, *entry;
+    char **names = NULL;
+    char buffer[256];
+    int num = 0, i;
+    size_t len;
+    ioutil_dir_t *ioutil_dir;
+    FILE *fd;
+
+    util_fname_split(file, NULL, &name);
+    warmboot_cache_add(&names, &num, dir, name);
+    lib_free(name);
+
+    index_path = archdep_join_paths(dir, WARMBOOT_INDEX_NAME, NULL);
+
+    fd = fopen(index_path, MODE_READ_TEXT);
+    if (fd != NULL) {
+        while (fgets(buffer, (int)sizeof(buffer), fd) != NULL) {
+            len = strlen(buffer);
+            while (len > 0 && (buffer[len - 1] == '\n' || buffer[len - 1] == '\r')) {
+                buffer[--len] = '\0';
+            }
+            warmboot_cache_add(&names, &num, dir, buffer);
+        }
+        fclose(fd);
+    }
+
+    ioutil_dir = ioutil_opendir(dir, IOUTIL_OPENDIR_NO_DOTFILES);
+    if (ioutil_dir != NULL) {
+        while ((entry = ioutil_readdir(ioutil_dir)) != NULL) {
+            warmboot_cache_add(&names, &num, dir, entry);
+        }
+        ioutil_closedir(ioutil_dir);
+    }
+
+    fd = fopen(index_path, MODE_WRITE_TEXT);
+    for (i = 0; i < num; i++) {
+        if (i < WARMBOOT_CACHE_MAX) {
+            if (fd != NULL) {
+                fprintf(fd, "%s\n", names[i]);
+            }
+        } else {
+            path = archdep_join_paths(dir, names[i], NULL);
+            log_message(autostart_log, "Removing warm boot snapshot `%s'.", path);
+            ioutil_remove(path);
+            lib_free(path);
+        }
+        lib_free(names[i]);
+    }
+    if (fd != NULL) {
+        fclose(fd);
+    }
+
+    lib_free(names);
+    lib_free(index_path);
+}
+
+static void warmboot_save_trap(uint16_t unused_addr, void *unused_data)
+{
+    if (warmboot_file == NULL) {
+        return;
+    }
+
+    if (machine_write_snapshot(warmboot_file, 0, 0, 0) < 0) {
+        log_warning(autostart_log, "Cannot save warm boot snapshot `%s'.",
+                    warmboot_file);
+        ioutil_remove(warmboot_file);
+    } else {
+        log_message(autostart_log, "Saved warm boot snapshot `%s'.",
+                    warmboot_file);
+        warmboot_cache_touch(warmboot_file);
+    }
+}
+
+static void warmboot_restore_trap(uint16_t unused_addr, void *unused_data)
+{
+    CLOCK extra_delay = autostart_initial_delay_cycles - min_cycles;
+
+    if (warmboot_file == NULL) {
+        return;
+    }
+
+    if (machine_read_snapshot(warmboot_file, 0) < 0) {
+        log_warning(autostart_log, "Cannot restore warm boot snapshot `%s', resetting.",
+                    warmboot_file);
+        ioutil_remove(warmboot_file);
+        warmboot_capture = 1;
+        autostart_ignore_reset = 1;
+        autostart_wait_for_reset = 1;
+        machine_trigger_reset(MACHINE_RESET_MODE_HARD);
+        return;
+    }
+
+    log_message(autostart_log, "Restored warm boot snapshot `%s'.", warmboot_file);
+    warmboot_cache_touch(warmboot_file);
+
+    /* the machine is at the READY prompt now, keep the random delay */
+    autostart_initial_delay_cycles = maincpu_clk + extra_delay;
+}
+
+/* Decide how to boot for autostart mode `mode'.  The machine is reset in
+   any case, the snapshot is restored right after the reset so nothing
+   pending from before the autostart survives.  */
+static void warmboot_start(unsigned int mode)
+{
+    lib_free(warmboot_file);
+    warmboot_file = NULL;
+    warmboot_restore = 0;
+    warmboot_capture = 0;
+
+    /* tape and snapshot autostarts depend on more than the machine state
+       at the READY prompt */
+    if (!AutostartWarmBoot
+        || (mode != AUTOSTART_HASDISK && mode != AUTOSTART_INJECT)
+        || network_connected() || event_record_active() || event_playback_active()) {
+        return;
+    }
+
+    warmboot_file = warmboot_cache_file();
+
+    if (util_file_exists(warmboot_file)) {
+        warmboot_restore = 1;
+    } else {
+        warmboot_capture = 1;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* Reset autostart.  */
 void autostart_reinit(CLOCK min_cycles_, int handle_tde)
 {
@@ -1094,6 +1336,10 @@ void autostart_advance(void)
 
     if (maincpu_clk < autostart_initial_delay_cycles) {
         autostart_wait_for_reset = 0;
+        if (warmboot_restore) {
+            warmboot_restore = 0;
+            interrupt_maincpu_trigger_trap(warmboot_restore_trap, NULL);
+        }
         return;
     }
 
@@ -1101,6 +1347,22 @@ void autostart_advance(void)
         return;
     }
 
+    /* take the warm boot snapshot before anything is typed or injected */
+    if (warmboot_capture) {
+        switch (check("READY.", AUTOSTART_WAIT_BLINK)) {
+            case YES:
+                warmboot_capture = 0;
+                interrupt_maincpu_trigger_trap(warmboot_save_trap, NULL);
+                return;
+            case NO:
+                warmboot_capture = 0;
+                break;
+            case NOT_YET:
+                check_rom_area();
+                return;
+        }
+    }
+
     /* DBG(("autostart_advance (%d)", autostartmode)); */
     
     switch (autostartmode) {
@@ -1195,6 +1457,8 @@ static void reboot_for_autostart(const char *program_name, unsigned int mode,
     }
     DBG(("reboot_for_autostart - autostart_initial_delay_cycles: %u", autostart_initial_delay_cycles));
 
+    warmboot_start(mode);
+
     machine_trigger_reset(MACHINE_RESET_MODE_HARD);
 
 /* FUUUUU and on *nix this causes funky results. wth! */    
@@ -1791,6 +2055,8 @@ void autostart_reset(void)
         }
         autostartmode = AUTOSTART_NONE;
         trigger_monitor = 0;
+        warmboot_restore = 0;
+        warmboot_capture = 0;
         deallocate_program_name();
         log_message(autostart_log, "Turned off.");
     }
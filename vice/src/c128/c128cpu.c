@@ -28,7 +28,6 @@
 
 #include "vice.h"
 
-#include "clkguard.h"
 #include "maincpu.h"
 #include "mem.h"
 #include "vicii.h"
@@ -102,11 +101,6 @@ inline static void c128cpu_memory_refresh_alarm_handler(void)
     }
 }
 
-static void clk_overflow_callback(CLOCK sub, void *unused_data)
-{
-    c128cpu_memory_refresh_clk -= sub;
-}
-
 #define CLK_ADD(clock, amount) c128cpu_clock_add(&clock, amount)
 
 #define REWIND_FETCH_OPCODE(clock) vicii_clock_add(clock, -(2 + opcode_cycle[0] + opcode_cycle[1]))
@@ -117,8 +111,6 @@ static void clk_overflow_callback(CLOCK sub, void *unused_data)
 
 #define CPU_ADDITIONAL_RESET() c128cpu_memory_refresh_clk = 11
 
-#define CPU_ADDITIONAL_INIT() clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL)
-
 #ifdef FEATURE_CPUMEMHISTORY
 #warning "CPUMEMHISTORY implementation for x128 is incomplete"
 static void memmap_mem_store(unsigned int addr, unsigned int value)
@@ -25,6 +25,7 @@
 
 #include "vice.h"
 
+#include "c64mem.h"
 #include "maincpu.h"
 #include "mem.h"
 
@@ -137,4 +138,6 @@ static void check_and_run_alternate_cpu(void)
 
 #define HAVE_Z80_REGS
 
+#define MEM_IDLE_READ(addr) mem_idle_read((uint16_t)(addr))
+
 #include "../maincpu.c"
@@ -73,6 +73,7 @@ extern void colorram_store(uint16_t addr, uint8_t value);
 extern uint8_t colorram_read(uint16_t addr);
 
 extern void mem_pla_config_changed(void);
+extern CLOCK mem_idle_read(uint16_t addr);
 extern void mem_set_tape_sense(int sense);
 extern void mem_set_tape_write_in(int val);
 extern void mem_set_tape_motor_in(int val);
@@ -162,8 +162,8 @@ fail:
    BYTE  | pport data out      |   0.0+  | CPU port data out lines state
    BYTE  | pport data read     |   0.0+  | CPU port data in lines state
    BYTE  | pport dir read      |   0.0+  | CPU port direction in lines state
-   DWORD | pport bit6 clock    |   0.1   | CPU port bit 6 falloff clock
-   DWORD | pport bit7 clock    |   0.1   | CPU port bit 7 falloff clock
+   CLOCK | pport bit6 clock    |   0.1   | CPU port bit 6 falloff clock
+   CLOCK | pport bit7 clock    |   0.1   | CPU port bit 7 falloff clock
    BYTE  | pport bit 6         |   0.1   | CPU port bit 6 state
    BYTE  | pport bit 7         |   0.1   | CPU port bit 7 state
    BYTE  | pport bit 6 falloff |   0.1   | CPU port bit 6 discharge flag
@@ -195,8 +195,8 @@ int c64_snapshot_write_module(snapshot_t *s, int save_roms)
         || SMW_B(m, pport.data_out) < 0
         || SMW_B(m, pport.data_read) < 0
         || SMW_B(m, pport.dir_read) < 0
-        || SMW_DW(m, (uint32_t)pport.data_set_clk_bit6) < 0
-        || SMW_DW(m, (uint32_t)pport.data_set_clk_bit7) < 0
+        || SMW_CLOCK(m, pport.data_set_clk_bit6) < 0
+        || SMW_CLOCK(m, pport.data_set_clk_bit7) < 0
         || SMW_B(m, pport.data_set_bit6) < 0
         || SMW_B(m, pport.data_set_bit7) < 0
         || SMW_B(m, pport.data_falloff_bit6) < 0
@@ -220,7 +220,6 @@ int c64_snapshot_read_module(snapshot_t *s)
 {
     uint8_t major_version, minor_version;
     snapshot_module_t *m;
-    int tmp_bit6, tmp_bit7;
 
     /* Main memory module.  */
 
@@ -251,16 +250,14 @@ int c64_snapshot_read_module(snapshot_t *s)
     /* new since 0.1 */
     if (!snapshot_version_is_smaller(major_version, minor_version, 0, 1)) {
         if (0
-            || SMR_DW_INT(m, &tmp_bit6) < 0
-            || SMR_DW_INT(m, &tmp_bit7) < 0
+            || SMR_CLOCK(m, &pport.data_set_clk_bit6) < 0
+            || SMR_CLOCK(m, &pport.data_set_clk_bit7) < 0
             || SMR_B(m, &pport.data_set_bit6) < 0
             || SMR_B(m, &pport.data_set_bit7) < 0
             || SMR_B(m, &pport.data_falloff_bit6) < 0
             || SMR_B(m, &pport.data_falloff_bit7) < 0) {
             goto fail;
         }
-        pport.data_set_clk_bit6 = (CLOCK)tmp_bit6;
-        pport.data_set_clk_bit7 = (CLOCK)tmp_bit7;
     } else {
         pport.data_set_bit6 = 0;
         pport.data_set_bit7 = 0;
@@ -66,6 +66,11 @@ char *machine_romset_file_list(void)
     return romset_file_list(machine_romset_resources_list);
 }
 
+char *machine_romset_file_crc_list(void)
+{
+    return romset_file_crc_list(machine_romset_resources_list);
+}
+
 int machine_romset_archive_item_create(const char *romset_name)
 {
     return romset_archive_item_create(romset_name, machine_romset_resources_list);
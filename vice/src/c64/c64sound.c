@@ -147,6 +147,7 @@ static sound_chip_t sid_sound_chip = {
     sid_sound_machine_init,              /* sound chip init function */
     sid_sound_machine_close,             /* sound chip close function */
     sid_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    sid_sound_machine_skip_samples,      /* sound chip skip samples function */
     sid_sound_machine_store,             /* sound chip store function */
     sid_sound_machine_read,              /* sound chip read function */
     sid_sound_machine_reset,             /* sound chip reset function */
@@ -304,11 +305,6 @@ void machine_sid2_enable(int val)
     }
 }
 
-void sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub)
-{
-    sid_sound_machine_prevent_clk_overflow(psid, sub);
-}
-
 char *sound_machine_dump_state(sound_t *psid)
 {
     return sid_sound_machine_dump_state(psid);
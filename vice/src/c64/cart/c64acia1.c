@@ -32,7 +32,6 @@
 #define mycpu           maincpu
 #define myclk           maincpu_clk
 #define mycpu_rmw_flag  maincpu_rmw_flag
-#define mycpu_clk_guard maincpu_clk_guard
 
 #define myacia acia1
 
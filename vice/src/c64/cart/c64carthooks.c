@@ -125,6 +125,7 @@
 #include "silverrock128.h"
 #include "simonsbasic.h"
 #include "snapshot64.h"
+#include "spi-sdcard.h"
 #include "stardos.h"
 #include "stb.h"
 #include "supergames.h"
@@ -1722,7 +1723,11 @@ void cartridge_shutdown(void)
     magicvoice_shutdown();
     /* mmc64_shutdown(); */
 
+    /* write back the SD card image of MMC64 and MMC Replay */
+    mmc_close_card_image();
+
     /* "Main Slot" */
+    ide64_shutdown();
     /* "Slot 1" */
     /* "IO Slot" */
 }
@@ -2568,8 +2573,8 @@ int cartridge_snapshot_write_modules(struct snapshot_s *s)
         || SMW_B(m, (uint8_t)export_ram) < 0
         || SMW_B(m, export.ultimax_phi1) < 0
         || SMW_B(m, export.ultimax_phi2) < 0
-        || SMW_DW(m, (uint32_t)cart_freeze_alarm_time) < 0
-        || SMW_DW(m, (uint32_t)cart_nmi_alarm_time) < 0
+        || SMW_CLOCK(m, cart_freeze_alarm_time) < 0
+        || SMW_CLOCK(m, cart_nmi_alarm_time) < 0
         || SMW_B(m, export_slot1.game) < 0
         || SMW_B(m, export_slot1.exrom) < 0
         || SMW_B(m, export_slot1.ultimax_phi1) < 0
@@ -3069,8 +3074,8 @@ int cartridge_snapshot_read_modules(struct snapshot_s *s)
         || SMR_B_INT(m, &export_ram) < 0
         || SMR_B(m, &export.ultimax_phi1) < 0
         || SMR_B(m, &export.ultimax_phi2) < 0
-        || SMR_DW(m, &cart_freeze_alarm_time) < 0
-        || SMR_DW(m, &cart_nmi_alarm_time) < 0
+        || SMR_CLOCK(m, &cart_freeze_alarm_time) < 0
+        || SMR_CLOCK(m, &cart_nmi_alarm_time) < 0
         || SMR_B(m, &export_slot1.game) < 0
         || SMR_B(m, &export_slot1.exrom) < 0
         || SMR_B(m, &export_slot1.ultimax_phi1) < 0
@@ -189,6 +189,7 @@ static sound_chip_t clockport_mp3at64_sound_chip = {
     clockport_mp3at64_sound_machine_init,              /* sound chip init function */
     clockport_mp3at64_sound_machine_close,             /* sound chip close function */
     clockport_mp3at64_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                              /* NO sound chip skip samples function */
     NULL,                                              /* NO sound chip store function */
     NULL,                                              /* NO sound chip read function */
     clockport_mp3at64_sound_reset,                     /* sound chip reset function */
@@ -1535,6 +1535,18 @@ void ide64_detach(void)
     debug("IDE64 detached");
 }
 
+/* Write back the drive images, they are cached while attached */
+void ide64_shutdown(void)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        if (drives[i].drv) {
+            ata_image_detach(drives[i].drv);
+        }
+    }
+}
+
 static int ide64_common_attach(uint8_t *rawcart, int detect)
 {
     int i;
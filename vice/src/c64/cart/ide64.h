@@ -41,6 +41,7 @@ extern int ide64_bin_attach(const char *filename, uint8_t *rawcart);
 extern int ide64_crt_attach(FILE *fd, uint8_t *rawcart);
 extern char *ide64_image_file;
 extern void ide64_detach(void);
+extern void ide64_shutdown(void);
 
 extern uint8_t ide64_rom_read(uint16_t addr);
 extern uint8_t ide64_ram_read(uint16_t addr);
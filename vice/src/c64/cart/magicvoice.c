@@ -866,6 +866,7 @@ static sound_chip_t magicvoice_sound_chip = {
     magicvoice_sound_machine_init,              /* sound chip init function */
     magicvoice_sound_machine_close,             /* sound chip close function */
     magicvoice_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                       /* NO sound chip skip samples function */
     NULL,                                       /* NO sound chip store function */
     NULL,                                       /* NO sound chip read function */
     magicvoice_sound_machine_reset,             /* sound chip reset function, currently only used for debug */
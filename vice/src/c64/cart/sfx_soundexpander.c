@@ -148,6 +148,7 @@ static sound_chip_t sfx_soundexpander_sound_chip = {
     sfx_soundexpander_sound_machine_init,              /* sound chip init function */
     sfx_soundexpander_sound_machine_close,             /* sound chip close function */
     sfx_soundexpander_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                              /* NO sound chip skip samples function */
     sfx_soundexpander_sound_machine_store,             /* sound chip store function */
     sfx_soundexpander_sound_machine_read,              /* sound chip read function */
     sfx_soundexpander_sound_reset,                     /* sound chip reset function */
@@ -122,6 +122,7 @@ static sound_chip_t sfx_soundsampler_sound_chip = {
     sfx_soundsampler_sound_machine_init,              /* sound chip init function */
     NULL,                                             /* NO sound chip close function */
     sfx_soundsampler_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                             /* NO sound chip skip samples function */
     sfx_soundsampler_sound_machine_store,             /* sound chip store function */
     sfx_soundsampler_sound_machine_read,              /* sound chip read function */
     sfx_soundsampler_sound_reset,                     /* sound chip reset function */
@@ -396,7 +396,7 @@ int stardos_snapshot_write_module(snapshot_t *s)
     }
 
     if (0
-        || (SMW_DW(m, stardos_alarm_time) < 0)
+        || (SMW_CLOCK(m, stardos_alarm_time) < 0)
         || (SMW_DW(m, (uint32_t)cap_voltage) < 0)
         || (SMW_B(m, (uint8_t)roml_enable) < 0)
         || (SMW_BA(m, roml_banks, 0x2000) < 0)
@@ -426,7 +426,7 @@ int stardos_snapshot_read_module(snapshot_t *s)
     }
 
     if (0
-        || (SMR_DW(m, &temp_clk) < 0)
+        || (SMR_CLOCK(m, &temp_clk) < 0)
         || (SMR_DW_INT(m, &cap_voltage) < 0)
         || (SMR_B_INT(m, &roml_enable) < 0)
         || (SMR_BA(m, roml_banks, 0x2000) < 0)
@@ -0,0 +1,600 @@
+/** \file   vsid-render.c
+ * \brief   Non-interactive rendering of PSID files to audio files
+ *
+ * When the PSIDRenderList resource names a list of tunes, VSID plays them
+ * one after another in warp mode and records each to a file with one of
+ * the recording sound devices, then quits.
+ *
+ * Each line of the list is a PSID file, optionally followed by a tune
+ * number; without a number all tunes of the file are rendered.  Empty
+ * lines and lines starting with '#' or ';' are ignored.  Tune lengths are
+ * taken from the HVSC song length database, PSIDRenderLength seconds are
+ * used for tunes it does not know.
+ *
+ * The emulator can only play one tune at a time, so on systems with
+ * fork() the list is rendered by several worker processes that take the
+ * entries from a pipe.  This is only done when no UI is running: a toolkit
+ * does not survive being forked, and the parent waits for the workers.
+ * Otherwise the list is rendered in turn by the emulator itself.
+ */
+
+/*
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(UNIX_COMPILE) && defined(HAVE_FORK)
+#define VSID_RENDER_FORK
+#include <errno.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "archdep.h"
+#include "cmdline.h"
+#include "hvsc.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "maincpu.h"
+#include "psid.h"
+#include "resources.h"
+#include "sound.h"
+#include "util.h"
+#include "vsid-render.h"
+#include "vsyncapi.h"
+#include "workqueue.h"
+
+
+/** \brief  One line of the render list */
+typedef struct render_entry_s {
+    char *path;     /**< PSID file */
+    int tune;       /**< tune to render, 0 for all tunes */
+} render_entry_t;
+
+static char *render_list = NULL;
+static char *render_dir = NULL;
+static char *render_format = NULL;
+static int render_jobs = 0;
+static int render_length = 180;
+
+static log_t render_log = LOG_ERR;
+
+static render_entry_t *entries = NULL;
+static int num_entries = 0;
+
+static int started = 0;
+static int worker = 0;          /* worker process number, 0 if none */
+static int job_fd = -1;         /* read end of the job pipe in workers */
+static int next_entry = 0;      /* next entry when there are no workers */
+static unsigned long start_time;
+
+/* tune being rendered */
+static int cur_entry = -1;
+static int cur_tune = 0;
+static int cur_last_tune = 0;
+static long *cur_lengths = NULL;
+static int cur_num_lengths = 0;
+static char *cur_file = NULL;
+static long cur_seconds = 0;
+static CLOCK cur_end_clk = 0;
+static unsigned long cur_start_time;
+
+static int num_rendered = 0;
+static int num_failed = 0;
+
+
+/*-----------------------------------------------------------------------*/
+
+static int set_render_list(const char *val, void *param)
+{
+    util_string_set(&render_list, val);
+    return 0;
+}
+
+static int set_render_dir(const char *val, void *param)
+{
+    util_string_set(&render_dir, val);
+    return 0;
+}
+
+static int set_render_format(const char *val, void *param)
+{
+    util_string_set(&render_format, val);
+    return 0;
+}
+
+static int set_render_jobs(int val, void *param)
+{
+    if (val < 0) {
+        return -1;
+    }
+    render_jobs = val;
+    return 0;
+}
+
+static int set_render_length(int val, void *param)
+{
+    if (val < 1) {
+        return -1;
+    }
+    render_length = val;
+    return 0;
+}
+
+static const resource_string_t resources_string[] = {
+    { "PSIDRenderList", "", RES_EVENT_NO, NULL,
+      &render_list, set_render_list, NULL },
+    { "PSIDRenderDir", ".", RES_EVENT_NO, NULL,
+      &render_dir, set_render_dir, NULL },
+    { "PSIDRenderFormat", "wav", RES_EVENT_NO, NULL,
+      &render_format, set_render_format, NULL },
+    RESOURCE_STRING_LIST_END
+};
+
+static const resource_int_t resources_int[] = {
+    { "PSIDRenderJobs", 0, RES_EVENT_NO, NULL,
+      &render_jobs, set_render_jobs, NULL },
+    { "PSIDRenderLength", 180, RES_EVENT_NO, NULL,
+      &render_length, set_render_length, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+/** \brief  Register PSID render resources
+ *
+ * \return  0 on success, -1 on error
+ */
+int vsid_render_resources_init(void)
+{
+    if (resources_register_string(resources_string) < 0) {
+        return -1;
+    }
+    return resources_register_int(resources_int);
+}
+
+/** \brief  Free memory used by PSID render resources and the list
+ */
+void vsid_render_resources_shutdown(void)
+{
+    int i;
+
+    for (i = 0; i < num_entries; i++) {
+        lib_free(entries[i].path);
+    }
+    lib_free(entries);
+    entries = NULL;
+    num_entries = 0;
+
+    lib_free(render_list);
+    lib_free(render_dir);
+    lib_free(render_format);
+    render_list = NULL;
+    render_dir = NULL;
+    render_format = NULL;
+}
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-render", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "PSIDRenderList", NULL,
+      "<Name>", "Render the tunes listed in file <Name> to audio files and quit" },
+    { "-renderdir", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "PSIDRenderDir", NULL,
+      "<path>", "Set directory for rendered audio files" },
+    { "-renderformat", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "PSIDRenderFormat", NULL,
+      "<Name>", "Set recording sound driver used for rendered tunes (wav, aiff, voc, iff, flac, ogg)" },
+    { "-renderjobs", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "PSIDRenderJobs", NULL,
+      "<value>", "Set number of tunes rendered at the same time (0: one per CPU)" },
+    { "-renderlength", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "PSIDRenderLength", NULL,
+      "<seconds>", "Set length of tunes not in the song length database" },
+    CMDLINE_LIST_END
+};
+
+/** \brief  Register PSID render command line options
+ *
+ * \return  0 on success, -1 on error
+ */
+int vsid_render_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+
+/*-----------------------------------------------------------------------*/
+
+static int render_load_list(void)
+{
+    FILE *f;
+    char buf[4096];
+    char *p;
+    int len, tune;
+    int size = 0;
+
+    f = fopen(render_list, MODE_READ);
+    if (f == NULL) {
+        log_error(render_log, "Cannot open render list `%s'.", render_list);
+        return -1;
+    }
+
+    while ((len = util_get_line(buf, (int)sizeof(buf), f)) >= 0) {
+        if (len == 0 || buf[0] == '#' || buf[0] == ';') {
+            continue;
+        }
+
+        /* a trailing number is the tune */
+        tune = 0;
+        p = strrchr(buf, ' ');
+        if (p == NULL) {
+            p = strrchr(buf, '\t');
+        }
+        if (p != NULL && p[1] != '\0' && strspn(p + 1, "0123456789") == strlen(p + 1)) {
+            tune = atoi(p + 1);
+            while (p > buf && (*p == ' ' || *p == '\t')) {
+                *p-- = '\0';
+            }
+        }
+
+        if (num_entries == size) {
+            size = size ? size * 2 : 64;
+            entries = lib_realloc(entries, sizeof(render_entry_t) * (size_t)size);
+        }
+        entries[num_entries].path = lib_strdup(buf);
+        entries[num_entries].tune = tune;
+        num_entries++;
+    }
+    fclose(f);
+
+    if (num_entries == 0) {
+        log_error(render_log, "No tunes in render list `%s'.", render_list);
+        return -1;
+    }
+    return 0;
+}
+
+/* Build the name of the file for `tune' of `path': the path below the HVSC
+   root (or just the file name) with the directories flattened, so equal
+   file names in different directories do not clash.  */
+static char *render_output_name(const char *path, int tune)
+{
+    const char *root = NULL;
+    const char *rel = path;
+    char *name, *result, *p, *base;
+
+    if (resources_get_string("HVSCRoot", &root) == 0 && root != NULL
+        && *root != '\0' && strncmp(path, root, strlen(root)) == 0) {
+        rel = path + strlen(root);
+    } else {
+        p = strrchr(path, FSDEV_DIR_SEP_CHR);
+        if (p == NULL) {
+            p = strrchr(path, '/');
+        }
+        if (p != NULL) {
+            rel = p + 1;
+        }
+    }
+    while (*rel == '/' || *rel == FSDEV_DIR_SEP_CHR) {
+        rel++;
+    }
+
+    name = lib_strdup(rel);
+    base = name;
+    for (p = name; *p != '\0'; p++) {
+        if (*p == '/' || *p == FSDEV_DIR_SEP_CHR || *p == ':') {
+            *p = '_';
+            base = p + 1;
+        }
+    }
+    p = strrchr(base, '.');
+    if (p != NULL && p != base) {
+        *p = '\0';
+    }
+
+    result = lib_msprintf("%s%c%s-%02d.%s", render_dir, FSDEV_DIR_SEP_CHR,
+                          name, tune, render_format);
+    lib_free(name);
+    return result;
+}
+
+static double render_elapsed(unsigned long since)
+{
+    return (double)(vsyncarch_gettime() - since) / (double)vsyncarch_frequency();
+}
+
+static int render_next_entry(void)
+{
+#ifdef VSID_RENDER_FORK
+    int index;
+    ssize_t n;
+
+    if (job_fd >= 0) {
+        do {
+            n = read(job_fd, &index, sizeof(index));
+        } while (n < 0 && errno == EINTR);
+
+        return (n == (ssize_t)sizeof(index)) ? index : -1;
+    }
+#endif
+    return (next_entry < num_entries) ? next_entry++ : -1;
+}
+
+/* Load the next PSID file from the list, returns -1 at the end of the
+   list.  */
+static int render_open_entry(void)
+{
+    render_entry_t *entry;
+    int default_tune, tunes;
+
+    free(cur_lengths);      /* allocated by the hvsc library */
+    cur_lengths = NULL;
+    cur_num_lengths = 0;
+
+    while ((cur_entry = render_next_entry()) >= 0) {
+        entry = &entries[cur_entry];
+
+        if (machine_autodetect_psid(entry->path) < 0) {
+            log_error(render_log, "`%s' is not a valid PSID file.", entry->path);
+            num_failed++;
+            continue;
+        }
+        tunes = psid_tunes(&default_tune);
+        if (entry->tune > tunes) {
+            log_error(render_log, "`%s' has no tune %d.", entry->path, entry->tune);
+            num_failed++;
+            continue;
+        }
+
+        if (entry->tune > 0) {
+            cur_tune = entry->tune;
+            cur_last_tune = entry->tune;
+        } else {
+            cur_tune = 1;
+            cur_last_tune = tunes;
+        }
+        cur_num_lengths = hvsc_sldb_get_lengths(entry->path, &cur_lengths);
+        return 0;
+    }
+    return -1;
+}
+
+/* Start recording the next tune, returns -1 when everything is done.  */
+static int render_start_tune(void)
+{
+    if (cur_entry < 0 || cur_tune > cur_last_tune) {
+        if (render_open_entry() < 0) {
+            return -1;
+        }
+    }
+
+    cur_seconds = render_length;
+    if (cur_lengths != NULL && cur_tune <= cur_num_lengths
+        && cur_lengths[cur_tune - 1] > 0) {
+        cur_seconds = cur_lengths[cur_tune - 1];
+    }
+    cur_file = render_output_name(entries[cur_entry].path, cur_tune);
+
+    psid_init_driver();
+    machine_play_psid(cur_tune);
+    machine_trigger_reset(MACHINE_RESET_MODE_SOFT);
+
+    /* the sound device is reopened with the new file on the next flush */
+    resources_set_string("SoundRecordDeviceArg", cur_file);
+    resources_set_string("SoundRecordDeviceName", render_format);
+
+    /* The reset puts the clock back when the CPU gets to it, so the end of
+       the tune is only known on the next frame.  */
+    cur_end_clk = 0;
+    cur_start_time = vsyncarch_gettime();
+
+    return 0;
+}
+
+static void render_finish_tune(void)
+{
+    double elapsed = render_elapsed(cur_start_time);
+    char stats[64];
+
+    if (!sound_is_recording()) {
+        /* the recording device failed and reset the resource */
+        log_error(render_log, "%s #%d: could not record `%s'.",
+                  entries[cur_entry].path, cur_tune, cur_file);
+        num_failed++;
+    } else {
+        /* log_message isn't guaranteed to handle "%f" */
+        sprintf(stats, "%.2fs (%.1fx realtime)", elapsed,
+                elapsed > 0.0 ? (double)cur_seconds / elapsed : 0.0);
+        log_message(render_log, "%s #%d: %lds rendered in %s to `%s'.",
+                    entries[cur_entry].path, cur_tune, cur_seconds, stats,
+                    cur_file);
+        num_rendered++;
+    }
+
+    lib_free(cur_file);
+    cur_file = NULL;
+    cur_tune++;
+}
+
+static void render_done(void)
+{
+    char stats[32];
+
+    sprintf(stats, "%.1fs", render_elapsed(start_time));
+    if (worker > 0) {
+        log_message(render_log, "Worker %d: %d tunes rendered, %d failed, %s.",
+                    worker, num_rendered, num_failed, stats);
+    } else {
+        log_message(render_log, "%d tunes rendered, %d failed, %s.",
+                    num_rendered, num_failed, stats);
+    }
+    archdep_vice_exit(num_failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+#ifdef VSID_RENDER_FORK
+/* Forking is only safe without a UI, see the top of the file.  */
+static int render_can_fork(void)
+{
+#if defined(USE_NATIVE_GTK3) || defined(USE_SDLUI) || defined(USE_SDLUI2)
+    return console_mode;
+#else
+    return 1;
+#endif
+}
+
+/* Fork `jobs' workers and feed them the list.  Returns in the workers, and
+   in the parent if no worker could be started.  */
+static void render_fork_workers(int jobs)
+{
+    pid_t *pids;
+    pid_t pid;
+    int fds[2];
+    int i, status, n = 0, failed = 0;
+    char stats[32];
+
+    if (pipe(fds) < 0) {
+        log_error(render_log, "Cannot create job pipe: %s.", strerror(errno));
+        return;
+    }
+
+    pids = lib_malloc(sizeof(pid_t) * (size_t)jobs);
+    fflush(stdout);
+    fflush(stderr);
+
+    for (i = 0; i < jobs; i++) {
+        pid = fork();
+        if (pid == 0) {
+            close(fds[1]);
+            job_fd = fds[0];
+            worker = i + 1;
+            lib_free(pids);
+            return;
+        }
+        if (pid < 0) {
+            log_error(render_log, "Cannot start worker: %s.", strerror(errno));
+            break;
+        }
+        pids[n++] = pid;
+    }
+    close(fds[0]);
+
+    if (n == 0) {
+        close(fds[1]);
+        lib_free(pids);
+        return;
+    }
+
+    log_message(render_log, "Rendering %d entries with %d workers.", num_entries, n);
+
+    /* a worker that died must not take the parent with it */
+    signal(SIGPIPE, SIG_IGN);
+    for (i = 0; i < num_entries; i++) {
+        if (write(fds[1], &i, sizeof(i)) != (ssize_t)sizeof(i)) {
+            log_error(render_log, "Workers stopped taking jobs.");
+            failed = 1;
+            break;
+        }
+    }
+    close(fds[1]);
+
+    for (i = 0; i < n; i++) {
+        if (waitpid(pids[i], &status, 0) != pids[i]
+            || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = 1;
+        }
+    }
+    lib_free(pids);
+
+    sprintf(stats, "%.1fs", render_elapsed(start_time));
+    log_message(render_log, "All workers done%s, %s.",
+                failed ? " (with errors)" : "", stats);
+    archdep_vice_exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+#endif
+
+static void render_start(void)
+{
+    int jobs;
+
+    render_log = log_open("VSIDRender");
+    start_time = vsyncarch_gettime();
+
+    if (render_load_list() < 0) {
+        archdep_vice_exit(EXIT_FAILURE);
+    }
+
+    /* Samples are only calculated in warp mode while recording, and the
+       dummy device keeps the playback side from throttling.  */
+    resources_set_string("SoundRecordDeviceName", "");
+    resources_set_string("SoundDeviceName", "dummy");
+    resources_set_int("Sound", 1);
+    resources_set_int("WarpMode", 1);
+
+    jobs = render_jobs > 0 ? render_jobs : workqueue_cpu_count();
+    if (jobs > num_entries) {
+        jobs = num_entries;
+    }
+#ifdef VSID_RENDER_FORK
+    if (jobs > 1 && render_can_fork()) {
+        render_fork_workers(jobs);
+    }
+#endif
+    if (worker == 0) {
+        log_message(render_log, "Rendering %d entries.", num_entries);
+    }
+}
+
+/** \brief  Advance the render list, called at the end of every frame
+ */
+void vsid_render_vsync(void)
+{
+    if (render_list == NULL || *render_list == '\0') {
+        return;
+    }
+
+    if (!started) {
+        started = 1;
+        render_start();
+    }
+
+    if (cur_file != NULL) {
+        if (cur_end_clk == 0) {
+            /* psid_init_driver() may have switched between PAL and NTSC */
+            cur_end_clk = maincpu_clk + (CLOCK)cur_seconds
+                                        * (CLOCK)machine_get_cycles_per_second();
+            return;
+        }
+        if (maincpu_clk < cur_end_clk) {
+            return;
+        }
+        render_finish_tune();
+    }
+
+    if (render_start_tune() < 0) {
+        render_done();
+    }
+}
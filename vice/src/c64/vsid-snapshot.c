@@ -51,8 +51,12 @@
 #include "vice-event.h"
 #include "vicii.h"
 
-#define SNAP_MAJOR 1
-#define SNAP_MINOR 1
+#define SNAP_MAJOR 2
+#define SNAP_MINOR 0
+
+/* Last version written with 32-bit clocks, still read as such */
+#define SNAP_MAJOR_CLOCK32 1
+#define SNAP_MINOR_CLOCK32 1
 
 int c64_snapshot_write(const char *name, int save_roms, int save_disks, int event_mode)
 {
@@ -96,7 +100,8 @@ int c64_snapshot_read(const char *name, int event_mode)
         return -1;
     }
 
-    if (!snapshot_version_is_equal(major, minor, SNAP_MAJOR, SNAP_MINOR)) {
+    if (!snapshot_version_is_equal(major, minor, SNAP_MAJOR, SNAP_MINOR)
+        && !snapshot_version_is_equal(major, minor, SNAP_MAJOR_CLOCK32, SNAP_MINOR_CLOCK32)) {
         log_error(LOG_DEFAULT, "Snapshot version (%d.%d) not valid: expecting %d.%d.", major, minor, SNAP_MAJOR, SNAP_MINOR);
         snapshot_set_error(SNAPSHOT_MODULE_INCOMPATIBLE);
         goto fail;
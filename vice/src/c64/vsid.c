@@ -44,7 +44,6 @@
 #include "c64gluelogic.h"
 #include "c64mem.h"
 #include "cia.h"
-#include "clkguard.h"
 #include "debug.h"
 #include "drive.h"
 #include "imagecontents.h"
@@ -66,6 +65,7 @@
 #include "vicii-mem.h"
 #include "video.h"
 #include "vsid-cmdline-options.h"
+#include "vsid-render.h"
 #include "vsidui.h"
 #include "vsid-debugcart.h"
 #include "vsync.h"
@@ -111,6 +111,10 @@ int machine_resources_init(void)
         init_resource_fail("psid");
         return -1;
     }
+    if (vsid_render_resources_init() < 0) {
+        init_resource_fail("psid render");
+        return -1;
+    }
     if (debugcart_resources_init() < 0) {
         init_resource_fail("debug cart");
         return -1;
@@ -128,6 +132,7 @@ void machine_resources_shutdown(void)
 {
     c64_resources_shutdown();
     debugcart_resources_shutdown();
+    vsid_render_resources_shutdown();
 }
 
 /* C64-specific command-line option initialization.  */
@@ -151,6 +156,10 @@ int machine_cmdline_options_init(void)
         init_cmdline_options_fail("psid");
         return -1;
     }
+    if (vsid_render_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("psid render");
+        return -1;
+    }
     if (debugcart_cmdline_options_init() < 0) {
         init_cmdline_options_fail("debug cart");
         return -1;
@@ -322,7 +331,7 @@ static void machine_vsync_hook(void)
         vsid_ui_display_time(playtime);
     }
 
-    clk_guard_prevent_overflow(maincpu_clk_guard);
+    vsid_render_vsync();
 }
 
 void machine_set_restore_key(int v)
@@ -396,7 +405,6 @@ void machine_change_timing(int timeval, int border_mode)
     sound_set_machine_parameter(machine_timing.cycles_per_sec, machine_timing.cycles_per_rfsh);
     debug_set_machine_parameter(machine_timing.cycles_per_line, machine_timing.screen_lines);
     sid_set_machine_parameter(machine_timing.cycles_per_sec);
-    clk_guard_set_clk_base(maincpu_clk_guard, machine_timing.cycles_per_rfsh);
 
     vicii_change_timing(&machine_timing);
 
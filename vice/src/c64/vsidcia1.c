@@ -220,7 +220,7 @@ static void store_sdr(cia_context_t *cia_context, uint8_t byte)
 
 void cia1_init(cia_context_t *cia_context)
 {
-    ciacore_init(machine_context.cia1, maincpu_alarm_context, maincpu_int_status, maincpu_clk_guard);
+    ciacore_init(machine_context.cia1, maincpu_alarm_context, maincpu_int_status);
 }
 
 void cia1_setup_context(machine_context_t *machine_ctx)
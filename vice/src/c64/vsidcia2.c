@@ -200,7 +200,7 @@ void cia2_set_sdrx(uint8_t received_byte)
 
 void cia2_init(cia_context_t *cia_context)
 {
-    ciacore_init(machine_context.cia2, maincpu_alarm_context, maincpu_int_status, maincpu_clk_guard);
+    ciacore_init(machine_context.cia2, maincpu_alarm_context, maincpu_int_status);
 }
 
 void cia2_setup_context(machine_context_t *machine_ctx)
@@ -25,6 +25,7 @@
 
 #include "vice.h"
 
+#include "c64mem.h"
 #include "maincpu.h"
 #include "mem.h"
 
@@ -110,4 +111,6 @@ static uint8_t memmap_mem_read_dummy(unsigned int addr)
 }
 #endif
 
+#define MEM_IDLE_READ(addr) mem_idle_read((uint16_t)(addr))
+
 #include "../maincpu.c"
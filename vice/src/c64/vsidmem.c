@@ -47,7 +47,6 @@
 #include "cartio.h"
 #include "cartridge.h"
 #include "cia.h"
-#include "clkguard.h"
 #include "machine.h"
 #include "maincpu.h"
 #include "mem.h"
@@ -197,27 +196,8 @@ void mem_toggle_watchpoints(int flag, void *context)
     see testprogs/CPU/cpuport for details and tests
 */
 
-static void clk_overflow_callback(CLOCK sub, void *unused_data)
-{
-    if (pport.data_set_clk_bit6 > (CLOCK)0) {
-        pport.data_set_clk_bit6 -= sub;
-    }
-    if (pport.data_falloff_bit6 && (pport.data_set_clk_bit6 < maincpu_clk)) {
-        pport.data_falloff_bit6 = 0;
-        pport.data_set_bit6 = 0;
-    }
-    if (pport.data_set_clk_bit7 > (CLOCK)0) {
-        pport.data_set_clk_bit7 -= sub;
-    }
-    if (pport.data_falloff_bit7 && (pport.data_set_clk_bit7 < maincpu_clk)) {
-        pport.data_falloff_bit7 = 0;
-        pport.data_set_bit7 = 0;
-    }
-}
-
 void c64_mem_init(void)
 {
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
 }
 
 void mem_pla_config_changed(void)
@@ -582,6 +562,33 @@ void mem_mmu_translate(unsigned int addr, uint8_t **base, int *start, int *limit
     }
 }
 
+/* Return the clock up to which reading `addr' keeps giving the same value
+   without side effects, or 0 if that is not known.  Used by the busy loop
+   detection of the CPU.  */
+CLOCK mem_idle_read(uint16_t addr)
+{
+    read_func_ptr_t read = _mem_read_tab_ptr[addr >> 8];
+
+    if (_mem_read_tab_ptr == mem_read_tab_watch) {
+        /* every read has to reach the watchpoints */
+        return 0;
+    }
+    if (_mem_read_base_tab_ptr[addr >> 8] != NULL) {
+        /* the unused bits of the processor port fade by themselves */
+        return addr > 1 ? CLOCK_MAX : 0;
+    }
+    if (read == vicii_read) {
+        return vicii_idle_read(addr);
+    }
+    if (read == cia1_read) {
+        return ciacore_idle_read(machine_context.cia1, addr);
+    }
+    if (read == cia2_read) {
+        return ciacore_idle_read(machine_context.cia2, addr);
+    }
+    return 0;
+}
+
 /* ------------------------------------------------------------------------- */
 
 /* Initialize RAM for power-up.  */
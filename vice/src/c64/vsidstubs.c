@@ -366,6 +366,10 @@ int tap_seek_start(tap_t *tap)
     return 0;
 }
 
+void tap_data_load(tap_t *tap)
+{
+}
+
 int tape_image_create(const char *name, unsigned int type)
 {
     return 0;
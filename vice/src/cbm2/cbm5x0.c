@@ -48,7 +48,6 @@
 #include "cbm2tpi.h"
 #include "cbm2ui.h"
 #include "cia.h"
-#include "clkguard.h"
 #include "datasette.h"
 #include "debug.h"
 #include "debugcart.h"
@@ -507,11 +506,6 @@ static void c500_powerline_clk_alarm_handler(CLOCK offset, void *data)
     SIGNAL_VERT_BLANK_ON
 }
 
-static void c500_powerline_clk_overflow_callback(CLOCK sub, void *data)
-{
-    c500_powerline_clk -= sub;
-}
-
 
 /*
  * C500 extra data (state of 50Hz clk)
@@ -652,8 +646,6 @@ int machine_specific_init(void)
                                          "C500PowerlineClk",
                                          c500_powerline_clk_alarm_handler,
                                          NULL);
-    clk_guard_add_callback(maincpu_clk_guard,
-                           c500_powerline_clk_overflow_callback, NULL);
     machine_timing.cycles_per_sec = C500_PAL_CYCLES_PER_SEC;
     machine_timing.rfsh_per_sec = C500_PAL_RFSH_PER_SEC;
     machine_timing.cycles_per_rfsh = C500_PAL_CYCLES_PER_RFSH;
@@ -798,19 +790,11 @@ void machine_handle_pending_alarms(int num_write_cycles)
 /* This hook is called at the end of every frame.  */
 static void machine_vsync_hook(void)
 {
-    CLOCK sub;
-
     drive_vsync_hook();
 
     autostart_advance();
 
     screenshot_record();
-
-    sub = clk_guard_prevent_overflow(maincpu_clk_guard);
-
-    /* The drive has to deal both with our overflowing and its own one, so
-       it is called even when there is no overflowing in the main CPU.  */
-    drive_cpu_prevent_clk_overflow_all(sub);
 }
 
 /* Dummy - no restore key.  */
@@ -876,7 +860,6 @@ void machine_change_timing(int timeval, int border_mode)
 #ifdef HAVE_MOUSE
     neos_mouse_set_machine_parameter(machine_timing.cycles_per_sec);
 #endif
-    clk_guard_set_clk_base(maincpu_clk_guard, machine_timing.cycles_per_rfsh);
 
     vicii_change_timing(&machine_timing, border_mode);
     cia1_set_timing(machine_context.cia1, machine_timing.cycles_per_sec, machine_timing.power_freq);
@@ -65,7 +65,6 @@
 struct alarm_context_s;
 struct cia_context_s;
 struct ciat_s;
-struct clk_guard_s;
 struct interrupt_cpu_status_s;
 struct snapshot_s;
 
@@ -153,14 +152,14 @@ typedef struct cia_context_s {
 extern void ciacore_setup_context(struct cia_context_s *cia_context);
 extern void ciacore_init(struct cia_context_s *cia_context,
                          struct alarm_context_s *alarm_context,
-                         struct interrupt_cpu_status_s *int_status,
-                         struct clk_guard_s *clk_guard);
+                         struct interrupt_cpu_status_s *int_status);
 extern void ciacore_shutdown(cia_context_t *cia_context);
 extern void ciacore_reset(struct cia_context_s *cia_context);
 extern void ciacore_disable(struct cia_context_s *cia_context);
 extern void ciacore_store(struct cia_context_s *cia_context, uint16_t addr, uint8_t data);
 extern uint8_t ciacore_read(struct cia_context_s *cia_context, uint16_t addr);
 extern uint8_t ciacore_peek(struct cia_context_s *cia_context, uint16_t addr);
+extern CLOCK ciacore_idle_read(struct cia_context_s *cia_context, uint16_t addr);
 
 extern void ciacore_set_flag(struct cia_context_s *cia_context);
 extern void ciacore_set_sdr(struct cia_context_s *cia_context, uint8_t data);
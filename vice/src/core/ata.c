@@ -26,22 +26,13 @@
 
 #include "vice.h"
 
-/* required for off_t on some platforms */
-#ifdef HAVE_SYS_TYPES_H
-#include <sys/types.h>
-#endif
-
-/* VAC++ has off_t in sys/stat.h */
-#ifdef __IBMC__
-#include <sys/stat.h>
-#endif
-
 #include <stdio.h>
 #include <string.h>
 
 #include "archdep.h"
 #include "log.h"
 #include "ata.h"
+#include "blockimage.h"
 #include "snapshot.h"
 #include "types.h"
 #include "util.h"
@@ -50,11 +41,6 @@
 #include "maincpu.h"
 #include "monitor.h"
 
-#ifndef HAVE_FSEEKO
-#define fseeko(a, b, c) fseek(a, b, c)
-#define ftello(a) ftell(a)
-#endif
-
 #define ATA_UNC  0x40
 #define ATA_IDNF 0x10
 #define ATA_ABRT 0x04
@@ -88,7 +74,8 @@ struct ata_drive_s {
     uint8_t packet[12];
     int bufp;
     uint8_t *buffer;
-    FILE *file;
+    block_image_t *file;
+    uint64_t offset; /* image offset of the next sector transferred */
     char *filename;
     char *myname;
     ata_drive_geometry_t geometry;
@@ -252,9 +239,7 @@ static int seek_sector(ata_drive_t *drv)
     drv->busy |= 2;
     alarm_set(drv->head_alarm, maincpu_clk + (CLOCK)(abs(drv->pos - lba) * drv->seek_time / drv->geometry.size));
     ata_change_power_mode(drv, 0xff);
-    if (fseeko(drv->file, (off_t)lba * drv->sector_size, SEEK_SET)) {
-        drv->error = drv->atapi ? 0x54 : ATA_IDNF;
-    }
+    drv->offset = (uint64_t)lba * drv->sector_size;
     drv->pos = lba;
     return drv->error;
 }
@@ -287,16 +272,12 @@ static int read_sector(ata_drive_t *drv)
         return drv->error;
     }
 
-    clearerr(drv->file);
-    if (fread(drv->buffer, drv->sector_size, 1, drv->file) != 1) {
-        memset(drv->buffer, 0, drv->sector_size);
-    }
-
-    if (ferror(drv->file)) {
+    if (block_image_read(drv->file, drv->offset, drv->buffer, drv->sector_size)) {
         ata_set_command_block(drv);
         drv->error = drv->atapi ? 0x54 : (ATA_UNC | ATA_ABRT);
         drv->cmd = 0x00;
     } else {
+        drv->offset += drv->sector_size;
         drv->pos++;
         drv->bufp = 0;
     }
@@ -329,16 +310,17 @@ static int write_sector(ata_drive_t *drv)
         return drv->error;
     }
 
-    if (fwrite(drv->buffer, 1, drv->sector_size, drv->file) != (size_t)drv->sector_size) {
+    if (block_image_write(drv->file, drv->offset, drv->buffer, drv->sector_size)) {
         ata_set_command_block(drv);
         drv->error = drv->atapi ? 0x54 : (ATA_UNC | ATA_ABRT);
         drv->cmd = 0x00;
     } else {
+        drv->offset += drv->sector_size;
         drv->pos++;
     }
 
     if (!drv->wcache) {
-        if (fflush(drv->file)) {
+        if (block_image_flush(drv->file)) {
             ata_set_command_block(drv);
             drv->error = drv->atapi ? 0x54 : (ATA_UNC | ATA_ABRT);
             drv->cmd = 0x00;
@@ -542,6 +524,7 @@ ata_drive_t *ata_init(int drive)
     drv->myname = lib_msprintf("ATA%d", drive);
     drv->log = log_open(drv->myname);
     drv->file = NULL;
+    drv->offset = 0;
     drv->filename = NULL;
     drv->buffer = lib_malloc(2048);
     drv->slave = drive & 1;
@@ -731,7 +714,7 @@ static void ata_execute_command(ata_drive_t *drv, uint8_t value)
             }
             debug((drv->log, "FLUSH CACHE"));
             if (drv->file) {
-                if (fflush(drv->file)) {
+                if (block_image_flush(drv->file)) {
                     drv->error = drv->atapi ? 0x54 : (ATA_UNC | ATA_ABRT);
                 }
             }
@@ -836,7 +819,7 @@ static void ata_execute_command(ata_drive_t *drv, uint8_t value)
                     debug((drv->log, "SET DISABLE WRITE CACHE"));
                     drv->wcache = 0;
                     if (drv->file) {
-                        fflush(drv->file);
+                        block_image_flush(drv->file);
                     }
                     return;
                 case 0x99:
@@ -1198,7 +1181,7 @@ void ata_register_store(ata_drive_t *drv, uint16_t addr, uint16_t value)
                                     drv->bufp = 0;
                                     return;
                                 }
-                                if (!drv->file || fflush(drv->file)) {
+                                if (!drv->file || block_image_flush(drv->file)) {
                                     drv->error = drv->atapi ? 0x54 : (ATA_UNC | ATA_ABRT);
                                     break;
                                 }
@@ -1260,11 +1243,19 @@ void ata_register_store(ata_drive_t *drv, uint16_t addr, uint16_t value)
     return;
 }
 
+static void ata_image_close(ata_drive_t *drv)
+{
+    block_image_log_stats(drv->file, drv->log);
+    if (block_image_close(drv->file)) {
+        log_error(drv->log, "Cannot write back image file `%s'.", drv->filename);
+    }
+    drv->file = NULL;
+}
+
 void ata_image_attach(ata_drive_t *drv, char *filename, ata_drive_type_t type, ata_drive_geometry_t geometry)
 {
     if (drv->file != NULL) {
-        fclose(drv->file);
-        drv->file = NULL;
+        ata_image_close(drv);
     }
 
     if (drv->filename != filename) {
@@ -1274,12 +1265,8 @@ void ata_image_attach(ata_drive_t *drv, char *filename, ata_drive_type_t type, a
 
     if (type != ATA_DRIVE_NONE) {
         if (drv->filename && drv->filename[0]) {
-            if (type != ATA_DRIVE_CD) {
-                drv->file = fopen(drv->filename, MODE_READ_WRITE);
-            }
-            if (!drv->file) {
-                drv->file = fopen(drv->filename, MODE_READ);
-            }
+            drv->file = block_image_open(drv->filename, type != ATA_DRIVE_CD);
+            drv->offset = 0;
         }
 
         if (drv->geometry.size < 1) {
@@ -1327,9 +1314,8 @@ void ata_image_attach(ata_drive_t *drv, char *filename, ata_drive_type_t type, a
 void ata_image_detach(ata_drive_t *drv)
 {
     if (drv->file != NULL) {
-        fclose(drv->file);
-        drv->file = NULL;
         log_message(drv->log, "Detached.");
+        ata_image_close(drv);
     }
     return;
 }
@@ -1356,6 +1342,16 @@ int ata_register_dump(ata_drive_t *drv)
     mon_out("LBA high:     %02x\n", ata_register_peek(drv, 5));
     mon_out("Device:       %02x\n", ata_register_peek(drv, 6));
     mon_out("Status:       %02x\n", ata_register_peek(drv, 7));
+    if (drv->file) {
+        const block_image_stats_t *st = block_image_get_stats(drv->file);
+
+        mon_out("Transferred:  %"PRIu64" KiB read, %"PRIu64" KiB written\n",
+                st->bytes_read >> 10, st->bytes_written >> 10);
+        mon_out("Cache:        %"PRIu64" hits, %"PRIu64" misses\n",
+                st->hits, st->misses);
+        mon_out("Host I/O:     %"PRIu64" reads, %"PRIu64" writes\n",
+                st->host_reads, st->host_writes);
+    }
 
     return 0;
 }
@@ -1375,10 +1371,9 @@ int ata_register_dump(ata_drive_t *drv)
 int ata_snapshot_write_module(ata_drive_t *drv, snapshot_t *s)
 {
     snapshot_module_t *m;
-    uint32_t spindle_clk = CLOCK_MAX;
-    uint32_t head_clk = CLOCK_MAX;
-    uint32_t standby_clk = CLOCK_MAX;
-    off_t pos = 0;
+    CLOCK spindle_clk = CLOCK_MAX;
+    CLOCK head_clk = CLOCK_MAX;
+    CLOCK standby_clk = CLOCK_MAX;
 
     m = snapshot_module_create(s, drv->myname,
                                CART_DUMP_VER_MAJOR, CART_DUMP_VER_MINOR);
@@ -1395,11 +1390,9 @@ int ata_snapshot_write_module(ata_drive_t *drv, snapshot_t *s)
     if (drv->standby) {
         standby_clk = drv->standby_alarm->context->pending_alarms[drv->standby_alarm->pending_idx].clk;
     }
-    if (drv->file) {
-        pos = ftello(drv->file);
-        if (pos < 0) {
-            pos = 0;
-        }
+    /* the image on disk must match the snapshot */
+    if (drv->file && block_image_flush(drv->file)) {
+        log_error(drv->log, "Cannot write back image file `%s'.", drv->filename);
     }
 
     SMW_STR(m, drv->filename);
@@ -1425,13 +1418,13 @@ int ata_snapshot_write_module(ata_drive_t *drv, snapshot_t *s)
     SMW_B(m, (uint8_t)drv->heads);
     SMW_B(m, (uint8_t)drv->sectors);
     SMW_DW(m, drv->pos);
-    SMW_DW(m, pos / drv->sector_size);
+    SMW_DW(m, (uint32_t)(drv->offset / drv->sector_size));
     SMW_B(m, (uint8_t)drv->wcache);
     SMW_B(m, (uint8_t)drv->lookahead);
     SMW_B(m, (uint8_t)drv->busy);
-    SMW_DW(m, spindle_clk);
-    SMW_DW(m, head_clk);
-    SMW_DW(m, standby_clk);
+    SMW_CLOCK(m, spindle_clk);
+    SMW_CLOCK(m, head_clk);
+    SMW_CLOCK(m, standby_clk);
     SMW_DW(m, drv->standby);
     SMW_DW(m, drv->standby_max);
 
@@ -1443,9 +1436,9 @@ int ata_snapshot_read_module(ata_drive_t *drv, snapshot_t *s)
     uint8_t vmajor, vminor;
     snapshot_module_t *m;
     char *filename = NULL;
-    uint32_t spindle_clk;
-    uint32_t head_clk;
-    uint32_t standby_clk;
+    CLOCK spindle_clk;
+    CLOCK head_clk;
+    CLOCK standby_clk;
     int pos, type;
 
     m = snapshot_module_open(s, drv->myname, &vmajor, &vminor);
@@ -1536,9 +1529,9 @@ int ata_snapshot_read_module(ata_drive_t *drv, snapshot_t *s)
         drv->lookahead = 1;
     }
     SMR_B_INT(m, &drv->busy);
-    SMR_DW(m, &spindle_clk);
-    SMR_DW(m, &head_clk);
-    SMR_DW(m, &standby_clk);
+    SMR_CLOCK(m, &spindle_clk);
+    SMR_CLOCK(m, &head_clk);
+    SMR_CLOCK(m, &standby_clk);
     SMR_DW_INT(m, &drv->standby);
     SMR_DW_INT(m, &drv->standby_max);
     drv->busy &= 0x03;
@@ -1558,9 +1551,7 @@ int ata_snapshot_read_module(ata_drive_t *drv, snapshot_t *s)
         alarm_unset(drv->standby_alarm);
     }
 
-    if (drv->file) {
-        fseeko(drv->file, (off_t)pos * drv->sector_size, SEEK_SET);
-    }
+    drv->offset = (uint64_t)pos * drv->sector_size;
     if (!drv->atapi) { /* atapi supports disc change events */
         drv->readonly = 1; /* make sure for ata that there's no filesystem corruption */
     }
@@ -0,0 +1,272 @@
+/*
+ * blockimage.c - Cached block access to storage device images.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
+/* VAC++ has off_t in sys/stat.h */
+#ifdef __IBMC__
+#include <sys/stat.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "blockimage.h"
+#include "lib.h"
+#include "log.h"
+#include "types.h"
+
+#ifndef HAVE_FSEEKO
+#define fseeko(a, b, c) fseek(a, b, c)
+#define ftello(a) ftell(a)
+#endif
+
+/* 256 lines of 4 KiB, direct mapped.  A line covers eight 512 byte sectors
+   so sequential reads also get some read-ahead.  */
+#define BLOCK_IMAGE_LINE_SIZE 4096
+#define BLOCK_IMAGE_LINES     256
+
+typedef struct block_image_line_s {
+    uint64_t base;              /* image offset of the line */
+    int valid;
+    unsigned int dirty_start;   /* modified range, empty if start == end */
+    unsigned int dirty_end;
+    uint8_t *data;
+} block_image_line_t;
+
+struct block_image_s {
+    FILE *file;
+    int readonly;
+    uint64_t size;              /* length of the image file */
+    uint8_t *data;
+    block_image_line_t lines[BLOCK_IMAGE_LINES];
+    block_image_stats_t stats;
+};
+
+block_image_t *block_image_open(const char *name, int rw)
+{
+    block_image_t *img;
+    FILE *file = NULL;
+    off_t size;
+    int i;
+
+    if (rw) {
+        file = fopen(name, MODE_READ_WRITE);
+    }
+    if (file == NULL) {
+        file = fopen(name, MODE_READ);
+        if (file == NULL) {
+            return NULL;
+        }
+        rw = 0;
+    }
+
+    img = lib_calloc(1, sizeof(block_image_t));
+    img->file = file;
+    img->readonly = !rw;
+
+    if (fseeko(file, 0, SEEK_END) == 0 && (size = ftello(file)) > 0) {
+        img->size = (uint64_t)size;
+    }
+
+    img->data = lib_malloc(BLOCK_IMAGE_LINES * BLOCK_IMAGE_LINE_SIZE);
+    for (i = 0; i < BLOCK_IMAGE_LINES; i++) {
+        img->lines[i].data = img->data + i * BLOCK_IMAGE_LINE_SIZE;
+    }
+
+    return img;
+}
+
+/* Write back the modified part of a line.  On failure the modification is
+   dropped, there's nothing better to do with it.  */
+static int block_image_write_back(block_image_t *img, block_image_line_t *line)
+{
+    uint64_t start = line->base + line->dirty_start;
+    size_t len = line->dirty_end - line->dirty_start;
+    int result = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    img->stats.host_writes++;
+    if (fseeko(img->file, (off_t)start, SEEK_SET)
+        || fwrite(line->data + line->dirty_start, 1, len, img->file) != len) {
+        clearerr(img->file);
+        line->valid = 0;
+        result = -1;
+    } else if (start + len > img->size) {
+        img->size = start + len;
+    }
+    line->dirty_start = line->dirty_end = 0;
+
+    return result;
+}
+
+static block_image_line_t *block_image_line(block_image_t *img, uint64_t base)
+{
+    block_image_line_t *line = &img->lines[(base / BLOCK_IMAGE_LINE_SIZE) % BLOCK_IMAGE_LINES];
+    size_t len = 0;
+
+    if (line->valid && line->base == base) {
+        img->stats.hits++;
+        return line;
+    }
+    img->stats.misses++;
+
+    if (line->valid && block_image_write_back(img, line) < 0) {
+        return NULL;
+    }
+    line->valid = 0;
+
+    /* nothing to read past the end of the file */
+    if (base < img->size) {
+        img->stats.host_reads++;
+        if (fseeko(img->file, (off_t)base, SEEK_SET) == 0) {
+            len = fread(line->data, 1, BLOCK_IMAGE_LINE_SIZE, img->file);
+        }
+        if (ferror(img->file)) {
+            clearerr(img->file);
+            return NULL;
+        }
+    }
+    memset(line->data + len, 0, BLOCK_IMAGE_LINE_SIZE - len);
+
+    line->base = base;
+    line->valid = 1;
+    return line;
+}
+
+/* Reads past the end of the image return zeros.  */
+int block_image_read(block_image_t *img, uint64_t offset, uint8_t *buf, unsigned int len)
+{
+    img->stats.bytes_read += len;
+
+    while (len) {
+        unsigned int start = (unsigned int)(offset % BLOCK_IMAGE_LINE_SIZE);
+        unsigned int part = BLOCK_IMAGE_LINE_SIZE - start;
+        block_image_line_t *line = block_image_line(img, offset - start);
+
+        if (line == NULL) {
+            return -1;
+        }
+        if (part > len) {
+            part = len;
+        }
+        memcpy(buf, line->data + start, part);
+        buf += part;
+        offset += part;
+        len -= part;
+    }
+    return 0;
+}
+
+int block_image_write(block_image_t *img, uint64_t offset, const uint8_t *buf, unsigned int len)
+{
+    if (img->readonly) {
+        return -1;
+    }
+    img->stats.bytes_written += len;
+
+    while (len) {
+        unsigned int start = (unsigned int)(offset % BLOCK_IMAGE_LINE_SIZE);
+        unsigned int part = BLOCK_IMAGE_LINE_SIZE - start;
+        block_image_line_t *line = block_image_line(img, offset - start);
+
+        if (line == NULL) {
+            return -1;
+        }
+        if (part > len) {
+            part = len;
+        }
+        memcpy(line->data + start, buf, part);
+        if (line->dirty_start == line->dirty_end) {
+            line->dirty_start = start;
+            line->dirty_end = start + part;
+        } else {
+            if (start < line->dirty_start) {
+                line->dirty_start = start;
+            }
+            if (start + part > line->dirty_end) {
+                line->dirty_end = start + part;
+            }
+        }
+        buf += part;
+        offset += part;
+        len -= part;
+    }
+    return 0;
+}
+
+int block_image_flush(block_image_t *img)
+{
+    int i, result = 0;
+
+    for (i = 0; i < BLOCK_IMAGE_LINES; i++) {
+        if (block_image_write_back(img, &img->lines[i]) < 0) {
+            result = -1;
+        }
+    }
+    if (fflush(img->file)) {
+        result = -1;
+    }
+    return result;
+}
+
+int block_image_close(block_image_t *img)
+{
+    int result = block_image_flush(img);
+
+    if (fclose(img->file)) {
+        result = -1;
+    }
+    lib_free(img->data);
+    lib_free(img);
+    return result;
+}
+
+int block_image_readonly(block_image_t *img)
+{
+    return img->readonly;
+}
+
+const block_image_stats_t *block_image_get_stats(block_image_t *img)
+{
+    return &img->stats;
+}
+
+void block_image_log_stats(block_image_t *img, log_t log)
+{
+    const block_image_stats_t *st = &img->stats;
+    uint64_t total = st->hits + st->misses;
+
+    log_message(log, "%"PRIu64" KiB read, %"PRIu64" KiB written, %u%% cache hits, %"PRIu64" host reads, %"PRIu64" host writes.",
+                st->bytes_read >> 10, st->bytes_written >> 10,
+                total ? (unsigned int)(st->hits * 100 / total) : 0,
+                st->host_reads, st->host_writes);
+}
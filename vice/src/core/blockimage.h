@@ -0,0 +1,57 @@
+/*
+ * blockimage.h - Cached block access to storage device images.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_BLOCKIMAGE
+#define VICE_BLOCKIMAGE
+
+#include "log.h"
+#include "types.h"
+
+/* Image files of the SD card and ATA devices are accessed through a write
+   back cache.  Reads and writes of whole or partial sectors are served from
+   memory; the host file is only touched when a cache line is filled or a
+   dirty one is evicted, and on block_image_flush().  Callers flush on
+   detach, before snapshots and when the emulated device flushes its own
+   write cache.  */
+
+typedef struct block_image_s block_image_t;
+
+typedef struct block_image_stats_s {
+    uint64_t bytes_read;        /* read by the emulated device */
+    uint64_t bytes_written;     /* written by the emulated device */
+    uint64_t hits;              /* accesses served by the cache */
+    uint64_t misses;            /* accesses that had to fill a line */
+    uint64_t host_reads;        /* reads from the image file */
+    uint64_t host_writes;       /* writes to the image file */
+} block_image_stats_t;
+
+extern block_image_t *block_image_open(const char *name, int rw);
+extern int block_image_close(block_image_t *img);
+extern int block_image_read(block_image_t *img, uint64_t offset, uint8_t *buf, unsigned int len);
+extern int block_image_write(block_image_t *img, uint64_t offset, const uint8_t *buf, unsigned int len);
+extern int block_image_flush(block_image_t *img);
+extern int block_image_readonly(block_image_t *img);
+extern const block_image_stats_t *block_image_get_stats(block_image_t *img);
+extern void block_image_log_stats(block_image_t *img, log_t log);
+
+#endif
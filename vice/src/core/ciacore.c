@@ -43,7 +43,6 @@
 #include <string.h>
 
 #include "cia.h"
-#include "clkguard.h"
 #include "ciatimer.h"
 #include "interrupt.h"
 #include "lib.h"
@@ -241,42 +240,6 @@ static void cia_do_set_int(cia_context_t *cia_context, CLOCK rclk)
     cia_context->irqflags |= 0x80;
 }
 
-/* ------------------------------------------------------------------------- */
-
-static void ciacore_clk_overflow_callback(CLOCK sub, void *data)
-{
-    cia_context_t *cia_context;
-
-    cia_context = (cia_context_t *)data;
-
-    if (cia_context->enabled == 0) {
-        return;
-    }
-
-    /* we assume that sub has already been substracted from myclk */
-    cia_update_ta(cia_context, *(cia_context->clk_ptr) + sub);
-    cia_update_tb(cia_context, *(cia_context->clk_ptr) + sub);
-
-    ciat_prevent_clock_overflow(cia_context->ta, sub);
-    ciat_prevent_clock_overflow(cia_context->tb, sub);
-
-    if (cia_context->rdi > sub) {
-        cia_context->rdi -= sub;
-    } else {
-        cia_context->rdi = 0;
-    }
-
-    if (cia_context->read_clk > sub) {
-        cia_context->read_clk -= sub;
-    } else {
-        cia_context->read_clk = 0;
-    }
-
-    if (cia_context->todclk) {
-        cia_context->todclk -= sub;
-    }
-}
-
 /* -------------------------------------------------------------------------- */
 void ciacore_disable(cia_context_t *cia_context)
 {
@@ -842,6 +805,26 @@ uint8_t cia_read_(cia_context_t *cia_context, uint16_t addr)
     return (cia_context->c_cia[addr]);
 }
 
+/* Return the clock up to which reading `addr' keeps giving the same value
+   without side effects, or 0 if it may not.  For the busy loop detection
+   of the CPU.  */
+CLOCK ciacore_idle_read(cia_context_t *cia_context, uint16_t addr)
+{
+    switch (addr & 0xf) {
+        case CIA_DDRA:
+        case CIA_DDRB:
+        case CIA_CRA:
+        case CIA_CRB:
+            return CLOCK_MAX;
+        case CIA_ICR:
+            /* Reading clears the flags, which is harmless while there are
+               none.  They are only set by the alarms.  */
+            return cia_context->irqflags ? 0 : CLOCK_MAX;
+        default:
+            return 0;
+    }
+}
+
 uint8_t ciacore_peek(cia_context_t *cia_context, uint16_t addr)
 {
     /* This code assumes that update_cia is a projector - called at
@@ -1332,7 +1315,7 @@ static void ciacore_idle(CLOCK offset, void *data)
 #endif
 
 void ciacore_init(cia_context_t *cia_context, alarm_context_t *alarm_context,
-                  interrupt_cpu_status_t *int_status, clk_guard_t *clk_guard)
+                  interrupt_cpu_status_t *int_status)
 {
     char *buffer;
 
@@ -1367,9 +1350,6 @@ void ciacore_init(cia_context_t *cia_context, alarm_context_t *alarm_context,
     cia_context->int_num
         = interrupt_cpu_status_int_new(int_status, cia_context->myname);
 
-    clk_guard_add_callback(clk_guard, ciacore_clk_overflow_callback,
-                           cia_context);
-
     buffer = lib_msprintf("%s_TA", cia_context->myname);
     ciat_init(cia_context->ta, buffer, *(cia_context->clk_ptr),
               cia_context->ta_alarm);
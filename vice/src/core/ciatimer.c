@@ -195,19 +195,6 @@ void ciat_reset(ciat_t *state, CLOCK cclk)
     CIAT_LOGOUT((""));
 }
 
-/* handle clock overflow. needs update */
-void ciat_prevent_clock_overflow(ciat_t *state, CLOCK sub)
-{
-    CIAT_LOGIN(("%s prevent_clock_overflow", state->name));
-
-    state->clk -= sub;
-    if (state->alarmclk < CLOCK_MAX) {
-        state->alarmclk -= sub;
-    }
-
-    CIAT_LOGOUT((""));
-}
-
 void ciat_save_snapshot(ciat_t *cia_state, CLOCK cclk, snapshot_module_t *m,
                         int ver)
 {
@@ -467,7 +467,6 @@ extern uint16_t ciat_is_running(ciat_t *state, CLOCK cclk);
 extern void ciat_init(ciat_t *state, const char *name, CLOCK cclk,
                       alarm_t *alarm);
 extern void ciat_reset(ciat_t *state, CLOCK cclk);
-extern void ciat_prevent_clock_overflow(ciat_t *state, CLOCK sub);
 
 extern void ciat_save_snapshot(ciat_t *cia_state, CLOCK cclk,
                                struct snapshot_module_s *m, int ver);
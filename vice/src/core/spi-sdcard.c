@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "blockimage.h"
 #include "log.h"
 #include "snapshot.h"
 #include "spi-sdcard.h"
@@ -94,11 +95,14 @@ static int mmc_card_type = CARD_TYPE_MMC;
 static int mmc_card_rw = 0;
 
 /* Image file */
-static FILE *mmc_image_file = NULL;
+static block_image_t *mmc_image_file = NULL;
 
 /* Pointer inside image */
 static sd_addr_t mmc_image_pointer;
 
+/* Start of the block being written */
+static sd_addr_t mmc_write_address;
+
 /* write sequence counter */
 static unsigned int mmc_write_sequence;
 
@@ -635,29 +639,21 @@ static void mmc_execute_cmd(void)
 #endif
                     mmc_card_state = MMC_CARD_DUMMY_READ;
                 } else {
+                    uint8_t readbuf[0x1000];    /* FIXME */
+                    uint32_t size = mmc_block_size < sizeof(readbuf) ? mmc_block_size : sizeof(readbuf);
 #ifdef DEBUG_MMC
                     log_debug("Address: %08x", mmc_current_address_pointer);
+                    log_debug("Buffering: %08x", mmc_current_address_pointer);
 #endif
-                    if (fseek(mmc_image_file, mmc_current_address_pointer, SEEK_SET) != 0) {
+                    if (block_image_read(mmc_image_file, mmc_current_address_pointer, readbuf, size) != 0) {
                         mmc_card_state = MMC_CARD_DUMMY_READ;
                     } else {
-                        uint8_t readbuf[0x1000];    /* FIXME */
-#ifdef DEBUG_MMC
-                        log_debug("Buffering: %08x", mmc_current_address_pointer);
-#endif
-                        fseek(mmc_image_file, mmc_current_address_pointer, SEEK_SET);
-                        if (!feof(mmc_image_file)) {
-                            if (fread(readbuf, 1, mmc_block_size, mmc_image_file) > 0) {
-                                mmc_read_buffer_readptr = 0;
-                                mmc_read_buffer_writeptr = 0;
-                                mmc_read_buffer_set(readbuf, mmc_block_size);
+                        mmc_read_buffer_readptr = 0;
+                        mmc_read_buffer_writeptr = 0;
+                        mmc_read_buffer_set(readbuf, size);
 #ifdef DEBUG_MMC
-                                log_debug("Buffered: %02x %02x", readbuf[0], readbuf[1]);
+                        log_debug("Buffered: %02x %02x", readbuf[0], readbuf[1]);
 #endif
-                            } else {
-                                /* FIXME: handle error */
-                            }
-                        }
                     }
                 }
             } else {
@@ -681,6 +677,7 @@ static void mmc_execute_cmd(void)
 #endif
                 } else {
                     mmc_write_sequence = 0;
+                    mmc_write_address = mmc_current_address_pointer;
                     mmc_card_state = MMC_CARD_WRITE;
                 }
             } else {
@@ -802,7 +799,7 @@ static void mmc_write_to_mmc(uint8_t value)
             break;
         case 1:
             if (mmc_card_state == MMC_CARD_WRITE) {
-                if (fwrite(&value, 1, 1, mmc_image_file) != 1) {
+                if (block_image_write(mmc_image_file, mmc_write_address + mmc_image_pointer, &value, 1) != 0) {
                     LOG(("could not write to mmc image file"));
                     /* FIXME: handle error */
                 }
@@ -849,24 +846,18 @@ int mmc_open_card_image(char *name, int rw)
         mmc_close_card_image();
     }
 
-    if (rw) {
-        mmc_image_file = fopen(mmc_image_filename, "rb+");
-    }
+    mmc_image_file = block_image_open(mmc_image_filename, rw);
 
     if (mmc_image_file == NULL) {
-        mmc_image_file = fopen(mmc_image_filename, "rb");
-
-        if (mmc_image_file == NULL) {
-            LOG(("could not open sd card image: %s", mmc_image_filename));
-            return 1;
-        } else {
-            /* FIXME */
-            spi_mmc_set_card_inserted(MMC_CARD_INSERTED);
-            LOG(("opened sd card image (ro): %s", mmc_image_filename));
-            /* mmc_image_file_readonly = 1; */
-            /* mmcreplay_hw_writeprotect = 1; */
-            /* mmcreplay_writeprotect = MMC_WRITEPROT; */
-        }
+        LOG(("could not open sd card image: %s", mmc_image_filename));
+        return 1;
+    } else if (block_image_readonly(mmc_image_file)) {
+        /* FIXME */
+        spi_mmc_set_card_inserted(MMC_CARD_INSERTED);
+        LOG(("opened sd card image (ro): %s", mmc_image_filename));
+        /* mmc_image_file_readonly = 1; */
+        /* mmcreplay_hw_writeprotect = 1; */
+        /* mmcreplay_writeprotect = MMC_WRITEPROT; */
     } else {
         /* mmc_image_file_readonly = 0; */
         spi_mmc_set_card_inserted(MMC_CARD_INSERTED);
@@ -880,7 +871,10 @@ void mmc_close_card_image(void)
 {
     /* unmount mmc cart image */
     if (mmc_image_file != NULL) {
-        fclose(mmc_image_file);
+        block_image_log_stats(mmc_image_file, LOG_DEFAULT);
+        if (block_image_close(mmc_image_file) != 0) {
+            log_error(LOG_DEFAULT, "could not write back sd card image");
+        }
         mmc_image_file = NULL;
         spi_mmc_set_card_inserted(MMC_CARD_NOTINSERTED);
     }
@@ -898,6 +892,11 @@ int mmc_snapshot_write_module(snapshot_t *s)
 {
     snapshot_module_t *m;
 
+    /* the image on disk should at least be consistent */
+    if (mmc_image_file != NULL && block_image_flush(mmc_image_file) != 0) {
+        log_error(LOG_DEFAULT, "could not write back sd card image");
+    }
+
     m = snapshot_module_create(s, SNAP_MODULE_NAME,
                                CART_DUMP_VER_MAJOR, CART_DUMP_VER_MINOR);
     if (m == NULL) {
@@ -43,7 +43,6 @@
 #include <stdlib.h>
 
 #include "alarm.h"
-#include "clkguard.h"
 #include "crtc-cmdline-options.h"
 #include "crtc-color.h"
 #include "crtc-draw.h"
@@ -475,13 +474,6 @@ void crtc_set_hires_draw_callback(crtc_hires_draw_t callback)
 
 /*--------------------------------------------------------------------*/
 
-static void clk_overflow_callback(CLOCK sub, void *data)
-{
-    crtc.frame_start -= sub;
-
-    crtc.rl_start -= sub;
-}
-
 /*--------------------------------------------------------------------*/
 
 raster_t *crtc_init(void)
@@ -495,8 +487,6 @@ raster_t *crtc_init(void)
     crtc.raster_draw_alarm = alarm_new(maincpu_alarm_context, "CrtcRasterDraw",
                                        crtc_raster_draw_alarm_handler, NULL);
 
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
-
     raster = &crtc.raster;
 
     raster->sprite_status = NULL;
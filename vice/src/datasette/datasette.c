@@ -35,7 +35,6 @@
 
 #include "alarm.h"
 #include "autostart.h"
-#include "clkguard.h"
 #include "cmdline.h"
 #include "datasette.h"
 #include "lib.h"
@@ -60,7 +59,6 @@
 #endif
 
 #define MOTOR_DELAY         32000
-#define TAP_BUFFER_LENGTH   100000
 
 /* at least every DATASETTE_MAX_GAP cycle there should be an alarm */
 #define DATASETTE_MAX_GAP   100000
@@ -69,11 +67,16 @@
 /* Attached TAP tape image.  */
 static tap_t *current_image = NULL;
 
-/* Buffer for the TAP */
-static uint8_t tap_buffer[TAP_BUFFER_LENGTH];
+/* Offsets in the attached TAP where a pulse starts, one bit per byte.
+   The pulses themselves are read from the image data of the TAP, this is
+   only needed to find the pulse before the current one when rewinding.  */
+static uint8_t *tap_pulse_start = NULL;
 
-/* Pointer and length of the tap-buffer */
-static long next_tap, last_tap;
+/* Offset behind the last complete pulse.  */
+static long tap_pulse_end = 0;
+
+/* Recording invalidates the pulse map.  */
+static int tap_pulses_valid = 0;
 
 /* State of the datasette motor.  */
 static int datasette_motor = 0;
@@ -332,144 +335,118 @@ void datasette_reset_counter(void)
 }
 
 
-inline static int datasette_move_buffer_forward(int offset)
+static void datasette_decode_image(void)
 {
-    /* reads buffer to fit the next gap-read
-       tap_buffer[next_tap] ~ current_file_seek_position
+    const uint8_t *data;
+    long size, i, len;
+
+    /* marks where the pulses of the TAP start, so the tape can be moved
+       in both directions without touching the file
     */
-    if (next_tap + offset >= last_tap) {
-        if (fseek(current_image->fd, current_image->current_file_seek_position
-                  + current_image->offset, SEEK_SET)) {
-            log_error(datasette_log, "Cannot read in tap-file.");
-            return 0;
-        }
-        last_tap = (long)fread(tap_buffer, 1, TAP_BUFFER_LENGTH, current_image->fd);
-        next_tap = 0;
-        if (next_tap >= last_tap) {
-            return 0;
+
+    tap_data_load(current_image);
+    data = current_image->data + current_image->offset;
+    size = current_image->data_size - current_image->offset;
+    if (size > current_image->size) {
+        size = current_image->size;
+    }
+    if (size < 0) {
+        size = 0;
+    }
+
+    lib_free(tap_pulse_start);
+    tap_pulse_start = lib_calloc((size_t)size / 8 + 1, 1);
+
+    i = 0;
+    while (i < size) {
+        len = ((current_image->version == 0) || data[i]) ? 1 : 4;
+        if (i + len > size) {
+            break;
         }
+        tap_pulse_start[i >> 3] |= (uint8_t)(1 << (i & 7));
+        i += len;
     }
-    return 1;
+    tap_pulse_end = i;
+    tap_pulses_valid = 1;
+
+    /* recording continues at the current position */
+    fseek(current_image->fd, current_image->current_file_seek_position
+          + current_image->offset, SEEK_SET);
 }
 
-inline static int datasette_move_buffer_back(int offset)
+inline static int datasette_is_pulse_start(long pos)
 {
-    /* reads buffer to fit the next gap-read at current_file_seek_position-1
-       tap_buffer[next_tap] ~ current_file_seek_position
-    */
-    if (next_tap + offset < 0) {
-        if (current_image->current_file_seek_position >= TAP_BUFFER_LENGTH) {
-            next_tap = TAP_BUFFER_LENGTH;
-        } else {
-            next_tap = current_image->current_file_seek_position;
-        }
-        if (fseek(current_image->fd, current_image->current_file_seek_position
-                  - next_tap + current_image->offset, SEEK_SET)) {
-            log_error(datasette_log, "Cannot read in tap-file.");
-            return 0;
-        }
-        last_tap = (long)fread(tap_buffer, 1, TAP_BUFFER_LENGTH, current_image->fd);
-        if (next_tap > last_tap) {
-            return 0;
-        }
-    }
-    return 1;
+    return (tap_pulse_start[pos >> 3] >> (pos & 7)) & 1;
 }
 
-inline static int fetch_gap(CLOCK *gap, int *direction, long read_tap)
+inline static CLOCK fetch_gap(long pos, long *next)
 {
+    const uint8_t *data = current_image->data + current_image->offset + pos;
+    CLOCK gap;
     int wobble;
 
-    if ((read_tap >= last_tap) || (read_tap < 0)) {
-        return -1;
+    if ((current_image->version == 0) || data[0]) {
+        gap = (CLOCK)data[0] * 8;
+        *next = pos + 1;
+    } else {
+        gap = (CLOCK)(data[1] + (data[2] << 8) + (data[3] << 16));
+        *next = pos + 4;
+    }
+    if (gap == 0) {
+        gap = (CLOCK)datasette_zero_gap_delay;
     }
 
-    *gap = tap_buffer[read_tap];
-
-    if ((current_image->version == 0) || *gap) {
-        *gap = (*gap ? (CLOCK)(*gap * 8) : (CLOCK)datasette_zero_gap_delay)
-               + (CLOCK)datasette_speed_tuning;
-    } else {
-        if (read_tap >= last_tap - 3) {
-            return -1;
-        }
-        *direction *= 4;
-        *gap = tap_buffer[read_tap + 1]
-               + (tap_buffer[read_tap + 2] << 8)
-               + (tap_buffer[read_tap + 3] << 16);
-        if (!(*gap)) {
-            *gap = (CLOCK)datasette_zero_gap_delay;
-        }
+    /* long gaps are not affected by the speed tuning */
+    if (*next - pos == 1) {
+        gap += (CLOCK)datasette_speed_tuning;
     }
+
     /* add some random wobble */
     if (datasette_tape_wobble) {
         wobble = lib_unsigned_rand(-datasette_tape_wobble, datasette_tape_wobble);
-        if ((wobble >= 0) || (*gap > (CLOCK)-wobble)) {
-            *gap += wobble;
+        if ((wobble >= 0) || (gap > (CLOCK)-wobble)) {
+            gap += wobble;
         } else {
-            *gap = 1;
+            gap = 1;
         }
     }
-    return 0;
-}
-
-inline static void read_gap_forward(long *read_tap)
-{
-    *read_tap = next_tap;
-}
-
-inline static void read_gap_backward_v0(long *read_tap)
-{
-    *read_tap = next_tap - 1;
+    return gap;
 }
 
-inline static int read_gap_backward_v1(long *read_tap)
+inline static int datasette_next_pulse(CLOCK *gap, int direction)
 {
-    /* examine, if previous gap was long
-       by rewinding until 3 non-zero-values
-       in a row found, then reading forward (FIXME???)
-    */
-    int non_zeros_in_a_row = 0;
-    long remember_file_seek_position;
-
-    remember_file_seek_position = current_image->current_file_seek_position;
-
-    current_image->current_file_seek_position -= 4;
-    next_tap -= 4;
+    /* moves the tape over the next pulse in the given direction,
+       returns -1 if the end of the tape has been reached */
+    long pos, next;
 
-    while ((non_zeros_in_a_row < 3) && current_image->current_file_seek_position) {
-        if (!datasette_move_buffer_back(-1)) {
-            return 1;
-        }
-        current_image->current_file_seek_position--;
-        next_tap--;
-        if (tap_buffer[next_tap]) {
-            non_zeros_in_a_row++;
-        } else {
-            non_zeros_in_a_row = 0;
-        }
+    if (!tap_pulses_valid) {
+        datasette_decode_image();
     }
+    pos = current_image->current_file_seek_position;
 
-    /* now forward */
-    while (current_image->current_file_seek_position < remember_file_seek_position - 4) {
-        if (!datasette_move_buffer_forward(1)) {
+    if (direction > 0) {
+        /* the position may have been moved into a long pulse */
+        while (pos < tap_pulse_end && !datasette_is_pulse_start(pos)) {
+            pos++;
+        }
+        if (pos >= tap_pulse_end) {
             return -1;
         }
-        if (tap_buffer[next_tap]) {
-            current_image->current_file_seek_position++;
-            next_tap++;
-        } else {
-            current_image->current_file_seek_position += 4;
-            next_tap += 4;
+        *gap = fetch_gap(pos, &next);
+        pos = next;
+    } else {
+        if (pos > tap_pulse_end) {
+            pos = tap_pulse_end;
         }
+        do {
+            if (pos <= 0) {
+                return -1;
+            }
+            pos--;
+        } while (!datasette_is_pulse_start(pos));
+        *gap = fetch_gap(pos, &next);
     }
-    if (!datasette_move_buffer_forward(4)) {
-        return -1;
-    }
-
-    *read_tap = next_tap;
-    next_tap += (remember_file_seek_position - current_image->current_file_seek_position);
-    current_image->current_file_seek_position = remember_file_seek_position;
+    current_image->current_file_seek_position = (int)pos;
 
     return 0;
 }
@@ -477,92 +454,30 @@ inline static int read_gap_backward_v1(long *read_tap)
 static CLOCK datasette_read_gap(int direction)
 {
     /* direction 1: forward, -1: rewind */
-    long read_tap = 0;
     CLOCK gap = 0;
 
 /*    if (current_image->system != 2 || current_image->version != 1
         || !fullwave) {*/
     if (machine_tape_behaviour() != TAPE_BEHAVIOUR_C16) {
-        if ((direction < 0) && !datasette_move_buffer_back(direction * 4)) {
-            return 0;
-        }
-        if ((direction > 0 ) && !datasette_move_buffer_forward(direction * 4)) {
+        if (datasette_next_pulse(&gap, direction) < 0) {
             return 0;
         }
-
-        if (direction > 0) {
-            read_gap_forward(&read_tap);
-        } else {
-            if ((current_image->version == 0) || (next_tap < 4) || tap_buffer[next_tap - 4]) {
-                read_gap_backward_v0(&read_tap);
-            } else {
-                if (read_gap_backward_v1(&read_tap) < 0) {
-                    return 0;
-                }
-            }
-        }
-        if (fetch_gap(&gap, &direction, read_tap) < 0) {
-            return 0;
-        }
-        next_tap += direction;
-        current_image->current_file_seek_position += direction;
     } else if (current_image->version == 1) {
         if (!fullwave) {
-            if ((direction < 0) && !datasette_move_buffer_back(direction * 4)) {
-                return 0;
-            }
-            if ((direction > 0 ) && !datasette_move_buffer_forward(direction * 4)) {
-                return 0;
-            }
-
-            if (direction > 0) {
-                read_gap_forward(&read_tap);
-            } else {
-                if ((current_image->version == 0) || (next_tap < 4) || tap_buffer[next_tap - 4]) {
-                    read_gap_backward_v0(&read_tap);
-                } else {
-                    if (read_gap_backward_v1(&read_tap) < 0) {
-                        return 0;
-                    }
-                }
-            }
-            if (fetch_gap(&gap, &direction, read_tap) < 0) {
+            if (datasette_next_pulse(&gap, direction) < 0) {
                 return 0;
             }
-
             fullwave_gap = gap;
-            next_tap += direction;
-            current_image->current_file_seek_position += direction;
         } else {
             gap = fullwave_gap;
         }
         fullwave ^= 1;
     } else if (current_image->version == 2) {
-        if ((direction < 0) && !datasette_move_buffer_back(direction * 4)) {
-            return 0;
-        }
-        if ((direction > 0 ) && !datasette_move_buffer_forward(direction * 4)) {
-            return 0;
-        }
-
-        if (direction > 0) {
-            read_gap_forward(&read_tap);
-        } else {
-            if ((current_image->version == 0) || (next_tap < 4) || tap_buffer[next_tap - 4]) {
-                read_gap_backward_v0(&read_tap);
-            } else {
-                if (read_gap_backward_v1(&read_tap) < 0) {
-                    return 0;
-                }
-            }
-        }
-        if (fetch_gap(&gap, &direction, read_tap) < 0) {
+        if (datasette_next_pulse(&gap, direction) < 0) {
             return 0;
         }
         gap *= 2;
         fullwave ^= 1;
-        next_tap += direction;
-        current_image->current_file_seek_position += direction;
     }
     return gap;
 }
@@ -693,17 +608,6 @@ static void datasette_read_bit(CLOCK offset, void *data)
 }
 
 
-static void clk_overflow_callback(CLOCK sub, void *data)
-{
-    DBG(("clk_overflow_callback"));
-    if (last_write_clk > (CLOCK)0) {
-        last_write_clk -= sub;
-    }
-    if (motor_stop_clk > (CLOCK)0) {
-        motor_stop_clk -= sub;
-    }
-}
-
 void datasette_init(void)
 {
     DBG(("datasette_init"));
@@ -712,8 +616,6 @@ void datasette_init(void)
     datasette_alarm = alarm_new(maincpu_alarm_context, "Datasette",
                                 datasette_read_bit, NULL);
 
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
-
     datasette_cycles_per_second = machine_get_cycles_per_second();
     if (!datasette_cycles_per_second) {
         log_error(datasette_log,
@@ -730,10 +632,16 @@ void datasette_set_tape_image(tap_t *image)
     DBG(("datasette_set_tape_image (image present:%s)", image ? "yes" : "no"));
 
     current_image = image;
-    last_tap = next_tap = 0;
     datasette_internal_reset();
 
+    lib_free(tap_pulse_start);
+    tap_pulse_start = NULL;
+    tap_pulse_end = 0;
+    tap_pulses_valid = 0;
+
     if (image != NULL) {
+        datasette_decode_image();
+
         /* We need the length of tape for realistic counter. */
         current_image->cycle_counter_total = 0;
         do {
@@ -746,7 +654,6 @@ void datasette_set_tape_image(tap_t *image)
         tapeport_set_tape_sense(0, datasette_device.id);
     }
 
-    last_tap = next_tap = 0;
     fullwave = 0;
 
     ui_set_tape_status(current_image ? 1 : 0);
@@ -961,8 +868,6 @@ static void datasette_control_internal(int command)
         }
         ui_display_tape_control_status(notape_mode);
     }
-    /* clear the tap-buffer */
-    last_tap = next_tap = 0;
 }
 
 void datasette_control(int command)
@@ -1067,6 +972,8 @@ inline static void bit_write(void)
         current_image->cycle_counter_total = current_image->cycle_counter;
     }
     current_image->has_changed = 1;
+    current_image->data_valid = 0;
+    tap_pulses_valid = 0;
     datasette_update_ui_counter();
 }
 
@@ -1120,7 +1027,7 @@ void datasette_event_playback(CLOCK offset, void *data)
 static int datasette_write_snapshot(snapshot_t *s, int write_image)
 {
     snapshot_module_t *m;
-    uint32_t alarm_clk = CLOCK_MAX;
+    CLOCK alarm_clk = CLOCK_MAX;
 
     m = snapshot_module_create(s, "DATASETTE", DATASETTE_SNAP_MAJOR,
                                DATASETTE_SNAP_MINOR);
@@ -1135,12 +1042,12 @@ static int datasette_write_snapshot(snapshot_t *s, int write_image)
     if (0
         || SMW_B(m, (uint8_t)datasette_motor) < 0
         || SMW_B(m, (uint8_t)notape_mode) < 0
-        || SMW_DW(m, last_write_clk) < 0
-        || SMW_DW(m, motor_stop_clk) < 0
+        || SMW_CLOCK(m, last_write_clk) < 0
+        || SMW_CLOCK(m, motor_stop_clk) < 0
         || SMW_B(m, (uint8_t)datasette_alarm_pending) < 0
-        || SMW_DW(m, alarm_clk) < 0
-        || SMW_DW(m, datasette_long_gap_pending) < 0
-        || SMW_DW(m, datasette_long_gap_elapsed) < 0
+        || SMW_CLOCK(m, alarm_clk) < 0
+        || SMW_CLOCK(m, datasette_long_gap_pending) < 0
+        || SMW_CLOCK(m, datasette_long_gap_elapsed) < 0
         || SMW_B(m, (uint8_t)datasette_last_direction) < 0
         || SMW_DW(m, datasette_counter_offset) < 0
         || SMW_B(m, (uint8_t)reset_datasette_with_maincpu) < 0
@@ -1148,7 +1055,7 @@ static int datasette_write_snapshot(snapshot_t *s, int write_image)
         || SMW_DW(m, datasette_speed_tuning) < 0
         || SMW_DW(m, datasette_tape_wobble) < 0
         || SMW_B(m, (uint8_t)fullwave) < 0
-        || SMW_DW(m, fullwave_gap) < 0) {
+        || SMW_CLOCK(m, fullwave_gap) < 0) {
         snapshot_module_close(m);
         return -1;
     }
@@ -1164,7 +1071,7 @@ static int datasette_read_snapshot(snapshot_t *s)
 {
     uint8_t major_version, minor_version;
     snapshot_module_t *m;
-    uint32_t alarm_clk;
+    CLOCK alarm_clk;
 
     m = snapshot_module_open(s, "DATASETTE",
                              &major_version, &minor_version);
@@ -1175,12 +1082,12 @@ static int datasette_read_snapshot(snapshot_t *s)
     if (0
         || SMR_B_INT(m, &datasette_motor) < 0
         || SMR_B_INT(m, &notape_mode) < 0
-        || SMR_DW(m, &last_write_clk) < 0
-        || SMR_DW(m, &motor_stop_clk) < 0
+        || SMR_CLOCK(m, &last_write_clk) < 0
+        || SMR_CLOCK(m, &motor_stop_clk) < 0
         || SMR_B_INT(m, &datasette_alarm_pending) < 0
-        || SMR_DW(m, &alarm_clk) < 0
-        || SMR_DW(m, &datasette_long_gap_pending) < 0
-        || SMR_DW(m, (uint32_t *)&datasette_long_gap_elapsed) < 0
+        || SMR_CLOCK(m, &alarm_clk) < 0
+        || SMR_CLOCK(m, &datasette_long_gap_pending) < 0
+        || SMR_CLOCK(m, &datasette_long_gap_elapsed) < 0
         || SMR_B_INT(m, &datasette_last_direction) < 0
         || SMR_DW_INT(m, &datasette_counter_offset) < 0
         || SMR_B_INT(m, &reset_datasette_with_maincpu) < 0
@@ -1188,7 +1095,7 @@ static int datasette_read_snapshot(snapshot_t *s)
         || SMR_DW_INT(m, &datasette_speed_tuning) < 0
         || SMR_DW_INT(m, &datasette_tape_wobble) < 0
         || SMR_B_INT(m, (int *)&fullwave) < 0
-        || SMR_DW(m, &fullwave_gap) < 0) {
+        || SMR_CLOCK(m, &fullwave_gap) < 0) {
         snapshot_module_close(m);
         return -1;
     }
@@ -1216,9 +1123,6 @@ static int datasette_read_snapshot(snapshot_t *s)
         }
     }
 
-    /* reset buffer */
-    next_tap = last_tap = 0;
-
     snapshot_module_close(m);
 
     return tape_snapshot_read_module(s);
@@ -52,6 +52,7 @@ static sound_chip_t digimax_sound_chip = {
     digimax_sound_machine_init,              /* sound chip init function */
     NULL,                                    /* NO sound chip close function */
     digimax_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                    /* NO sound chip skip samples function */
     digimax_sound_machine_store,             /* sound chip store function */
     digimax_sound_machine_read,              /* sound chip read function */
     digimax_sound_reset,                     /* sound chip reset function */
@@ -53,6 +53,12 @@ static const cmdline_option_t cmdline_options[] =
     { "-drivesoundvolume", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
       NULL, NULL, "DriveSoundEmulationVolume", NULL,
       "<Volume>", "Set volume for disk drive sound emulation (0-4000)" },
+    { "-drivebusyloopskip", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "DriveBusyLoopSkip", (void *)1,
+      NULL, "Skip over busy loops of the drive CPUs" },
+    { "+drivebusyloopskip", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "DriveBusyLoopSkip", (void *)0,
+      NULL, "Execute busy loops of the drive CPUs" },
     CMDLINE_LIST_END
 };
 
@@ -55,6 +55,9 @@ int drive_sound_emulation;
 /* volume of the drive sound */
 int drive_sound_emulation_volume;
 
+/* Is skipping of busy loops enabled?  */
+int drive_busy_loop_skip;
+
 static int set_drive_true_emulation(int val, void *param)
 {
     unsigned int dnr;
@@ -108,6 +111,13 @@ static int set_drive_sound_emulation_volume(int val, void *param)
     return 0;
 }
 
+static int set_drive_busy_loop_skip(int val, void *param)
+{
+    drive_busy_loop_skip = val ? 1 : 0;
+
+    return 0;
+}
+
 static int set_drive_extend_image_policy(int val, void *param)
 {
     switch (val) {
@@ -330,6 +340,8 @@ static const resource_int_t resources_int[] = {
       &drive_sound_emulation, set_drive_sound_emulation, NULL },
     { "DriveSoundEmulationVolume", 1000, RES_EVENT_NO, (resource_value_t)1000,
       &drive_sound_emulation_volume, set_drive_sound_emulation_volume, NULL },
+    { "DriveBusyLoopSkip", 1, RES_EVENT_NO, NULL,
+      &drive_busy_loop_skip, set_drive_busy_loop_skip, NULL },
     RESOURCE_INT_LIST_END
 };
 
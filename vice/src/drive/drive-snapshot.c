@@ -160,11 +160,11 @@ int drive_snapshot_write_module(snapshot_t *s, int save_disks, int save_roms)
     for (i = 0; i < DRIVE_NUM; i++) {
         drive = drive_context[i]->drives[0];
         if (0
-            || SMW_DW(m, (uint32_t)(drive->attach_clk)) < 0
+            || SMW_CLOCK(m, drive->attach_clk) < 0
             || SMW_B(m, (uint8_t)(drive->byte_ready_level)) < 0
             || SMW_B(m, (uint8_t)(drive->clock_frequency)) < 0
             || SMW_W(m, (uint16_t)(drive->current_half_track + (drive->side * DRIVE_HALFTRACKS_1571))) < 0
-            || SMW_DW(m, (uint32_t)(drive->detach_clk)) < 0
+            || SMW_CLOCK(m, drive->detach_clk) < 0
             || SMW_B(m, (uint8_t)0) < 0
             || SMW_B(m, (uint8_t)0) < 0
             || SMW_B(m, (uint8_t)(drive->extend_image_policy)) < 0
@@ -179,7 +179,7 @@ int drive_snapshot_write_module(snapshot_t *s, int save_disks, int save_roms)
 
             /* rotation */
             || SMW_DW(m, (uint32_t)(drive->snap_accum)) < 0
-            || SMW_DW(m, (uint32_t)(drive->snap_rotation_last_clk)) < 0
+            || SMW_CLOCK(m, drive->snap_rotation_last_clk) < 0
             || SMW_DW(m, (uint32_t)(drive->snap_bit_counter)) < 0
             || SMW_DW(m, (uint32_t)(drive->snap_zero_count)) < 0
             || SMW_W(m, (uint16_t)(drive->snap_last_read_data)) < 0
@@ -213,7 +213,7 @@ int drive_snapshot_write_module(snapshot_t *s, int save_disks, int save_roms)
     for (i = 0; i < DRIVE_NUM; i++) {
         drive = drive_context[i]->drives[0];
         if (0
-            || SMW_DW(m, (uint32_t)(drive->attach_detach_clk)) < 0
+            || SMW_CLOCK(m, drive->attach_detach_clk) < 0
             ) {
             if (m != NULL) {
                 snapshot_module_close(m);
@@ -344,12 +344,12 @@ int drive_snapshot_read_module(snapshot_t *s)
         if (snapshot_version_is_equal(major_version, minor_version, 1, 0)) {
             if (0
                 || SMR_DW_UL(m, &(drive->snap_accum)) < 0
-                || SMR_DW(m, &(attach_clk[i])) < 0
+                || SMR_CLOCK(m, &(attach_clk[i])) < 0
                 || SMR_DW_INT(m, &dummy) < 0
                 || SMR_B_INT(m, (int *)&(drive->byte_ready_level)) < 0
                 || SMR_B_INT(m, &(drive->clock_frequency)) < 0
                 || SMR_W_INT(m, &half_track[i]) < 0
-                || SMR_DW(m, &(detach_clk[i])) < 0
+                || SMR_CLOCK(m, &(detach_clk[i])) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B_INT(m, &(drive->extend_image_policy)) < 0
@@ -361,7 +361,7 @@ int drive_snapshot_read_module(snapshot_t *s)
                 || SMR_B_INT(m, &dummy) < 0
                 || SMR_B_INT(m, &(drive->parallel_cable)) < 0
                 || SMR_B_INT(m, &(drive->read_only)) < 0
-                || SMR_DW(m, &(drive->snap_rotation_last_clk)) < 0
+                || SMR_CLOCK(m, &(drive->snap_rotation_last_clk)) < 0
                 || SMR_DW(m, &rotation_table_ptr[i]) < 0
                 || SMR_DW_UINT(m, &(drive->type)) < 0
                 ) {
@@ -372,11 +372,11 @@ int drive_snapshot_read_module(snapshot_t *s)
             /* Partially read 1.1 snapshots */
         } else if (snapshot_version_is_equal(major_version, minor_version, 1, 1)) {
             if (0
-                || SMR_DW(m, &(attach_clk[i])) < 0
+                || SMR_CLOCK(m, &(attach_clk[i])) < 0
                 || SMR_B_INT(m, (int *)&(drive->byte_ready_level)) < 0
                 || SMR_B_INT(m, &(drive->clock_frequency)) < 0
                 || SMR_W_INT(m, &half_track[i]) < 0
-                || SMR_DW(m, &(detach_clk[i])) < 0
+                || SMR_CLOCK(m, &(detach_clk[i])) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B_INT(m, &(drive->extend_image_policy)) < 0
@@ -390,7 +390,7 @@ int drive_snapshot_read_module(snapshot_t *s)
                 || SMR_DW_UINT(m, &(drive->type)) < 0
 
                 || SMR_DW_UL(m, &(drive->snap_accum)) < 0
-                || SMR_DW(m, &(drive->snap_rotation_last_clk)) < 0
+                || SMR_CLOCK(m, &(drive->snap_rotation_last_clk)) < 0
                 || SMR_DW_INT(m, &(drive->snap_bit_counter)) < 0
                 || SMR_DW_INT(m, &(drive->snap_zero_count)) < 0
                 || SMR_W_INT(m, &(drive->snap_last_read_data)) < 0
@@ -404,11 +404,11 @@ int drive_snapshot_read_module(snapshot_t *s)
             /* Partially read 1.2 snapshots */
         } else if (snapshot_version_is_equal(major_version, minor_version, 1, 2)) {
             if (0
-                || SMR_DW(m, &(attach_clk[i])) < 0
+                || SMR_CLOCK(m, &(attach_clk[i])) < 0
                 || SMR_B_INT(m, (int *)&(drive->byte_ready_level)) < 0
                 || SMR_B_INT(m, &(drive->clock_frequency)) < 0
                 || SMR_W_INT(m, &half_track[i]) < 0
-                || SMR_DW(m, &(detach_clk[i])) < 0
+                || SMR_CLOCK(m, &(detach_clk[i])) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B_INT(m, &(drive->extend_image_policy)) < 0
@@ -422,7 +422,7 @@ int drive_snapshot_read_module(snapshot_t *s)
                 || SMR_DW_UINT(m, &(drive->type)) < 0
 
                 || SMR_DW_UL(m, &(drive->snap_accum)) < 0
-                || SMR_DW(m, &(drive->snap_rotation_last_clk)) < 0
+                || SMR_CLOCK(m, &(drive->snap_rotation_last_clk)) < 0
                 || SMR_DW_INT(m, &(drive->snap_bit_counter)) < 0
                 || SMR_DW_INT(m, &(drive->snap_zero_count)) < 0
                 || SMR_W_INT(m, &(drive->snap_last_read_data)) < 0
@@ -445,11 +445,11 @@ int drive_snapshot_read_module(snapshot_t *s)
             }
         } else if (snapshot_version_is_equal(major_version, minor_version, 1, 3)) {
             if (0
-                || SMR_DW(m, &(attach_clk[i])) < 0
+                || SMR_CLOCK(m, &(attach_clk[i])) < 0
                 || SMR_B_INT(m, (int *)&(drive->byte_ready_level)) < 0
                 || SMR_B_INT(m, &(drive->clock_frequency)) < 0
                 || SMR_W_INT(m, &half_track[i]) < 0
-                || SMR_DW(m, &(detach_clk[i])) < 0
+                || SMR_CLOCK(m, &(detach_clk[i])) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B_INT(m, &(drive->extend_image_policy)) < 0
@@ -463,7 +463,7 @@ int drive_snapshot_read_module(snapshot_t *s)
                 || SMR_DW_UINT(m, &(drive->type)) < 0
 
                 || SMR_DW_UL(m, &(drive->snap_accum)) < 0
-                || SMR_DW(m, &(drive->snap_rotation_last_clk)) < 0
+                || SMR_CLOCK(m, &(drive->snap_rotation_last_clk)) < 0
                 || SMR_DW_INT(m, &(drive->snap_bit_counter)) < 0
                 || SMR_DW_INT(m, &(drive->snap_zero_count)) < 0
                 || SMR_W_INT(m, &(drive->snap_last_read_data)) < 0
@@ -487,11 +487,11 @@ int drive_snapshot_read_module(snapshot_t *s)
             }
         } else {
             if (0
-                || SMR_DW(m, &(attach_clk[i])) < 0
+                || SMR_CLOCK(m, &(attach_clk[i])) < 0
                 || SMR_B_INT(m, (int *)&(drive->byte_ready_level)) < 0
                 || SMR_B_INT(m, &(drive->clock_frequency)) < 0
                 || SMR_W_INT(m, &half_track[i]) < 0
-                || SMR_DW(m, &(detach_clk[i])) < 0
+                || SMR_CLOCK(m, &(detach_clk[i])) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B(m, (uint8_t *)&dummy) < 0
                 || SMR_B_INT(m, &(drive->extend_image_policy)) < 0
@@ -505,7 +505,7 @@ int drive_snapshot_read_module(snapshot_t *s)
                 || SMR_DW_UINT(m, &(drive->type)) < 0
 
                 || SMR_DW_UL(m, &(drive->snap_accum)) < 0
-                || SMR_DW(m, &(drive->snap_rotation_last_clk)) < 0
+                || SMR_CLOCK(m, &(drive->snap_rotation_last_clk)) < 0
                 || SMR_DW_INT(m, &(drive->snap_bit_counter)) < 0
                 || SMR_DW_INT(m, &(drive->snap_zero_count)) < 0
                 || SMR_W_INT(m, &(drive->snap_last_read_data)) < 0
@@ -536,7 +536,7 @@ int drive_snapshot_read_module(snapshot_t *s)
     /* this one is new, so don't test so stay compatible with old snapshots */
     for (i = 0; i < DRIVE_NUM; i++) {
         drive = drive_context[i]->drives[0];
-        SMR_DW(m, &(attach_detach_clk[i]));
+        SMR_CLOCK(m, &(attach_detach_clk[i]));
     }
 
     /* these are even newer */
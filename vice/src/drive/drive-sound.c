@@ -1526,6 +1526,7 @@ static sound_chip_t drive_sound = {
     drive_sound_machine_init,              /* sound chip init function */
     NULL,                                  /* NO sound chip close function */
     drive_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                  /* NO sound chip skip samples function */
     NULL,                                  /* NO sound chip store function */
     NULL,                                  /* NO sound chip read function */
     NULL,                                  /* NO sound chip reset function */
@@ -48,7 +48,6 @@
 #include "diskconstants.h"
 #include "diskimage.h"
 #include "drive-check.h"
-#include "drive-overflow.h"
 #include "drive.h"
 #include "drivecpu.h"
 #include "drivecpu65c02.h"
@@ -195,8 +194,6 @@ int drive_init(void)
     log_message(drive_log, "Finished loading ROM images.");
     rom_loaded = 1;
 
-    drive_overflow_init();
-
     for (dnr = 0; dnr < DRIVE_NUM; dnr++) {
         drive = drive_context[dnr]->drives[0];
 
@@ -540,20 +537,6 @@ void drive_cpu_early_init_all(void)
     }
 }
 
-void drive_cpu_prevent_clk_overflow_all(CLOCK sub)
-{
-    unsigned int dnr;
-
-    for (dnr = 0; dnr < DRIVE_NUM; dnr++) {
-        drive_t *drive = drive_context[dnr]->drives[0];
-        if (drive->type == DRIVE_TYPE_2000 || drive->type == DRIVE_TYPE_4000) {
-            drivecpu65c02_prevent_clk_overflow(drive_context[dnr], sub);
-        } else {
-            drivecpu_prevent_clk_overflow(drive_context[dnr], sub);
-        }
-    }
-}
-
 void drive_cpu_trigger_reset(unsigned int dnr)
 {
     drive_t *drive = drive_context[dnr]->drives[0];
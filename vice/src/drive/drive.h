@@ -367,6 +367,9 @@ extern struct drive_context_s *drive_context[DRIVE_NUM];
 
 extern int rom_loaded;
 
+/* Fast-forward through busy loops of the drive CPU.  */
+extern int drive_busy_loop_skip;
+
 extern int drive_init(void);
 extern int drive_enable(struct drive_context_s *drv);
 extern void drive_disable(struct drive_context_s *drv);
@@ -374,7 +377,6 @@ extern void drive_move_head(int step, struct drive_s *drive);
 /* Don't use these pointers before the context is set up!  */
 extern struct monitor_interface_s *drive_cpu_monitor_interface_get(unsigned int dnr);
 extern void drive_cpu_early_init_all(void);
-extern void drive_cpu_prevent_clk_overflow_all(CLOCK sub);
 extern void drive_cpu_trigger_reset(unsigned int dnr);
 extern void drive_reset(void);
 extern void drive_shutdown(void);
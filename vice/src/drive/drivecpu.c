@@ -34,8 +34,8 @@
 #include <string.h>
 
 #include "6510core.h"
+#include "6510idle.h"
 #include "alarm.h"
-#include "clkguard.h"
 #include "debug.h"
 #include "drive.h"
 #include "drivecpu.h"
@@ -57,10 +57,25 @@
 
 #define DRIVE_CPU
 
+/* Longest busy loop that is skipped, in bytes.  */
+#define DRIVECPU_IDLE_LOOP_MAX   32
+
+/* Passes through a loop before it is given up if its state keeps
+   changing.  */
+#define DRIVECPU_IDLE_PASSES_MAX 4
+
+/* Drive cycles until a rejected loop is examined again, as the code may
+   have been replaced in the meantime.  */
+#define DRIVECPU_IDLE_RETRY      20000
+
+/* Value of idle_head while there is no candidate loop.  */
+#define DRIVECPU_IDLE_NONE       0x10000
+
 /* Global clock counters.  */
 CLOCK drive_clk[DRIVE_NUM];
 
 static void drive_jam(drive_context_t *drv);
+static void drivecpu_idle_candidate(drive_context_t *drv, unsigned int head);
 
 static void drivecpu_set_bank_base(void *context);
 
@@ -89,6 +104,9 @@ void drivecpu_setup_context(struct drive_context_s *drv, int i)
     cpu->d_bank_limit = 0;
     cpu->d_bank_start = 0;
     cpu->pageone = NULL;
+    cpu->idle_head = DRIVECPU_IDLE_NONE;
+    cpu->idle_len = 0;
+    cpu->idle_reject = DRIVECPU_IDLE_NONE;
     if (i) {
         cpu->snap_module_name = lib_msprintf("DRIVECPU%d", drv->mynumber);
         cpu->identification_string = lib_msprintf("DRIVE#%d", drv->mynumber + 8);
@@ -121,8 +139,6 @@ void drivecpu_setup_context(struct drive_context_s *drv, int i)
     cpu->monspace = monitor_diskspace_mem(drv->mynumber);
 
     if (i) {
-        drv->cpu->clk_guard = clk_guard_new(drv->clk_ptr, CLOCK_MAX - CLKGUARD_SUB_MIN);
-
         drv->cpu->alarm_context = alarm_context_new(drv->cpu->identification_string);
     }
 }
@@ -145,6 +161,10 @@ void drivecpu_setup_context(struct drive_context_s *drv, int i)
 
 #define JUMP(addr)                                                         \
     do {                                                                   \
+        if (cpu->last_opcode_addr - (unsigned int)(addr)                   \
+            < DRIVECPU_IDLE_LOOP_MAX) {                                    \
+            drivecpu_idle_candidate(drv, (unsigned int)(addr));            \
+        }                                                                  \
         reg_pc = (unsigned int)(addr);                                     \
         if (reg_pc >= cpu->d_bank_limit || reg_pc < cpu->d_bank_start) {   \
             uint8_t *p = drv->cpud->read_base_tab_ptr[reg_pc >> 8];           \
@@ -229,9 +249,6 @@ void drivecpu_shutdown(drive_context_t *drv)
     if (cpu->alarm_context != NULL) {
         alarm_context_destroy(cpu->alarm_context);
     }
-    if (cpu->clk_guard != NULL) {
-        clk_guard_destroy(cpu->clk_guard);
-    }
 
     monitor_interface_destroy(cpu->monitor_interface);
     interrupt_cpu_status_destroy(cpu->int_status);
@@ -268,28 +285,6 @@ inline void drivecpu_sleep(drive_context_t *drv)
     /* Currently does nothing.  But we might need this hook some day.  */
 }
 
-/* Make sure the drive clock counters never overflow; return nonzero if
-   they have been decremented to prevent overflow.  */
-CLOCK drivecpu_prevent_clk_overflow(drive_context_t *drv, CLOCK sub)
-{
-    if (sub != 0) {
-        /* First, get in sync with what the main CPU has done.  Notice that
-           `clk' has already been decremented at this point.  */
-        if (drv->drives[0]->enable) {
-            if (drv->cpu->last_clk < sub) {
-                /* Hm, this is kludgy.  :-(  */
-                drive_cpu_execute_all(maincpu_clk + sub);
-            }
-            drv->cpu->last_clk -= sub;
-        } else {
-            drv->cpu->last_clk = maincpu_clk;
-        }
-    }
-
-    /* Then, check our own clock counters.  */
-    return clk_guard_prevent_overflow(drv->cpu->clk_guard);
-}
-
 /* Handle a ROM trap. */
 inline static uint32_t drive_trap_handler(drive_context_t *drv)
 {
@@ -372,6 +367,184 @@ inline static int interrupt_check_irq_delay(interrupt_cpu_status_t *cs,
     return 0;
 }
 
+/* -------------------------------------------------------------------------- */
+
+/* Busy loop detection.
+
+   Fastloaders usually wait for the computer in loops of their own, which
+   neither the idle trap nor skipping cycles catch.  A short loop entered
+   by a jump backwards is a candidate if it only branches, compares and
+   loads from memory or from I/O registers whose idle function tells that
+   they can only change with a write from either CPU or with an alarm (see
+   drivemem_set_idle_func()).  Everything the computer does to the bus
+   first catches up the drive, so within one drivecpu_execute() the loop
+   can only be left through an alarm.  Once two passes through the head of
+   the loop show the same registers, every following pass does exactly the
+   same, and the clock is advanced by whole passes up to the next alarm.
+   The drive thus ends up in exactly the state it would have after running
+   the loop.  */
+
+/* Return nonzero if the loop from `head' to the jump back at `tail' can be
+   skipped.  */
+static int drivecpu_idle_check_loop(drive_context_t *drv, unsigned int head,
+                                    unsigned int tail)
+{
+    drivecpud_context_t *cpud = drv->cpud;
+    unsigned int pc = head;
+    unsigned int last_pc = head;
+    unsigned int addr = 0;
+    int mode = IDLE_OP_NONE;
+    drive_idle_func_t *idle_func;
+
+    while (pc <= tail) {
+        uint8_t opcode, lo, hi;
+
+        last_pc = pc;
+
+        /* the code itself must be in plain memory */
+        if (cpud->idle_tab[pc >> 8] != drivemem_idle_mem
+            || cpud->idle_tab[((pc + 2) >> 8) & 0xff] != drivemem_idle_mem) {
+            return 0;
+        }
+        opcode = cpud->peek_func_ptr[pc >> 8](drv, (uint16_t)pc);
+        lo = cpud->peek_func_ptr[(pc + 1) >> 8](drv, (uint16_t)(pc + 1));
+        hi = cpud->peek_func_ptr[(pc + 2) >> 8](drv, (uint16_t)(pc + 2));
+
+        mode = mos6510_idle_opcode(opcode);
+        switch (mode) {
+            case IDLE_OP_IMPLIED:
+                pc += 1;
+                break;
+            case IDLE_OP_IMMEDIATE:
+                pc += 2;
+                break;
+            case IDLE_OP_ZERO:
+                idle_func = cpud->idle_tab[0];
+                if (idle_func == NULL || !idle_func(drv, lo)) {
+                    return 0;
+                }
+                pc += 2;
+                break;
+            case IDLE_OP_ZERO_INDEXED:
+                if (cpud->idle_tab[0] != drivemem_idle_mem) {
+                    return 0;
+                }
+                pc += 2;
+                break;
+            case IDLE_OP_ABS:
+                addr = lo | (hi << 8);
+                idle_func = cpud->idle_tab[addr >> 8];
+                if (idle_func == NULL || !idle_func(drv, (uint16_t)addr)) {
+                    return 0;
+                }
+                pc += 3;
+                break;
+            case IDLE_OP_ABS_INDEXED:
+                /* any index may be used, I/O is ruled out */
+                addr = lo | (hi << 8);
+                if (cpud->idle_tab[addr >> 8] != drivemem_idle_mem
+                    || cpud->idle_tab[((addr + 0xff) >> 8) & 0xff] != drivemem_idle_mem) {
+                    return 0;
+                }
+                pc += 3;
+                break;
+            case IDLE_OP_BRANCH:
+                addr = (pc + 2 + (signed char)lo) & 0xffff;
+                pc += 2;
+                break;
+            case IDLE_OP_JMP:
+                addr = lo | (hi << 8);
+                pc += 3;
+                break;
+            default:
+                return 0;
+        }
+    }
+
+    /* the last instruction must be the jump back */
+    return last_pc == tail && addr == head
+           && (mode == IDLE_OP_BRANCH || mode == IDLE_OP_JMP);
+}
+
+/* Called from JUMP() when jumping back by less than
+   DRIVECPU_IDLE_LOOP_MAX bytes.  */
+static void drivecpu_idle_candidate(drive_context_t *drv, unsigned int head)
+{
+    drivecpu_context_t *cpu = drv->cpu;
+    unsigned int tail = cpu->last_opcode_addr;
+
+    if (head == cpu->idle_head || !drive_busy_loop_skip) {
+        return;
+    }
+    if (head == cpu->idle_reject
+        && *(drv->clk_ptr) - cpu->idle_reject_clk < DRIVECPU_IDLE_RETRY) {
+        return;
+    }
+
+    if (drivecpu_idle_check_loop(drv, head, tail)) {
+        cpu->idle_head = head;
+        cpu->idle_len = tail - head;
+        cpu->idle_passes = 0;
+    } else {
+        cpu->idle_head = DRIVECPU_IDLE_NONE;
+        cpu->idle_len = 0;
+        cpu->idle_reject = head;
+        cpu->idle_reject_clk = *(drv->clk_ptr);
+    }
+}
+
+/* Called at the head of the candidate loop, before alarms and interrupts
+   are processed.  */
+static void drivecpu_idle_loop(drive_context_t *drv)
+{
+    drivecpu_context_t *cpu = drv->cpu;
+    mos6510_regs_t *regs = &cpu->cpu_regs;
+    mos6510_regs_t *last = &cpu->idle_regs;
+    unsigned int pending = cpu->int_status->global_pending_int;
+    CLOCK clk = *(drv->clk_ptr);
+    CLOCK alarm_clk, limit, period;
+
+    alarm_clk = alarm_context_next_pending_clk(cpu->alarm_context);
+
+    /* Nothing may happen in between but the loop itself.  Watchpoints
+       and breakpoints must see every access.  */
+    if (clk >= alarm_clk
+        || (pending != IK_NONE
+            && (pending != IK_IRQ || !(regs->p & P_INTERRUPT)))
+        || drv->cpud->read_func_ptr != drv->cpud->read_tab[0]
+        || !drive_busy_loop_skip) {
+        cpu->idle_passes = 0;
+        return;
+    }
+
+    if (cpu->idle_passes > 0
+        && alarm_clk == cpu->idle_alarm_clk
+        && regs->a == last->a && regs->x == last->x && regs->y == last->y
+        && regs->sp == last->sp && regs->p == last->p
+        && regs->n == last->n && regs->z == last->z) {
+        period = clk - cpu->idle_clk;
+        limit = alarm_clk < cpu->stop_clk ? alarm_clk : cpu->stop_clk;
+        if (period > 0 && limit > clk) {
+            clk += (limit - clk) / period * period;
+            *(drv->clk_ptr) = clk;
+        }
+        cpu->idle_clk = clk;
+        return;
+    }
+
+    if (++cpu->idle_passes > DRIVECPU_IDLE_PASSES_MAX) {
+        cpu->idle_reject = cpu->idle_head;
+        cpu->idle_reject_clk = clk;
+        cpu->idle_head = DRIVECPU_IDLE_NONE;
+        cpu->idle_len = 0;
+        return;
+    }
+
+    cpu->idle_clk = clk;
+    cpu->idle_alarm_clk = alarm_clk;
+    *last = *regs;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Execute up to the current main CPU clock value.  This automatically
    calculates the corresponding number of clock ticks in the drive.  */
@@ -394,6 +567,9 @@ void drivecpu_execute(drive_context_t *drv, CLOCK clk_value)
 
     drivecpu_wake_up(drv);
 
+    /* The computer may have changed the bus since the last call.  */
+    cpu->idle_passes = 0;
+
     /* Calculate number of main CPU clocks to emulate */
     if (clk_value > cpu->last_clk) {
         cycles = clk_value - cpu->last_clk;
@@ -410,11 +586,18 @@ void drivecpu_execute(drive_context_t *drv, CLOCK clk_value)
         cpu->cycle_accum &= 0xffff;
     }
 
-    /* Run drive CPU emulation until the stop_clk clock has been reached.
-     * There appears to be a nasty 32-bit overflow problem here, so we
-     * paper over it by only considering subtractions of 2nd complement
-     * integers. */
-    while ((int) (*(drv->clk_ptr) - cpu->stop_clk) < 0) {
+    /* Run drive CPU emulation until the stop_clk clock has been reached.  */
+    while (*(drv->clk_ptr) < cpu->stop_clk) {
+        if (reg_pc - cpu->idle_head <= cpu->idle_len) {
+            if (reg_pc == cpu->idle_head) {
+                drivecpu_idle_loop(drv);
+            }
+        } else if (cpu->idle_head != DRIVECPU_IDLE_NONE) {
+            /* left the loop */
+            cpu->idle_head = DRIVECPU_IDLE_NONE;
+            cpu->idle_len = 0;
+        }
+
 /* Include the 6502/6510 CPU emulation core.  */
 
 #define CLK (*(drv->clk_ptr))
@@ -574,7 +757,7 @@ int drivecpu_snapshot_write_module(drive_context_t *drv, snapshot_t *s)
     }
 
     if (0
-        || SMW_DW(m, (uint32_t) *(drv->clk_ptr)) < 0
+        || SMW_CLOCK(m, *(drv->clk_ptr)) < 0
         || SMW_B(m, (uint8_t)MOS6510_REGS_GET_A(&(cpu->cpu_regs))) < 0
         || SMW_B(m, (uint8_t)MOS6510_REGS_GET_X(&(cpu->cpu_regs))) < 0
         || SMW_B(m, (uint8_t)MOS6510_REGS_GET_Y(&(cpu->cpu_regs))) < 0
@@ -582,10 +765,10 @@ int drivecpu_snapshot_write_module(drive_context_t *drv, snapshot_t *s)
         || SMW_W(m, (uint16_t)MOS6510_REGS_GET_PC(&(cpu->cpu_regs))) < 0
         || SMW_B(m, (uint16_t)MOS6510_REGS_GET_STATUS(&(cpu->cpu_regs))) < 0
         || SMW_DW(m, (uint32_t)(cpu->last_opcode_info)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->last_clk)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->cycle_accum)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->last_exc_cycles)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->stop_clk)) < 0
+        || SMW_CLOCK(m, cpu->last_clk) < 0
+        || SMW_CLOCK(m, cpu->cycle_accum) < 0
+        || SMW_CLOCK(m, cpu->last_exc_cycles) < 0
+        || SMW_CLOCK(m, cpu->stop_clk) < 0
         ) {
         goto fail;
     }
@@ -651,9 +834,8 @@ int drivecpu_snapshot_read_module(drive_context_t *drv, snapshot_t *s)
     /* Before we start make sure all devices are reset.  */
     drivecpu_reset(drv);
 
-    /* XXX: Assumes `CLOCK' is the same size as a `DWORD'.  */
     if (0
-        || SMR_DW(m, drv->clk_ptr) < 0
+        || SMR_CLOCK(m, drv->clk_ptr) < 0
         || SMR_B(m, &a) < 0
         || SMR_B(m, &x) < 0
         || SMR_B(m, &y) < 0
@@ -661,10 +843,10 @@ int drivecpu_snapshot_read_module(drive_context_t *drv, snapshot_t *s)
         || SMR_W(m, &pc) < 0
         || SMR_B(m, &status) < 0
         || SMR_DW_UINT(m, &(cpu->last_opcode_info)) < 0
-        || SMR_DW(m, &(cpu->last_clk)) < 0
-        || SMR_DW(m, &(cpu->cycle_accum)) < 0
-        || SMR_DW(m, &(cpu->last_exc_cycles)) < 0
-        || SMR_DW(m, &(cpu->stop_clk)) < 0
+        || SMR_CLOCK(m, &(cpu->last_clk)) < 0
+        || SMR_CLOCK(m, &(cpu->cycle_accum)) < 0
+        || SMR_CLOCK(m, &(cpu->last_exc_cycles)) < 0
+        || SMR_CLOCK(m, &(cpu->stop_clk)) < 0
         ) {
         goto fail;
     }
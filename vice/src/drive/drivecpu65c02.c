@@ -30,7 +30,6 @@
 
 #include "6510core.h"   /* using 6510core.h because the registers are the same */
 #include "alarm.h"
-#include "clkguard.h"
 #include "debug.h"
 #include "drive.h"
 #include "drivecpu65c02.h"
@@ -111,8 +110,6 @@ void drivecpu65c02_setup_context(struct drive_context_s *drv, int i)
     cpu->monspace = monitor_diskspace_mem(drv->mynumber);
 
     if (i) {
-        drv->cpu->clk_guard = clk_guard_new(drv->clk_ptr, CLOCK_MAX - CLKGUARD_SUB_MIN);
-
         drv->cpu->alarm_context = alarm_context_new(drv->cpu->identification_string);
     }
 }
@@ -206,9 +203,6 @@ void drivecpu65c02_shutdown(drive_context_t *drv)
     if (cpu->alarm_context != NULL) {
         alarm_context_destroy(cpu->alarm_context);
     }
-    if (cpu->clk_guard != NULL) {
-        clk_guard_destroy(cpu->clk_guard);
-    }
 
     monitor_interface_destroy(cpu->monitor_interface);
     interrupt_cpu_status_destroy(cpu->int_status);
@@ -245,28 +239,6 @@ void drivecpu65c02_sleep(drive_context_t *drv)
     /* Currently does nothing.  But we might need this hook some day.  */
 }
 
-/* Make sure the drive clock counters never overflow; return nonzero if
-   they have been decremented to prevent overflow.  */
-CLOCK drivecpu65c02_prevent_clk_overflow(drive_context_t *drv, CLOCK sub)
-{
-    if (sub != 0) {
-        /* First, get in sync with what the main CPU has done.  Notice that
-           `clk' has already been decremented at this point.  */
-        if (drv->drives[0]->enable) {
-            if (drv->cpu->last_clk < sub) {
-                /* Hm, this is kludgy.  :-(  */
-                drive_cpu_execute_all(maincpu_clk + sub);
-            }
-            drv->cpu->last_clk -= sub;
-        } else {
-            drv->cpu->last_clk = maincpu_clk;
-        }
-    }
-
-    /* Then, check our own clock counters.  */
-    return clk_guard_prevent_overflow(drv->cpu->clk_guard);
-}
-
 /* Handle a ROM trap. */
 inline static uint32_t drive_trap_handler(drive_context_t *drv)
 {
@@ -391,11 +363,8 @@ void drivecpu65c02_execute(drive_context_t *drv, CLOCK clk_value)
         cpu->cycle_accum &= 0xffff;
     }
 
-    /* Run drive CPU emulation until the stop_clk clock has been reached.
-     * There appears to be a nasty 32-bit overflow problem here, so we
-     * paper over it by only considering subtractions of 2nd complement
-     * integers. */
-    while ((int) (*(drv->clk_ptr) - cpu->stop_clk) < 0) {
+    /* Run drive CPU emulation until the stop_clk clock has been reached.  */
+    while (*(drv->clk_ptr) < cpu->stop_clk) {
 /* Include the R65C02 CPU emulation core.  */
 
 #define CLK (*(drv->clk_ptr))
@@ -468,7 +437,7 @@ int drivecpu65c02_snapshot_write_module(drive_context_t *drv, snapshot_t *s)
     }
 
     if (0
-        || SMW_DW(m, (uint32_t) *(drv->clk_ptr)) < 0
+        || SMW_CLOCK(m, *(drv->clk_ptr)) < 0
         || SMW_B(m, (uint8_t)R65C02_REGS_GET_A(&(cpu->cpu_R65C02_regs))) < 0
         || SMW_B(m, (uint8_t)R65C02_REGS_GET_X(&(cpu->cpu_R65C02_regs))) < 0
         || SMW_B(m, (uint8_t)R65C02_REGS_GET_Y(&(cpu->cpu_R65C02_regs))) < 0
@@ -476,10 +445,10 @@ int drivecpu65c02_snapshot_write_module(drive_context_t *drv, snapshot_t *s)
         || SMW_W(m, (uint16_t)R65C02_REGS_GET_PC(&(cpu->cpu_R65C02_regs))) < 0
         || SMW_B(m, (uint8_t)R65C02_REGS_GET_STATUS(&(cpu->cpu_R65C02_regs))) < 0
         || SMW_DW(m, (uint32_t)(cpu->last_opcode_info)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->last_clk)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->cycle_accum)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->last_exc_cycles)) < 0
-        || SMW_DW(m, (uint32_t)(cpu->stop_clk)) < 0
+        || SMW_CLOCK(m, cpu->last_clk) < 0
+        || SMW_CLOCK(m, cpu->cycle_accum) < 0
+        || SMW_CLOCK(m, cpu->last_exc_cycles) < 0
+        || SMW_CLOCK(m, cpu->stop_clk) < 0
         ) {
         goto fail;
     }
@@ -526,9 +495,8 @@ int drivecpu65c02_snapshot_read_module(drive_context_t *drv, snapshot_t *s)
     /* Before we start make sure all devices are reset.  */
     drivecpu65c02_reset(drv);
 
-    /* XXX: Assumes `CLOCK' is the same size as a `DWORD'.  */
     if (0
-        || SMR_DW(m, drv->clk_ptr) < 0
+        || SMR_CLOCK(m, drv->clk_ptr) < 0
         || SMR_B(m, &a) < 0
         || SMR_B(m, &x) < 0
         || SMR_B(m, &y) < 0
@@ -536,10 +504,10 @@ int drivecpu65c02_snapshot_read_module(drive_context_t *drv, snapshot_t *s)
         || SMR_W(m, &pc) < 0
         || SMR_B(m, &status) < 0
         || SMR_DW_UINT(m, &(cpu->last_opcode_info)) < 0
-        || SMR_DW(m, &(cpu->last_clk)) < 0
-        || SMR_DW(m, &(cpu->cycle_accum)) < 0
-        || SMR_DW(m, &(cpu->last_exc_cycles)) < 0
-        || SMR_DW(m, &(cpu->stop_clk)) < 0
+        || SMR_CLOCK(m, &(cpu->last_clk)) < 0
+        || SMR_CLOCK(m, &(cpu->cycle_accum)) < 0
+        || SMR_CLOCK(m, &(cpu->last_exc_cycles)) < 0
+        || SMR_CLOCK(m, &(cpu->stop_clk)) < 0
         ) {
         goto fail;
     }
@@ -161,9 +161,29 @@ void drivemem_set_func(drivecpud_context_t *cpud,
     for (i = start; i < stop; i++) {
         cpud->read_base_tab[0][i] = base ? (base - (start << 8)) : NULL;
         cpud->read_limit_tab[0][i] = limit;
+        cpud->idle_tab[i] = NULL;
     }
 }
 
+/* Allow busy loops to read these pages while being skipped.  Must be
+   called after drivemem_set_func() for the same pages.  */
+void drivemem_set_idle_func(drivecpud_context_t *cpud,
+                            unsigned int start, unsigned int stop,
+                            drive_idle_func_t *idle_func)
+{
+    unsigned int i;
+
+    for (i = start; i < stop; i++) {
+        cpud->idle_tab[i] = idle_func;
+    }
+}
+
+/* For RAM and ROM without side effects.  */
+int drivemem_idle_mem(drive_context_t *drv, uint16_t addr)
+{
+    return 1;
+}
+
 /* ------------------------------------------------------------------------- */
 /* This is the external interface for banked memory access.  */
 
@@ -218,6 +238,7 @@ void drivemem_init(drive_context_t *drv, unsigned int type)
     drv->cpud->read_tab[0][0x100] = drv->cpud->read_tab[0][0];
     drv->cpud->store_tab[0][0x100] = drv->cpud->store_tab[0][0];
     drv->cpud->peek_tab[0][0x100] = drv->cpud->peek_tab[0][0];
+    drv->cpud->idle_tab[0x100] = drv->cpud->idle_tab[0];
 
     drv->cpud->read_func_ptr = drv->cpud->read_tab[0];
     drv->cpud->store_func_ptr = drv->cpud->store_tab[0];
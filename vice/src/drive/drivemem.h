@@ -46,6 +46,10 @@ extern void drivemem_set_func(struct drivecpud_context_s *cpud,
                               drive_store_func_t *store_func,
                               drive_peek_func_t *peek_func,
                               uint8_t *base, uint32_t limit);
+extern void drivemem_set_idle_func(struct drivecpud_context_s *cpud,
+                                   unsigned int start, unsigned int stop,
+                                   drive_idle_func_t *idle_func);
+extern int drivemem_idle_mem(struct drive_context_s *drv, uint16_t addr);
 
 extern struct mem_ioreg_list_s *drivemem_ioreg_list_get(void *context);
 
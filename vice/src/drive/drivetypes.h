@@ -51,6 +51,9 @@ typedef void drive_store_func_t (struct drive_context_s *, uint16_t, uint8_t);
 typedef drive_store_func_t *drive_store_func_ptr_t;
 typedef uint8_t drive_peek_func_t (struct drive_context_s *, uint16_t);
 typedef drive_peek_func_t *drive_peek_func_ptr_t;
+/* Returns nonzero if reading the address has no side effects and returns
+   the same value until either CPU writes or an alarm is dispatched.  */
+typedef int drive_idle_func_t (struct drive_context_s *, uint16_t);
 
 /*
  *  The private CPU data.
@@ -67,9 +70,6 @@ typedef struct drivecpu_context_s {
 
     struct alarm_context_s *alarm_context;
 
-    /* Clk guard.  */
-    struct clk_guard_s *clk_guard;
-
     struct monitor_interface_s *monitor_interface;
 
     /* Value of clk for the last time mydrive_cpu_execute() was called.  */
@@ -92,6 +92,18 @@ typedef struct drivecpu_context_s {
     /* Address of the last executed opcode. This is used by watchpoints. */
     unsigned int last_opcode_addr;
 
+    /* Busy loop detection, see drivecpu_idle_loop().  The loop runs from
+       idle_head to the jump back at idle_head + idle_len; idle_head is
+       0x10000 while there is no candidate.  */
+    unsigned int idle_head;
+    unsigned int idle_len;
+    int idle_passes;
+    CLOCK idle_clk;
+    CLOCK idle_alarm_clk;
+    mos6510_regs_t idle_regs;
+    unsigned int idle_reject;
+    CLOCK idle_reject_clk;
+
     /* Public copy of the registers.  */
     mos6510_regs_t cpu_regs;
     R65C02_regs_t cpu_R65C02_regs;
@@ -129,6 +141,9 @@ typedef struct drivecpud_context_s {
     uint8_t *read_base_tab[1][0x101];
     uint32_t read_limit_tab[1][0x101];
 
+    /* Pages that may be read by a skipped busy loop.  */
+    drive_idle_func_t *idle_tab[0x101];
+
     int sync_factor;
 } drivecpud_context_t;
 
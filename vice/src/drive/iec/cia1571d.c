@@ -176,7 +176,7 @@ static void store_sdr(cia_context_t *cia_context, uint8_t byte)
 void cia1571_init(drive_context_t *ctxptr)
 {
     ciacore_init(ctxptr->cia1571, ctxptr->cpu->alarm_context,
-                 ctxptr->cpu->int_status, ctxptr->cpu->clk_guard);
+                 ctxptr->cpu->int_status);
 }
 
 void cia1571_setup_context(drive_context_t *ctxptr)
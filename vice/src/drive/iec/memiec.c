@@ -81,6 +81,23 @@ static void drive_store_zero(drive_context_t *drv, uint16_t address, uint8_t val
     drv->drives[0]->drive_ram[address & 0xff] = value;
 }
 
+/* Mark the memory and VIA1 pages that a skipped busy loop may read.  */
+static void memiec_idle_init(drivecpud_context_t *cpud)
+{
+    unsigned int i;
+    drive_read_func_t *read_func;
+
+    for (i = 0; i < 0x100; i++) {
+        read_func = cpud->read_tab[0][i];
+        if (read_func == drive_read_zero || read_func == drive_read_1541ram
+            || read_func == drive_read_ram || read_func == drive_read_rom) {
+            drivemem_set_idle_func(cpud, i, i + 1, drivemem_idle_mem);
+        } else if (read_func == via1d1541_read) {
+            drivemem_set_idle_func(cpud, i, i + 1, via1d1541_idle);
+        }
+    }
+}
+
 /* ------------------------------------------------------------------------- */
 
 void memiec_init(struct drive_context_s *drv, unsigned int type)
@@ -128,6 +145,7 @@ void memiec_init(struct drive_context_s *drv, unsigned int type)
             drivemem_set_func(cpud, 0xa0, 0xc0, drive_read_rom, NULL, NULL, &drv->drives[0]->trap_rom[0x2000], 0xa000bffd);
         }
         drivemem_set_func(cpud, 0xc0, 0x100, drive_read_rom, NULL, NULL, &drv->drives[0]->trap_rom[0x4000], 0xc000fffd);
+        memiec_idle_init(cpud);
         break;
     case DRIVE_TYPE_1570:
     case DRIVE_TYPE_1571:
@@ -151,6 +169,7 @@ void memiec_init(struct drive_context_s *drv, unsigned int type)
             drivemem_set_func(cpud, 0x60, 0x80, cia1571_read, cia1571_store, cia1571_peek, NULL, 0);
         }
         drivemem_set_func(cpud, 0x80, 0x100, drive_read_rom, NULL, NULL, drv->drives[0]->trap_rom, 0x8000fffd);
+        memiec_idle_init(cpud);
         break;
     case DRIVE_TYPE_1581:
         drv->cpu->pageone = drv->drives[0]->drive_ram + 0x100;
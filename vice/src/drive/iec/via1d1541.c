@@ -73,6 +73,36 @@ uint8_t via1d1541_peek(drive_context_t *ctxptr, uint16_t addr)
     return viacore_peek(ctxptr->via1d1541, addr);
 }
 
+/* The IEC and parallel port inputs only change when the computer writes,
+   which first catches up the drive.  */
+int via1d1541_idle(drive_context_t *ctxptr, uint16_t addr)
+{
+    via_context_t *via_context = ctxptr->via1d1541;
+
+    switch (addr & 0xf) {
+        case VIA_PRB:
+            /* PB7 may be the timer 1 output */
+            return !(via_context->via[VIA_ACR] & 0x80);
+        case VIA_PRA_NHS:
+            /* the 157x read the byte ready line here */
+            return ctxptr->drives[0]->type != DRIVE_TYPE_1570
+                   && ctxptr->drives[0]->type != DRIVE_TYPE_1571
+                   && ctxptr->drives[0]->type != DRIVE_TYPE_1571CR;
+        case VIA_DDRB:
+        case VIA_DDRA:
+        case VIA_T1LL:
+        case VIA_T1LH:
+        case VIA_ACR:
+        case VIA_PCR:
+        case VIA_IFR:
+        case VIA_IER:
+            return 1;
+        default:
+            /* counters, shift register, port A handshake */
+            return 0;
+    }
+}
+
 int via1d1541_dump(drive_context_t *ctxptr, uint16_t addr)
 {
     viacore_dump(((drive_context_t*)ctxptr)->via1d1541);
@@ -344,7 +374,7 @@ static uint8_t read_prb(via_context_t *via_context)
 void via1d1541_init(drive_context_t *ctxptr)
 {
     viacore_init(ctxptr->via1d1541, ctxptr->cpu->alarm_context,
-                 ctxptr->cpu->int_status, ctxptr->cpu->clk_guard);
+                 ctxptr->cpu->int_status);
 }
 
 void via1d1541_setup_context(drive_context_t *ctxptr)
@@ -29,7 +29,6 @@
 #include <stdio.h>
 #include <string.h>
 
-#include "clkguard.h"
 #include "diskimage.h"
 #include "drive.h"
 #include "drivetypes.h"
@@ -170,16 +169,6 @@ static log_t wd1770_log = LOG_ERR;
 /*-----------------------------------------------------------------------*/
 /* WD1770 external interface.  */
 
-/* Clock overflow handling.  */
-static void clk_overflow_callback(CLOCK sub, void *data)
-{
-    wd1770_t *drv = (wd1770_t *)data;
-
-    if (drv->clk > (CLOCK) 0) {
-        drv->clk -= sub;
-    }
-}
-
 /* Functions using drive context.  */
 void wd1770d_init(drive_context_t *drv)
 {
@@ -193,9 +182,6 @@ void wd1770d_init(drive_context_t *drv)
     drv->wd1770->cpu_clk_ptr = drv->clk_ptr;
     drv->wd1770->is1772 = 0;
     drv->wd1770->clock_frequency = 2;
-
-    clk_guard_add_callback(drv->cpu->clk_guard, clk_overflow_callback,
-                           drv->wd1770);
 }
 
 void wd1770_shutdown(wd1770_t *drv)
@@ -1034,7 +1020,7 @@ int wd1770_snapshot_write_module(wd1770_t *drv, struct snapshot_s *s)
         || SMW_DW(m, drv->byte_count) < 0
         || SMW_DW(m, drv->tmp) < 0
         || SMW_DW(m, drv->direction) < 0
-        || SMW_DW(m, drv->clk) < 0
+        || SMW_CLOCK(m, drv->clk) < 0
         || SMW_B(m, (uint8_t)drv->irq) < 0
         || SMW_B(m, (uint8_t)drv->dden) < 0
         || SMW_B(m, (uint8_t)drv->sync) < 0
@@ -1081,7 +1067,7 @@ int wd1770_snapshot_read_module(wd1770_t *drv, struct snapshot_s *s)
         || SMR_DW_INT(m, &drv->byte_count) < 0
         || SMR_DW_INT(m, (int *)(&drv->tmp)) < 0
         || SMR_DW_INT(m, &drv->direction) < 0
-        || SMR_DW(m, &drv->clk) < 0
+        || SMR_CLOCK(m, &drv->clk) < 0
         || SMR_B_INT(m, &drv->irq) < 0
         || SMR_B_INT(m, &drv->dden) < 0
         || SMR_B_INT(m, &drv->sync) < 0
@@ -216,11 +216,6 @@ void rotation_table_set(uint32_t *rotation_table_ptr)
     }
 }
 
-void rotation_overflow_callback(CLOCK sub, unsigned int dnr)
-{
-    rotation[dnr].rotation_last_clk -= sub;
-}
-
 inline static void write_next_bit(drive_t *dptr, int value)
 {
     int off = dptr->GCR_head_offset;
@@ -296,6 +291,121 @@ void rotation_begins(drive_t *dptr)
     rotation[dnr].cycle_index = 0;
 }
 
+/* Fast path of the GCR read circuit simulation below.  While no BYTE READY
+ * signal is pending and the flux filter has settled, nothing but the UE7/UF4
+ * counters and the shifter changes until the next bitcell is read.  UE7
+ * overflows with a fixed period then, so the whole stretch up to the next
+ * bitcell can be done in one step, including the flux reversal detected in
+ * the cycle after reading a 1.  The state ends up exactly as if it had been
+ * stepped through by the exact loop, which takes over again when BYTE READY
+ * gets pending or a random flux reversal is due.  It only hands over at a
+ * bitcell or UE7 overflow, as the exact loop always ends a step there.
+ * Returns the number of reference cycles done.
+ */
+static int rotation_1541_gcr_read_cells(drive_t *dptr, rotation_t *rptr, int ref_cycles,
+                                        uint32_t count_new_bitcell, uint32_t cyc_sum_frv)
+{
+    uint32_t period = 16 - rptr->ue7_dcba;
+    uint32_t len, to_ue7, t, overflows;
+    int done = 0;
+
+    /* the filter step after reading a 1 must not reach the next bitcell */
+    if (count_new_bitcell < (cyc_sum_frv << 2)) {
+        return 0;
+    }
+
+    while ((done < ref_cycles)
+           && (rptr->so_delay == 0)
+           && (rptr->filter_last_state == rptr->filter_state)
+           && (rptr->ue7_counter < 16)
+           && (rptr->accum < count_new_bitcell)
+           && (rptr->fr_randcount > 0)) {
+        /* cycles until the next bitcell is read */
+        len = (count_new_bitcell - rptr->accum + cyc_sum_frv - 1) / cyc_sum_frv;
+        if (len > (uint32_t)(ref_cycles - done)) {
+            len = ref_cycles - done;
+        }
+
+        /* UE7 overflows at to_ue7 + n * period */
+        to_ue7 = 16 - rptr->ue7_counter;
+
+        /* the result of a random flux reversal depends on where the exact
+           loop started the step it happens in, so hand over at the last
+           UE7 overflow before it */
+        if (len >= rptr->fr_randcount) {
+            if (rptr->fr_randcount - 1 < to_ue7) {
+                break;
+            }
+            len = to_ue7 + ((rptr->fr_randcount - 1 - to_ue7) / period) * period;
+        }
+
+        /* the shifter is clocked whenever UF4 counts to 2 modulo 4 */
+        for (t = to_ue7 + ((1 - rptr->uf4_counter) & 3) * period; t <= len; t += period << 2) {
+            unsigned int uf4 = (rptr->uf4_counter + (t - to_ue7) / period + 1) & 0xf;
+
+            rptr->last_read_data = ((rptr->last_read_data << 1) & 0x3fe) | (((uf4 + 0x1c) >> 4) & 0x01);
+
+            rptr->write_flux = rptr->last_write_data & 0x80;
+            rptr->last_write_data <<= 1;
+
+            if (rptr->last_read_data == 0x3ff) {
+                rptr->bit_counter = 0;
+            } else if (++rptr->bit_counter == 8) {
+                rptr->bit_counter = 0;
+                dptr->GCR_read = (uint8_t) rptr->last_read_data;
+                rptr->last_write_data = dptr->GCR_read;
+
+                /* BYTE READY signal if enabled, leave it to the exact loop */
+                if ((dptr->byte_ready_active & 2) != 0) {
+                    rptr->so_delay = 16 - ((rptr->cycle_index + (t - 1)) & 15);
+                    if (rptr->so_delay < 10) {
+                        rptr->so_delay += 16;
+                    }
+                    len = t;
+                    break;
+                }
+            }
+        }
+
+        if (len >= to_ue7) {
+            overflows = (len - to_ue7) / period + 1;
+            rptr->ue7_counter = rptr->ue7_dcba + (len - to_ue7) - (overflows - 1) * period;
+            rptr->uf4_counter = (rptr->uf4_counter + overflows) & 0xf;
+        } else {
+            rptr->ue7_counter += len;
+        }
+        rptr->filter_counter += len;
+        rptr->fr_randcount -= len;
+        rptr->accum += cyc_sum_frv * len;
+        rptr->cycle_index += len;
+        done += len;
+
+        /* read the new bitcell */
+        if (rptr->accum >= count_new_bitcell) {
+            rptr->accum -= count_new_bitcell;
+            if (read_next_bit(dptr)) {
+                rptr->filter_state ^= 1;
+
+                /* the flux filter passes the reversal in the next cycle */
+                if ((rptr->so_delay == 0) && (done < ref_cycles)) {
+                    rptr->filter_counter = 40;
+                    rptr->filter_last_state = rptr->filter_state;
+                    rptr->ue7_counter = rptr->ue7_dcba + 1;
+                    rptr->uf4_counter = 0;
+                    rptr->fr_randcount = ((RANDOM_nextUInt(rptr) >> 16) % 31) + 289;
+                    rptr->accum += cyc_sum_frv;
+                    rptr->cycle_index++;
+                    done++;
+                } else {
+                    rptr->filter_counter = 39;
+                }
+            }
+        }
+    }
+
+    return done;
+}
+
 /*******************************************************************************
  * 1541 circuit simulation for GCR-based images (.g64),
  * see 1541 circuit description in this file for details
@@ -344,6 +454,15 @@ static void rotation_1541_gcr(drive_t *dptr, int ref_cycles)
     if (dptr->read_write_mode) {
         /* emulate the number of reference clocks requested */
         while (ref_cycles > 0) {
+            /* skip ahead whole bitcells while just streaming data */
+            if ((rptr->so_delay == 0) && (rptr->filter_last_state == rptr->filter_state)) {
+                int done = rotation_1541_gcr_read_cells(dptr, rptr, ref_cycles, count_new_bitcell, cyc_sum_frv);
+                if (done > 0) {
+                    ref_cycles -= done;
+                    continue;
+                }
+            }
+
             /* calculate how much cycles can we do in one single pass */
             todo = 1;
             delta = count_new_bitcell - rptr->accum;
@@ -590,35 +709,23 @@ static void rotation_1541_p64(drive_t *dptr, int ref_cycles)
 
     P64PulseStream = &dptr->p64->PulseStreams[dptr->side][dptr->current_half_track];
 
-    /* Reset if out of head position bounds */
-    if ((P64PulseStream->UsedLast >= 0) &&
-        (P64PulseStream->Pulses[P64PulseStream->UsedLast].Position <= rptr->PulseHeadPosition)) {
-        P64PulseStream->CurrentIndex = -1;
-    } else {
-        if (P64PulseStream->CurrentIndex < 0) {
-            P64PulseStream->CurrentIndex = P64PulseStream->UsedFirst;
+    if (dptr->read_write_mode) {
+        /* Reading only needs the sorted copy of the pulses, so the next
+           pulse is found by a cursor instead of walking the linked list */
+        PP64SortedPulses Sorted;
+        uint32_t Cursor, Count;
+
+        Cursor = P64PulseStreamSortedSeek(P64PulseStream, rptr->PulseHeadPosition + 1);
+        Sorted = P64PulseStream->SortedPulses;
+        Count = P64PulseStream->SortedCount;
+
+        /* Calculate delta to the next NRZI transition flux pulse */
+        if (Cursor < Count) {
+            DeltaPositionToNextPulse = Sorted[Cursor].Position - rptr->PulseHeadPosition;
         } else {
-            while ((P64PulseStream->CurrentIndex >= 0) &&
-                   ((P64PulseStream->CurrentIndex != P64PulseStream->UsedFirst) &&
-                    ((P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Previous >= 0) &&
-                     (P64PulseStream->Pulses[P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Previous].Position > rptr->PulseHeadPosition)))) {
-                P64PulseStream->CurrentIndex = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Previous;
-            }
-        }
-        while ((P64PulseStream->CurrentIndex >= 0) &&
-               (P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position <= rptr->PulseHeadPosition)) {
-            P64PulseStream->CurrentIndex = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Next;
+            DeltaPositionToNextPulse = P64PulseSamplesPerRotation - rptr->PulseHeadPosition;
         }
-    }
 
-    /* Calculate delta to the next NRZI transition flux pulse */
-    if (P64PulseStream->CurrentIndex >= 0) {
-        DeltaPositionToNextPulse = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position - rptr->PulseHeadPosition;
-    } else {
-        DeltaPositionToNextPulse = P64PulseSamplesPerRotation - rptr->PulseHeadPosition;
-    }
-
-    if (dptr->read_write_mode) {
         while (ref_cycles > 0) {
             /****************************************************************************************************************************************/
             {
@@ -732,13 +839,12 @@ static void rotation_1541_p64(drive_t *dptr, int ref_cycles)
                 if (rptr->PulseHeadPosition >= P64PulseSamplesPerRotation) {
                     rptr->PulseHeadPosition -= P64PulseSamplesPerRotation;
 
-                    P64PulseStream->CurrentIndex = P64PulseStream->UsedFirst;
-                    while ((P64PulseStream->CurrentIndex >= 0) &&
-                           (P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position < rptr->PulseHeadPosition)) {
-                        P64PulseStream->CurrentIndex = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Next;
+                    Cursor = 0;
+                    while ((Cursor < Count) && (Sorted[Cursor].Position < rptr->PulseHeadPosition)) {
+                        Cursor++;
                     }
-                    if (P64PulseStream->CurrentIndex >= 0) {
-                        DeltaPositionToNextPulse = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position - rptr->PulseHeadPosition;
+                    if (Cursor < Count) {
+                        DeltaPositionToNextPulse = Sorted[Cursor].Position - rptr->PulseHeadPosition;
                     } else {
                         DeltaPositionToNextPulse = P64PulseSamplesPerRotation - rptr->PulseHeadPosition;
                     }
@@ -746,9 +852,8 @@ static void rotation_1541_p64(drive_t *dptr, int ref_cycles)
 
                 /* Next NRZI transition flux pulse handling */
                 if (!DeltaPositionToNextPulse) {
-                    if ((P64PulseStream->CurrentIndex >= 0) &&
-                        (P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position == rptr->PulseHeadPosition)) {
-                        uint32_t Strength = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Strength;
+                    if ((Cursor < Count) && (Sorted[Cursor].Position == rptr->PulseHeadPosition)) {
+                        uint32_t Strength = Sorted[Cursor].Strength;
 
                         /* Forward pulse high hit to the decoder logic */
                         if ((Strength == 0xffffffffUL) ||                                   /* Strong pulse */
@@ -757,10 +862,10 @@ static void rotation_1541_p64(drive_t *dptr, int ref_cycles)
                             rptr->filter_counter = 0;
                         }
 
-                        P64PulseStream->CurrentIndex = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Next;
+                        Cursor++;
                     }
-                    if (P64PulseStream->CurrentIndex >= 0) {
-                        DeltaPositionToNextPulse = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position - rptr->PulseHeadPosition;
+                    if (Cursor < Count) {
+                        DeltaPositionToNextPulse = Sorted[Cursor].Position - rptr->PulseHeadPosition;
                     } else {
                         DeltaPositionToNextPulse = P64PulseSamplesPerRotation - rptr->PulseHeadPosition;
                     }
@@ -771,11 +876,41 @@ static void rotation_1541_p64(drive_t *dptr, int ref_cycles)
             rptr->cycle_index += ToDo;
             ref_cycles -= ToDo;
         }
+
+        P64PulseStream->SortedCursor = Cursor;
     } else {
         int head_write;
 
         head_write = 0;
 
+        /* Reset if out of head position bounds */
+        if ((P64PulseStream->UsedLast >= 0) &&
+            (P64PulseStream->Pulses[P64PulseStream->UsedLast].Position <= rptr->PulseHeadPosition)) {
+            P64PulseStream->CurrentIndex = -1;
+        } else {
+            if (P64PulseStream->CurrentIndex < 0) {
+                P64PulseStream->CurrentIndex = P64PulseStream->UsedFirst;
+            } else {
+                while ((P64PulseStream->CurrentIndex >= 0) &&
+                       ((P64PulseStream->CurrentIndex != P64PulseStream->UsedFirst) &&
+                        ((P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Previous >= 0) &&
+                         (P64PulseStream->Pulses[P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Previous].Position > rptr->PulseHeadPosition)))) {
+                    P64PulseStream->CurrentIndex = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Previous;
+                }
+            }
+            while ((P64PulseStream->CurrentIndex >= 0) &&
+                   (P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position <= rptr->PulseHeadPosition)) {
+                P64PulseStream->CurrentIndex = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Next;
+            }
+        }
+
+        /* Calculate delta to the next NRZI transition flux pulse */
+        if (P64PulseStream->CurrentIndex >= 0) {
+            DeltaPositionToNextPulse = P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position - rptr->PulseHeadPosition;
+        } else {
+            DeltaPositionToNextPulse = P64PulseSamplesPerRotation - rptr->PulseHeadPosition;
+        }
+
         while (ref_cycles > 0) {
             /****************************************************************************************************************************************/
             {
@@ -879,6 +1014,7 @@ static void rotation_1541_p64(drive_t *dptr, int ref_cycles)
                         (P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Position == rptr->PulseHeadPosition)) {
                         if (P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Strength != 0xffffffffUL) {
                             P64PulseStream->Pulses[P64PulseStream->CurrentIndex].Strength = 0xffffffffUL;
+                            P64PulseStream->SortedValid = 0;
                             dptr->P64_dirty = 1;
                         }
                     } else {
@@ -39,7 +39,6 @@ extern void rotation_reset(struct drive_s *drive);
 extern void rotation_speed_zone_set(unsigned int zone, unsigned int dnr);
 extern void rotation_table_get(uint32_t *rotation_table_ptr);
 extern void rotation_table_set(uint32_t *rotation_table_ptr);
-extern void rotation_overflow_callback(CLOCK sub, unsigned int dnr);
 extern void rotation_change_mode(unsigned int dnr);
 extern void rotation_begins(struct drive_s *dptr);
 extern void rotation_rotate_disk(struct drive_s *dptr);
@@ -36,7 +36,6 @@
 #include "archdep.h"
 #include "attach.h"
 #include "autostart.h"
-#include "clkguard.h"
 #include "cmdline.h"
 #include "crc32.h"
 #include "datasette.h"
@@ -57,11 +56,13 @@
 #include "util.h"
 #include "version.h"
 #include "vice-event.h"
+#include "vsync.h"
 
 
 #define EVENT_START_SNAPSHOT "start" FSDEV_EXT_SEP_STR "vsf"
 #define EVENT_END_SNAPSHOT "end" FSDEV_EXT_SEP_STR "vsf"
 #define EVENT_MILESTONE_SNAPSHOT "milestone" FSDEV_EXT_SEP_STR "vsf"
+#define EVENT_KEYFRAME_SNAPSHOT "keyframe%04u" FSDEV_EXT_SEP_STR "vsf"
 
 
 /** \brief  Size of the CRC32 entries
@@ -102,6 +103,16 @@ static char *event_snapshot_path_str = NULL;
 static int event_start_mode;
 static int event_image_include;
 
+/* Seconds between keyframe snapshots while recording, 0 for none.  */
+static int event_keyframe_interval;
+
+/* Keyframes in the list, numbers the snapshot files.  */
+static unsigned int event_keyframe_count = 0;
+
+/* Playback runs in catch-up mode until this timestamp has been reached.  */
+static int seek_active = 0;
+static unsigned int seek_timestamp;
+
 static char *event_snapshot_path(const char *snapshot_file)
 {
     lib_free(event_snapshot_path_str);
@@ -150,6 +161,108 @@ static int event_image_append(const char *filename, char **mapped_name, int appe
 }
 
 
+/*-----------------------------------------------------------------------*/
+/* event list records */
+
+#define EVENT_LIST_ALIGN        8
+#define EVENT_LIST_INITIAL_SIZE 256
+
+static size_t event_list_record_size(unsigned int size)
+{
+    return (sizeof(event_list_t) + size + EVENT_LIST_ALIGN - 1)
+           & ~(size_t)(EVENT_LIST_ALIGN - 1);
+}
+
+static event_list_t *event_list_at(event_list_state_t *list, size_t pos)
+{
+    return (event_list_t *)(list->base + pos);
+}
+
+static void event_list_reserve(event_list_state_t *list, size_t size)
+{
+    if (size > list->max) {
+        list->max = (size > list->max * 2) ? size : list->max * 2;
+        list->base = lib_realloc(list->base, list->max);
+    }
+}
+
+/* Write a record at `pos'.  The space must be reserved.  */
+static size_t event_list_write(event_list_state_t *list, size_t pos,
+                               unsigned int type, CLOCK clk,
+                               const void *data, unsigned int size)
+{
+    event_list_t *event = event_list_at(list, pos);
+    size_t len = event_list_record_size(size);
+
+    event->type = type;
+    event->clk = clk;
+    event->size = size;
+    if (size > 0) {
+        memcpy(event + 1, data, size);
+    }
+    memset((uint8_t *)(event + 1) + size, 0, len - sizeof(event_list_t) - size);
+
+    return pos + len;
+}
+
+/* Replace the current record and everything after it by the event, followed
+   by a new EVENT_LIST_END record that becomes the current one.  */
+static void event_list_append(event_list_state_t *list, unsigned int type,
+                              CLOCK clk, const void *data, unsigned int size)
+{
+    size_t pos = list->current;
+
+    event_list_reserve(list, pos + event_list_record_size(size)
+                             + event_list_record_size(0));
+    pos = event_list_write(list, pos, type, clk, data, size);
+    list->size = event_list_write(list, pos, EVENT_LIST_END, 0, NULL, 0);
+    list->current = pos;
+}
+
+/* Put the event in front of the list, replacing the first record if
+   `replace' is set.  */
+static void event_list_prepend(event_list_state_t *list, unsigned int type,
+                               CLOCK clk, const void *data, unsigned int size,
+                               int replace)
+{
+    size_t new_len = event_list_record_size(size);
+    size_t old_len = 0;
+
+    if (replace) {
+        old_len = event_list_record_size(event_list_at(list, 0)->size);
+    }
+
+    event_list_reserve(list, list->size - old_len + new_len);
+    memmove(list->base + new_len, list->base + old_len, list->size - old_len);
+    event_list_write(list, 0, type, clk, data, size);
+    list->size = list->size - old_len + new_len;
+    if (list->current >= old_len) {
+        list->current = list->current - old_len + new_len;
+    }
+}
+
+event_list_t *event_list_first(event_list_state_t *list)
+{
+    return event_list_at(list, 0);
+}
+
+event_list_t *event_list_next(event_list_t *event)
+{
+    return (event_list_t *)((uint8_t *)event + event_list_record_size(event->size));
+}
+
+void *event_list_data(event_list_t *event)
+{
+    return event->size > 0 ? (void *)(event + 1) : NULL;
+}
+
+static event_list_t *event_list_current(event_list_state_t *list)
+{
+    return event_list_at(list, list->current);
+}
+
+/*-----------------------------------------------------------------------*/
+
 void event_record_attach_in_list(event_list_state_t *list, unsigned int unit,
                                  unsigned int drive,
                                  const char *filename, unsigned int read_only)
@@ -158,10 +271,6 @@ void event_record_attach_in_list(event_list_state_t *list, unsigned int unit,
     unsigned int size;
     char *strdir, *strfile;
 
-    list->current->type = EVENT_ATTACHIMAGE;
-    list->current->clk = maincpu_clk;
-    list->current->next = lib_calloc(1, sizeof(event_list_t));
-
     util_fname_split(filename, &strdir, &strfile);
 
     if (event_image_include) {
@@ -211,9 +320,8 @@ void event_record_attach_in_list(event_list_state_t *list, unsigned int unit,
     lib_free(strdir);
     lib_free(strfile);
 
-    list->current->size = size;
-    list->current->data = event_data;
-    list->current = list->current->next;
+    event_list_append(list, EVENT_ATTACHIMAGE, maincpu_clk, event_data, size);
+    lib_free(event_data);
 }
 
 void event_record_attach_image(unsigned int unit, unsigned int drive, const char *filename,
@@ -323,8 +431,6 @@ error:
 void event_record_in_list(event_list_state_t *list, unsigned int type,
                           void *data, unsigned int size)
 {
-    void *event_data = NULL;
-
     /*log_debug("EVENT RECORD %i CLK %i", type, maincpu_clk);*/
 
     if (type == EVENT_RESETCPU) {
@@ -343,26 +449,20 @@ void event_record_in_list(event_list_state_t *list, unsigned int type,
         case EVENT_ATTACHIMAGE:         /* fall through */
         case EVENT_INITIAL:             /* fall through */
         case EVENT_SYNC_TEST:           /* fall through */
-        case EVENT_RESOURCE:
-            event_data = lib_malloc(size);
-            memcpy(event_data, data, size);
+        case EVENT_RESOURCE:            /* fall through */
+        case EVENT_KEYFRAME:
             break;
         case EVENT_LIST_END:            /* fall through */
         case EVENT_OVERFLOW:            /* fall through */
         case EVENT_KEYBOARD_CLEAR:
+            data = NULL;
             break;
         default:
             /*log_error(event_log, "Unknow event type %i.", type);*/
             return;
     }
 
-    list->current->type = type;
-    list->current->clk = maincpu_clk;
-    list->current->size = size;
-    list->current->data = event_data;
-    list->current->next = lib_calloc(1, sizeof(event_list_t));
-    list->current = list->current->next;
-    list->current->type = EVENT_LIST_END;
+    event_list_append(list, type, maincpu_clk, data, data != NULL ? size : 0);
 }
 
 void event_record(unsigned int type, void *data, unsigned int size)
@@ -377,51 +477,91 @@ static void next_alarm_set(void)
 {
     CLOCK new_value;
 
-    new_value = event_list->current->clk;
-
-    if (maincpu_clk > CLKGUARD_SUB_MIN
-        && new_value < maincpu_clk - CLKGUARD_SUB_MIN) {
-        new_value += clk_guard_clock_sub(maincpu_clk_guard);
-    }
+    new_value = event_list_current(event_list)->clk;
 
     alarm_set(event_alarm, new_value);
 }
 static void next_current_list(void)
 {
-    event_list->current = event_list->current->next;
+    event_list->current += event_list_record_size(event_list_current(event_list)->size);
+}
+
+/* Write a keyframe snapshot and mark its place in the list, playback can
+   seek to it.  */
+static void event_record_keyframe_trap(uint16_t addr, void *data)
+{
+    char *name;
+
+    if (record_active == 0) {
+        return;
+    }
+
+    name = lib_msprintf(EVENT_KEYFRAME_SNAPSHOT, event_keyframe_count);
+    if (machine_write_snapshot(event_snapshot_path(name), 0, 1, 0) < 0) {
+        log_error(event_log, "Could not create keyframe snapshot file %s.",
+                  event_snapshot_path(name));
+    } else {
+        event_record(EVENT_KEYFRAME, (void *)name, (unsigned int)strlen(name) + 1);
+        event_keyframe_count++;
+    }
+    lib_free(name);
+}
+
+/* Recount the keyframes when recording continues on a list that may
+   already have some.  */
+static void event_count_keyframes(void)
+{
+    event_list_t *curr;
+
+    event_keyframe_count = 0;
+    for (curr = event_list_first(event_list); curr->type != EVENT_LIST_END;
+         curr = event_list_next(curr)) {
+        if (curr->type == EVENT_KEYFRAME) {
+            event_keyframe_count++;
+        }
+    }
 }
 
 static void event_alarm_handler(CLOCK offset, void *data)
 {
+    event_list_t *current;
+    void *event_data;
+
     alarm_unset(event_alarm);
 
     /* when recording set a timestamp */
     if (record_active) {
         ui_display_event_time(current_timestamp++, 0);
+        if (event_keyframe_interval > 0
+            && current_timestamp % (unsigned int)event_keyframe_interval == 0) {
+            interrupt_maincpu_trigger_trap(event_record_keyframe_trap, (void *)0);
+        }
         next_timestamp_clk = next_timestamp_clk + machine_get_cycles_per_second();
         alarm_set(event_alarm, next_timestamp_clk);
         return;
     }
 
-    /*log_debug("EVENT PLAYBACK %i CLK %i", event_list_current->type,
-              event_list_current->clk);*/
+    current = event_list_current(event_list);
+    event_data = event_list_data(current);
+
+    /*log_debug("EVENT PLAYBACK %i CLK %i", current->type, current->clk);*/
 
-    switch (event_list->current->type) {
+    switch (current->type) {
         case EVENT_KEYBOARD_MATRIX:
-            keyboard_event_playback(offset, event_list->current->data);
+            keyboard_event_playback(offset, event_data);
             break;
         case EVENT_KEYBOARD_RESTORE:
-            keyboard_restore_event_playback(offset, event_list->current->data);
+            keyboard_restore_event_playback(offset, event_data);
             break;
         case EVENT_JOYSTICK_VALUE:
-            joystick_event_playback(offset, event_list->current->data);
+            joystick_event_playback(offset, event_data);
             break;
         case EVENT_DATASETTE:
-            datasette_event_playback(offset, event_list->current->data);
+            datasette_event_playback(offset, event_data);
             break;
         case EVENT_ATTACHIMAGE:
-            event_playback_attach_image(event_list->current->data,
-                                        event_list->current->size);
+            event_playback_attach_image(event_data,
+                                        current->size);
             break;
         case EVENT_ATTACHDISK:
         case EVENT_ATTACHTAPE:
@@ -430,8 +570,8 @@ static void event_alarm_handler(CLOCK offset, void *data)
                 unsigned int unit;
                 const char *filename;
 
-                unit = (unsigned int)((char*)event_list->current->data)[0];
-                filename = &((char*)event_list->current->data)[1];
+                unit = (unsigned int)((char*)event_data)[0];
+                filename = &((char*)event_data)[1];
 
                 if (unit == 1) {
                     tape_image_event_playback(unit, filename);
@@ -442,23 +582,28 @@ static void event_alarm_handler(CLOCK offset, void *data)
             }
             break;
         case EVENT_RESETCPU:
-            machine_reset_event_playback(offset, event_list->current->data);
+            machine_reset_event_playback(offset, event_data);
             break;
         case EVENT_TIMESTAMP:
             ui_display_event_time(current_timestamp++, playback_time);
+            if (seek_active && current_timestamp > seek_timestamp) {
+                seek_active = 0;
+                vsync_set_catch_up(0);
+            }
             break;
         case EVENT_LIST_END:
             event_playback_stop();
             break;
         case EVENT_OVERFLOW:
+        case EVENT_KEYFRAME:
             break;
         default:
             log_error(event_log, "Unknow event type %u.",
-                    event_list->current->type);
+                    current->type);
     }
 
-    if (event_list->current->type != EVENT_LIST_END
-        && event_list->current->type != EVENT_RESETCPU) {
+    if (current->type != EVENT_LIST_END
+        && current->type != EVENT_RESETCPU) {
         next_current_list();
         next_alarm_set();
     }
@@ -467,35 +612,39 @@ static void event_alarm_handler(CLOCK offset, void *data)
 /*-----------------------------------------------------------------------*/
 void event_playback_event_list(event_list_state_t *list)
 {
-    event_list_t *current = list->base;
+    event_list_t *current;
+    void *data;
+
+    for (current = event_list_first(list); current->type != EVENT_LIST_END;
+         current = event_list_next(current)) {
+        data = event_list_data(current);
 
-    while (current->type != EVENT_LIST_END) {
         switch (current->type) {
             case EVENT_SYNC_TEST:
                 break;
             case EVENT_KEYBOARD_DELAY:
-                keyboard_register_delay(*(unsigned int*)current->data);
+                keyboard_register_delay((unsigned int)util_le_buf4_to_int(data));
                 break;
             case EVENT_KEYBOARD_MATRIX:
-                keyboard_event_delayed_playback(current->data);
+                keyboard_event_delayed_playback(data);
                 break;
             case EVENT_KEYBOARD_RESTORE:
-                keyboard_restore_event_playback(0, current->data);
+                keyboard_restore_event_playback(0, data);
                 break;
             case EVENT_KEYBOARD_CLEAR:
                 keyboard_register_clear();
                 break;
             case EVENT_JOYSTICK_DELAY:
-                joystick_register_delay(*(unsigned int*)current->data);
+                joystick_register_delay((unsigned int)util_le_buf4_to_int(data));
                 break;
             case EVENT_JOYSTICK_VALUE:
-                joystick_event_delayed_playback(current->data);
+                joystick_event_delayed_playback(data);
                 break;
             case EVENT_DATASETTE:
-                datasette_event_playback(0, current->data);
+                datasette_event_playback(0, data);
                 break;
             case EVENT_RESETCPU:
-                machine_reset_event_playback(0, current->data);
+                machine_reset_event_playback(0, data);
                 break;
             case EVENT_ATTACHDISK:
             case EVENT_ATTACHTAPE:
@@ -503,7 +652,7 @@ void event_playback_event_list(event_list_state_t *list)
                     /* in fact this is only for detaching */
                     unsigned int unit;
 
-                    unit = (unsigned int)((char*)current->data)[0];
+                    unit = (unsigned int)((char*)data)[0];
 
                     if (unit == 1) {
                         tape_image_event_playback(1, NULL);
@@ -514,22 +663,36 @@ void event_playback_event_list(event_list_state_t *list)
                     break;
                 }
             case EVENT_ATTACHIMAGE:
-                event_playback_attach_image(current->data, current->size);
+                event_playback_attach_image(data, current->size);
                 break;
             case EVENT_RESOURCE:
-                resources_set_value_event(current->data, current->size);
+                resources_set_value_event(data, current->size);
                 break;
             default:
                 log_error(event_log, "Unknow event type %u.", current->type);
         }
-        current = current->next;
     }
 }
 
 void event_register_event_list(event_list_state_t *list)
 {
-    list->base = lib_calloc(1, sizeof(event_list_t));
-    list->current = list->base;
+    list->base = NULL;
+    list->max = 0;
+    list->current = 0;
+    event_list_reserve(list, EVENT_LIST_INITIAL_SIZE);
+    list->size = event_list_write(list, 0, EVENT_LIST_END, 0, NULL, 0);
+}
+
+/* Remove all events, keeping the buffer for recording new ones.  A list
+   that has been cleared or never been registered is registered anew.  */
+void event_reset_list(event_list_state_t *list)
+{
+    if (list->base == NULL) {
+        event_register_event_list(list);
+        return;
+    }
+    list->current = 0;
+    list->size = event_list_write(list, 0, EVENT_LIST_END, 0, NULL, 0);
 }
 
 void event_init_image_list(void)
@@ -546,20 +709,6 @@ static void create_list(void)
 }
 
 
-static void cut_list(event_list_t *cut_base)
-{
-    event_list_t *c1, *c2;
-
-    c1 = cut_base;
-
-    while (c1 != NULL) {
-        c2 = c1->next;
-        lib_free(c1->data);
-        lib_free(c1);
-        c1 = c2;
-    }
-}
-
 void event_destroy_image_list(void)
 {
     event_image_list_t *d1, *d2;
@@ -580,7 +729,11 @@ void event_destroy_image_list(void)
 void event_clear_list(event_list_state_t *list)
 {
     if (list != NULL && list->base != NULL) {
-        cut_list(list->base);
+        lib_free(list->base);
+        list->base = NULL;
+        list->size = 0;
+        list->max = 0;
+        list->current = 0;
     }
 }
 
@@ -595,18 +748,16 @@ static void warp_end_list(void)
 {
     event_list_t *curr;
 
-    curr = event_list->base;
-
-    while (curr->type != EVENT_LIST_END) {
+    for (curr = event_list_first(event_list); curr->type != EVENT_LIST_END;
+         curr = event_list_next(curr)) {
         if (curr->type == EVENT_ATTACHIMAGE) {
-            event_image_append(&((char*)curr->data)[3], NULL, 0);
+            event_image_append(&((char *)event_list_data(curr))[3], NULL, 0);
         }
-
-        curr = curr->next;
     }
 
-    memset(curr, 0, sizeof(event_list_t));
-    event_list->current = curr;
+    event_list->current = (size_t)((uint8_t *)curr - event_list->base);
+    event_list->size = event_list_write(event_list, event_list->current,
+                                        EVENT_LIST_END, 0, NULL, 0);
 }
 /*-----------------------------------------------------------------------*/
 /* writes or replaces version string in the initial event                */
@@ -614,40 +765,36 @@ static void event_write_version(void)
 {
     uint8_t *new_data;
     uint8_t *data;
-    unsigned int ver_idx;
+    unsigned int ver_idx, size;
+    event_list_t *first = event_list_first(event_list);
 
-    if (event_list->base->type != EVENT_INITIAL) {
+    if (first->type != EVENT_INITIAL) {
         /* EVENT_INITIAL is missing (bug in 1.14.xx); fix it */
-        event_list_t *new_event;
-
-        new_event = lib_calloc(1, sizeof(event_list_t));
-        new_event->clk = event_list->base->clk;
-        new_event->size = (unsigned int)strlen(event_start_snapshot) + 2;
-        new_event->type = EVENT_INITIAL;
-        data = lib_malloc(new_event->size);
+        size = (unsigned int)strlen(event_start_snapshot) + 2;
+        data = lib_malloc(size);
         data[0] = EVENT_START_MODE_FILE_SAVE;
         strcpy((char *)&data[1], event_start_snapshot);
-        new_event->data = data;
-        new_event->next = event_list->base;
-        event_list->base = new_event;
+        event_list_prepend(event_list, EVENT_INITIAL, first->clk, data, size, 0);
+        lib_free(data);
+        first = event_list_first(event_list);
     }
 
-    data = event_list->base->data;
+    data = event_list_data(first);
 
     ver_idx = 1;
     if (data[0] == EVENT_START_MODE_FILE_SAVE) {
         ver_idx += (unsigned int)strlen((char *)&data[1]) + 1;
     }
 
-    event_list->base->size = ver_idx + (unsigned int)strlen(VERSION) + 1;
-    new_data = lib_malloc(event_list->base->size);
+    size = ver_idx + (unsigned int)strlen(VERSION) + 1;
+    new_data = lib_malloc(size);
 
     memcpy(new_data, data, ver_idx);
 
     strcpy((char *)&new_data[ver_idx], VERSION);
 
-    event_list->base->data = new_data;
-    lib_free(data);
+    event_list_prepend(event_list, EVENT_INITIAL, first->clk, new_data, size, 1);
+    lib_free(new_data);
 }
 
 static void event_initial_write(void)
@@ -719,9 +866,10 @@ static void event_record_start_trap(uint16_t addr, void *data)
             current_timestamp = 0;
             break;
         case EVENT_START_MODE_PLAYBACK:
-            cut_list(event_list->current->next);
-            event_list->current->next = NULL;
-            event_list->current->type = EVENT_LIST_END;
+            event_list->size = event_list_write(event_list, event_list->current,
+                                                EVENT_LIST_END,
+                                                event_list_current(event_list)->clk,
+                                                NULL, 0);
             event_destroy_image_list();
             event_write_version();
             record_active = 1;
@@ -736,6 +884,8 @@ static void event_record_start_trap(uint16_t addr, void *data)
     debug_start_recording();
 #endif
 
+    event_count_keyframes();
+
     /* use alarm for timestamps */
     milestone_timestamp_alarm = 0;
     alarm_set(event_alarm, next_timestamp_clk);
@@ -808,7 +958,8 @@ void event_reset_ack(void)
         next_alarm_set();
     }
 
-    if (event_list->current && event_list->current->type == EVENT_RESETCPU) {
+    if (event_list->base != NULL
+        && event_list_current(event_list)->type == EVENT_RESETCPU) {
         next_current_list();
         next_alarm_set();
     }
@@ -851,10 +1002,10 @@ static void event_playback_start_trap(uint16_t addr, void *unused)
 
     snapshot_close(s);
 
-    event_list->current = event_list->base;
+    event_list->current = 0;
 
-    if (event_list->current->type == EVENT_INITIAL) {
-        uint8_t *data = (uint8_t *)(event_list->current->data);
+    if (event_list_current(event_list)->type == EVENT_INITIAL) {
+        uint8_t *data = (uint8_t *)event_list_data(event_list_current(event_list));
         switch (data[0]) {
             case EVENT_START_MODE_FILE_SAVE:
                 /*log_debug("READING %s", (char *)(&data[1]));*/
@@ -869,7 +1020,7 @@ static void event_playback_start_trap(uint16_t addr, void *unused)
                     return;
                 }
 
-                if (event_list->current->size > strlen((char *)&data[1]) + 2) {
+                if (event_list_current(event_list)->size > strlen((char *)&data[1]) + 2) {
                     strncpy(event_version, (char *)(&data[strlen((char *)&data[1]) + 2]), 15);
                 }
 
@@ -879,7 +1030,7 @@ static void event_playback_start_trap(uint16_t addr, void *unused)
             case EVENT_START_MODE_RESET:
                 /*log_debug("RESET MODE!");*/
                 machine_trigger_reset(MACHINE_RESET_MODE_HARD);
-                if (event_list->current->size > 1) {
+                if (event_list_current(event_list)->size > 1) {
                     strncpy(event_version, (char *)(&data[1]), 15);
                 }
                 next_current_list();
@@ -928,6 +1079,11 @@ int event_playback_stop(void)
 
     alarm_unset(event_alarm);
 
+    if (seek_active) {
+        seek_active = 0;
+        vsync_set_catch_up(0);
+    }
+
     ui_display_playback(0, NULL);
 
 #ifdef  DEBUG
@@ -937,6 +1093,70 @@ int event_playback_stop(void)
     return 0;
 }
 
+static void event_playback_seek_trap(uint16_t addr, void *data)
+{
+    event_list_t *curr;
+    size_t pos, keyframe_pos = 0;
+    unsigned int timestamp = 0, keyframe_timestamp = 0;
+    const char *keyframe = NULL;
+
+    if (playback_active == 0) {
+        return;
+    }
+
+    /* find the last keyframe before the time to seek to */
+    for (pos = 0; ; pos += event_list_record_size(curr->size)) {
+        curr = event_list_at(event_list, pos);
+        if (curr->type == EVENT_LIST_END) {
+            break;
+        }
+        if (curr->type == EVENT_TIMESTAMP) {
+            if (timestamp == seek_timestamp) {
+                break;
+            }
+            timestamp++;
+        } else if (curr->type == EVENT_KEYFRAME) {
+            keyframe = (const char *)event_list_data(curr);
+            keyframe_pos = pos;
+            keyframe_timestamp = timestamp;
+        }
+    }
+
+    if (keyframe == NULL) {
+        /* no keyframe before, start over */
+        event_playback_start_trap(addr, NULL);
+    } else {
+        if (machine_read_snapshot(event_snapshot_path(keyframe), 0) < 0) {
+            ui_error("Error reading keyframe snapshot file %s.",
+                     event_snapshot_path(keyframe));
+            return;
+        }
+        event_list->current = keyframe_pos;
+        next_current_list();
+        current_timestamp = keyframe_timestamp;
+        next_alarm_set();
+    }
+
+    /* replay the rest as fast as possible */
+    seek_active = 1;
+    vsync_set_catch_up(1);
+}
+
+/* Continue playback at the given time, replaying the events since the
+   nearest keyframe snapshot.  */
+int event_playback_seek(unsigned int seconds)
+{
+    if (playback_active == 0) {
+        return -1;
+    }
+
+    seek_timestamp = seconds;
+
+    interrupt_maincpu_trigger_trap(event_playback_seek_trap, (void *)0);
+
+    return 0;
+}
+
 static void event_record_set_milestone_trap(uint16_t addr, void *data)
 {
     if (machine_write_snapshot(event_snapshot_path(event_end_snapshot), 1, 1, 1) < 0) {
@@ -973,6 +1193,7 @@ static void event_record_reset_milestone_trap(uint16_t addr, void *data)
         return;
     }
     warp_end_list();
+    event_count_keyframes();
     record_active = 1;
     if (milestone_timestamp_alarm > 0) {
         alarm_set(event_alarm, milestone_timestamp_alarm);
@@ -1014,12 +1235,27 @@ int event_playback_active(void)
 
 /*-----------------------------------------------------------------------*/
 
+/* Amount the 32 bit clock used to be rebased by when it was about to
+   overflow: the largest multiple of the frame length that still leaves
+   0xfffff cycles of headroom.  */
+static CLOCK event_overflow_rebase(void)
+{
+    CLOCK sub, frame;
+
+    sub = (CLOCK)(0xffffffffU - 2 * 0xfffffU);
+    frame = (CLOCK)machine_get_cycles_per_frame();
+    if (frame > 0) {
+        sub = (sub / frame) * frame;
+    }
+    return sub;
+}
+
 int event_snapshot_read_module(struct snapshot_s *s, int event_mode)
 {
     snapshot_module_t *m;
     uint8_t major_version, minor_version;
-    event_list_t *curr;
     unsigned int num_of_timestamps;
+    CLOCK clk_offset = 0;
 
     if (event_mode == 0) {
         return 0;
@@ -1035,7 +1271,6 @@ int event_snapshot_read_module(struct snapshot_s *s, int event_mode)
     destroy_list();
     create_list();
 
-    curr = event_list->base;
     num_of_timestamps = 0;
     playback_time = 0;
     next_timestamp_clk = CLOCK_MAX;
@@ -1055,7 +1290,7 @@ int event_snapshot_read_module(struct snapshot_s *s, int event_mode)
                 return -1;
             }
 
-            if (SMR_DW(m, &(clk)) < 0) {
+            if (SMR_CLOCK(m, &(clk)) < 0) {
                 snapshot_module_close(m);
                 return -1;
             }
@@ -1066,9 +1301,17 @@ int event_snapshot_read_module(struct snapshot_s *s, int event_mode)
             }
         } while (type == EVENT_TIMESTAMP);
 
+        /* Histories recorded with a 32 bit clock mark each rebase of the
+           clock with an EVENT_OVERFLOW; make the clocks after it absolute.  */
+        if (type == EVENT_OVERFLOW) {
+            clk_offset += event_overflow_rebase();
+        }
+        clk += clk_offset;
+
         if (size > 0) {
             data = lib_malloc(size);
             if (SMR_BA(m, data, size) < 0) {
+                lib_free(data);
                 snapshot_module_close(m);
                 return -1;
             }
@@ -1086,26 +1329,16 @@ int event_snapshot_read_module(struct snapshot_s *s, int event_mode)
             }
         } else {
             /* insert timestamps each second */
-            while (next_timestamp_clk < clk || (type == EVENT_OVERFLOW && next_timestamp_clk < maincpu_clk_guard->clk_max_value))
-            {
-                curr->type = EVENT_TIMESTAMP;
-                curr->clk = next_timestamp_clk;
-                curr->size = 0;
-                curr->next = lib_calloc(1, sizeof(event_list_t));
-                curr = curr->next;
+            while (next_timestamp_clk < clk) {
+                event_list_append(event_list, EVENT_TIMESTAMP,
+                                  next_timestamp_clk, NULL, 0);
                 next_timestamp_clk += machine_get_cycles_per_second();
                 num_of_timestamps++;
             }
-
-            if (type == EVENT_OVERFLOW) {
-                next_timestamp_clk -= clk_guard_clock_sub(maincpu_clk_guard);
-            }
         }
 
-        curr->type = type;
-        curr->clk = clk;
-        curr->size = size;
-        curr->data = (size > 0 ? data : NULL);
+        event_list_append(event_list, type, clk, data, size);
+        lib_free(data);
 
         if (type == EVENT_LIST_END) {
             break;
@@ -1113,12 +1346,12 @@ int event_snapshot_read_module(struct snapshot_s *s, int event_mode)
 
         if (type == EVENT_RESETCPU) {
             next_timestamp_clk -= clk;
+            clk_offset = 0;
         }
-
-        curr->next = lib_calloc(1, sizeof(event_list_t));
-        curr = curr->next;
     }
 
+    event_list->current = 0;
+
     if (num_of_timestamps > 0) {
         playback_time = num_of_timestamps - 1;
     }
@@ -1132,6 +1365,7 @@ int event_snapshot_write_module(struct snapshot_s *s, int event_mode)
 {
     snapshot_module_t *m;
     event_list_t *curr;
+    size_t pos;
 
     if (event_mode == 0) {
         return 0;
@@ -1143,19 +1377,17 @@ int event_snapshot_write_module(struct snapshot_s *s, int event_mode)
         return -1;
     }
 
-    curr = event_list->base;
-
-    while (curr != NULL) {
+    for (pos = 0; pos < event_list->size; pos += event_list_record_size(curr->size)) {
+        curr = event_list_at(event_list, pos);
         if (curr->type != EVENT_TIMESTAMP
             && (0
                 || SMW_DW(m, (uint32_t)curr->type) < 0
-                || SMW_DW(m, (uint32_t)curr->clk) < 0
+                || SMW_CLOCK(m, curr->clk) < 0
                 || SMW_DW(m, (uint32_t)curr->size) < 0
-                || SMW_BA(m, curr->data, curr->size) < 0)) {
+                || SMW_BA(m, event_list_data(curr), curr->size) < 0)) {
             snapshot_module_close(m);
             return -1;
         }
-        curr = curr->next;
     }
 
     if (snapshot_module_close(m) < 0) {
@@ -1224,6 +1456,17 @@ static int set_event_image_include(int enable, void *param)
     return 0;
 }
 
+static int set_event_keyframe_interval(int val, void *param)
+{
+    if (val < 0) {
+        return -1;
+    }
+
+    event_keyframe_interval = val;
+
+    return 0;
+}
+
 static const resource_string_t resources_string[] = {
     { "EventSnapshotDir",
       FSDEVICE_DEFAULT_DIR FSDEV_DIR_SEP_STR, RES_EVENT_NO, NULL,
@@ -1240,6 +1483,8 @@ static const resource_int_t resources_int[] = {
       &event_start_mode, set_event_start_mode, NULL },
     { "EventImageInclude", 1, RES_EVENT_NO, NULL,
       &event_image_include, set_event_image_include, NULL },
+    { "EventKeyframeInterval", 0, RES_EVENT_NO, NULL,
+      &event_keyframe_interval, set_event_keyframe_interval, NULL },
     RESOURCE_INT_LIST_END
 };
 
@@ -1292,6 +1537,9 @@ static const cmdline_option_t cmdline_options[] =
     { "+eventimageinc", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
       NULL, NULL, "EventImageInclude", (resource_value_t)0,
       NULL, "Disable including disk images" },
+    { "-eventkeyframes", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "EventKeyframeInterval", NULL,
+      "<Seconds>", "Set the interval of keyframe snapshots written while recording, for seeking during playback (0: none)" },
     CMDLINE_LIST_END
 };
 
@@ -1302,24 +1550,10 @@ int event_cmdline_options_init(void)
 
 /*-----------------------------------------------------------------------*/
 
-static void clk_overflow_callback(CLOCK sub, void *data)
-{
-    if (event_record_active()) {
-        event_record(EVENT_OVERFLOW, NULL, 0);
-    }
-
-    if (next_timestamp_clk) {
-        next_timestamp_clk -= sub;
-    }
-}
-
-
 void event_init(void)
 {
     event_log = log_open("Event");
 
     event_alarm = alarm_new(maincpu_alarm_context, "Event",
                             event_alarm_handler, NULL);
-
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
 }
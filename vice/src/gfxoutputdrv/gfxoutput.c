@@ -41,6 +41,7 @@
 #include "nativedrv.h"
 #include "pcxdrv.h"
 #include "ppmdrv.h"
+#include "rawvideodrv.h"
 #include "godotdrv.h"
 
 #ifdef HAVE_PNG
@@ -119,6 +120,7 @@ int gfxoutput_early_init(int help)
     gfxoutput_init_png(help);
 #endif
     gfxoutput_init_ppm(help);
+    gfxoutput_init_rawvideo(help);
 #ifdef HAVE_FFMPEG
     gfxoutput_init_ffmpeg(help);
 #endif
@@ -180,6 +180,9 @@ static int iffdrv_write(screenshot_t *screenshot)
             return -1;
         }
     }
+
+    sdata->line++;
+
     return 0;
 }
 
@@ -200,13 +203,13 @@ static int iffdrv_close(screenshot_t *screenshot)
 
 static int iffdrv_save(screenshot_t *screenshot, const char *filename)
 {
+    unsigned int i;
+
     if (iffdrv_open(screenshot, filename) < 0) {
         return -1;
     }
 
-    for (screenshot->gfxoutputdrv_data->line = 0;
-         screenshot->gfxoutputdrv_data->line < screenshot->height;
-         (screenshot->gfxoutputdrv_data->line)++) {
+    for (i = 0; i < screenshot->height; i++) {
         iffdrv_write(screenshot);
     }
 
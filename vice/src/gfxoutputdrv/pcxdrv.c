@@ -179,6 +179,9 @@ static int pcxdrv_write(screenshot_t *screenshot)
     if (fwrite(sdata->pcx_data, j, 1, sdata->fd) < 1) {
         return -1;
     }
+
+    sdata->line++;
+
     return 0;
 }
 
@@ -215,13 +218,13 @@ static int pcxdrv_close(screenshot_t *screenshot)
 
 static int pcxdrv_save(screenshot_t *screenshot, const char *filename)
 {
+    unsigned int i;
+
     if (pcxdrv_open(screenshot, filename) < 0) {
         return -1;
     }
 
-    for (screenshot->gfxoutputdrv_data->line = 0;
-         screenshot->gfxoutputdrv_data->line < screenshot->height;
-         (screenshot->gfxoutputdrv_data->line)++) {
+    for (i = 0; i < screenshot->height; i++) {
         pcxdrv_write(screenshot);
     }
 
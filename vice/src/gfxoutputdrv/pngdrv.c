@@ -101,6 +101,7 @@ static int pngdrv_open(screenshot_t *screenshot, const char *filename)
     }
 
     sdata->data = lib_malloc(screenshot->width * 4);
+    sdata->line = 0;
 
     png_init_io(sdata->png_ptr, sdata->fd);
     png_set_compression_level(sdata->png_ptr, Z_BEST_COMPRESSION);
@@ -128,6 +129,8 @@ static int pngdrv_write(screenshot_t *screenshot)
                                SCREENSHOT_MODE_RGB32);
     png_write_row(sdata->png_ptr, (png_bytep)(sdata->data));
 
+    sdata->line++;
+
     return 0;
 }
 
@@ -151,13 +154,13 @@ static int pngdrv_close(screenshot_t *screenshot)
 
 static int pngdrv_save(screenshot_t *screenshot, const char *filename)
 {
+    unsigned int i;
+
     if (pngdrv_open(screenshot, filename) < 0) {
         return -1;
     }
 
-    for (screenshot->gfxoutputdrv_data->line = 0;
-         screenshot->gfxoutputdrv_data->line < screenshot->height;
-         (screenshot->gfxoutputdrv_data->line)++) {
+    for (i = 0; i < screenshot->height; i++) {
         pngdrv_write(screenshot);
     }
 
@@ -102,6 +102,9 @@ static int ppmdrv_write(screenshot_t *screenshot)
     if (fwrite(sdata->data, 3, screenshot->width, sdata->fd) != screenshot->width) {
         return -1;
     }
+
+    sdata->line++;
+
     return 0;
 }
 
@@ -121,13 +124,13 @@ static int ppmdrv_close(screenshot_t *screenshot)
 
 static int ppmdrv_save(screenshot_t *screenshot, const char *filename)
 {
+    unsigned int i;
+
     if (ppmdrv_open(screenshot, filename) < 0) {
         return -1;
     }
 
-    for (screenshot->gfxoutputdrv_data->line = 0;
-         screenshot->gfxoutputdrv_data->line < screenshot->height;
-         (screenshot->gfxoutputdrv_data->line)++) {
+    for (i = 0; i < screenshot->height; i++) {
         ppmdrv_write(screenshot);
     }
 
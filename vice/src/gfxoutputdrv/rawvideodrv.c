@@ -0,0 +1,527 @@
+/*
+ * rawvideodrv.c - Uncompressed Y4M/RGB movie driver with raw PCM audio.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* This driver does no encoding at all: every emulated frame is written as
+   one uncompressed picture (YUV4MPEG2 4:4:4 or packed RGB24) to <name>.y4m
+   or <name>.rgb, and the sound stream goes as interleaved signed 16 bit
+   little endian PCM to <name>.pcm.  Both files may be named pipes, so an
+   external encoder (x264, ffmpeg, ...) can consume them in parallel.
+
+   Frames are never dropped or duplicated, so the video runs at exactly the
+   emulated frame rate (cycles per second / cycles per frame) and the audio
+   is padded with silence for the frames recorded while no sound device was
+   open, either before the first one or while it was being restarted.  The
+   two streams therefore stay in sync in emulated time. */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "cmdline.h"
+#include "gfxoutput.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "palette.h"
+#include "rawvideodrv.h"
+#include "resources.h"
+#include "screenshot.h"
+#include "soundmovie.h"
+#include "types.h"
+#include "util.h"
+
+
+/* Size of the audio block handed over by soundmovie, in milliseconds.  */
+#define RAWVIDEO_AUDIO_BLOCK_MS 10
+
+/* video */
+static FILE *video_fd = NULL;
+static char *video_filename = NULL;
+static unsigned int video_width;
+static unsigned int video_height;
+static uint8_t *video_frame = NULL;
+static size_t video_frame_size;
+static unsigned long framecounter;
+
+/* Per frame lookup from draw buffer pixel value to the output components,
+   in RGB or YUV order.  */
+static uint8_t video_lut[256][3];
+
+/* audio */
+static FILE *audio_fd = NULL;
+static char *audio_filename = NULL;
+static soundmovie_buffer_t rawvideo_audio_in;
+static int audio_speed;
+static int audio_channels;
+static uint64_t audio_written;  /* samples written, all channels */
+
+/* resources */
+static int rawvideo_format;
+
+static int set_rawvideo_format(int val, void *param)
+{
+    switch (val) {
+        case RAWVIDEO_FORMAT_Y4M:
+        case RAWVIDEO_FORMAT_RGB24:
+            break;
+        default:
+            return -1;
+    }
+
+    if (rawvideo_format != val && screenshot_is_recording()) {
+        log_error(LOG_DEFAULT, "rawvideodrv: Can't change format while recording.");
+        return -1;
+    }
+
+    rawvideo_format = val;
+    return 0;
+}
+
+/*---------- Resources ------------------------------------------------*/
+
+static const resource_int_t resources_int[] = {
+    { "RawVideoFormat", RAWVIDEO_FORMAT_Y4M, RES_EVENT_NO, NULL,
+      &rawvideo_format, set_rawvideo_format, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+static int rawvideodrv_resources_init(void)
+{
+    return resources_register_int(resources_int);
+}
+
+/*---------- Commandline options --------------------------------------*/
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-rawvideoformat", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "RawVideoFormat", NULL,
+      "<Type>", "Set raw video output format (0: Y4M 4:4:4, 1: RGB24)" },
+    CMDLINE_LIST_END
+};
+
+static int rawvideodrv_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+/*-----------------------*/
+/* audio stream          */
+/*-----------------------*/
+
+static int rawvideodrv_write_pcm(int16_t *pbuf, size_t nr)
+{
+#ifdef WORDS_BIGENDIAN
+    size_t i;
+
+    for (i = 0; i < nr; i++) {
+        pbuf[i] = (int16_t)((((uint16_t)pbuf[i] & 0xff) << 8) | ((uint16_t)pbuf[i] >> 8));
+    }
+#endif
+
+    if (fwrite(pbuf, sizeof(int16_t), nr, audio_fd) != nr) {
+        return -1;
+    }
+    audio_written += nr;
+    return 0;
+}
+
+/* Write the silence covering the frames that were recorded while no sound
+   device was open, up to the current frame.  */
+static int rawvideodrv_write_audio_gap(void)
+{
+    int16_t silence[1024];
+    double samples;
+    uint64_t target;
+    size_t todo, chunk;
+
+    samples = (double)framecounter * (double)machine_get_cycles_per_frame()
+              * (double)audio_speed / (double)machine_get_cycles_per_second();
+    target = (uint64_t)(samples + 0.5) * (uint64_t)audio_channels;
+    if (target <= audio_written) {
+        return 0;
+    }
+    todo = (size_t)(target - audio_written);
+
+    memset(silence, 0, sizeof(silence));
+    while (todo > 0) {
+        chunk = todo < 1024 ? todo : 1024;
+        if (fwrite(silence, sizeof(int16_t), chunk, audio_fd) != chunk) {
+            return -1;
+        }
+        audio_written += chunk;
+        todo -= chunk;
+    }
+    return 0;
+}
+
+/* Write out and drop the pending block, the stream itself stays open.  */
+static void rawvideodrv_flush_audio(void)
+{
+    if (audio_fd != NULL && rawvideo_audio_in.used > 0) {
+        rawvideodrv_write_pcm(rawvideo_audio_in.buffer, (size_t)rawvideo_audio_in.used);
+    }
+    if (rawvideo_audio_in.buffer != NULL) {
+        lib_free(rawvideo_audio_in.buffer);
+        rawvideo_audio_in.buffer = NULL;
+    }
+    rawvideo_audio_in.size = 0;
+    rawvideo_audio_in.used = 0;
+}
+
+static void rawvideodrv_close_audio(void)
+{
+    rawvideodrv_flush_audio();
+    if (audio_fd != NULL) {
+        fclose(audio_fd);
+        audio_fd = NULL;
+    }
+    audio_written = 0;
+}
+
+static int rawvideomovie_init_audio(int speed, int channels, soundmovie_buffer_t **audio_in)
+{
+    if (video_fd == NULL || audio_filename == NULL) {
+        return -1;
+    }
+
+    if (audio_fd != NULL) {
+        /* The sound system was restarted while recording.  Keep appending
+           to the stream, a raw PCM file cannot change its format though.  */
+        rawvideodrv_flush_audio();
+        if (speed != audio_speed || channels != audio_channels) {
+            log_error(LOG_DEFAULT, "rawvideodrv: Sound changed to %d Hz, %d channel(s) while recording, audio stopped.",
+                      speed, channels);
+            return -1;
+        }
+    } else {
+        audio_fd = fopen(audio_filename, "wb");
+        if (audio_fd == NULL) {
+            log_error(LOG_DEFAULT, "rawvideodrv: Cannot open audio stream `%s'.", audio_filename);
+            return -1;
+        }
+        audio_speed = speed;
+        audio_channels = channels;
+        audio_written = 0;
+    }
+
+    rawvideo_audio_in.size = (speed * RAWVIDEO_AUDIO_BLOCK_MS / 1000) * channels;
+    rawvideo_audio_in.used = 0;
+    rawvideo_audio_in.buffer = lib_malloc((size_t)rawvideo_audio_in.size * sizeof(int16_t));
+    *audio_in = &rawvideo_audio_in;
+
+    if (rawvideodrv_write_audio_gap() < 0) {
+        log_error(LOG_DEFAULT, "rawvideodrv: Error writing audio stream.");
+        return -1;
+    }
+
+    log_message(LOG_DEFAULT, "rawvideodrv: Audio: %s, s16le, %d Hz, %d channel(s).",
+                audio_filename, speed, channels);
+    return 0;
+}
+
+/* triggered by soundmovie->write */
+static int rawvideomovie_encode_audio(soundmovie_buffer_t *audio_in)
+{
+    if (audio_fd != NULL) {
+        if (rawvideodrv_write_pcm(audio_in->buffer, (size_t)audio_in->used) < 0) {
+            log_error(LOG_DEFAULT, "rawvideodrv: Error writing audio stream.");
+        }
+    }
+
+    audio_in->used = 0;
+    return 0;
+}
+
+static void rawvideomovie_close(void)
+{
+    /* just stop the whole recording */
+    screenshot_stop_recording();
+}
+
+static soundmovie_funcs_t rawvideodrv_soundmovie_funcs = {
+    rawvideomovie_init_audio,
+    rawvideomovie_encode_audio,
+    rawvideomovie_close
+};
+
+/*-----------------------*/
+/* video stream          */
+/*-----------------------*/
+
+static void rawvideodrv_update_lut(screenshot_t *screenshot)
+{
+    unsigned int i;
+    int r, g, b;
+    uint8_t color;
+
+    for (i = 0; i < 256; i++) {
+        color = screenshot->color_map[i];
+        if (color >= screenshot->palette->num_entries) {
+            color = 0;
+        }
+        r = screenshot->palette->entries[color].red;
+        g = screenshot->palette->entries[color].green;
+        b = screenshot->palette->entries[color].blue;
+
+        if (rawvideo_format == RAWVIDEO_FORMAT_Y4M) {
+            /* ITU-R BT.601, limited range */
+            video_lut[i][0] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            video_lut[i][1] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            video_lut[i][2] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        } else {
+            video_lut[i][0] = (uint8_t)r;
+            video_lut[i][1] = (uint8_t)g;
+            video_lut[i][2] = (uint8_t)b;
+        }
+    }
+}
+
+static void rawvideodrv_clear_frame(void)
+{
+    size_t plane = (size_t)video_width * video_height;
+
+    if (rawvideo_format == RAWVIDEO_FORMAT_Y4M) {
+        memset(video_frame, 16, plane);
+        memset(video_frame + plane, 128, plane * 2);
+    } else {
+        memset(video_frame, 0, plane * 3);
+    }
+}
+
+/* Convert the visible part of the draw buffer straight into the output
+   frame; the frame is written with a single fwrite() afterwards.  */
+static void rawvideodrv_fill_frame(screenshot_t *screenshot)
+{
+    unsigned int x, y;
+    unsigned int width, height;
+    size_t plane = (size_t)video_width * video_height;
+    uint8_t *line_base;
+    uint8_t *dst;
+    uint8_t *src;
+
+    width = screenshot->width < video_width ? screenshot->width : video_width;
+    height = screenshot->height < video_height ? screenshot->height : video_height;
+
+    for (y = 0; y < height; y++) {
+        line_base = screenshot->draw_buffer
+                    + (y + screenshot->y_offset) * screenshot->size_height
+                    * screenshot->draw_buffer_line_size
+                    + screenshot->x_offset;
+
+        if (rawvideo_format == RAWVIDEO_FORMAT_Y4M) {
+            uint8_t *dst_u, *dst_v;
+
+            dst = video_frame + (size_t)y * video_width;
+            dst_u = dst + plane;
+            dst_v = dst_u + plane;
+            for (x = 0; x < width; x++) {
+                src = video_lut[line_base[x * screenshot->size_width]];
+                dst[x] = src[0];
+                dst_u[x] = src[1];
+                dst_v[x] = src[2];
+            }
+        } else {
+            dst = video_frame + (size_t)y * video_width * 3;
+            for (x = 0; x < width; x++) {
+                src = video_lut[line_base[x * screenshot->size_width]];
+                dst[x * 3] = src[0];
+                dst[x * 3 + 1] = src[1];
+                dst[x * 3 + 2] = src[2];
+            }
+        }
+    }
+}
+
+static int rawvideodrv_write_header(void)
+{
+    if (rawvideo_format != RAWVIDEO_FORMAT_Y4M) {
+        return 0;
+    }
+
+    /* the frame rate is given as the exact ratio of emulated cycles */
+    if (fprintf(video_fd, "YUV4MPEG2 W%u H%u F%ld:%ld Ip A1:1 C444\n",
+                video_width, video_height,
+                machine_get_cycles_per_second(),
+                machine_get_cycles_per_frame()) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void rawvideodrv_close_video(void)
+{
+    if (video_fd != NULL) {
+        fclose(video_fd);
+        video_fd = NULL;
+    }
+    if (video_frame != NULL) {
+        lib_free(video_frame);
+        video_frame = NULL;
+    }
+}
+
+static void rawvideodrv_free_filenames(void)
+{
+    if (video_filename != NULL) {
+        lib_free(video_filename);
+        video_filename = NULL;
+    }
+    if (audio_filename != NULL) {
+        lib_free(audio_filename);
+        audio_filename = NULL;
+    }
+}
+
+static int rawvideodrv_close(screenshot_t *screenshot)
+{
+    soundmovie_stop();
+
+    rawvideodrv_close_audio();
+    rawvideodrv_close_video();
+
+    if (video_filename != NULL) {
+        log_message(LOG_DEFAULT, "rawvideodrv: Closed `%s' after %lu frames.",
+                    video_filename, framecounter);
+    }
+    rawvideodrv_free_filenames();
+
+    return 0;
+}
+
+static int rawvideodrv_save(screenshot_t *screenshot, const char *filename)
+{
+    const char *ext;
+    char *basename;
+    char *p;
+
+    ext = (rawvideo_format == RAWVIDEO_FORMAT_Y4M) ? "y4m" : "rgb";
+
+    /* strip a video extension given by the user, so "foo.y4m" gives
+       "foo.y4m" and "foo.pcm" */
+    basename = lib_strdup(filename);
+    p = util_get_extension(basename);
+    if (p != NULL && strcasecmp(p, ext) == 0) {
+        *(p - 1) = 0;
+    }
+    video_filename = util_add_extension_const(basename, ext);
+    audio_filename = util_add_extension_const(basename, "pcm");
+    lib_free(basename);
+
+    /* a named pipe blocks here until the reader has opened it */
+    video_fd = fopen(video_filename, "wb");
+    if (video_fd == NULL) {
+        log_error(LOG_DEFAULT, "rawvideodrv: Cannot open video stream `%s'.", video_filename);
+        rawvideodrv_free_filenames();
+        return -1;
+    }
+
+    video_width = screenshot->width;
+    video_height = screenshot->height;
+    video_frame_size = (size_t)video_width * video_height * 3;
+    video_frame = lib_malloc(video_frame_size);
+    rawvideodrv_clear_frame();
+    framecounter = 0;
+
+    if (rawvideodrv_write_header() < 0) {
+        log_error(LOG_DEFAULT, "rawvideodrv: Error writing video stream.");
+        rawvideodrv_close_video();
+        rawvideodrv_free_filenames();
+        return -1;
+    }
+
+    log_message(LOG_DEFAULT, "rawvideodrv: Video: %s, %s, %ux%u, %ld/%ld fps.",
+                video_filename,
+                rawvideo_format == RAWVIDEO_FORMAT_Y4M ? "yuv444p" : "rgb24",
+                video_width, video_height,
+                machine_get_cycles_per_second(),
+                machine_get_cycles_per_frame());
+
+    soundmovie_start(&rawvideodrv_soundmovie_funcs);
+
+    return 0;
+}
+
+/* triggered by screenshot_record */
+static int rawvideodrv_record(screenshot_t *screenshot)
+{
+    if (video_fd == NULL) {
+        return 0;
+    }
+
+    rawvideodrv_update_lut(screenshot);
+    rawvideodrv_fill_frame(screenshot);
+
+    if (rawvideo_format == RAWVIDEO_FORMAT_Y4M) {
+        if (fwrite("FRAME\n", 1, 6, video_fd) != 6) {
+            log_error(LOG_DEFAULT, "rawvideodrv: Error writing video stream.");
+            return -1;
+        }
+    }
+    if (fwrite(video_frame, 1, video_frame_size, video_fd) != video_frame_size) {
+        log_error(LOG_DEFAULT, "rawvideodrv: Error writing video stream.");
+        return -1;
+    }
+
+    framecounter++;
+
+    return 0;
+}
+
+static int rawvideodrv_write(screenshot_t *screenshot)
+{
+    return 0;
+}
+
+static void rawvideodrv_shutdown(void)
+{
+    if (video_fd != NULL) {
+        rawvideodrv_close(NULL);
+    }
+}
+
+static gfxoutputdrv_t rawvideo_drv = {
+    "RAWVIDEO",
+    "Raw video (Y4M/RGB + PCM)",
+    NULL,
+    NULL, /* formatlist */
+    NULL, /* open */
+    rawvideodrv_close,
+    rawvideodrv_write,
+    rawvideodrv_save,
+    NULL,
+    rawvideodrv_record,
+    rawvideodrv_shutdown,
+    rawvideodrv_resources_init,
+    rawvideodrv_cmdline_options_init
+#ifdef FEATURE_CPUMEMHISTORY
+    , NULL
+#endif
+};
+
+void gfxoutput_init_rawvideo(int help)
+{
+    gfxoutput_register(&rawvideo_drv);
+}
@@ -1,8 +1,5 @@
 /*
- * drive-overflow.h
- *
- * Written by
- *  Andreas Boose <viceteam@t-online.de>
+ * rawvideodrv.h - Uncompressed Y4M/RGB movie driver with raw PCM audio.
  *
  * This file is part of VICE, the Versatile Commodore Emulator.
  * See README for copyright notice.
@@ -24,9 +21,12 @@
  *
  */
 
-#ifndef VICE_DRIVE_OVERFLOW_H
-#define VICE_DRIVE_OVERFLOW_H
+#ifndef VICE_RAWVIDEODRV_H
+#define VICE_RAWVIDEODRV_H
+
+#define RAWVIDEO_FORMAT_Y4M     0
+#define RAWVIDEO_FORMAT_RGB24   1
 
-extern void drive_overflow_init(void);
+extern void gfxoutput_init_rawvideo(int help);
 
 #endif
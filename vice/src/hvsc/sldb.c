@@ -330,6 +330,12 @@ int hvsc_sldb_get_lengths(const char *psid, long **lengths)
 
     *lengths = NULL;
 
+    /* no usable HVSC root set */
+    if (hvsc_root_path == NULL || hvsc_sldb_path == NULL) {
+        hvsc_errno = HVSC_ERR_INVALID;
+        return -1;
+    }
+
 #ifdef HVSC_USE_MD5
     entry = hvsc_sldb_get_entry_md5(psid);
 #else
@@ -193,8 +193,8 @@ static void hardsid_alarm_handler(CLOCK offset, void *data)
 
 void hs_linux_state_read(int chipno, struct sid_hs_snapshot_state_s *sid_state)
 {
-    sid_state->hsid_main_clk = (uint32_t)hsid_main_clk;
-    sid_state->hsid_alarm_clk = (uint32_t)hsid_alarm_clk;
+    sid_state->hsid_main_clk = hsid_main_clk;
+    sid_state->hsid_alarm_clk = hsid_alarm_clk;
     sid_state->lastaccess_clk = 0;
     sid_state->lastaccess_ms = 0;
     sid_state->lastaccess_chipno = 0;
@@ -207,8 +207,8 @@ void hs_linux_state_read(int chipno, struct sid_hs_snapshot_state_s *sid_state)
 
 void hs_linux_state_write(int chipno, struct sid_hs_snapshot_state_s *sid_state)
 {
-    hsid_main_clk = (CLOCK)sid_state->hsid_main_clk;
-    hsid_alarm_clk = (CLOCK)sid_state->hsid_alarm_clk;
+    hsid_main_clk = sid_state->hsid_main_clk;
+    hsid_alarm_clk = sid_state->hsid_alarm_clk;
 }
 #endif
 #endif
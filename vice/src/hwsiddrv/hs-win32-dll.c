@@ -325,7 +325,7 @@ void hs_dll_state_read(int chipno, struct sid_hs_snapshot_state_s *sid_state)
 {
     sid_state->hsid_main_clk = 0;
     sid_state->hsid_alarm_clk = 0;
-    sid_state->lastaccess_clk = (DWORD)lastaccess_clk;
+    sid_state->lastaccess_clk = lastaccess_clk;
     sid_state->lastaccess_ms = lastaccess_ms;
     sid_state->lastaccess_chipno = (DWORD)lastaccess_chipno;
     sid_state->chipused = (DWORD)chipused;
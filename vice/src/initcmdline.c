@@ -142,12 +142,7 @@ static int cmdline_chdir(const char *param, void *extra_param)
 
 static int cmdline_limitcycles(const char *param, void *extra_param)
 {
-    uint64_t clk_limit = strtoull(param, NULL, 0);
-    if (clk_limit > CLOCK_MAX) {
-        fprintf(stderr, "too many cycles, use max %u\n", CLOCK_MAX);
-        return -1;
-    }
-    maincpu_clk_limit = (CLOCK)clk_limit;
+    maincpu_clk_limit = (CLOCK)strtoull(param, NULL, 0);
     return 0;
 }
 
@@ -126,47 +126,6 @@ void interrupt_set_reset_trap_func(interrupt_cpu_status_t *cs, void (*reset_trap
     cs->reset_trap_func = reset_trap_func;
 }
 
-/* Move all the CLOCK time references forward/backward.  */
-void interrupt_cpu_status_time_warp(interrupt_cpu_status_t *cs,
-                                    CLOCK warp_amount, int warp_direction)
-{
-    if (warp_direction == 0) {
-        return;
-    }
-
-    if (warp_direction > 0) {
-        cs->irq_clk += warp_amount;
-        cs->nmi_clk += warp_amount;
-        cs->last_stolen_cycles_clk += warp_amount;
-        if (cs->irq_pending_clk < CLOCK_MAX) {
-            cs->irq_pending_clk += warp_amount;
-        }
-    } else {
-        if (cs->irq_clk > warp_amount) {
-            cs->irq_clk -= warp_amount;
-        } else {
-            cs->irq_clk = (CLOCK) 0;
-        }
-        if (cs->nmi_clk > warp_amount) {
-            cs->nmi_clk -= warp_amount;
-        } else {
-            cs->nmi_clk = (CLOCK) 0;
-        }
-        if (cs->last_stolen_cycles_clk > warp_amount) {
-            cs->last_stolen_cycles_clk -= warp_amount;
-        } else {
-            cs->last_stolen_cycles_clk = (CLOCK) 0;
-        }
-        if (cs->irq_pending_clk < CLOCK_MAX) {
-            if (cs->irq_pending_clk > warp_amount) {
-                cs->irq_pending_clk -= warp_amount;
-            } else {
-                cs->irq_pending_clk = (CLOCK) 0;
-            }
-        }
-    }
-}
-
 void interrupt_log_wrong_nirq(void)
 {
     log_error(LOG_DEFAULT, "interrupt_set_irq(): wrong nirq!");
@@ -345,11 +304,11 @@ void interrupt_monitor_trap_off(interrupt_cpu_status_t *cs)
 int interrupt_write_snapshot(interrupt_cpu_status_t *cs, snapshot_module_t *m)
 {
     /* FIXME: could we avoid some of this info?  */
-    if (SMW_DW(m, cs->irq_clk) < 0
-        || SMW_DW(m, cs->nmi_clk) < 0
-        || SMW_DW(m, cs->irq_pending_clk) < 0
+    if (SMW_CLOCK(m, cs->irq_clk) < 0
+        || SMW_CLOCK(m, cs->nmi_clk) < 0
+        || SMW_CLOCK(m, cs->irq_pending_clk) < 0
         || SMW_DW(m, (uint32_t)cs->num_last_stolen_cycles) < 0
-        || SMW_DW(m, cs->last_stolen_cycles_clk) < 0) {
+        || SMW_CLOCK(m, cs->last_stolen_cycles_clk) < 0) {
         return -1;
     }
 
@@ -392,9 +351,9 @@ int interrupt_read_snapshot(interrupt_cpu_status_t *cs, snapshot_module_t *m)
     cs->nirq = cs->nnmi = cs->reset = cs->trap = 0;
 
     if (0
-        || SMR_DW(m, &cs->irq_clk) < 0
-        || SMR_DW(m, &cs->nmi_clk) < 0
-        || SMR_DW(m, &cs->irq_pending_clk) < 0) {
+        || SMR_CLOCK(m, &cs->irq_clk) < 0
+        || SMR_CLOCK(m, &cs->nmi_clk) < 0
+        || SMR_CLOCK(m, &cs->irq_pending_clk) < 0) {
         return -1;
     }
 
@@ -403,10 +362,9 @@ int interrupt_read_snapshot(interrupt_cpu_status_t *cs, snapshot_module_t *m)
     }
     cs->num_last_stolen_cycles = dw;
 
-    if (SMR_DW(m, &dw) < 0) {
+    if (SMR_CLOCK(m, &cs->last_stolen_cycles_clk) < 0) {
         return -1;
     }
-    cs->last_stolen_cycles_clk = dw;
 
     return 0;
 }
@@ -288,10 +288,6 @@ extern void interrupt_do_trap(interrupt_cpu_status_t *cs, uint16_t address);
 extern void interrupt_monitor_trap_on(interrupt_cpu_status_t *cs);
 extern void interrupt_monitor_trap_off(interrupt_cpu_status_t *cs);
 
-extern void interrupt_cpu_status_time_warp(interrupt_cpu_status_t *cs,
-                                           CLOCK warp_amount,
-                                           int warp_direction);
-
 extern int interrupt_read_snapshot(interrupt_cpu_status_t *cs,
                                    struct snapshot_module_s *m);
 extern int interrupt_read_new_snapshot(interrupt_cpu_status_t *cs,
@@ -54,6 +54,7 @@
 #include "types.h"
 #include "uiapi.h"
 #include "userport_joystick.h"
+#include "util.h"
 #include "vice-event.h"
 
 /* Control port <--> Joystick connections:
@@ -220,10 +221,13 @@ void joystick_register_delay(unsigned int delay)
 /*-----------------------------------------------------------------------*/
 static void joystick_process_latch(void)
 {
-    CLOCK delay = lib_unsigned_rand(1, (unsigned int)machine_get_cycles_per_frame());
+    unsigned int delay = lib_unsigned_rand(1, (unsigned int)machine_get_cycles_per_frame());
 
     if (network_connected()) {
-        network_event_record(EVENT_JOYSTICK_DELAY, (void *)&delay, sizeof(delay));
+        uint8_t delay_buf[4];
+
+        util_int_to_le_buf4(delay_buf, (int)delay);
+        network_event_record(EVENT_JOYSTICK_DELAY, (void *)delay_buf, sizeof(delay_buf));
         network_event_record(EVENT_JOYSTICK_VALUE, (void *)latch_joystick_value, sizeof(latch_joystick_value));
     } else {
         alarm_set(joystick_alarm, maincpu_clk + delay);
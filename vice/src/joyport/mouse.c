@@ -59,7 +59,6 @@
 #include "resources.h"
 #include "snapshot.h"
 #include "vsyncapi.h"
-#include "clkguard.h"
 #include "ds1202_1302.h"
 
 /* Control port <--> mouse/paddles/pad connections:
@@ -351,20 +350,6 @@ static uint8_t polled_joyval = 0xff;
 static const uint8_t amiga_mouse_table[4] = { 0x0, 0x1, 0x5, 0x4 };
 static const uint8_t st_mouse_table[4] = { 0x0, 0x2, 0x3, 0x1 };
 
-/* Clock overflow handling.  */
-static void clk_overflow_callback(CLOCK sub, void *data)
-{
-    if (next_update_x_emu_ts > (CLOCK) 0) {
-        next_update_x_emu_ts -= sub;
-    }
-    if (next_update_y_emu_ts > (CLOCK) 0) {
-        next_update_y_emu_ts -= sub;
-    }
-    if (up_down_pulse_end > (CLOCK) 0) {
-        up_down_pulse_end -= sub;
-    }
-}
-
 uint8_t mouse_poll(void)
 {
     int16_t new_x, new_y;
@@ -1075,7 +1060,6 @@ void mouse_init(void)
     neos_and_amiga_buttons = 0;
     neos_prev = 0xff;
     mousedrv_init();
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
 }
 
 void mouse_shutdown(void)
@@ -1276,8 +1260,8 @@ static int write_poll_val_snapshot(snapshot_module_t *m)
         || SMW_DW(m, (uint32_t)update_limit) < 0
         || SMW_DW(m, (uint32_t)latest_os_ts) < 0
         || SMW_DB(m, (double)emu_units_per_os_units) < 0
-        || SMW_DW(m, (uint32_t)next_update_x_emu_ts) < 0
-        || SMW_DW(m, (uint32_t)next_update_y_emu_ts) < 0
+        || SMW_CLOCK(m, next_update_x_emu_ts) < 0
+        || SMW_CLOCK(m, next_update_y_emu_ts) < 0
         || SMW_DW(m, (uint32_t)update_x_emu_iv) < 0
         || SMW_DW(m, (uint32_t)update_y_emu_iv) < 0) {
         return -1;
@@ -1290,8 +1274,6 @@ static int read_poll_val_snapshot(snapshot_module_t *m)
     uint16_t tmp_latest_x;
     uint16_t tmp_latest_y;
     double tmp_db;
-    uint32_t tmpc1;
-    uint32_t tmpc2;
     uint32_t tmpc3;
     uint32_t tmpc4;
 
@@ -1308,8 +1290,8 @@ static int read_poll_val_snapshot(snapshot_module_t *m)
         || SMR_DW_INT(m, &update_limit) < 0
         || SMR_DW_UL(m, &latest_os_ts) < 0
         || SMR_DB(m, &tmp_db) < 0
-        || SMR_DW(m, &tmpc1) < 0
-        || SMR_DW(m, &tmpc2) < 0
+        || SMR_CLOCK(m, &next_update_x_emu_ts) < 0
+        || SMR_CLOCK(m, &next_update_y_emu_ts) < 0
         || SMR_DW(m, &tmpc3) < 0
         || SMR_DW(m, &tmpc4) < 0) {
         return -1;
@@ -1318,8 +1300,6 @@ static int read_poll_val_snapshot(snapshot_module_t *m)
     latest_x = (int16_t)tmp_latest_x;
     latest_y = (int16_t)tmp_latest_y;
     emu_units_per_os_units = (float)tmp_db;
-    next_update_x_emu_ts = (CLOCK)tmpc1;
-    next_update_y_emu_ts = (CLOCK)tmpc2;
     update_x_emu_iv = (CLOCK)tmpc3;
     update_y_emu_iv = (CLOCK)tmpc4;
 
@@ -1429,8 +1409,8 @@ fail:
    DWORD  | update limit           | update limit
    DWORD  | latest os ts           | latest os ts
    DOUBLE | emu units per os units | emu units per os units
-   DWORD  | next update x emu ts   | next update X emu ts
-   DWORD  | next update y emu ts   | next update Y emu ts
+   CLOCK  | next update x emu ts   | next update X emu ts
+   CLOCK  | next update y emu ts   | next update Y emu ts
    DWORD  | update x emu iv        | update X emu IV
    DWORD  | update y emu iv        | update Y emu IV
  */
@@ -1510,7 +1490,7 @@ fail:
    BYTE  | neos last y          | neos last Y
    DWORD | neos state           | state
    DWORD | neos prev            | previous state
-   DWORD | last trigger         | last trigger clock
+   CLOCK | last trigger         | last trigger clock
    DWORD | neos time out cycles | time out cycles
  */
 
@@ -1543,7 +1523,7 @@ static int mouse_neos_write_snapshot(struct snapshot_s *s, int port)
         || SMW_B(m, neos_lasty) < 0
         || SMW_DW(m, (uint32_t)neos_state) < 0
         || SMW_DW(m, (uint32_t)neos_prev) < 0
-        || SMW_DW(m, (uint32_t)neos_last_trigger) < 0
+        || SMW_CLOCK(m, neos_last_trigger) < 0
         || SMW_DW(m, (uint32_t)neos_time_out_cycles) < 0) {
         goto fail;
     }
@@ -1559,7 +1539,6 @@ static int mouse_neos_read_snapshot(struct snapshot_s *s, int port)
 {
     uint8_t major_version, minor_version;
     snapshot_module_t *m;
-    uint32_t tmpc1;
     uint32_t tmpc2;
     int tmp_neos_state;
 
@@ -1590,12 +1569,11 @@ static int mouse_neos_read_snapshot(struct snapshot_s *s, int port)
         || SMR_B(m, &neos_lasty) < 0
         || SMR_DW_INT(m, &tmp_neos_state) < 0
         || SMR_DW_INT(m, &neos_prev) < 0
-        || SMR_DW(m, &tmpc1) < 0
+        || SMR_CLOCK(m, &neos_last_trigger) < 0
         || SMR_DW(m, &tmpc2) < 0) {
         goto fail;
     }
 
-    neos_last_trigger = (CLOCK)tmpc1;
     neos_time_out_cycles = (CLOCK)tmpc2;
     neos_state = tmp_neos_state;
 
@@ -1625,8 +1603,8 @@ fail:
    DWORD  | update limit           | update limit
    DWORD  | latest os ts           | latest os ts
    DOUBLE | emu units per os units | emu units per os units
-   DWORD  | next update x emu ts   | next update X emu ts
-   DWORD  | next update y emu ts   | next update Y emu ts
+   CLOCK  | next update x emu ts   | next update X emu ts
+   CLOCK  | next update y emu ts   | next update Y emu ts
    DWORD  | update x emu iv        | update X emu IV
    DWORD  | update y emu iv        | update Y emu IV
    DWORD  | buttons                | buttons state
@@ -1718,8 +1696,8 @@ fail:
    DWORD  | update limit           | update limit
    DWORD  | latest os ts           | latest os ts
    DOUBLE | emu units per os units | emu units per os units
-   DWORD  | next update x emu ts   | next update X emu ts
-   DWORD  | next update y emu ts   | next update Y emu ts
+   CLOCK  | next update x emu ts   | next update X emu ts
+   CLOCK  | next update y emu ts   | next update Y emu ts
    DWORD  | update x emu iv        | update X emu IV
    DWORD  | update y emu iv        | update Y emu IV
  */
@@ -1804,8 +1782,8 @@ fail:
    DWORD  | update limit           | update limit
    DWORD  | latest os ts           | latest os ts
    DOUBLE | emu units per os units | emu units per os units
-   DWORD  | next update x emu ts   | next update X emu ts
-   DWORD  | next update y emu ts   | next update Y emu ts
+   CLOCK  | next update x emu ts   | next update X emu ts
+   CLOCK  | next update y emu ts   | next update Y emu ts
    DWORD  | update x emu iv        | update X emu IV
    DWORD  | update y emu iv        | update Y emu IV
    DWORD  | buttons                | buttons state
@@ -1897,8 +1875,8 @@ fail:
    DWORD  | update limit           | update limit
    DWORD  | latest os ts           | latest os ts
    DOUBLE | emu units per os units | emu units per os units
-   DWORD  | next update x emu ts   | next update X emu ts
-   DWORD  | next update y emu ts   | next update Y emu ts
+   CLOCK  | next update x emu ts   | next update X emu ts
+   CLOCK  | next update y emu ts   | next update Y emu ts
    DWORD  | update x emu iv        | update X emu IV
    DWORD  | update y emu iv        | update Y emu IV
  */
@@ -1986,12 +1964,12 @@ fail:
    DWORD  | update limit           | update limit
    DWORD  | latest os ts           | latest os ts
    DOUBLE | emu units per os units | emu units per os units
-   DWORD  | next update x emu ts   | next update X emu ts
-   DWORD  | next update y emu ts   | next update Y emu ts
+   CLOCK  | next update x emu ts   | next update X emu ts
+   CLOCK  | next update y emu ts   | next update Y emu ts
    DWORD  | update x emu iv        | update X emu IV
    DWORD  | update y emu iv        | update Y emu IV
    DWORD  | up down counter        | up down counter
-   DWORD  | up down pulse end      | up down pulse end
+   CLOCK  | up down pulse end      | up down pulse end
  */
 
 static char mouse_micromys_snap_module_name[] = "MOUSE_MICROMYS";
@@ -2018,7 +1996,7 @@ static int mouse_micromys_write_snapshot(struct snapshot_s *s, int port)
 
     if (0
         || SMW_DW(m, (uint32_t)up_down_counter) < 0
-        || SMW_DW(m, (uint32_t)up_down_pulse_end) < 0) {
+        || SMW_CLOCK(m, up_down_pulse_end) < 0) {
         goto fail;
     }
 
@@ -2033,7 +2011,6 @@ static int mouse_micromys_read_snapshot(struct snapshot_s *s, int port)
 {
     uint8_t major_version, minor_version;
     snapshot_module_t *m;
-    uint32_t tmpc1;
 
     m = snapshot_module_open(s, mouse_micromys_snap_module_name, &major_version, &minor_version);
 
@@ -2057,12 +2034,10 @@ static int mouse_micromys_read_snapshot(struct snapshot_s *s, int port)
 
     if (0
         || SMR_DW_INT(m, &up_down_counter) < 0
-        || SMR_DW(m, &tmpc1) < 0) {
+        || SMR_CLOCK(m, &up_down_pulse_end) < 0) {
         goto fail;
     }
 
-    up_down_pulse_end = (CLOCK)tmpc1;
-
     return snapshot_module_close(m);
 
 fail:
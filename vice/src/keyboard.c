@@ -665,8 +665,10 @@ void keyboard_key_pressed(signed long key, int mod)
     if (latch) {
         keyboard_set_latch_keyarr(key_latch_row, key_latch_column, 1);
         if (network_connected()) {
-            CLOCK delay = KEYBOARD_RAND();
-            network_event_record(EVENT_KEYBOARD_DELAY, (void *)&delay, sizeof(delay));
+            uint8_t delay[4];
+
+            util_int_to_le_buf4(delay, (int)KEYBOARD_RAND());
+            network_event_record(EVENT_KEYBOARD_DELAY, (void *)delay, sizeof(delay));
             network_event_record(EVENT_KEYBOARD_MATRIX, (void *)latch_keyarr, sizeof(latch_keyarr));
         } else {
             alarm_set(keyboard_alarm, maincpu_clk + KEYBOARD_RAND());
@@ -831,8 +833,10 @@ void keyboard_key_released(signed long key, int mod)
 
     if (latch) {
         if (network_connected()) {
-            CLOCK delay = KEYBOARD_RAND();
-            network_event_record(EVENT_KEYBOARD_DELAY, (void *)&delay, sizeof(delay));
+            uint8_t delay[4];
+
+            util_int_to_le_buf4(delay, (int)KEYBOARD_RAND());
+            network_event_record(EVENT_KEYBOARD_DELAY, (void *)delay, sizeof(delay));
             network_event_record(EVENT_KEYBOARD_MATRIX, (void *)latch_keyarr, sizeof(latch_keyarr));
         } else {
             alarm_set(keyboard_alarm, maincpu_clk + KEYBOARD_RAND());
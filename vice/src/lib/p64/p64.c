@@ -416,6 +416,14 @@ void P64PulseStreamClear(PP64PulseStream Instance) {
     if(Instance->Pulses) {
         p64_free(Instance->Pulses);
     }
+    if(Instance->SortedPulses) {
+        p64_free(Instance->SortedPulses);
+    }
+    Instance->SortedPulses = 0;
+    Instance->SortedAllocated = 0;
+    Instance->SortedCount = 0;
+    Instance->SortedCursor = 0;
+    Instance->SortedValid = 0;
     Instance->Pulses = 0;
     Instance->PulsesAllocated = 0;
     Instance->PulsesCount = 0;
@@ -446,6 +454,7 @@ p64_int32_t P64PulseStreamAllocatePulse(PP64PulseStream Instance) {
         Index = Instance->FreeList;
         Instance->FreeList = Instance->Pulses[Index].Next;
     }
+    Instance->SortedValid = 0;
     Instance->Pulses[Index].Previous = -1;
     Instance->Pulses[Index].Next = -1;
     Instance->Pulses[Index].Position = 0;
@@ -470,6 +479,7 @@ void P64PulseStreamFreePulse(PP64PulseStream Instance, p64_int32_t Index) {
     Instance->Pulses[Index].Previous = -1;
     Instance->Pulses[Index].Next = Instance->FreeList;
     Instance->FreeList = Index;
+    Instance->SortedValid = 0;
 }
 
 void P64PulseStreamAddPulse(PP64PulseStream Instance, p64_uint32_t Position, p64_uint32_t Strength) {
@@ -515,6 +525,7 @@ void P64PulseStreamAddPulse(PP64PulseStream Instance, p64_uint32_t Position, p64
     Instance->Pulses[Index].Position = Position;
     Instance->Pulses[Index].Strength = Strength;
     Instance->CurrentIndex = Index;
+    Instance->SortedValid = 0;
 }
 
 void P64PulseStreamRemovePulses(PP64PulseStream Instance, p64_uint32_t Position, p64_uint32_t Count) {
@@ -660,6 +671,74 @@ void P64PulseStreamSeek(PP64PulseStream Instance, p64_uint32_t Position) {
     Instance->CurrentIndex = Current;
 }
 
+void P64PulseStreamUpdateSorted(PP64PulseStream Instance) {
+    p64_int32_t Current;
+    p64_uint32_t Count;
+    if(Instance->SortedValid) {
+        return;
+    }
+    Count = 0;
+    Current = Instance->UsedFirst;
+    while(Current >= 0) {
+        Count++;
+        Current = Instance->Pulses[Current].Next;
+    }
+    if(Count > Instance->SortedAllocated) {
+        if(Instance->SortedPulses) {
+            p64_free(Instance->SortedPulses);
+        }
+        Instance->SortedAllocated = Count;
+        Instance->SortedPulses = p64_malloc(Count * sizeof(TP64SortedPulse));
+    }
+    Count = 0;
+    Current = Instance->UsedFirst;
+    while(Current >= 0) {
+        Instance->SortedPulses[Count].Position = Instance->Pulses[Current].Position;
+        Instance->SortedPulses[Count].Strength = Instance->Pulses[Current].Strength;
+        Count++;
+        Current = Instance->Pulses[Current].Next;
+    }
+    Instance->SortedCount = Count;
+    Instance->SortedCursor = 0;
+    Instance->SortedValid = 1;
+}
+
+/* Returns the index of the first pulse at or after Position in the sorted
+   array, or SortedCount if there is none.  The cursor of the last lookup is
+   tried first, as the head usually just moved on a bit since then.  */
+p64_uint32_t P64PulseStreamSortedSeek(PP64PulseStream Instance, p64_uint32_t Position) {
+    PP64SortedPulses Sorted;
+    p64_uint32_t Low, High, Middle;
+    P64PulseStreamUpdateSorted(Instance);
+    Sorted = Instance->SortedPulses;
+    Low = Instance->SortedCursor;
+    if(Low > Instance->SortedCount) {
+        Low = Instance->SortedCount;
+    }
+    if((Low == 0) || (Sorted[Low - 1].Position < Position)) {
+        if((Low == Instance->SortedCount) || (Sorted[Low].Position >= Position)) {
+            Instance->SortedCursor = Low;
+            return Low;
+        }
+        if((Low + 1 == Instance->SortedCount) || (Sorted[Low + 1].Position >= Position)) {
+            Instance->SortedCursor = Low + 1;
+            return Low + 1;
+        }
+    }
+    Low = 0;
+    High = Instance->SortedCount;
+    while(Low < High) {
+        Middle = Low + ((High - Low) >> 1);
+        if(Sorted[Middle].Position < Position) {
+            Low = Middle + 1;
+        } else {
+            High = Middle;
+        }
+    }
+    Instance->SortedCursor = Low;
+    return Low;
+}
+
 void P64PulseStreamConvertFromGCR(PP64PulseStream Instance, p64_uint8_t* Bytes, p64_uint32_t Len) {
     p64_uint32_t PositionHi, PositionLo, IncrementHi, IncrementLo, BitStreamPosition;
     P64PulseStreamClear(Instance);
@@ -99,6 +99,16 @@ typedef TP64Pulse* PP64Pulse;
 
 typedef TP64Pulse* PP64Pulses;
 
+typedef struct {
+	p64_uint32_t Position;
+	p64_uint32_t Strength;
+} TP64SortedPulse;
+
+typedef TP64SortedPulse* PP64SortedPulses;
+
+/* The linked pulse list is the editable form of a track, the sorted array
+   is a read-only copy of it for fast lookups.  It is rebuilt on demand
+   after the list has been changed.  */
 typedef struct {
 	PP64Pulses Pulses;
 	p64_uint32_t PulsesAllocated;
@@ -107,6 +117,11 @@ typedef struct {
 	p64_int32_t UsedLast;
 	p64_int32_t FreeList;
 	p64_int32_t CurrentIndex;
+	PP64SortedPulses SortedPulses;
+	p64_uint32_t SortedAllocated;
+	p64_uint32_t SortedCount;
+	p64_uint32_t SortedCursor;
+	p64_uint32_t SortedValid;
 } TP64PulseStream;
 
 typedef TP64PulseStream* PP64PulseStream;
@@ -163,6 +178,8 @@ extern p64_uint32_t P64PulseStreamGetPulseCount(PP64PulseStream Instance);
 extern p64_uint32_t P64PulseStreamGetPulse(PP64PulseStream Instance, p64_uint32_t Position);
 extern void P64PulseStreamSetPulse(PP64PulseStream Instance, p64_uint32_t Position, p64_uint32_t Strength);
 extern void P64PulseStreamSeek(PP64PulseStream Instance, p64_uint32_t Position);
+extern void P64PulseStreamUpdateSorted(PP64PulseStream Instance);
+extern p64_uint32_t P64PulseStreamSortedSeek(PP64PulseStream Instance, p64_uint32_t Position);
 extern void P64PulseStreamConvertFromGCR(PP64PulseStream Instance, p64_uint8_t* Bytes, p64_uint32_t Len);
 extern void P64PulseStreamConvertToGCR(PP64PulseStream Instance, p64_uint8_t* Bytes, p64_uint32_t Len);
 extern p64_uint32_t P64PulseStreamConvertToGCRWithLogic(PP64PulseStream Instance, p64_uint8_t* Bytes, p64_uint32_t Len, p64_uint32_t SpeedZone);
@@ -34,7 +34,6 @@
 #include "archdep.h"
 #include "attach.h"
 #include "autostart.h"
-#include "clkguard.h"
 #include "cmdline.h"
 #include "console.h"
 #include "diskimage.h"
@@ -61,6 +60,7 @@
 #include "resources.h"
 #include "romset.h"
 #include "screenshot.h"
+#include "snapshot.h"
 #include "sound.h"
 #include "sysfile.h"
 #include "tape.h"
@@ -209,10 +209,30 @@ void machine_reset(void)
     vsync_suspend_speed_eval();
 }
 
-static void machine_maincpu_clk_overflow_callback(CLOCK sub, void *data)
+/* The machine snapshot code goes through snapshot_create() and
+   snapshot_open(), which use the selected memory snapshot instead of a
+   file.  */
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms,
+                                  int save_disks, int event_mode)
 {
-    alarm_context_time_warp(maincpu_alarm_context, sub, -1);
-    interrupt_cpu_status_time_warp(maincpu_int_status, sub, -1);
+    int err;
+
+    snapshot_memory_select(mem);
+    err = machine_write_snapshot("", save_roms, save_disks, event_mode);
+    snapshot_memory_select(NULL);
+
+    return err;
+}
+
+int machine_read_snapshot_memory(snapshot_memory_t *mem, int event_mode)
+{
+    int err;
+
+    snapshot_memory_select(mem);
+    err = machine_read_snapshot("", event_mode);
+    snapshot_memory_select(NULL);
+
+    return err;
 }
 
 void machine_maincpu_init(void)
@@ -224,12 +244,6 @@ void machine_maincpu_init(void)
 void machine_early_init(void)
 {
     maincpu_alarm_context = alarm_context_new("MainCPU");
-
-    maincpu_clk_guard = clk_guard_new(&maincpu_clk, CLOCK_MAX
-                                      - CLKGUARD_SUB_MIN);
-
-    clk_guard_add_callback(maincpu_clk_guard,
-                           machine_maincpu_clk_overflow_callback, NULL);
 }
 
 int machine_init(void)
@@ -250,9 +264,6 @@ static void machine_maincpu_shutdown(void)
     if (maincpu_alarm_context != NULL) {
         alarm_context_destroy(maincpu_alarm_context);
     }
-    if (maincpu_clk_guard != NULL) {
-        clk_guard_destroy(maincpu_clk_guard);
-    }
 
     lib_free(maincpu_monitor_interface);
     maincpu_shutdown();
@@ -425,6 +436,9 @@ int machine_common_resources_init(void)
         if (resources_register_string(resources_string) < 0) {
            return -1;
         }
+        if (screenshot_resources_init() < 0) {
+            return -1;
+        }
         if (machine_class == VICE_MACHINE_C128) {
             if (resources_register_string(resources_string_c128) < 0) {
             return -1;
@@ -475,10 +489,15 @@ static const cmdline_option_t cmdline_options_vsid[] =
 
 int machine_common_cmdline_options_init(void)
 {
+    if (machine_class == VICE_MACHINE_VSID) {
+        return cmdline_register_options(cmdline_options_vsid);
+    }
+
+    if (screenshot_cmdline_options_init() < 0) {
+        return -1;
+    }
     if (machine_class == VICE_MACHINE_C128) {
         return cmdline_register_options(cmdline_options_c128);
-    } else if (machine_class == VICE_MACHINE_VSID) {
-        return cmdline_register_options(cmdline_options_vsid);
     } else {
         return cmdline_register_options(cmdline_options);
     }
@@ -142,6 +142,12 @@ extern int machine_write_snapshot(const char *name, int save_roms,
 /* Read a snapshot.  */
 extern int machine_read_snapshot(const char *name, int even_mode);
 
+/* Write and read a snapshot kept in memory.  */
+struct snapshot_memory_s;
+extern int machine_write_snapshot_memory(struct snapshot_memory_s *mem, int save_roms,
+                                         int save_disks, int event_mode);
+extern int machine_read_snapshot_memory(struct snapshot_memory_s *mem, int event_mode);
+
 /* handle pending interrupts - needed by libsid.a.  */
 extern void machine_handle_pending_alarms(int num_write_cycles);
 
@@ -191,6 +197,7 @@ extern void machine_romset_init(void);
 extern int machine_romset_file_load(const char *filename);
 extern int machine_romset_file_save(const char *filename);
 extern char *machine_romset_file_list(void);
+extern char *machine_romset_file_crc_list(void);
 extern int machine_romset_archive_item_create(const char *romset_name);
 
 extern uint8_t machine_tape_type_default(void);
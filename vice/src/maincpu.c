@@ -31,9 +31,9 @@
 #include <stdlib.h>
 
 #include "6510core.h"
+#include "6510idle.h"
 #include "alarm.h"
 #include "archdep.h"
-#include "clkguard.h"
 #include "debug.h"
 #include "interrupt.h"
 #include "log.h"
@@ -50,6 +50,7 @@
 #include "snapshot.h"
 #include "traps.h"
 #include "types.h"
+#include "vsync.h"
 
 #ifndef EXIT_FAILURE
 #define EXIT_FAILURE 1
@@ -65,6 +66,7 @@
  - PAGE_ONE
  - STORE_IND
  - LOAD_IND
+ - MEM_IDLE_READ
 
 */
 
@@ -74,9 +76,42 @@
 
 /* ------------------------------------------------------------------------- */
 
+#ifdef MEM_IDLE_READ
+/* Busy loop detection, see maincpu_idle_loop().  */
+
+/* Loops longer than this are not examined.  */
+#define MAINCPU_IDLE_LOOP_MAX   32
+
+/* Passes through a loop before it is given up if its state keeps
+   changing.  */
+#define MAINCPU_IDLE_PASSES_MAX 4
+
+/* Cycles until a rejected loop is examined again.  */
+#define MAINCPU_IDLE_RETRY      20000
+
+/* Operands a loop may read outside of indexed memory.  */
+#define MAINCPU_IDLE_READS_MAX  8
+
+/* Value of idle_head while there is no candidate loop.  */
+#define MAINCPU_IDLE_NONE       0x10000
+
+static void maincpu_idle_candidate(unsigned int head);
+
+#define IDLE_CANDIDATE(addr)                                        \
+    do {                                                            \
+        if (last_opcode_addr - (unsigned int)(addr)                 \
+            < MAINCPU_IDLE_LOOP_MAX) {                              \
+            maincpu_idle_candidate((unsigned int)(addr));           \
+        }                                                           \
+    } while (0)
+#else
+#define IDLE_CANDIDATE(addr)
+#endif
+
 /* Implement the hack to make opcode fetches faster.  */
 #define JUMP(addr)                                                                         \
     do {                                                                                   \
+        IDLE_CANDIDATE(addr);                                                              \
         reg_pc = (unsigned int)(addr);                                                     \
         if (reg_pc >= (unsigned int)bank_limit || reg_pc < (unsigned int)bank_start) {     \
             mem_mmu_translate((unsigned int)(addr), &bank_base, &bank_start, &bank_limit); \
@@ -230,7 +265,6 @@ struct interrupt_cpu_status_s *maincpu_int_status = NULL;
 #ifndef CYCLE_EXACT_ALARM
 alarm_context_t *maincpu_alarm_context = NULL;
 #endif
-clk_guard_t *maincpu_clk_guard = NULL;
 monitor_interface_t *maincpu_monitor_interface = NULL;
 
 /* Global clock counter.  */
@@ -451,6 +485,224 @@ void maincpu_resync_limits(void)
     }
 }
 
+#ifdef MEM_IDLE_READ
+/* Busy loop detection.
+
+   Programs spend much of their time in loops waiting for an interrupt, a
+   raster line or a CIA flag.  A short loop entered by a jump backwards is a
+   candidate if it only branches, compares and loads (see 6510idle.h), and
+   MEM_IDLE_READ() knows about everything it reads: it returns the clock up
+   to which reading an address gives the same value without side effects, or
+   0 if it can't tell.  Once a pass through the loop has started with all
+   those clocks and the next alarm ahead and has ended with the same
+   registers, every following pass does exactly the same up to the earliest
+   of them, and the clock is advanced by whole passes up to there.  All the
+   chips are driven by alarms, so they end up in exactly the state they
+   would have after running the loop.
+
+   In real time the cycles saved would only be slept away in vsync, so this
+   is only done in warp mode and without video output.  */
+
+typedef struct maincpu_idle_regs_s {
+    uint8_t a, x, y, sp, p, n, z;
+} maincpu_idle_regs_t;
+
+static unsigned int idle_head = MAINCPU_IDLE_NONE;
+static unsigned int idle_len;
+static unsigned int idle_passes;
+static CLOCK idle_clk;
+static CLOCK idle_until;
+static maincpu_idle_regs_t idle_regs;
+
+/* Operands which have to be checked again before every skip.  */
+static unsigned int idle_reads[MAINCPU_IDLE_READS_MAX];
+static int idle_num_reads;
+
+static unsigned int idle_reject = MAINCPU_IDLE_NONE;
+static CLOCK idle_reject_clk;
+
+static int maincpu_idle_enabled(void)
+{
+    return video_disabled_mode || vsync_get_warp_mode();
+}
+
+/* Return nonzero if all addresses from `addr' to `addr' + 0xff (wrapping
+   within the zero page if `zero' is set) are plain memory.  */
+static int maincpu_idle_check_indexed(unsigned int addr, int zero)
+{
+    unsigned int i;
+
+    for (i = 0; i < 0x100; i++) {
+        unsigned int a = zero ? ((addr + i) & 0xff) : ((addr + i) & 0xffff);
+
+        if (MEM_IDLE_READ(a) != CLOCK_MAX) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Return nonzero if the loop from `head' to the jump back at `tail' can be
+   skipped, and collect the operands it reads.  */
+static int maincpu_idle_check_loop(unsigned int head, unsigned int tail)
+{
+    unsigned int pc = head;
+    unsigned int last_pc = head;
+    unsigned int addr = 0;
+    int mode = IDLE_OP_NONE;
+
+    idle_num_reads = 0;
+
+    while (pc <= tail) {
+        uint8_t opcode, lo, hi;
+
+        last_pc = pc;
+
+        /* the code itself must be in plain memory */
+        if (MEM_IDLE_READ(pc) != CLOCK_MAX
+            || MEM_IDLE_READ((pc + 1) & 0xffff) != CLOCK_MAX
+            || MEM_IDLE_READ((pc + 2) & 0xffff) != CLOCK_MAX) {
+            return 0;
+        }
+        opcode = mem_read((uint16_t)pc);
+        lo = mem_read((uint16_t)(pc + 1));
+        hi = mem_read((uint16_t)(pc + 2));
+
+        mode = mos6510_idle_opcode(opcode);
+        switch (mode) {
+            case IDLE_OP_IMPLIED:
+                pc += 1;
+                break;
+            case IDLE_OP_IMMEDIATE:
+                pc += 2;
+                break;
+            case IDLE_OP_ZERO:
+            case IDLE_OP_ABS:
+                addr = (mode == IDLE_OP_ZERO) ? lo : (lo | (hi << 8));
+                if (idle_num_reads == MAINCPU_IDLE_READS_MAX
+                    || MEM_IDLE_READ(addr) == 0) {
+                    return 0;
+                }
+                idle_reads[idle_num_reads++] = addr;
+                pc += (mode == IDLE_OP_ZERO) ? 2 : 3;
+                break;
+            case IDLE_OP_ZERO_INDEXED:
+                /* any index may be used, this includes the dummy read */
+                if (!maincpu_idle_check_indexed(lo, 1)) {
+                    return 0;
+                }
+                pc += 2;
+                break;
+            case IDLE_OP_ABS_INDEXED:
+                if (!maincpu_idle_check_indexed(lo | (hi << 8), 0)) {
+                    return 0;
+                }
+                pc += 3;
+                break;
+            case IDLE_OP_BRANCH:
+                addr = (pc + 2 + (signed char)lo) & 0xffff;
+                pc += 2;
+                break;
+            case IDLE_OP_JMP:
+                addr = lo | (hi << 8);
+                pc += 3;
+                break;
+            default:
+                return 0;
+        }
+    }
+
+    /* the last instruction must be the jump back */
+    return last_pc == tail && addr == head
+           && (mode == IDLE_OP_BRANCH || mode == IDLE_OP_JMP);
+}
+
+/* Called for every short jump backwards.  */
+static void maincpu_idle_candidate(unsigned int head)
+{
+    unsigned int tail = last_opcode_addr;
+
+    if (head == idle_head || !maincpu_idle_enabled()) {
+        return;
+    }
+    if (head == idle_reject
+        && maincpu_clk - idle_reject_clk < MAINCPU_IDLE_RETRY) {
+        return;
+    }
+
+    if (maincpu_idle_check_loop(head, tail)) {
+        idle_head = head;
+        idle_len = tail - head;
+        idle_passes = 0;
+    } else {
+        idle_head = MAINCPU_IDLE_NONE;
+        idle_len = 0;
+        idle_reject = head;
+        idle_reject_clk = maincpu_clk;
+    }
+}
+
+/* Called whenever the candidate loop is at its head.  */
+static void maincpu_idle_loop(const maincpu_idle_regs_t *regs)
+{
+    unsigned int pending = maincpu_int_status->global_pending_int;
+    CLOCK clk = maincpu_clk;
+    CLOCK until, period, t;
+    int i;
+
+    until = alarm_context_next_pending_clk(maincpu_alarm_context);
+    if (maincpu_clk_limit && maincpu_clk_limit < until) {
+        until = maincpu_clk_limit;
+    }
+    for (i = 0; i < idle_num_reads; i++) {
+        t = MEM_IDLE_READ(idle_reads[i]);
+        if (t < until) {
+            until = t;
+        }
+    }
+
+    /* Nothing may happen in between but the loop itself.  Breakpoints
+       and watchpoints (IK_MONITOR) must see every access.  An IRQ that is
+       held off by the I flag doesn't matter as long as the line stays
+       asserted.  */
+    if (clk >= until
+        || (pending != IK_NONE
+            && (!(pending & IK_IRQ) || (pending & ~(IK_IRQ | IK_IRQPEND))
+                || !(regs->p & P_INTERRUPT)))
+        || !maincpu_idle_enabled()) {
+        idle_passes = 0;
+        return;
+    }
+
+    /* The last pass read the same values as all following ones if it
+       started with the same registers and ended before anything could
+       change.  */
+    if (idle_passes > 0 && clk < idle_until
+        && regs->a == idle_regs.a && regs->x == idle_regs.x
+        && regs->y == idle_regs.y && regs->sp == idle_regs.sp
+        && regs->p == idle_regs.p && regs->n == idle_regs.n
+        && regs->z == idle_regs.z) {
+        period = clk - idle_clk;
+        if (period > 0) {
+            clk += (until - clk) / period * period;
+            maincpu_clk = clk;
+        }
+        /* the next pass crosses `until' and starts counting again */
+        idle_passes = 0;
+    } else if (++idle_passes > MAINCPU_IDLE_PASSES_MAX) {
+        idle_reject = idle_head;
+        idle_reject_clk = clk;
+        idle_head = MAINCPU_IDLE_NONE;
+        idle_len = 0;
+        return;
+    }
+
+    idle_clk = clk;
+    idle_until = until;
+    idle_regs = *regs;
+}
+#endif
+
 void maincpu_mainloop(void)
 {
 #ifndef C64DTV
@@ -556,6 +808,27 @@ void maincpu_mainloop(void)
 
 #define GLOBAL_REGS maincpu_regs
 
+#ifdef MEM_IDLE_READ
+        if (reg_pc - idle_head <= idle_len) {
+            if (reg_pc == idle_head) {
+                maincpu_idle_regs_t regs;
+
+                regs.a = reg_a;
+                regs.x = reg_x;
+                regs.y = reg_y;
+                regs.sp = reg_sp;
+                regs.p = reg_p;
+                regs.n = flag_n;
+                regs.z = flag_z;
+                maincpu_idle_loop(&regs);
+            }
+        } else if (idle_head != MAINCPU_IDLE_NONE) {
+            /* the loop has been left */
+            idle_head = MAINCPU_IDLE_NONE;
+            idle_len = 0;
+        }
+#endif
+
 #include "6510core.c"
 
         maincpu_int_status->num_dma_per_opcode = 0;
@@ -695,7 +968,7 @@ int maincpu_snapshot_write_module(snapshot_t *s)
     }
 
 #ifdef C64DTV
-    if (SMW_DW(m, maincpu_clk) < 0
+    if (SMW_CLOCK(m, maincpu_clk) < 0
             || SMW_B(m, MOS6510DTV_REGS_GET_A(&maincpu_regs)) < 0
             || SMW_B(m, MOS6510DTV_REGS_GET_X(&maincpu_regs)) < 0
             || SMW_B(m, MOS6510DTV_REGS_GET_Y(&maincpu_regs)) < 0
@@ -724,7 +997,7 @@ int maincpu_snapshot_write_module(snapshot_t *s)
         goto fail;
     }
 #else
-    if (SMW_DW(m, maincpu_clk) < 0
+    if (SMW_CLOCK(m, maincpu_clk) < 0
             || SMW_B(m, MOS6510_REGS_GET_A(&maincpu_regs)) < 0
             || SMW_B(m, MOS6510_REGS_GET_X(&maincpu_regs)) < 0
             || SMW_B(m, MOS6510_REGS_GET_Y(&maincpu_regs)) < 0
@@ -772,8 +1045,7 @@ int maincpu_snapshot_read_module(snapshot_t *s)
        wrong number of cycles.  */
     maincpu_rmw_flag = 0;
 
-    /* XXX: Assumes `CLOCK' is the same size as a `DWORD'.  */
-    if (SMR_DW(m, &maincpu_clk) < 0
+    if (SMR_CLOCK(m, &maincpu_clk) < 0
             || SMR_B(m, &a) < 0
             || SMR_B(m, &x) < 0
             || SMR_B(m, &y) < 0
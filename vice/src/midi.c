@@ -34,7 +34,6 @@
 
 #include "alarm.h"
 #include "archdep.h"
-#include "clkguard.h"
 #include "cmdline.h"
 #include "interrupt.h"
 #include "lib.h"
@@ -232,21 +231,12 @@ int midi_cmdline_options_init(void)
 
 /******************************************************************/
 
-static void clk_overflow_callback(CLOCK sub, void *var)
-{
-    if (alarm_active) {
-        midi_alarm_clk -= sub;
-    }
-}
-
 void midi_init(void)
 {
     midi_int_num = interrupt_cpu_status_int_new(maincpu_int_status, "MIDI");
 
     midi_alarm = alarm_new(maincpu_alarm_context, "MIDI", int_midi, NULL);
 
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
-
     if (midi_log == LOG_ERR) {
         midi_log = log_open("MIDI");
     }
@@ -510,7 +500,7 @@ static void int_midi(CLOCK offset, void *data)
    DWORD | IRQ res      | IRQ res
    BYTE  | mode         | midi mode
    DWORD | int num      | interrupt number
-   DWORD | alarm clk    | alarm clock
+   CLOCK | alarm clk    | alarm clock
  */
 
 static char snap_module_name[] = "MIDI";
@@ -542,7 +532,7 @@ int midi_snapshot_write_module(snapshot_t *s)
         || SMW_DW(m, (uint32_t)midi_irq_res) < 0
         || SMW_B(m, (uint8_t)midi_mode) < 0
         || SMW_DW(m, (uint32_t)midi_int_num) < 0
-        || SMW_DW(m, (uint32_t)midi_alarm_clk) < 0) {
+        || SMW_CLOCK(m, midi_alarm_clk) < 0) {
         snapshot_module_close(m);
         return -1;
     }
@@ -554,7 +544,6 @@ int midi_snapshot_read_module(snapshot_t *s)
 {
     uint8_t vmajor, vminor;
     snapshot_module_t *m;
-    uint32_t tmpc;
 
     m = snapshot_module_open(s, snap_module_name, &vmajor, &vminor);
 
@@ -583,12 +572,10 @@ int midi_snapshot_read_module(snapshot_t *s)
         || SMR_DW_INT(m, &midi_irq_res) < 0
         || SMR_B_INT(m, &midi_mode) < 0
         || SMR_DW_UINT(m, &midi_int_num) < 0
-        || SMR_DW(m, &tmpc) < 0) {
+        || SMR_CLOCK(m, &midi_alarm_clk) < 0) {
         goto fail;
     }
 
-    midi_alarm_clk = (CLOCK)tmpc;
-
     return snapshot_module_close(m);
 
 fail:
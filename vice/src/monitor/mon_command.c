@@ -680,6 +680,13 @@ static const mon_cmds_t mon_cmd_array[] = {
       NO_FILENAME_ARG
     },
 
+    { "histseek", "",
+      "<seconds>",
+      "Continue the event history being played back at the given time, it is\n"
+      "replayed from the nearest keyframe snapshot before it.",
+      NO_FILENAME_ARG
+    },
+
     { "keybuf", "",
       "\"<string>\"",
       "Put the specified string into the keyboard buffer.",
@@ -90,6 +90,7 @@
 #include "uiapi.h"
 #include "uimon.h"
 #include "util.h"
+#include "vice-event.h"
 #include "vsync.h"
 
 int mon_stop_output;
@@ -1095,6 +1096,15 @@ void mon_tape_ctrl(int command)
     }
 }
 
+void mon_history_seek(int seconds)
+{
+    if (seconds < 0) {
+        mon_out("Invalid time.\n");
+    } else if (event_playback_seek((unsigned int)seconds) < 0) {
+        mon_out("Not playing back an event history.\n");
+    }
+}
+
 void mon_cart_freeze(void)
 {
     if (mon_cart_cmd.cartridge_trigger_freeze != NULL) {
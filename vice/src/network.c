@@ -38,6 +38,10 @@
 #include <strings.h>
 #endif
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include "archdep.h"
 #include "cmdline.h"
 #include "interrupt.h"
@@ -48,6 +52,7 @@
 #include "mos6510.h"
 #include "network.h"
 #include "resources.h"
+#include "snapshot.h"
 #include "types.h"
 #include "uiapi.h"
 #include "util.h"
@@ -76,7 +81,83 @@ static int network_control;
 static int frame_buffer_full;
 static int current_frame, frame_to_play;
 static event_list_state_t *frame_event_list = NULL;
-static char *snapshotfilename;
+
+/* Snapshot transferred when connecting.  The client keeps the last one it
+   received, so that on reconnecting the server only needs to send the
+   modules that have changed since.  */
+static snapshot_memory_t *network_snapshot = NULL;
+
+/* The snapshot is sent in chunks, to show the progress.  */
+#define NETWORK_SNAPSHOT_CHUNK  (64 * 1024)
+
+/* Compression of the snapshot transfer.  */
+#define NETWORK_SNAPSHOT_RAW    0
+#define NETWORK_SNAPSHOT_ZLIB   1
+
+/* The server opens the connection with a hello of the magic and its
+   protocol version, and the client answers with its own.  Older servers
+   start with the snapshot size instead, and the magic has the top bit set
+   so that older clients can't take it for one.  */
+#define NETWORK_PROTOCOL_MAGIC      0xfe504e56
+#define NETWORK_PROTOCOL_VERSION    2
+
+/* Seconds the server waits for the client to answer the hello.  */
+#define NETWORK_HELLO_TIMEOUT       5
+
+/* Larger snapshots, digests or settings lists come from a broken peer.  */
+#define NETWORK_TRANSFER_MAX    (256 * 1024 * 1024)
+
+/* Rollback mode.  Instead of delaying all input by `frame_delta' frames,
+   local input is applied right away and the remote input is predicted to
+   stay unchanged.  Every frame starts with a memory snapshot.  When the
+   input of the remote host turns out to differ from the prediction, the
+   snapshot of that frame is restored and the frames up to the current one
+   are emulated again without video and sound.  */
+#define NETWORK_ROLLBACK_MAX 25
+
+typedef struct network_frame_s {
+    /* Local input, applied at the start of the frame.  */
+    event_list_state_t local;
+
+    /* Remote input, valid for frames before `remote_frame'.  */
+    event_list_state_t *remote;
+
+    /* Machine state at the start of frame `num'.  */
+    snapshot_memory_t *snapshot;
+    unsigned int num;
+
+    /* CPU registers at the start of frame `num', compared with the
+       remote host once the frame can't be rolled back anymore.  */
+    uint8_t sync[5 * 4];
+} network_frame_t;
+
+/* Resource, maximum number of frames to predict.  0 means lockstep.  */
+static int rollback_frames;
+
+/* Number of frames to predict, as agreed on when connecting.  */
+static int rollback_window;
+
+/* Ring of `frames_num' frames, indexed by frame number.  */
+static network_frame_t *frames = NULL;
+static unsigned int frames_num;
+
+/* Next frame to start.  */
+static unsigned int frame_num;
+
+/* Frame collecting local input.  Frames before it have been sent.  */
+static unsigned int send_frame;
+
+/* Remote input is known for frames before this one.  */
+static unsigned int remote_frame;
+
+/* First frame whose remote input was mispredicted.  */
+static unsigned int rollback_to;
+static int rollback_pending;
+
+/* Latest final frame of the remote host and its registers.  */
+static unsigned int remote_sync_frame;
+static uint8_t remote_sync[5 * 4];
+static int remote_sync_valid;
 
 static int set_server_name(const char *val, void *param)
 {
@@ -103,6 +184,17 @@ static int set_server_port(int val, void *param)
     return 0;
 }
 
+static int set_rollback_frames(int val, void *param)
+{
+    if (val < 0 || val > NETWORK_ROLLBACK_MAX) {
+        return -1;
+    }
+
+    rollback_frames = val;
+
+    return 0;
+}
+
 static int set_network_control(int val, void *param)
 {
     network_control = val;
@@ -128,6 +220,8 @@ static const resource_int_t resources_int[] = {
       &res_server_port, set_server_port, NULL },
     { "NetworkControl", NETWORK_CONTROL_DEFAULT, RES_EVENT_SAME, NULL,
       &network_control, set_network_control, NULL },
+    { "NetworkRollbackFrames", 0, RES_EVENT_NO, NULL,
+      &rollback_frames, set_rollback_frames, NULL },
     RESOURCE_INT_LIST_END
 };
 
@@ -212,6 +306,9 @@ static const cmdline_option_t cmdline_options[] =
     { "-netplayctrl", CALL_FUNCTION, CMDLINE_ATTRIB_NEED_ARGS,
       network_control_cmd, NULL, NULL, NULL,
       "<key,joy1,joy2,dev,rsrc>", "Set the netplay control elements (keyboard, joystick1, joystick2, devices and resources), each item takes a value (0: None, 1: Server, 2: Client, 3: Both)" },
+    { "-netplayrollback", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "NetworkRollbackFrames", NULL,
+      "<frames>", "Apply local input right away and roll back up to <frames> frames when the remote input was mispredicted (0: delay all input instead). Set on the server." },
     CMDLINE_LIST_END
 };
 
@@ -223,6 +320,8 @@ int network_cmdline_options_init(void)
 
 /*---------------------------------------------------------------------*/
 
+static void network_rollback_free(void);
+
 static void network_free_frame_event_list(void)
 {
     int i;
@@ -234,6 +333,7 @@ static void network_free_frame_event_list(void)
         lib_free(frame_event_list);
         frame_event_list = NULL;
     }
+    network_rollback_free();
     event_destroy_image_list();
 }
 
@@ -265,11 +365,60 @@ static void network_prepare_next_frame(void)
 {
     current_frame = (current_frame + 1) % frame_delta;
     frame_to_play = (current_frame + 1) % frame_delta;
-    event_clear_list(&(frame_event_list[current_frame]));
-    event_register_event_list(&(frame_event_list[current_frame]));
+    event_reset_list(&(frame_event_list[current_frame]));
     interrupt_maincpu_trigger_trap(network_event_record_sync_test, (void *)0);
 }
 
+/* List collecting the local input.  */
+static event_list_state_t *network_record_list(void)
+{
+    if (rollback_window > 0) {
+        return &(frames[send_frame % frames_num].local);
+    }
+    return &(frame_event_list[current_frame]);
+}
+
+static void network_rollback_free(void)
+{
+    unsigned int i;
+
+    if (frames != NULL) {
+        for (i = 0; i < frames_num; i++) {
+            event_clear_list(&(frames[i].local));
+            if (frames[i].remote != NULL) {
+                event_clear_list(frames[i].remote);
+                lib_free(frames[i].remote);
+            }
+            snapshot_memory_free(frames[i].snapshot);
+        }
+        lib_free(frames);
+        frames = NULL;
+    }
+    rollback_window = 0;
+}
+
+static void network_rollback_init(int window)
+{
+    unsigned int i;
+
+    /* Frames that may be rolled back, plus those the remote host may be
+       ahead.  */
+    rollback_window = window;
+    frames_num = 2 * window + 2;
+    frames = lib_calloc(frames_num, sizeof(network_frame_t));
+    for (i = 0; i < frames_num; i++) {
+        event_register_event_list(&(frames[i].local));
+        frames[i].snapshot = snapshot_memory_new();
+        frames[i].num = (unsigned int)-1;
+    }
+    frame_num = 0;
+    send_frame = 0;
+    remote_frame = 0;
+    rollback_pending = 0;
+    remote_sync_valid = 0;
+    event_init_image_list();
+}
+
 static unsigned int network_create_event_buffer(uint8_t **buf,
                                                 event_list_state_t *list)
 {
@@ -285,12 +434,12 @@ static unsigned int network_create_event_buffer(uint8_t **buf,
 
     /* calculate the buffer length */
     num_of_events = 0;
-    current_event = list->base;
+    current_event = event_list_first(list);
     do {
         num_of_events++;
         data_len += current_event->size;
         last_event = current_event;
-        current_event = current_event->next;
+        current_event = event_list_next(current_event);
     } while (last_event->type != EVENT_LIST_END);
 
     size = num_of_events * 3 * sizeof(uint32_t) + data_len;
@@ -298,16 +447,18 @@ static unsigned int network_create_event_buffer(uint8_t **buf,
     *buf = lib_malloc(size);
 
     /* fill the buffer with the events */
-    current_event = list->base;
+    current_event = event_list_first(list);
     bufptr = *buf;
     do {
         util_dword_to_le_buf(&bufptr[0], (uint32_t)(current_event->type));
         util_dword_to_le_buf(&bufptr[4], (uint32_t)(current_event->clk));
         util_dword_to_le_buf(&bufptr[8], (uint32_t)(current_event->size));
-        memcpy(&bufptr[12], current_event->data, current_event->size);
+        if (current_event->size > 0) {
+            memcpy(&bufptr[12], event_list_data(current_event), current_event->size);
+        }
         bufptr += 12 + current_event->size;
         last_event = current_event;
-        current_event = current_event->next;
+        current_event = event_list_next(current_event);
     } while (last_event->type != EVENT_LIST_END);
 
     return size;
@@ -343,8 +494,9 @@ static int network_recv_buffer(vice_network_socket_t * s, uint8_t *buf, int len)
     while (received_total < len) {
         t = vice_network_receive(s, buf, len - received_total, 0);
 
-        if (t < 0) {
-            return t;
+        if (t <= 0) {
+            /* the remote host closed the connection */
+            return -1;
         }
 
         received_total += t;
@@ -384,10 +536,186 @@ typedef struct {
     unsigned char buf[0x60];
 } testpacket;
 
+static int network_transfer_chunked(uint8_t *buf, size_t size, int send,
+                                    const char *text)
+{
+    size_t pos, len;
+    unsigned int percent, last_percent = 101;
+    char st[64];
+
+    for (pos = 0; pos < size; pos += len) {
+        len = size - pos;
+        if (len > NETWORK_SNAPSHOT_CHUNK) {
+            len = NETWORK_SNAPSHOT_CHUNK;
+        }
+
+        percent = (unsigned int)((uint64_t)pos * 100 / size);
+        if (percent != last_percent) {
+            sprintf(st, "%s... %u%%", text, percent);
+            ui_display_statustext(st, 0);
+            last_percent = percent;
+        }
+
+        if ((send ? network_send_buffer(network_socket, buf + pos, (int)len)
+                  : network_recv_buffer(network_socket, buf + pos, (int)len)) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int network_send_hello(void)
+{
+    uint8_t hello[2 * 4];
+
+    util_int_to_le_buf4(&hello[0], (int)NETWORK_PROTOCOL_MAGIC);
+    util_int_to_le_buf4(&hello[4], NETWORK_PROTOCOL_VERSION);
+    return network_send_buffer(network_socket, hello, sizeof(hello));
+}
+
+/* Receive the hello of the remote host and return its protocol version,
+   or -1 if it does not send one.  */
+static int network_recv_hello(void)
+{
+    uint8_t hello[2 * 4];
+
+    if (network_recv_buffer(network_socket, hello, sizeof(hello)) < 0
+        || (unsigned int)util_le_buf4_to_int(&hello[0]) != NETWORK_PROTOCOL_MAGIC) {
+        return -1;
+    }
+    return util_le_buf4_to_int(&hello[4]);
+}
+
+/* Wait up to `seconds' for data from the remote host.  */
+static int network_wait_for_data(unsigned int seconds)
+{
+    unsigned long start = vsyncarch_gettime();
+
+    while (vice_network_select_poll_one(network_socket) == 0) {
+        if (vsyncarch_gettime() - start > vsyncarch_frequency() * seconds) {
+            return -1;
+        }
+        vsyncarch_sleep(vsyncarch_frequency() / 100);
+    }
+    return 0;
+}
+
+/* Read a size from the stream and check it.  */
+static int network_recv_size(size_t *size)
+{
+    uint8_t buf4[4];
+    unsigned int val;
+
+    if (network_recv_buffer(network_socket, buf4, 4) < 0) {
+        return -1;
+    }
+    val = (unsigned int)util_le_buf4_to_int(buf4);
+    if (val > NETWORK_TRANSFER_MAX) {
+        log_error(LOG_DEFAULT, "Netplay: remote host sent invalid size %u.", val);
+        return -1;
+    }
+    *size = (size_t)val;
+    return 0;
+}
+
+/* Send a snapshot, compressed if the receiver can handle it.  */
+static int network_send_snapshot(snapshot_memory_t *mem, int compress)
+{
+    uint8_t *buf;
+    uint8_t *packed = NULL;
+    size_t size, send_size;
+    uint8_t header[3 * 4];
+    int method = NETWORK_SNAPSHOT_RAW;
+    int ret;
+
+    buf = (uint8_t *)snapshot_memory_get_data(mem, &size);
+    send_size = size;
+    if (size > NETWORK_TRANSFER_MAX) {
+        log_error(LOG_DEFAULT, "Netplay: snapshot too large to send (%u bytes).",
+                  (unsigned int)size);
+        return -1;
+    }
+
+#ifdef HAVE_ZLIB
+    if (compress) {
+        uLongf packed_size = compressBound((uLong)size);
+
+        packed = lib_malloc(packed_size);
+        if (compress2(packed, &packed_size, buf, (uLong)size, Z_BEST_SPEED) == Z_OK
+            && packed_size < size) {
+            method = NETWORK_SNAPSHOT_ZLIB;
+            buf = packed;
+            send_size = packed_size;
+        }
+    }
+#endif
+
+    log_debug("netplay snapshot: %u bytes, sending %u bytes.",
+              (unsigned int)size, (unsigned int)send_size);
+
+    util_int_to_le_buf4(&header[0], method);
+    util_int_to_le_buf4(&header[4], (int)size);
+    util_int_to_le_buf4(&header[8], (int)send_size);
+
+    ret = network_send_buffer(network_socket, header, sizeof(header));
+    if (ret >= 0) {
+        ret = network_transfer_chunked(buf, send_size, 1, "Sending snapshot to client");
+    }
+
+    lib_free(packed);
+    return ret;
+}
+
+static int network_recv_snapshot(snapshot_memory_t *mem)
+{
+    uint8_t *buf;
+    size_t size, recv_size;
+    uint8_t method4[4];
+    int method;
+
+    if (network_recv_buffer(network_socket, method4, 4) < 0
+        || network_recv_size(&size) < 0
+        || network_recv_size(&recv_size) < 0) {
+        return -1;
+    }
+    method = util_le_buf4_to_int(method4);
+
+    buf = lib_malloc(recv_size);
+    if (network_transfer_chunked(buf, recv_size, 0, "Receiving snapshot from server") < 0) {
+        lib_free(buf);
+        return -1;
+    }
+
+    if (method == NETWORK_SNAPSHOT_RAW && recv_size == size) {
+        snapshot_memory_set_data(mem, buf, size);
+#ifdef HAVE_ZLIB
+    } else if (method == NETWORK_SNAPSHOT_ZLIB) {
+        uint8_t *unpacked = lib_malloc(size);
+        uLongf unpacked_size = (uLongf)size;
+
+        if (uncompress(unpacked, &unpacked_size, buf, (uLong)recv_size) != Z_OK
+            || unpacked_size != size) {
+            lib_free(unpacked);
+            lib_free(buf);
+            return -1;
+        }
+        snapshot_memory_set_data(mem, unpacked, size);
+        lib_free(unpacked);
+#endif
+    } else {
+        lib_free(buf);
+        return -1;
+    }
+
+    lib_free(buf);
+    return 0;
+}
+
 static void network_test_delay(void)
 {
     int i, j;
     uint8_t new_frame_delta;
+    uint8_t new_rollback_window;
     unsigned char *buf;
     testpacket pkt;
 
@@ -430,8 +758,11 @@ static void network_test_delay(void)
         new_frame_delta = 5 + (uint8_t)(vsync_get_refresh_frequency()
                                      * packet_delay[(int)(0.1 * NUM_OF_TESTPACKETS)]
                                      / (float)vsyncarch_frequency());
+        new_rollback_window = (uint8_t)rollback_frames;
         network_send_buffer(network_socket, &new_frame_delta,
                             sizeof(new_frame_delta));
+        network_send_buffer(network_socket, &new_rollback_window,
+                            sizeof(new_rollback_window));
     } else {
         /* network_mode == NETWORK_CLIENT */
         for (i = 0; i < NUM_OF_TESTPACKETS; i++) {
@@ -442,51 +773,98 @@ static void network_test_delay(void)
         }
         network_recv_buffer(network_socket, &new_frame_delta,
                             sizeof(new_frame_delta));
+        network_recv_buffer(network_socket, &new_rollback_window,
+                            sizeof(new_rollback_window));
     }
     network_free_frame_event_list();
     frame_delta = new_frame_delta;
-    network_init_frame_event_list();
-    sprintf(st, "Using %d frames delay.", frame_delta);
-    log_debug("netplay connected with %d frames delta.", frame_delta);
+    if (new_rollback_window > 0 && new_rollback_window <= NETWORK_ROLLBACK_MAX) {
+        network_rollback_init(new_rollback_window);
+        sprintf(st, "Rolling back up to %d frames.", rollback_window);
+        log_debug("netplay connected with up to %d frames rollback.", rollback_window);
+    } else {
+        network_init_frame_event_list();
+        sprintf(st, "Using %d frames delay.", frame_delta);
+        log_debug("netplay connected with %d frames delta.", frame_delta);
+    }
     ui_display_statustext(st, 1);
 }
 
+/* Drop a client that can't be served, the server keeps listening.  */
+static void network_drop_client(void)
+{
+    vice_network_socket_close(network_socket);
+    network_socket = NULL;
+}
+
 static void network_server_connect_trap(uint16_t addr, void *data)
 {
-    FILE *f;
     uint8_t *buf;
     size_t buf_size;
     uint8_t send_size4[4];
+    uint8_t recv_buf4[4];
+    int compress;
+    int version;
     long i;
     event_list_state_t settings_list;
+    snapshot_memory_t *digest;
+    snapshot_memory_t *delta;
 
     vsync_suspend_speed_eval();
 
+    /* An older client doesn't answer, don't wait for it forever */
+    if (network_send_hello() < 0
+        || network_wait_for_data(NETWORK_HELLO_TIMEOUT) < 0
+        || (version = network_recv_hello()) < 0) {
+        ui_error("Client does not support this netplay protocol");
+        network_drop_client();
+        return;
+    }
+    if (version != NETWORK_PROTOCOL_VERSION) {
+        ui_error("Client uses netplay protocol version %d, expecting %d",
+                 version, NETWORK_PROTOCOL_VERSION);
+        network_drop_client();
+        return;
+    }
+
+    /* The client tells whether it can decompress and which snapshot modules
+       it has already.  */
+    if (network_recv_buffer(network_socket, recv_buf4, 4) < 0
+        || network_recv_size(&buf_size) < 0) {
+        ui_error("Cannot receive snapshot request from client");
+        network_drop_client();
+        return;
+    }
+    compress = util_le_buf4_to_int(recv_buf4) & 1;
+    buf = lib_malloc(buf_size);
+    if (network_recv_buffer(network_socket, buf, (int)buf_size) < 0) {
+        ui_error("Cannot receive snapshot request from client");
+        lib_free(buf);
+        network_drop_client();
+        return;
+    }
+    digest = snapshot_memory_new();
+    snapshot_memory_set_data(digest, buf, buf_size);
+    lib_free(buf);
+
     /* Create snapshot and send it */
-    snapshotfilename = archdep_tmpnam();
-    if (machine_write_snapshot(snapshotfilename, 1, 1, 0) == 0) {
-        f = fopen(snapshotfilename, MODE_READ);
-        if (f == NULL) {
-            ui_error("Cannot load snapshot file for transfer");
-            lib_free(snapshotfilename);
-            return;
-        }
-        buf_size = util_file_length(f);
-        buf = lib_malloc(buf_size);
-        if (fread(buf, 1, buf_size, f) == 0) {
-            log_debug("network_server_connect_trap read failed.");
+    if (network_snapshot == NULL) {
+        network_snapshot = snapshot_memory_new();
+    }
+    if (machine_write_snapshot_memory(network_snapshot, 1, 1, 0) == 0) {
+        delta = snapshot_memory_new();
+        if (snapshot_memory_get_delta(network_snapshot, digest, delta) < 0) {
+            /* send everything */
+            buf = (uint8_t *)snapshot_memory_get_data(network_snapshot, &buf_size);
+            snapshot_memory_set_data(delta, buf, buf_size);
         }
-        fclose(f);
+        snapshot_memory_free(digest);
 
-        ui_display_statustext("Sending snapshot to client...", 0);
-        util_int_to_le_buf4(send_size4, (int)buf_size);
-        network_send_buffer(network_socket, send_size4, 4);
-        i = network_send_buffer(network_socket, buf, (int)buf_size);
-        lib_free(buf);
+        i = network_send_snapshot(delta, compress);
+        snapshot_memory_free(delta);
         if (i < 0) {
             ui_error("Cannot send snapshot to client");
             ui_display_statustext("", 0);
-            lib_free(snapshotfilename);
             return;
         }
 
@@ -510,16 +888,15 @@ static void network_server_connect_trap(uint16_t addr, void *data)
 
         network_test_delay();
     } else {
-        ui_error("Cannot create snapshot file %s", snapshotfilename);
+        snapshot_memory_free(digest);
+        ui_error("Cannot create snapshot for transfer");
     }
-    lib_free(snapshotfilename);
 }
 
 static void network_client_connect_trap(uint16_t addr, void *data)
 {
     uint8_t *buf;
     size_t buf_size;
-    uint8_t recv_buf4[4];
     event_list_state_t *settings_list;
 
     /* Set proper settings */
@@ -528,14 +905,14 @@ static void network_client_connect_trap(uint16_t addr, void *data)
     }
 
     /* Receive settings that need to be same as on server */
-    if (network_recv_buffer(network_socket, recv_buf4, 4) < 0) {
+    if (network_recv_size(&buf_size) < 0) {
         return;
     }
 
-    buf_size = (size_t)util_le_buf4_to_int(recv_buf4);
     buf = lib_malloc(buf_size);
 
     if (network_recv_buffer(network_socket, buf, (int)buf_size) < 0) {
+        lib_free(buf);
         return;
     }
 
@@ -548,9 +925,8 @@ static void network_client_connect_trap(uint16_t addr, void *data)
     lib_free(settings_list);
 
     /* read the snapshot */
-    if (machine_read_snapshot(snapshotfilename, 0) != 0) {
-        ui_error("Cannot open snapshot file %s", snapshotfilename);
-        lib_free(snapshotfilename);
+    if (machine_read_snapshot_memory(network_snapshot, 0) != 0) {
+        ui_error("Cannot read snapshot received from server");
         return;
     }
 
@@ -560,7 +936,6 @@ static void network_client_connect_trap(uint16_t addr, void *data)
     network_mode = NETWORK_CLIENT;
 
     network_test_delay();
-    lib_free(snapshotfilename);
 }
 
 /*-------------------------------------------------------------------------*/
@@ -607,7 +982,23 @@ void network_event_record(unsigned int type, void *data, unsigned int size)
         return;
     }
 
-    event_record_in_list(&(frame_event_list[current_frame]), type, data, size);
+    if (rollback_window > 0
+        && (type == EVENT_KEYBOARD_DELAY || type == EVENT_JOYSTICK_DELAY)
+        && size == 4) {
+        /* The key or joystick value must be latched before the next frame
+           starts, as the snapshot taken there doesn't hold pending
+           alarms.  */
+        uint8_t delay[4];
+        unsigned int max_delay = (unsigned int)machine_get_cycles_per_frame() / 2;
+
+        if ((unsigned int)util_le_buf4_to_int(data) > max_delay) {
+            util_int_to_le_buf4(delay, (int)max_delay);
+            event_record_in_list(network_record_list(), type, (void *)delay, size);
+            return;
+        }
+    }
+
+    event_record_in_list(network_record_list(), type, data, size);
 }
 
 void network_attach_image(unsigned int unit, const char *filename)
@@ -625,7 +1016,7 @@ void network_attach_image(unsigned int unit, const char *filename)
         return;
     }
 
-    event_record_attach_in_list(&(frame_event_list[current_frame]), unit, drive, filename, 1);
+    event_record_attach_in_list(network_record_list(), unit, drive, filename, 1);
 }
 
 int network_get_mode(void)
@@ -687,10 +1078,13 @@ int network_start_server(void)
 int network_connect_client(void)
 {
     vice_network_socket_address_t * server_addr;
-    FILE *f;
-    uint8_t *buf;
-    uint8_t recv_buf4[4];
+    const uint8_t *buf;
+    uint8_t send_buf4[4];
     size_t buf_size;
+    snapshot_memory_t *digest;
+    snapshot_memory_t *delta;
+    int version;
+    int ret;
 
     if (network_mode != NETWORK_IDLE) {
         return -1;
@@ -698,14 +1092,6 @@ int network_connect_client(void)
 
     vsync_suspend_speed_eval();
 
-    snapshotfilename = NULL;
-
-    f = archdep_mkstemp_fd(&snapshotfilename, MODE_WRITE);
-    if (f == NULL) {
-        ui_error("Cannot create snapshot file. Select different history directory!");
-        return -1;
-    }
-
     server_addr = vice_network_address_generate(server_name, server_port);
     if (server_addr == NULL) {
         ui_error("Cannot resolve %s", server_name);
@@ -718,31 +1104,65 @@ int network_connect_client(void)
 
     if (!network_socket) {
         ui_error("Cannot connect to %s (no server running on port %d).", server_name, server_port);
-        lib_free(snapshotfilename);
         return -1;
     }
 
-    ui_display_statustext("Receiving snapshot from server...", 0);
-    if (network_recv_buffer(network_socket, recv_buf4, 4) < 0) {
-        lib_free(snapshotfilename);
+    version = network_recv_hello();
+    if (version != NETWORK_PROTOCOL_VERSION) {
+        if (version < 0) {
+            ui_error("Server does not support this netplay protocol");
+        } else {
+            ui_error("Server uses netplay protocol version %d, expecting %d",
+                     version, NETWORK_PROTOCOL_VERSION);
+        }
         vice_network_socket_close(network_socket);
         return -1;
     }
 
-    buf_size = (size_t)util_le_buf4_to_int(recv_buf4);
-    buf = lib_malloc(buf_size);
+    /* Tell the server which snapshot modules are here already */
+    if (network_snapshot == NULL) {
+        network_snapshot = snapshot_memory_new();
+    }
+    digest = snapshot_memory_new();
+    if (snapshot_memory_get_digest(network_snapshot, digest) < 0) {
+        snapshot_memory_set_data(digest, NULL, 0);
+    }
+    buf = snapshot_memory_get_data(digest, &buf_size);
 
-    if (network_recv_buffer(network_socket, buf, (int)buf_size) < 0) {
-        lib_free(snapshotfilename);
-        vice_network_socket_close(network_socket);
-        return -1;
+    ret = network_send_hello();
+#ifdef HAVE_ZLIB
+    util_int_to_le_buf4(send_buf4, 1);
+#else
+    util_int_to_le_buf4(send_buf4, 0);
+#endif
+    if (ret >= 0) {
+        ret = network_send_buffer(network_socket, send_buf4, 4);
+    }
+    util_int_to_le_buf4(send_buf4, (int)buf_size);
+    if (ret >= 0) {
+        ret = network_send_buffer(network_socket, send_buf4, 4);
+    }
+    if (ret >= 0) {
+        ret = network_send_buffer(network_socket, buf, (int)buf_size);
     }
+    snapshot_memory_free(digest);
 
-    if (fwrite(buf, 1, buf_size, f) == 0) {
-        log_debug("network_connect_client write failed.");
+    ui_display_statustext("Receiving snapshot from server...", 0);
+    delta = snapshot_memory_new();
+    if (ret >= 0) {
+        ret = network_recv_snapshot(delta);
+    }
+    if (ret >= 0) {
+        ret = snapshot_memory_apply_delta(network_snapshot, delta);
+    }
+    snapshot_memory_free(delta);
+
+    if (ret < 0) {
+        ui_error("Cannot receive snapshot from server");
+        ui_display_statustext("", 0);
+        vice_network_socket_close(network_socket);
+        return -1;
     }
-    fclose(f);
-    lib_free(buf);
 
     interrupt_maincpu_trigger_trap(network_client_connect_trap, (void *)0);
     vsync_suspend_speed_eval();
@@ -752,6 +1172,7 @@ int network_connect_client(void)
 
 void network_disconnect(void)
 {
+    vsync_set_catch_up(0);
     vice_network_socket_close(network_socket);
     if (network_mode == NETWORK_SERVER_CONNECTED) {
         network_mode = NETWORK_SERVER;
@@ -786,7 +1207,7 @@ static void network_hook_connected_send(void)
 
     /* create and send current event buffer */
     network_event_record(EVENT_LIST_END, NULL, 0);
-    send_len = network_create_event_buffer(&local_event_buf, &(frame_event_list[current_frame]));
+    send_len = network_create_event_buffer(&local_event_buf, network_record_list());
 
 #ifdef NETWORK_DEBUG
     t1 = vsyncarch_gettime();
@@ -864,13 +1285,14 @@ static void network_hook_connected_receive(void)
         }
 
         /* test for sync */
-        if (client_event_list->base->type == EVENT_SYNC_TEST
-            && server_event_list->base->type == EVENT_SYNC_TEST) {
+        if (event_list_first(client_event_list)->type == EVENT_SYNC_TEST
+            && event_list_first(server_event_list)->type == EVENT_SYNC_TEST) {
+            uint32_t *client_sync = event_list_data(event_list_first(client_event_list));
+            uint32_t *server_sync = event_list_data(event_list_first(server_event_list));
             int i;
 
             for (i = 0; i < 5; i++) {
-                if (((uint32_t *)client_event_list->base->data)[i]
-                    != ((uint32_t *)server_event_list->base->data)[i]) {
+                if (client_sync[i] != server_sync[i]) {
                     ui_error("Network out of sync - disconnecting.");
                     network_disconnect();
                     /* shouldn't happen but resyncing would be nicer */
@@ -892,6 +1314,214 @@ static void network_hook_connected_receive(void)
 #endif
 }
 
+/* Send the local input of the frame about to start.  */
+static void network_rollback_send(void)
+{
+    network_frame_t *frame;
+    unsigned int final_frame;
+    uint8_t syncbuf[6 * 4];
+
+    /* Tell the remote host the registers of the latest frame that can't be
+       rolled back anymore.  */
+    if (frame_num > 0) {
+        final_frame = remote_frame < frame_num - 1 ? remote_frame : frame_num - 1;
+        frame = &frames[final_frame % frames_num];
+        if (frame->num == final_frame) {
+            util_dword_to_le_buf(&syncbuf[0], (uint32_t)final_frame);
+            memcpy(&syncbuf[4], frame->sync, sizeof(frame->sync));
+            event_record_in_list(network_record_list(), EVENT_SYNC_TEST,
+                                 (void *)syncbuf, sizeof(syncbuf));
+        }
+    }
+
+    network_hook_connected_send();
+
+    send_frame++;
+    frame = &frames[send_frame % frames_num];
+    event_reset_list(&(frame->local));
+}
+
+/* Take the remote input that has arrived, and wait for it if the remote host
+   is too far behind.  */
+static int network_rollback_receive(void)
+{
+    uint8_t *remote_event_buf;
+    unsigned int recv_len;
+    uint8_t recv_len4[4];
+    event_list_state_t *remote_event_list;
+    event_list_t *event;
+    network_frame_t *frame;
+    int remote_suspended = 0;
+
+    while (remote_frame < frame_num + rollback_window) {
+        if (frame_num <= remote_frame + rollback_window
+            && vice_network_select_poll_one(network_socket) <= 0) {
+            break;
+        }
+
+        if (network_recv_buffer(network_socket, recv_len4, 4) < 0) {
+            return -1;
+        }
+
+        recv_len = util_le_buf4_to_int(recv_len4);
+        if (recv_len == 0) {
+            /* remote host suspended emulation */
+            ui_display_statustext("Remote host suspending...", 0);
+            remote_suspended = 1;
+            vsync_suspend_speed_eval();
+            continue;
+        }
+        if (remote_suspended) {
+            ui_display_statustext("", 0);
+            remote_suspended = 0;
+        }
+
+        remote_event_buf = lib_malloc(recv_len);
+
+        if (network_recv_buffer(network_socket, remote_event_buf,
+                                recv_len) < 0) {
+            lib_free(remote_event_buf);
+            return -1;
+        }
+
+        remote_event_list = network_create_event_list(remote_event_buf);
+        lib_free(remote_event_buf);
+
+        frame = &frames[remote_frame % frames_num];
+        if (frame->remote != NULL) {
+            event_clear_list(frame->remote);
+            lib_free(frame->remote);
+        }
+        frame->remote = remote_event_list;
+
+        for (event = event_list_first(remote_event_list);
+             event->type != EVENT_LIST_END; event = event_list_next(event)) {
+            if (event->type == EVENT_SYNC_TEST) {
+                if (event->size == 6 * 4) {
+                    remote_sync_frame = util_le_buf_to_dword(event_list_data(event));
+                    memcpy(remote_sync, (uint8_t *)event_list_data(event) + 4,
+                           sizeof(remote_sync));
+                    remote_sync_valid = 1;
+                }
+            } else if (remote_frame < frame_num && !rollback_pending) {
+                /* the frame has been emulated without this input */
+                rollback_to = remote_frame;
+                rollback_pending = 1;
+            }
+        }
+
+        remote_frame++;
+    }
+
+    return 0;
+}
+
+static void network_rollback_check_sync(void)
+{
+    network_frame_t *frame = &frames[remote_sync_frame % frames_num];
+
+    if (remote_sync_valid
+        && frame->num == remote_sync_frame
+        && remote_sync_frame <= remote_frame
+        && remote_sync_frame < frame_num) {
+        remote_sync_valid = 0;
+        if (memcmp(frame->sync, remote_sync, sizeof(remote_sync)) != 0) {
+            ui_error("Network out of sync - disconnecting.");
+            network_disconnect();
+        }
+    }
+}
+
+/* Start frame `frame_num': save its snapshot and apply the input.  */
+static int network_rollback_start_frame(int save)
+{
+    network_frame_t *frame = &frames[frame_num % frames_num];
+    event_list_state_t *remote_event_list = NULL;
+
+    if (save) {
+        if (machine_write_snapshot_memory(frame->snapshot, 0, 0, 0) < 0) {
+            return -1;
+        }
+        frame->num = frame_num;
+        util_dword_to_le_buf(&frame->sync[0 * 4], (uint32_t)(maincpu_get_pc()));
+        util_dword_to_le_buf(&frame->sync[1 * 4], (uint32_t)(maincpu_get_a()));
+        util_dword_to_le_buf(&frame->sync[2 * 4], (uint32_t)(maincpu_get_x()));
+        util_dword_to_le_buf(&frame->sync[3 * 4], (uint32_t)(maincpu_get_y()));
+        util_dword_to_le_buf(&frame->sync[4 * 4], (uint32_t)(maincpu_get_sp()));
+    }
+
+    /* remote input not known yet is predicted to be unchanged */
+    if (frame_num < remote_frame) {
+        remote_event_list = frame->remote;
+    }
+
+    /* replay the event_lists; server first, then client */
+    if (network_mode == NETWORK_SERVER_CONNECTED) {
+        event_playback_event_list(&(frame->local));
+    }
+    if (remote_event_list != NULL) {
+        event_playback_event_list(remote_event_list);
+    }
+    if (network_mode == NETWORK_CLIENT) {
+        event_playback_event_list(&(frame->local));
+    }
+
+    frame_num++;
+    return 0;
+}
+
+static void network_rollback_frame_trap(uint16_t addr, void *data)
+{
+    network_frame_t *frame;
+
+    if (!network_connected()) {
+        return;
+    }
+
+    if (rollback_pending) {
+        rollback_pending = 0;
+        frame = &frames[rollback_to % frames_num];
+        if (frame->num != rollback_to
+            || machine_read_snapshot_memory(frame->snapshot, 0) < 0) {
+            ui_error("Cannot roll back netplay - disconnecting.");
+            network_disconnect();
+            return;
+        }
+        frame_num = rollback_to;
+        network_rollback_start_frame(0);
+    } else if (network_rollback_start_frame(1) < 0) {
+        ui_error("Cannot create netplay snapshot - disconnecting.");
+        network_disconnect();
+        return;
+    }
+
+    /* re-emulate the frames up to the one sent last */
+    vsync_set_catch_up(frame_num < send_frame);
+}
+
+static void network_hook_rollback(void)
+{
+    if (frame_num == send_frame) {
+        network_rollback_check_sync();
+        if (!network_connected()) {
+            return;
+        }
+
+        network_rollback_send();
+        if (!network_connected()) {
+            return;
+        }
+
+        if (network_rollback_receive() < 0) {
+            ui_display_statustext("Remote host disconnected.", 1);
+            network_disconnect();
+            return;
+        }
+    }
+
+    interrupt_maincpu_trigger_trap(network_rollback_frame_trap, (void *)0);
+}
+
 void network_hook(void)
 {
     if (network_mode == NETWORK_IDLE) {
@@ -909,7 +1539,9 @@ void network_hook(void)
         }
     }
 
-    if (network_connected()) {
+    if (network_connected() && rollback_window > 0) {
+        network_hook_rollback();
+    } else if (network_connected()) {
         network_hook_connected_send();
         network_hook_connected_receive();
 #ifdef NETWORK_DEBUG
@@ -926,6 +1558,8 @@ void network_shutdown(void)
     }
 
     network_free_frame_event_list();
+    snapshot_memory_free(network_snapshot);
+    network_snapshot = NULL;
     lib_free(server_name);
     lib_free(server_bind_address);
 }
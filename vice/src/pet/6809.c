@@ -5981,7 +5981,7 @@ int cpu6809_snapshot_write_module(snapshot_t *s)
     EXPORT_REGISTERS();
 
     if (0
-        || SMW_DW(m, maincpu_clk) < 0
+        || SMW_CLOCK(m, maincpu_clk) < 0
         || SMW_W(m, GLOBAL_REGS.reg_x) < 0
         || SMW_W(m, GLOBAL_REGS.reg_y) < 0
         || SMW_W(m, GLOBAL_REGS.reg_u) < 0
@@ -6038,7 +6038,7 @@ int cpu6809_snapshot_read_module(snapshot_t *s)
 {
     uint8_t major, minor;
     snapshot_module_t *m;
-    uint32_t my_maincpu_clk;
+    CLOCK my_maincpu_clk;
     uint16_t v;
     uint8_t e, f, md;
 
@@ -6057,7 +6057,7 @@ int cpu6809_snapshot_read_module(snapshot_t *s)
     }
 
     if (0
-        || SMR_DW(m, &my_maincpu_clk) < 0
+        || SMR_CLOCK(m, &my_maincpu_clk) < 0
         || SMR_W(m, &GLOBAL_REGS.reg_x) < 0
         || SMR_W(m, &GLOBAL_REGS.reg_y) < 0
         || SMR_W(m, &GLOBAL_REGS.reg_u) < 0
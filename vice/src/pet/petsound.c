@@ -65,6 +65,7 @@ static sound_chip_t pet_sound_chip = {
     pet_sound_machine_init,              /* sound chip init function */
     NULL,                                /* NO sound chip close function */
     pet_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                /* NO sound chip skip samples function */
     pet_sound_machine_store,             /* sound chip store function */
     NULL,                                /* NO sound chip read function */
     pet_sound_reset,                     /* sound chip reset function */
@@ -264,11 +265,6 @@ void petsound_reset(sound_t *psid, CLOCK cpu_clk)
     sound_reset();
 }
 
-void sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub)
-{
-    sid_sound_machine_prevent_clk_overflow(psid, sub);
-}
-
 char *sound_machine_dump_state(sound_t *psid)
 {
     return sid_sound_machine_dump_state(psid);
@@ -66,6 +66,7 @@ static sound_chip_t digiblaster_sound_chip = {
     digiblaster_sound_machine_init,              /* sound chip init function */
     NULL,                                        /* NO sound chip close function */
     digiblaster_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                        /* NO sound chip skip samples function */
     digiblaster_sound_machine_store,             /* sound chip store function */
     NULL,                                        /* NO sound chip read function */
     digiblaster_sound_reset,                     /* sound chip reset function */
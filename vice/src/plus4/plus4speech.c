@@ -501,6 +501,7 @@ static sound_chip_t speech_sound_chip = {
     speech_sound_machine_init,              /* sound chip init function */
     NULL,                                   /* NO sound chip close function */
     speech_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                   /* NO sound chip skip samples function */
     NULL,                                   /* NO sound chip store function */
     NULL,                                   /* NO sound chip read function */
     NULL,                                   /* NO sound chip reset function */
@@ -78,7 +78,7 @@ void ted_snapshot_prepare(void)
 
     Name                        Type   Size   Description
 
-    last_emulate_line_clk       DWORD  1
+    last_emulate_line_clk       CLOCK  1
     AllowBadLines               BYTE   1      flag: if true, bad lines can happen
     BadLine                     BYTE   1      flag: this is a bad line
     Blank                       BYTE   1      flag: draw lines in border color
@@ -119,7 +119,7 @@ int ted_snapshot_write_module(snapshot_t *s)
     DBG(("TED write snapshot at clock: %d cycle: %d tedline: %d rasterline: %d\n", maincpu_clk, TED_RASTER_CYCLE(maincpu_clk), TED_RASTER_Y(maincpu_clk), ted.raster.current_line));
 
     if (0
-        || SMW_DW(m, ted.last_emulate_line_clk) < 0
+        || SMW_CLOCK(m, ted.last_emulate_line_clk) < 0
         /* AllowBadLines */
         || SMW_B(m, (uint8_t)ted.allow_bad_lines) < 0
         /* BadLine */
@@ -202,7 +202,7 @@ int ted_snapshot_read_module(snapshot_t *s)
     /* FIXME: initialize changes?  */
 
     if (0
-        || SMR_DW(m, &ted.last_emulate_line_clk) < 0
+        || SMR_CLOCK(m, &ted.last_emulate_line_clk) < 0
         /* AllowBadLines */
         || SMR_B_INT(m, &ted.allow_bad_lines) < 0
         /* BadLine */
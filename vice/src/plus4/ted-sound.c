@@ -68,6 +68,7 @@ static sound_chip_t ted_sound_chip = {
     ted_sound_machine_init,              /* sound chip init function */
     NULL,                                /* NO sound chip close function */
     ted_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                /* NO sound chip skip samples function */
     ted_sound_machine_store,             /* sound chip store function */
     ted_sound_machine_read,              /* sound chip read function */
     ted_sound_reset,                     /* sound chip reset function */
@@ -363,11 +364,6 @@ uint8_t ted_sound_read(uint16_t addr)
     return value;
 }
 
-void sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub)
-{
-    sid_sound_machine_prevent_clk_overflow(psid, sub);
-}
-
 char *sound_machine_dump_state(sound_t *psid)
 {
     return sid_sound_machine_dump_state(psid);
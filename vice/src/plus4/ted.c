@@ -35,7 +35,6 @@
 #include "videoarch.h"
 
 #include "alarm.h"
-#include "clkguard.h"
 #include "dma.h"
 #include "lib.h"
 #include "log.h"
@@ -79,15 +78,6 @@ CLOCK first_write_cycle;
 static void ted_set_geometry(void);
 
 
-static void clk_overflow_callback(CLOCK sub, void *unused_data)
-{
-    ted.raster_irq_clk -= sub;
-    ted.last_emulate_line_clk -= sub;
-    ted.fetch_clk -= sub;
-    ted.draw_clk -= sub;
-    old_maincpu_clk -= sub;
-}
-
 void ted_change_timing(machine_timing_t *machine_timing, int bordermode)
 {
     ted_timing_set(machine_timing, bordermode);
@@ -193,6 +183,12 @@ inline void ted_handle_pending_alarms(int num_write_cycles)
            cannot take us here and we would not be able to handle JSR
            correctly anyway, so we don't care about them...  */
 
+        /* The registers are also written on reset, before the CPU has
+           executed anything.  */
+        if ((CLOCK)num_write_cycles > maincpu_clk) {
+            num_write_cycles = (int)maincpu_clk;
+        }
+
         /* Go back to the time when the read accesses happened and serve TED
            events.  */
         maincpu_clk -= num_write_cycles;
@@ -382,8 +378,6 @@ raster_t *ted_init(void)
 
     ted.initialized = 1;
 
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
-
     return &ted.raster;
 }
 
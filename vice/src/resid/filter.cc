@@ -27,6 +27,7 @@
 #include "filter.h"
 #include "dac.h"
 #include "spline.h"
+#include "tablecache.h"
 #include <math.h>
 
 namespace reSID
@@ -175,8 +176,12 @@ static model_filter_init_t model_filter_init[2] = {
     }
 };
 
-unsigned short Filter::vcr_kVg[1 << 16];
-unsigned short Filter::vcr_n_Ids_term[1 << 16];
+// Change this whenever the code building the lookup tables changes, so
+// that tables cached by older versions are not used.
+static const unsigned int FILTER_TABLES_VERSION = 1;
+
+unsigned short* Filter::vcr_kVg;
+unsigned short* Filter::vcr_n_Ids_term;
 
 #if defined(__amiga__) && defined(__mc68000__)
 #undef HAS_LOG1P
@@ -189,7 +194,7 @@ static double log1p(double x)
 }
 #endif
 
-Filter::model_filter_t Filter::model_filter[2];
+Filter::model_filter_t* Filter::model_filter;
 
 
 // ----------------------------------------------------------------------------
@@ -200,236 +205,298 @@ Filter::Filter()
     static bool class_init;
 
     if (!class_init) {
-        // Temporary table for op-amp transfer function.
-        unsigned int* voltages = new unsigned int[1 << 16];
-        opamp_t* opamp = new opamp_t[1 << 16];
-
-        for (int m = 0; m < 2; m++) {
-            model_filter_init_t& fi = model_filter_init[m];
-            model_filter_t& mf = model_filter[m];
-
-            // Convert op-amp voltage transfer to 16 bit values.
-            double vmin = fi.opamp_voltage[0][0];
-            double opamp_max = fi.opamp_voltage[0][1];
-            double kVddt = fi.k*(fi.Vdd - fi.Vth);
-            double vmax = kVddt < opamp_max ? opamp_max : kVddt;
-            double denorm = vmax - vmin;
-            double norm = 1.0/denorm;
-
-            // Scaling and translation constants.
-            double N16 = norm*((1u << 16) - 1);
-            double N30 = norm*((1u << 30) - 1);
-            double N31 = norm*((1u << 31) - 1);
-            mf.vo_N16 = (int)(N16);  // FIXME: Remove?
-
-            // The "zero" output level of the voices.
-            // The digital range of one voice is 20 bits; create a scaling term
-            // for multiplication which fits in 11 bits.
-            double N14 = norm*(1u << 14);
-            mf.voice_scale_s14 = (int)(N14*fi.voice_voltage_range);
-            mf.voice_DC = (int)(N16*(fi.voice_DC_voltage - vmin));
-
-            // Vdd - Vth, normalized so that translated values can be subtracted:
-            // k*Vddt - x = (k*Vddt - t) - (x - t)
-            mf.kVddt = (int)(N16*(kVddt - vmin) + 0.5);
-
-            // Normalized snake current factor, 1 cycle at 1MHz.
-            // Fit in 5 bits.
-            mf.n_snake = (int)(denorm*(1 << 13)*(fi.uCox/(2*fi.k)*fi.WL_snake*1.0e-6/fi.C) + 0.5);
-
-            // Create lookup table mapping op-amp voltage across output and input
-            // to input voltage: vo - vx -> vx
-            // FIXME: No variable length arrays in ISO C++, hardcoding to max 50
-            // points.
-            // double_point scaled_voltage[fi.opamp_voltage_size];
-            double_point scaled_voltage[50];
-
-            for (int i = 0; i < fi.opamp_voltage_size; i++) {
-                // The target output range is 16 bits, in order to fit in an unsigned
-                // short.
-                //
-                // The y axis is temporarily scaled to 31 bits for maximum accuracy in
-                // the calculated derivative.
-                //
-                // Values are normalized using
-                //
-                //   x_n = m*2^N*(x - xmin)
-                //
-                // and are translated back later (for fixed point math) using
-                //
-                //   m*2^N*x = x_n - m*2^N*xmin
-                //
-                scaled_voltage[fi.opamp_voltage_size - 1 - i][0] = int(N16*(fi.opamp_voltage[i][1] - fi.opamp_voltage[i][0] + denorm)/2 + 0.5);
-                scaled_voltage[fi.opamp_voltage_size - 1 - i][1] = N31*(fi.opamp_voltage[i][0] - vmin);
+        unsigned int key = tables_key();
+        filter_tables_t* tables = (filter_tables_t*)
+            table_cache_map("resid-filter", key, sizeof(filter_tables_t));
+
+        if (!tables) {
+            tables = new filter_tables_t;
+            set_tables(tables);
+            build_tables();
+
+            // Use the shared copy from now on if it could be stored.
+            filter_tables_t* cached = (filter_tables_t*)
+                table_cache_store("resid-filter", key, tables, sizeof(filter_tables_t));
+            if (cached) {
+                delete tables;
+                tables = cached;
             }
+        }
+        set_tables(tables);
 
-            // Clamp x to 16 bits (rounding may cause overflow).
-            if (scaled_voltage[fi.opamp_voltage_size - 1][0] >= (1 << 16)) {
-                // The last point is repeated.
-                scaled_voltage[fi.opamp_voltage_size - 1][0] =
-                scaled_voltage[fi.opamp_voltage_size - 2][0] = (1 << 16) - 1;
-            }
+        class_init = true;
+    }
 
-            interpolate(scaled_voltage, scaled_voltage + fi.opamp_voltage_size - 1,
-                PointPlotter<unsigned int>(voltages), 1.0);
+    enable_filter(true);
+    set_chip_model(MOS6581);
+    set_voice_mask(0x07);
+    input(0);
+    reset();
+}
 
-            // Store both fn and dfn in the same table.
-            mf.ak = (int)scaled_voltage[0][0];
-            mf.bk = (int)scaled_voltage[fi.opamp_voltage_size - 1][0];
-            int j;
-            for (j = 0; j < mf.ak; j++) {
-                opamp[j].vx = 0;
-                opamp[j].dvx = 0;
-            }
-            unsigned int f = voltages[j];
-            for (; j <= mf.bk; j++) {
-                unsigned int fp = f;
-                f = voltages[j];  // Scaled by m*2^31
-                // m*2^31*dy/1 = (m*2^31*dy)/(m*2^16*dx) = 2^15*dy/dx
-                int df = f - fp;  // Scaled by 2^15
-
-                // 16 bits unsigned: m*2^16*(fn - xmin)
-                opamp[j].vx = f > (0xffff << 15) ? 0xffff : f >> 15;
-                // 16 bits (15 bits + sign bit): 2^11*dfn
-                opamp[j].dvx = df >> (15 - 11);
-            }
-            for (; j < (1 << 16); j++) {
-                opamp[j].vx = 0;
-                opamp[j].dvx = 0;
-            }
 
-            // Create lookup tables for gains / summers.
-
-            // 4 bit "resistor" ladders in the bandpass resonance gain and the audio
-            // output gain necessitate 16 gain tables.
-            // From die photographs of the bandpass and volume "resistor" ladders
-            // it follows that gain ~ vol/8 and 1/Q ~ ~res/8 (assuming ideal
-            // op-amps and ideal "resistors").
-            for (int n8 = 0; n8 < 16; n8++) {
-                int n = n8 << 4;  // Scaled by 2^7
-                int x = mf.ak;
-                for (int vi = 0; vi < (1 << 16); vi++) {
-                    mf.gain[n8][vi] = solve_gain(opamp, n, vi, x, mf);
-                }
-            }
+// ----------------------------------------------------------------------------
+// Key for the table cache, covering everything the tables are built from.
+// ----------------------------------------------------------------------------
+unsigned int Filter::tables_key()
+{
+    unsigned int key = table_cache_hash(2166136261u, &FILTER_TABLES_VERSION,
+                                        sizeof(FILTER_TABLES_VERSION));
+
+    for (int m = 0; m < 2; m++) {
+        model_filter_init_t& fi = model_filter_init[m];
+
+        key = table_cache_hash(key, fi.opamp_voltage,
+                               fi.opamp_voltage_size*sizeof(*fi.opamp_voltage));
+        // The parameters from voice_voltage_range up to dac_2R_div_R are
+        // consecutive doubles.
+        key = table_cache_hash(key, &fi.voice_voltage_range,
+                               (const char*)(&fi.dac_2R_div_R + 1)
+                               - (const char*)&fi.voice_voltage_range);
+        key = table_cache_hash(key, &fi.dac_term, sizeof(fi.dac_term));
+    }
 
-            // The filter summer operates at n ~ 1, and has 5 fundamentally different
-            // input configurations (2 - 6 input "resistors").
-            //
-            // Note that all "on" transistors are modeled as one. This is not
-            // entirely accurate, since the input for each transistor is different,
-            // and transistors are not linear components. However modeling all
-            // transistors separately would be extremely costly.
-            int offset = 0;
-            int size;
-            for (int k = 0; k < 5; k++) {
-                int idiv = 2 + k;        // 2 - 6 input "resistors".
-                int n_idiv = idiv << 7;  // n*idiv, scaled by 2^7
-                size = idiv << 16;
-                int x = mf.ak;
-                for (int vi = 0; vi < size; vi++) {
-                    mf.summer[offset + vi] = solve_gain(opamp, n_idiv, vi/idiv, x, mf);
-                }
-                offset += size;
-            }
+    return key;
+}
+
+
+// ----------------------------------------------------------------------------
+// Point the shared table pointers to a set of tables.
+// ----------------------------------------------------------------------------
+void Filter::set_tables(filter_tables_t* tables)
+{
+    model_filter = tables->model_filter;
+    vcr_kVg = tables->vcr_kVg;
+    vcr_n_Ids_term = tables->vcr_n_Ids_term;
+}
 
-            // The audio mixer operates at n ~ 8/6, and has 8 fundamentally different
-            // input configurations (0 - 7 input "resistors").
+
+// ----------------------------------------------------------------------------
+// Build the lookup tables, set_tables() must have been called first.
+// ----------------------------------------------------------------------------
+void Filter::build_tables()
+{
+    // Temporary table for op-amp transfer function.
+    unsigned int* voltages = new unsigned int[1 << 16];
+    opamp_t* opamp = new opamp_t[1 << 16];
+
+    for (int m = 0; m < 2; m++) {
+        model_filter_init_t& fi = model_filter_init[m];
+        model_filter_t& mf = model_filter[m];
+
+        // Convert op-amp voltage transfer to 16 bit values.
+        double vmin = fi.opamp_voltage[0][0];
+        double opamp_max = fi.opamp_voltage[0][1];
+        double kVddt = fi.k*(fi.Vdd - fi.Vth);
+        double vmax = kVddt < opamp_max ? opamp_max : kVddt;
+        double denorm = vmax - vmin;
+        double norm = 1.0/denorm;
+
+        // Scaling and translation constants.
+        double N16 = norm*((1u << 16) - 1);
+        double N30 = norm*((1u << 30) - 1);
+        double N31 = norm*((1u << 31) - 1);
+        mf.vo_N16 = (int)(N16);  // FIXME: Remove?
+
+        // The "zero" output level of the voices.
+        // The digital range of one voice is 20 bits; create a scaling term
+        // for multiplication which fits in 11 bits.
+        double N14 = norm*(1u << 14);
+        mf.voice_scale_s14 = (int)(N14*fi.voice_voltage_range);
+        mf.voice_DC = (int)(N16*(fi.voice_DC_voltage - vmin));
+
+        // Vdd - Vth, normalized so that translated values can be subtracted:
+        // k*Vddt - x = (k*Vddt - t) - (x - t)
+        mf.kVddt = (int)(N16*(kVddt - vmin) + 0.5);
+
+        // Normalized snake current factor, 1 cycle at 1MHz.
+        // Fit in 5 bits.
+        mf.n_snake = (int)(denorm*(1 << 13)*(fi.uCox/(2*fi.k)*fi.WL_snake*1.0e-6/fi.C) + 0.5);
+
+        // Create lookup table mapping op-amp voltage across output and input
+        // to input voltage: vo - vx -> vx
+        // FIXME: No variable length arrays in ISO C++, hardcoding to max 50
+        // points.
+        // double_point scaled_voltage[fi.opamp_voltage_size];
+        double_point scaled_voltage[50];
+
+        for (int i = 0; i < fi.opamp_voltage_size; i++) {
+            // The target output range is 16 bits, in order to fit in an unsigned
+            // short.
             //
-            // All "on", transistors are modeled as one - see comments above for
-            // the filter summer.
-            offset = 0;
-            size = 1;  // Only one lookup element for 0 input "resistors".
-            for (int l = 0; l < 8; l++) {
-                int idiv = l;                 // 0 - 7 input "resistors".
-                int n_idiv = (idiv << 7)*8/6; // n*idiv, scaled by 2^7
-                if (idiv == 0) {
-                    // Avoid division by zero; the result will be correct since
-                    // n_idiv = 0.
-                    idiv = 1;
-                }
-                int x = mf.ak;
-                for (int vi = 0; vi < size; vi++) {
-                    mf.mixer[offset + vi] = solve_gain(opamp, n_idiv, vi/idiv, x, mf);
-                }
-                offset += size;
-                size = (l + 1) << 16;
-            }
+            // The y axis is temporarily scaled to 31 bits for maximum accuracy in
+            // the calculated derivative.
+            //
+            // Values are normalized using
+            //
+            //   x_n = m*2^N*(x - xmin)
+            //
+            // and are translated back later (for fixed point math) using
+            //
+            //   m*2^N*x = x_n - m*2^N*xmin
+            //
+            scaled_voltage[fi.opamp_voltage_size - 1 - i][0] = int(N16*(fi.opamp_voltage[i][1] - fi.opamp_voltage[i][0] + denorm)/2 + 0.5);
+            scaled_voltage[fi.opamp_voltage_size - 1 - i][1] = N31*(fi.opamp_voltage[i][0] - vmin);
+        }
 
-            // Create lookup table mapping capacitor voltage to op-amp input voltage:
-            // vc -> vx
-            for (int m = 0; m < (1 << 16); m++) {
-                mf.opamp_rev[m] = opamp[m].vx;
-            }
+        // Clamp x to 16 bits (rounding may cause overflow).
+        if (scaled_voltage[fi.opamp_voltage_size - 1][0] >= (1 << 16)) {
+            // The last point is repeated.
+            scaled_voltage[fi.opamp_voltage_size - 1][0] =
+            scaled_voltage[fi.opamp_voltage_size - 2][0] = (1 << 16) - 1;
+        }
 
-            mf.vc_max = (int)(N30*(fi.opamp_voltage[0][1] - fi.opamp_voltage[0][0]));
-            mf.vc_min = (int)(N30*(fi.opamp_voltage[fi.opamp_voltage_size - 1][1] - fi.opamp_voltage[fi.opamp_voltage_size - 1][0]));
+        interpolate(scaled_voltage, scaled_voltage + fi.opamp_voltage_size - 1,
+            PointPlotter<unsigned int>(voltages), 1.0);
 
-            // DAC table.
-            int bits = 11;
-            build_dac_table(mf.f0_dac, bits, fi.dac_2R_div_R, fi.dac_term);
-            for (int n = 0; n < (1 << bits); n++) {
-                mf.f0_dac[n] = (unsigned short)(N16*(fi.dac_zero + mf.f0_dac[n]*fi.dac_scale/(1 << bits) - vmin) + 0.5);
-            }
+        // Store both fn and dfn in the same table.
+        mf.ak = (int)scaled_voltage[0][0];
+        mf.bk = (int)scaled_voltage[fi.opamp_voltage_size - 1][0];
+        int j;
+        for (j = 0; j < mf.ak; j++) {
+            opamp[j].vx = 0;
+            opamp[j].dvx = 0;
+        }
+        unsigned int f = voltages[j];
+        for (; j <= mf.bk; j++) {
+            unsigned int fp = f;
+            f = voltages[j];  // Scaled by m*2^31
+            // m*2^31*dy/1 = (m*2^31*dy)/(m*2^16*dx) = 2^15*dy/dx
+            int df = f - fp;  // Scaled by 2^15
+
+            // 16 bits unsigned: m*2^16*(fn - xmin)
+            opamp[j].vx = f > (0xffff << 15) ? 0xffff : f >> 15;
+            // 16 bits (15 bits + sign bit): 2^11*dfn
+            opamp[j].dvx = df >> (15 - 11);
+        }
+        for (; j < (1 << 16); j++) {
+            opamp[j].vx = 0;
+            opamp[j].dvx = 0;
         }
 
-        // Free temporary tables.
-        delete[] voltages;
-        delete[] opamp;
+        // Create lookup tables for gains / summers.
+
+        // 4 bit "resistor" ladders in the bandpass resonance gain and the audio
+        // output gain necessitate 16 gain tables.
+        // From die photographs of the bandpass and volume "resistor" ladders
+        // it follows that gain ~ vol/8 and 1/Q ~ ~res/8 (assuming ideal
+        // op-amps and ideal "resistors").
+        for (int n8 = 0; n8 < 16; n8++) {
+            int n = n8 << 4;  // Scaled by 2^7
+            int x = mf.ak;
+            for (int vi = 0; vi < (1 << 16); vi++) {
+                mf.gain[n8][vi] = solve_gain(opamp, n, vi, x, mf);
+            }
+        }
 
-        // VCR - 6581 only.
-        model_filter_init_t& fi = model_filter_init[0];
+        // The filter summer operates at n ~ 1, and has 5 fundamentally different
+        // input configurations (2 - 6 input "resistors").
+        //
+        // Note that all "on" transistors are modeled as one. This is not
+        // entirely accurate, since the input for each transistor is different,
+        // and transistors are not linear components. However modeling all
+        // transistors separately would be extremely costly.
+        int offset = 0;
+        int size;
+        for (int k = 0; k < 5; k++) {
+            int idiv = 2 + k;        // 2 - 6 input "resistors".
+            int n_idiv = idiv << 7;  // n*idiv, scaled by 2^7
+            size = idiv << 16;
+            int x = mf.ak;
+            for (int vi = 0; vi < size; vi++) {
+                mf.summer[offset + vi] = solve_gain(opamp, n_idiv, vi/idiv, x, mf);
+            }
+            offset += size;
+        }
 
-        double N16 = model_filter[0].vo_N16;
-        double vmin = N16*fi.opamp_voltage[0][0];
-        double k = fi.k;
-        double kVddt = N16*(k*(fi.Vdd - fi.Vth));
+        // The audio mixer operates at n ~ 8/6, and has 8 fundamentally different
+        // input configurations (0 - 7 input "resistors").
+        //
+        // All "on", transistors are modeled as one - see comments above for
+        // the filter summer.
+        offset = 0;
+        size = 1;  // Only one lookup element for 0 input "resistors".
+        for (int l = 0; l < 8; l++) {
+            int idiv = l;                 // 0 - 7 input "resistors".
+            int n_idiv = (idiv << 7)*8/6; // n*idiv, scaled by 2^7
+            if (idiv == 0) {
+                // Avoid division by zero; the result will be correct since
+                // n_idiv = 0.
+                idiv = 1;
+            }
+            int x = mf.ak;
+            for (int vi = 0; vi < size; vi++) {
+                mf.mixer[offset + vi] = solve_gain(opamp, n_idiv, vi/idiv, x, mf);
+            }
+            offset += size;
+            size = (l + 1) << 16;
+        }
 
-        for (int i = 0; i < (1 << 16); i++) {
-            // The table index is right-shifted 16 times in order to fit in
-            // 16 bits; the argument to sqrt is thus multiplied by (1 << 16).
-            //
-            // The returned value must be corrected for translation. Vg always
-            // takes part in a subtraction as follows:
-            //
-            //   k*Vg - Vx = (k*Vg - t) - (Vx - t)
-            //
-            // I.e. k*Vg - t must be returned.
-            double Vg = kVddt - sqrt((double)i*(1 << 16));
-            vcr_kVg[i] = (unsigned short)(k*Vg - vmin + 0.5);
+        // Create lookup table mapping capacitor voltage to op-amp input voltage:
+        // vc -> vx
+        for (int m = 0; m < (1 << 16); m++) {
+            mf.opamp_rev[m] = opamp[m].vx;
         }
 
-        /*
-        EKV model:
-
-        Ids = Is*(if - ir)
-        Is = 2*u*Cox*Ut^2/k*W/L
-        if = ln^2(1 + e^((k*(Vg - Vt) - Vs)/(2*Ut))
-        ir = ln^2(1 + e^((k*(Vg - Vt) - Vd)/(2*Ut))
-        */
-        double kVt = fi.k*fi.Vth;
-        double Ut = fi.Ut;
-        double Is = 2*fi.uCox*Ut*Ut/fi.k*fi.WL_vcr;
-        // Normalized current factor for 1 cycle at 1MHz.
-        double N15 = N16/2;
-        double n_Is = N15*1.0e-6/fi.C*Is;
-
-        // kVg_Vx = k*Vg - Vx
-        // I.e. if k != 1.0, Vg must be scaled accordingly.
-        for (int kVg_Vx = 0; kVg_Vx < (1 << 16); kVg_Vx++) {
-            double log_term = log1p(exp((kVg_Vx/N16 - kVt)/(2*Ut)));
-            // Scaled by m*2^15
-            vcr_n_Ids_term[kVg_Vx] = (unsigned short)(n_Is*log_term*log_term);
+        mf.vc_max = (int)(N30*(fi.opamp_voltage[0][1] - fi.opamp_voltage[0][0]));
+        mf.vc_min = (int)(N30*(fi.opamp_voltage[fi.opamp_voltage_size - 1][1] - fi.opamp_voltage[fi.opamp_voltage_size - 1][0]));
+
+        // DAC table.
+        int bits = 11;
+        build_dac_table(mf.f0_dac, bits, fi.dac_2R_div_R, fi.dac_term);
+        for (int n = 0; n < (1 << bits); n++) {
+            mf.f0_dac[n] = (unsigned short)(N16*(fi.dac_zero + mf.f0_dac[n]*fi.dac_scale/(1 << bits) - vmin) + 0.5);
         }
+    }
 
-        class_init = true;
+    // Free temporary tables.
+    delete[] voltages;
+    delete[] opamp;
+
+    // VCR - 6581 only.
+    model_filter_init_t& fi = model_filter_init[0];
+
+    double N16 = model_filter[0].vo_N16;
+    double vmin = N16*fi.opamp_voltage[0][0];
+    double k = fi.k;
+    double kVddt = N16*(k*(fi.Vdd - fi.Vth));
+
+    for (int i = 0; i < (1 << 16); i++) {
+        // The table index is right-shifted 16 times in order to fit in
+        // 16 bits; the argument to sqrt is thus multiplied by (1 << 16).
+        //
+        // The returned value must be corrected for translation. Vg always
+        // takes part in a subtraction as follows:
+        //
+        //   k*Vg - Vx = (k*Vg - t) - (Vx - t)
+        //
+        // I.e. k*Vg - t must be returned.
+        double Vg = kVddt - sqrt((double)i*(1 << 16));
+        vcr_kVg[i] = (unsigned short)(k*Vg - vmin + 0.5);
     }
 
-    enable_filter(true);
-    set_chip_model(MOS6581);
-    set_voice_mask(0x07);
-    input(0);
-    reset();
+    /*
+    EKV model:
+
+    Ids = Is*(if - ir)
+    Is = 2*u*Cox*Ut^2/k*W/L
+    if = ln^2(1 + e^((k*(Vg - Vt) - Vs)/(2*Ut))
+    ir = ln^2(1 + e^((k*(Vg - Vt) - Vd)/(2*Ut))
+    */
+    double kVt = fi.k*fi.Vth;
+    double Ut = fi.Ut;
+    double Is = 2*fi.uCox*Ut*Ut/fi.k*fi.WL_vcr;
+    // Normalized current factor for 1 cycle at 1MHz.
+    double N15 = N16/2;
+    double n_Is = N15*1.0e-6/fi.C*Is;
+
+    // kVg_Vx = k*Vg - Vx
+    // I.e. if k != 1.0, Vg must be scaled accordingly.
+    for (int kVg_Vx = 0; kVg_Vx < (1 << 16); kVg_Vx++) {
+        double log_term = log1p(exp((kVg_Vx/N16 - kVt)/(2*Ut)));
+        // Scaled by m*2^15
+        vcr_n_Ids_term[kVg_Vx] = (unsigned short)(n_Is*log_term*log_term);
+    }
 }
 
 
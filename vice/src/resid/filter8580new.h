@@ -635,17 +635,32 @@ protected:
   int nVgt;
 
   // Lookup tables for resonance
-  static unsigned short resonance[16][1 << 16];
+  static unsigned short (*resonance)[1 << 16];
 
   int solve_gain(opamp_t* opamp, int n, int vi_t, int& x, model_filter_t& mf);
   int solve_integrate_6581(int dt, int vi_t, int& x, int& vc, model_filter_t& mf);
   int solve_integrate_8580(int dt, int vi_t, int& x, int& vc, model_filter_t& mf);
 
+  // Lookup tables shared by all instances. They are built once, and kept in
+  // the table cache so that later runs can map them instead.
+  typedef struct {
+    model_filter_t model_filter[2];
+    unsigned short resonance[16][1 << 16];
+    unsigned short vcr_kVg[1 << 16];
+    unsigned short vcr_n_Ids_term[1 << 16];
+    int n_snake;
+    int n_param;
+  } filter_tables_t;
+
+  static unsigned int tables_key();
+  static void set_tables(filter_tables_t* tables);
+  void build_tables();
+
   // VCR - 6581 only.
-  static unsigned short vcr_kVg[1 << 16];
-  static unsigned short vcr_n_Ids_term[1 << 16];
+  static unsigned short* vcr_kVg;
+  static unsigned short* vcr_n_Ids_term;
   // Common parameters.
-  static model_filter_t model_filter[2];
+  static model_filter_t* model_filter;
 
 friend class SID;
 };
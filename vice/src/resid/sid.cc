@@ -25,6 +25,7 @@
 #endif
 
 #include "sid.h"
+#include "tablecache.h"
 #include <math.h>
 
 #ifndef round
@@ -663,13 +664,21 @@ void SID::adjust_sampling_frequency(double sample_freq)
 }
 
 
+// ----------------------------------------------------------------------------
+// Set the directory used to cache the filter lookup tables. Must be called
+// before the first SID is created to have an effect; 0 disables the cache.
+// ----------------------------------------------------------------------------
+void SID::set_table_cache_dir(const char* dir)
+{
+  table_cache_set_dir(dir);
+}
+
+
 // ----------------------------------------------------------------------------
 // SID clocking - delta_t cycles.
 // ----------------------------------------------------------------------------
 void SID::clock(cycle_count delta_t)
 {
-  int i;
-
   // Pipelined writes on the MOS8580.
   if (unlikely(write_pipeline) && likely(delta_t > 0)) {
     // Step one cycle by a recursive call to ourselves.
@@ -683,6 +692,47 @@ void SID::clock(cycle_count delta_t)
     return;
   }
 
+  clock_voices(delta_t);
+
+  // Clock filter.
+  filter.clock(delta_t, voice[0].output(), voice[1].output(), voice[2].output());
+
+  // Clock external filter.
+  extfilt.clock(delta_t, filter.output());
+}
+
+
+// ----------------------------------------------------------------------------
+// SID clocking - delta_t cycles, without the filter and the external filter.
+// This keeps everything that can be read back through the registers
+// (oscillator 3, envelope 3, the bus value) in sync when no audio output is
+// needed, e.g. while the emulator runs in warp mode.
+// ----------------------------------------------------------------------------
+void SID::clock_silent(cycle_count delta_t)
+{
+  // Pipelined writes on the MOS8580.
+  if (unlikely(write_pipeline) && likely(delta_t > 0)) {
+    write_pipeline = 0;
+    clock_silent(1);
+    write();
+    delta_t -= 1;
+  }
+
+  if (unlikely(delta_t <= 0)) {
+    return;
+  }
+
+  clock_voices(delta_t);
+}
+
+
+// ----------------------------------------------------------------------------
+// Clock bus value, envelopes and oscillators - delta_t cycles.
+// ----------------------------------------------------------------------------
+void SID::clock_voices(cycle_count delta_t)
+{
+  int i;
+
   // Age bus value.
   bus_value_ttl -= delta_t;
   if (unlikely(bus_value_ttl <= 0)) {
@@ -747,12 +797,6 @@ void SID::clock(cycle_count delta_t)
   for (i = 0; i < 3; i++) {
     voice[i].wave.set_waveform_output(delta_t);
   }
-
-  // Clock filter.
-  filter.clock(delta_t, voice[0].output(), voice[1].output(), voice[2].output());
-
-  // Clock external filter.
-  extfilt.clock(delta_t, filter.output());
 }
 
 
@@ -51,9 +51,13 @@ public:
   double filter_scale = 0.97);
   void adjust_sampling_frequency(double sample_freq);
 
+  // Directory for cached lookup tables, see tablecache.h.
+  static void set_table_cache_dir(const char* dir);
+
   void clock();
   void clock(cycle_count delta_t);
   int clock(cycle_count& delta_t, short* buf, int n, int interleave = 1);
+  void clock_silent(cycle_count delta_t);
   void reset();
 
   // Read/write registers.
@@ -106,6 +110,7 @@ public:
   int clock_interpolate(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int interleave);
+  void clock_voices(cycle_count delta_t);
   void write();
 
   chip_model sid_model;
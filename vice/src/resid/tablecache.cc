@@ -0,0 +1,241 @@
+//  ---------------------------------------------------------------------------
+//  This file is part of reSID, a MOS6581 SID emulator engine.
+//  Copyright (C) 2010  Dag Lem <resid@nimrod.no>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//  ---------------------------------------------------------------------------
+
+#define RESID_TABLECACHE_CC
+
+#include "tablecache.h"
+#include <stdio.h>
+#include <string.h>
+
+#if RESID_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace reSID
+{
+
+// "rSTC" in native byte order, files written on another architecture are
+// thus never used.
+const unsigned int TABLE_CACHE_MAGIC = 0x43545372;
+
+// The tables start at this offset in the file, which keeps them aligned.
+const size_t TABLE_CACHE_HEADER_SIZE = 64;
+
+typedef struct {
+  unsigned int magic;
+  unsigned int key;
+  unsigned int size;
+} table_cache_header_t;
+
+static char* cache_dir;
+
+
+void table_cache_set_dir(const char* dir)
+{
+  delete[] cache_dir;
+  cache_dir = 0;
+
+  if (dir && *dir) {
+    cache_dir = new char[strlen(dir) + 1];
+    strcpy(cache_dir, dir);
+  }
+}
+
+unsigned int table_cache_hash(unsigned int hash, const void* data, size_t size)
+{
+  const unsigned char* p = (const unsigned char*)data;
+
+  while (size--) {
+    hash = (hash ^ *p++)*16777619u;
+  }
+  return hash;
+}
+
+// Returns the file name for name/key, or 0 if the cache is disabled.
+static char* table_cache_path(const char* name, unsigned int key)
+{
+  if (!cache_dir) {
+    return 0;
+  }
+
+  size_t len = strlen(cache_dir) + strlen(name) + 32;
+  char* path = new char[len];
+  sprintf(path, "%s/%s-%08x.bin", cache_dir, name, key);
+  return path;
+}
+
+static bool table_cache_check(const table_cache_header_t* header,
+                              unsigned int key, size_t size)
+{
+  return header->magic == TABLE_CACHE_MAGIC
+    && header->key == key
+    && header->size == size;
+}
+
+// Write header and tables to a new file.
+static bool table_cache_write(const char* path, unsigned int key,
+                              const void* data, size_t size)
+{
+  char header[TABLE_CACHE_HEADER_SIZE];
+  table_cache_header_t h;
+
+  memset(header, 0, sizeof(header));
+  h.magic = TABLE_CACHE_MAGIC;
+  h.key = key;
+  h.size = (unsigned int)size;
+  memcpy(header, &h, sizeof(h));
+
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+  bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header)
+    && fwrite(data, 1, size, f) == size;
+  ok = fclose(f) == 0 && ok;
+  if (!ok) {
+    remove(path);
+  }
+  return ok;
+}
+
+#if RESID_HAVE_MMAP
+
+void* table_cache_map(const char* name, unsigned int key, size_t size)
+{
+  char* path = table_cache_path(name, key);
+  if (!path) {
+    return 0;
+  }
+
+  int fd = open(path, O_RDONLY);
+  delete[] path;
+  if (fd < 0) {
+    return 0;
+  }
+
+  // Files are written completely and renamed into place, so a file of the
+  // right size is complete.
+  struct stat st;
+  void* base = MAP_FAILED;
+  if (fstat(fd, &st) == 0
+      && (size_t)st.st_size == TABLE_CACHE_HEADER_SIZE + size) {
+    base = mmap(0, TABLE_CACHE_HEADER_SIZE + size, PROT_READ, MAP_SHARED,
+                fd, 0);
+  }
+  close(fd);
+
+  if (base == MAP_FAILED) {
+    return 0;
+  }
+  if (!table_cache_check((const table_cache_header_t*)base, key, size)) {
+    munmap(base, TABLE_CACHE_HEADER_SIZE + size);
+    return 0;
+  }
+
+  return (char*)base + TABLE_CACHE_HEADER_SIZE;
+}
+
+void* table_cache_store(const char* name, unsigned int key, const void* data, size_t size)
+{
+  char* path = table_cache_path(name, key);
+  if (!path) {
+    return 0;
+  }
+
+  // Several processes may build the same tables at the same time; each
+  // writes its own file, and the last rename wins.
+  char* tmp_path = new char[strlen(path) + 16];
+  sprintf(tmp_path, "%s.%ld", path, (long)getpid());
+
+  bool ok = table_cache_write(tmp_path, key, data, size);
+  if (ok && rename(tmp_path, path) != 0) {
+    remove(tmp_path);
+    ok = false;
+  }
+
+  delete[] tmp_path;
+  delete[] path;
+
+  return ok ? table_cache_map(name, key, size) : 0;
+}
+
+#else // !RESID_HAVE_MMAP
+
+// Without mmap() the tables are read into memory; this still saves the time
+// needed to build them.
+void* table_cache_map(const char* name, unsigned int key, size_t size)
+{
+  char* path = table_cache_path(name, key);
+  if (!path) {
+    return 0;
+  }
+
+  FILE* f = fopen(path, "rb");
+  delete[] path;
+  if (!f) {
+    return 0;
+  }
+
+  char header[TABLE_CACHE_HEADER_SIZE];
+  char* data = 0;
+  if (fread(header, 1, sizeof(header), f) == sizeof(header)
+      && table_cache_check((const table_cache_header_t*)header, key, size)) {
+    data = new char[size];
+    if (fread(data, 1, size, f) != size) {
+      delete[] data;
+      data = 0;
+    }
+  }
+  fclose(f);
+
+  return data;
+}
+
+void* table_cache_store(const char* name, unsigned int key, const void* data, size_t size)
+{
+  char* path = table_cache_path(name, key);
+  if (!path) {
+    return 0;
+  }
+
+  char* tmp_path = new char[strlen(path) + 8];
+  sprintf(tmp_path, "%s.tmp", path);
+
+  if (table_cache_write(tmp_path, key, data, size)) {
+    // rename() does not replace existing files everywhere.
+    remove(path);
+    if (rename(tmp_path, path) != 0) {
+      remove(tmp_path);
+    }
+  }
+
+  delete[] tmp_path;
+  delete[] path;
+
+  // The caller's copy is as good as a copy read back from the file.
+  return 0;
+}
+
+#endif // RESID_HAVE_MMAP
+
+} // namespace reSID
@@ -0,0 +1,57 @@
+//  ---------------------------------------------------------------------------
+//  This file is part of reSID, a MOS6581 SID emulator engine.
+//  Copyright (C) 2010  Dag Lem <resid@nimrod.no>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//  ---------------------------------------------------------------------------
+
+#ifndef RESID_TABLECACHE_H
+#define RESID_TABLECACHE_H
+
+#include "resid-config.h"
+#include <stddef.h>
+
+namespace reSID
+{
+
+// ----------------------------------------------------------------------------
+// Cache for large, constant lookup tables.
+//
+// Tables which take a long time to build are written to a file in the cache
+// directory once, and mapped read-only by every later instance. Since the
+// mapping is shared, all processes using reSID on the same host also share
+// the physical memory of the tables.
+//
+// The key identifies the tables; it must change whenever the parameters or
+// the code used to build the tables change. Stale files are simply ignored.
+// ----------------------------------------------------------------------------
+
+// Set the cache directory; 0 or "" disables the cache.
+void table_cache_set_dir(const char* dir);
+
+// FNV-1a hash, for building keys.
+unsigned int table_cache_hash(unsigned int hash, const void* data, size_t size);
+
+// Map the cached tables for name/key, returns 0 when there are none.
+void* table_cache_map(const char* name, unsigned int key, size_t size);
+
+// Write freshly built tables to the cache and map them. Returns the mapped
+// copy, or 0 when the tables could not be cached; the caller keeps using
+// its own copy in that case.
+void* table_cache_store(const char* name, unsigned int key, const void* data, size_t size);
+
+} // namespace reSID
+
+#endif // not RESID_TABLECACHE_H
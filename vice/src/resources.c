@@ -410,6 +410,35 @@ char *resources_write_item_to_string(const char *name, const char *delim)
     return NULL;
 }
 
+/** \brief  Write all resources that affect emulation into a string
+ *
+ * Collects the resources that have to match for netplay and event
+ * playback (RES_EVENT_SAME and RES_EVENT_STRICT), one "name=value" item
+ * per line.
+ *
+ * \param[in]   delim   line delimiter
+ *
+ * \return  heap-allocated string, free with lib_free()
+ */
+char *resources_write_event_relevant_to_string(const char *delim)
+{
+    unsigned int i;
+    char *list, *line;
+
+    list = lib_strdup("");
+
+    for (i = 0; i < num_resources; i++) {
+        if (resources[i].event_relevant != RES_EVENT_NO) {
+            line = string_resource_item((int)i, delim);
+            if (line != NULL) {
+                util_addline_free(&list, line);
+            }
+        }
+    }
+
+    return list;
+}
+
 static void resource_create_event_data(char **event_data, int *data_size,
                                        resource_ram_t *r,
                                        resource_value_t value)
@@ -158,6 +158,7 @@ extern int resources_dump(const char *fname);
 extern int resources_write_item_to_file(FILE *fp, const char *name);
 extern int resources_read_item_from_file(FILE *fp);
 extern char *resources_write_item_to_string(const char *name, const char *delim);
+extern char *resources_write_event_relevant_to_string(const char *delim);
 
 extern int resources_set_defaults(void);
 extern int resources_set_default_int(const char *name, int value);
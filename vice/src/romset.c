@@ -38,6 +38,7 @@
 
 #include "archdep.h"
 #include "cmdline.h"
+#include "crc32.h"
 #include "ioutil.h"
 #include "lib.h"
 #include "log.h"
@@ -243,6 +244,37 @@ char *romset_file_list(const char **resource_list)
     return list;
 }
 
+/* Like romset_file_list(), but with a CRC of each ROM file's contents
+   instead of its name, so replacing a ROM image is noticed.  ROMs that
+   can't be found get a CRC of 0.  */
+char *romset_file_crc_list(const char **resource_list)
+{
+    char *list;
+    const char *s;
+
+    list = lib_strdup("");
+    s = *resource_list++;
+
+    while (s != NULL) {
+        const char *name;
+        char *path;
+        uint32_t crc = 0;
+
+        if (resources_query_type(s) == RES_STRING
+            && resources_get_string(s, &name) == 0
+            && name != NULL && *name != '\0'
+            && sysfile_locate(name, &path) == 0) {
+            crc = crc32_file(path);
+            lib_free(path);
+        }
+        util_addline_free(&list, lib_msprintf("%s=%08x", s, crc));
+
+        s = *resource_list++;
+    }
+
+    return list;
+}
+
 
 typedef struct string_link_s {
     char *name;
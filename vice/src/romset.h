@@ -36,6 +36,7 @@ extern int romset_cmdline_options_init(void);
 extern int romset_file_load(const char *filename);
 extern int romset_file_save(const char *filename, const char **resource_list);
 extern char *romset_file_list(const char **resource_list);
+extern char *romset_file_crc_list(const char **resource_list);
 
 extern int romset_archive_load(const char *filename, int autostart);
 extern int romset_archive_save(const char *filename);
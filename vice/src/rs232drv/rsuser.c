@@ -37,7 +37,6 @@
 #include <stdio.h>
 
 #include "alarm.h"
-#include "clkguard.h"
 #include "cmdline.h"
 #include "log.h"
 #include "maincpu.h"
@@ -65,7 +64,6 @@ static CLOCK clk_end_tx = 0;
 static void (*start_bit_trigger)(void);
 static void (*byte_rx_func)(uint8_t);
 
-static void clk_overflow_callback(CLOCK sub, void *data);
 
 static void int_rsuser(CLOCK offset, void *data);
 
@@ -243,8 +241,6 @@ void rsuser_init(long cycles, void (*startfunc)(void), void (*bytefunc)(uint8_t)
 
     rsuser_alarm = alarm_new(maincpu_alarm_context, "RSUser", int_rsuser, NULL);
 
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
-
     cycles_per_sec = cycles;
     calculate_baudrate();
 
@@ -548,16 +544,3 @@ static void int_rsuser(CLOCK offset, void *data)
             break;
     }
 }
-
-static void clk_overflow_callback(CLOCK sub, void *data)
-{
-    if (clk_start_tx) {
-        clk_start_tx -= sub;
-    }
-    if (clk_start_rx) {
-        clk_start_rx -= sub;
-    }
-    if (clk_start_bit) {
-        clk_start_bit -= sub;
-    }
-}
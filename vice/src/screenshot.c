@@ -34,15 +34,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "cmdline.h"
 #include "gfxoutput.h"
 #include "lib.h"
 #include "log.h"
+#include "machine-video.h"
 #include "machine.h"
 #include "palette.h"
 #include "resources.h"
 #include "screenshot.h"
 #include "uiapi.h"
+#include "util.h"
 #include "video.h"
+#include "workqueue.h"
 
 
 static log_t screenshot_log = LOG_ERR;
@@ -54,6 +58,49 @@ static char *reopen_recording_drivername;
 static struct video_canvas_s *reopen_recording_canvas;
 static char *reopen_filename;
 
+/* Background encoding of the burst sequence: the emulation thread copies
+   the frame and opens/closes the file, the driver's write function runs on
+   one of the worker threads.  */
+static workqueue_t *screenshot_workqueue = NULL;
+static int screenshot_workers = 1;
+
+/* Burst mode: save every Nth frame to a numbered sequence.  */
+static char *burst_name = NULL;
+static char *burst_driver = NULL;
+static int burst_interval = 1;
+static unsigned int burst_frame = 0;
+static unsigned int burst_index = 0;
+
+#define SCREENSHOT_WORKERS_MAX  16
+#define SCREENSHOT_QUEUE_SIZE   16
+
+/* Drivers whose write function only uses its own gfxoutputdrv_data, and
+   neither allocates nor logs, so it may run on several threads at once.  */
+static const char * const screenshot_async_drivers[] = {
+    "BMP", "IFF", "PCX", "PNG", "PPM", NULL
+};
+
+#if defined(__GNUC__)
+#define SCREENSHOT_BARRIER() __sync_synchronize()
+#else
+#define SCREENSHOT_BARRIER()
+#endif
+
+typedef struct screenshot_job_s {
+    gfxoutputdrv_t *drv;
+    char *filename;
+    screenshot_t screenshot;
+    palette_t palette;
+    int failed;
+    volatile int done;              /* set by the worker when it's finished */
+    struct screenshot_job_s *next;
+} screenshot_job_t;
+
+/* Jobs handed to the workers, only used by the emulation thread.  */
+static screenshot_job_t *screenshot_jobs = NULL;
+
+static void screenshot_finish_jobs(void);
+
 
 /** \brief  Initialize module
  *
@@ -76,6 +123,16 @@ int screenshot_init(void)
  */
 void screenshot_shutdown(void)
 {
+    /* finish pending saves */
+    workqueue_destroy(screenshot_workqueue);
+    screenshot_workqueue = NULL;
+    screenshot_finish_jobs();
+
+    lib_free(burst_name);
+    burst_name = NULL;
+    lib_free(burst_driver);
+    burst_driver = NULL;
+
     if (reopen_recording_drivername != NULL) {
         lib_free(reopen_recording_drivername);
     }
@@ -86,6 +143,105 @@ void screenshot_shutdown(void)
 
 
 
+/*-----------------------------------------------------------------------*/
+
+static int set_screenshot_workers(int val, void *param)
+{
+    if (val < 0 || val > SCREENSHOT_WORKERS_MAX) {
+        return -1;
+    }
+
+    if (val != screenshot_workers) {
+        /* the queue is recreated on the next save */
+        workqueue_destroy(screenshot_workqueue);
+        screenshot_workqueue = NULL;
+        screenshot_finish_jobs();
+    }
+    screenshot_workers = val;
+
+    return 0;
+}
+
+static int set_burst_name(const char *val, void *param)
+{
+    util_string_set(&burst_name, val);
+    burst_frame = 0;
+    burst_index = 0;
+
+    return 0;
+}
+
+static int set_burst_driver(const char *val, void *param)
+{
+    util_string_set(&burst_driver, val);
+
+    return 0;
+}
+
+static int set_burst_interval(int val, void *param)
+{
+    if (val < 1) {
+        return -1;
+    }
+    burst_interval = val;
+
+    return 0;
+}
+
+static const resource_string_t resources_string[] = {
+    { "ScreenshotBurstName", "", RES_EVENT_NO, NULL,
+      &burst_name, set_burst_name, NULL },
+    { "ScreenshotBurstDriver", "PNG", RES_EVENT_NO, NULL,
+      &burst_driver, set_burst_driver, NULL },
+    RESOURCE_STRING_LIST_END
+};
+
+static const resource_int_t resources_int[] = {
+    { "ScreenshotWorkers", 1, RES_EVENT_NO, NULL,
+      &screenshot_workers, set_screenshot_workers, NULL },
+    { "ScreenshotBurstInterval", 1, RES_EVENT_NO, NULL,
+      &burst_interval, set_burst_interval, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+/** \brief  Register resources of the module
+ *
+ * \return  0 on success, -1 on error
+ */
+int screenshot_resources_init(void)
+{
+    if (resources_register_string(resources_string) < 0) {
+        return -1;
+    }
+    return resources_register_int(resources_int);
+}
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-screenshotworkers", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "ScreenshotWorkers", NULL,
+      "<value>", "Set number of threads encoding the screenshot sequence (0: encode on the emulation thread)" },
+    { "-screenshotburst", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "ScreenshotBurstName", NULL,
+      "<Name>", "Save a numbered screenshot sequence <Name>NNNNNN while running" },
+    { "-screenshotburstdriver", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "ScreenshotBurstDriver", NULL,
+      "<Name>", "Set graphics output driver used for the screenshot sequence" },
+    { "-screenshotburstinterval", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "ScreenshotBurstInterval", NULL,
+      "<value>", "Save only every Nth frame of the screenshot sequence" },
+    CMDLINE_LIST_END
+};
+
+/** \brief  Register command line options of the module
+ *
+ * \return  0 on success, -1 on error
+ */
+int screenshot_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
 /*-----------------------------------------------------------------------*/
 
 static void screenshot_line_data(screenshot_t *screenshot, uint8_t *data,
@@ -135,8 +291,7 @@ static void screenshot_line_data(screenshot_t *screenshot, uint8_t *data,
 }
 
 /*-----------------------------------------------------------------------*/
-static int screenshot_save_core(screenshot_t *screenshot, gfxoutputdrv_t *drv,
-                                const char *filename)
+static void screenshot_setup(screenshot_t *screenshot)
 {
     unsigned int i;
 
@@ -151,6 +306,12 @@ static int screenshot_save_core(screenshot_t *screenshot, gfxoutputdrv_t *drv,
     }
 
     screenshot->convert_line = screenshot_line_data;
+}
+
+static int screenshot_save_core(screenshot_t *screenshot, gfxoutputdrv_t *drv,
+                                const char *filename)
+{
+    screenshot_setup(screenshot);
 
     if (drv != NULL) {
         if (drv->save_native != NULL) {
@@ -183,6 +344,153 @@ static int screenshot_save_core(screenshot_t *screenshot, gfxoutputdrv_t *drv,
 
 /*-----------------------------------------------------------------------*/
 
+static int screenshot_driver_is_async(gfxoutputdrv_t *drv)
+{
+    int i;
+
+    if (drv->open == NULL || drv->write == NULL || drv->close == NULL
+        || drv->save_native != NULL || drv->record != NULL) {
+        return 0;
+    }
+
+    for (i = 0; screenshot_async_drivers[i] != NULL; i++) {
+        if (strcmp(drv->name, screenshot_async_drivers[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void screenshot_job_free(screenshot_job_t *job)
+{
+    lib_free(job->screenshot.draw_buffer);
+    lib_free(job->screenshot.color_map);
+    lib_free(job->palette.entries);
+    lib_free(job->filename);
+    lib_free(job);
+}
+
+/* Runs on a worker thread, so it must neither allocate nor log.  */
+static void screenshot_job_run(void *data)
+{
+    screenshot_job_t *job = (screenshot_job_t *)data;
+    unsigned int i;
+
+    for (i = 0; i < job->screenshot.height; i++) {
+        if ((job->drv->write)(&job->screenshot) < 0) {
+            job->failed = 1;
+            break;
+        }
+    }
+
+    /* everything written must be visible before the flag */
+    SCREENSHOT_BARRIER();
+    job->done = 1;
+}
+
+/* Close the files of the jobs the workers have finished.  The first
+   failure is reported to the user and stops the burst sequence.  With
+   `wait' set, all jobs are expected to be done.  */
+static void screenshot_reap_jobs(int wait)
+{
+    screenshot_job_t **link = &screenshot_jobs;
+
+    while (*link != NULL) {
+        screenshot_job_t *job = *link;
+
+        if (!job->done && !wait) {
+            link = &job->next;
+            continue;
+        }
+        SCREENSHOT_BARRIER();
+
+        if ((job->drv->close)(&job->screenshot) < 0) {
+            job->failed = 1;
+        }
+        if (job->failed) {
+            log_error(screenshot_log, "Saving `%s' failed...", job->filename);
+            if (burst_name != NULL && burst_name[0] != 0) {
+                ui_error("Saving screenshot `%s' failed, burst mode stopped.",
+                         job->filename);
+                resources_set_string("ScreenshotBurstName", "");
+            }
+        }
+
+        *link = job->next;
+        screenshot_job_free(job);
+    }
+}
+
+/* Wait for the workers and close all files.  */
+static void screenshot_finish_jobs(void)
+{
+    if (screenshot_workqueue != NULL) {
+        workqueue_wait(screenshot_workqueue);
+    }
+    screenshot_reap_jobs(1);
+}
+
+/* Take a copy of the visible part of the frame and its palette, open the
+   file and hand the encoding to the worker threads.  The file is closed by
+   screenshot_reap_jobs() once the job is done.  */
+static int screenshot_save_async(screenshot_t *screenshot, gfxoutputdrv_t *drv,
+                                 const char *filename)
+{
+    screenshot_job_t *job;
+    unsigned int i;
+    unsigned int first_line, num_lines;
+
+    if (screenshot_workqueue == NULL) {
+        screenshot_workqueue = workqueue_create("screenshot", screenshot_workers,
+                                                SCREENSHOT_QUEUE_SIZE);
+    }
+
+    job = lib_calloc(1, sizeof(screenshot_job_t));
+    job->drv = drv;
+    job->filename = lib_strdup(filename);
+    job->screenshot = *screenshot;
+
+    screenshot_setup(&job->screenshot);
+
+    /* only the displayed lines are copied, so they start at line 0 */
+    first_line = job->screenshot.y_offset * job->screenshot.size_height;
+    num_lines = job->screenshot.height * job->screenshot.size_height;
+    job->screenshot.draw_buffer
+        = lib_malloc((size_t)num_lines * job->screenshot.draw_buffer_line_size);
+    memcpy(job->screenshot.draw_buffer,
+           screenshot->draw_buffer + (size_t)first_line * job->screenshot.draw_buffer_line_size,
+           (size_t)num_lines * job->screenshot.draw_buffer_line_size);
+    job->screenshot.y_offset = 0;
+
+    job->palette.num_entries = screenshot->palette->num_entries;
+    job->palette.entries = lib_malloc(sizeof(palette_entry_t) * job->palette.num_entries);
+    for (i = 0; i < job->palette.num_entries; i++) {
+        job->palette.entries[i] = screenshot->palette->entries[i];
+        job->palette.entries[i].name = NULL;
+    }
+    job->screenshot.palette = &job->palette;
+
+    job->screenshot.canvas = NULL;
+    job->screenshot.gfxoutputdrv_data = NULL;
+
+    if ((drv->open)(&job->screenshot, filename) < 0) {
+        screenshot_job_free(job);
+        return -1;
+    }
+
+    /* waits for a free slot if the workers fall behind */
+    if (workqueue_submit(screenshot_workqueue, screenshot_job_run, job) < 0) {
+        (drv->close)(&job->screenshot);
+        screenshot_job_free(job);
+        return -1;
+    }
+
+    job->next = screenshot_jobs;
+    screenshot_jobs = job;
+
+    return 0;
+}
+
 int screenshot_save(const char *drvname, const char *filename,
                     struct video_canvas_s *canvas)
 {
@@ -240,10 +548,56 @@ int memmap_screenshot_save(const char *drvname, const char *filename, int x_size
 }
 #endif
 
+/* Save the next picture of the burst sequence, if it is due.  */
+static void screenshot_burst_frame(void)
+{
+    gfxoutputdrv_t *drv;
+    screenshot_t screenshot;
+    char *filename;
+    int result;
+
+    if (burst_frame++ % (unsigned int)burst_interval != 0) {
+        return;
+    }
+
+    drv = gfxoutput_get_driver(burst_driver);
+    if (drv == NULL || drv->save == NULL || drv->record != NULL) {
+        log_error(screenshot_log, "Driver `%s' can't save a screenshot sequence, burst mode stopped.",
+                  burst_driver);
+        resources_set_string("ScreenshotBurstName", "");
+        return;
+    }
+
+    filename = lib_msprintf("%s%06u", burst_name, burst_index++);
+    if (screenshot_workers > 0 && screenshot_driver_is_async(drv)) {
+        if (machine_screenshot(&screenshot, machine_video_canvas_get(0)) < 0) {
+            log_error(screenshot_log, "Retrieving screen geometry failed.");
+            result = -1;
+        } else {
+            result = screenshot_save_async(&screenshot, drv, filename);
+        }
+    } else {
+        result = screenshot_save(burst_driver, filename, machine_video_canvas_get(0));
+    }
+    if (result < 0) {
+        log_error(screenshot_log, "Saving `%s' failed, burst mode stopped.", filename);
+        resources_set_string("ScreenshotBurstName", "");
+    }
+    lib_free(filename);
+}
+
 int screenshot_record(void)
 {
     screenshot_t screenshot;
 
+    if (screenshot_jobs != NULL) {
+        screenshot_reap_jobs(0);
+    }
+
+    if (burst_name != NULL && burst_name[0] != 0) {
+        screenshot_burst_frame();
+    }
+
     if (recording_driver == NULL) {
         return 0;
     }
@@ -110,6 +110,8 @@ typedef struct screenshot_s {
 /* Functions called by external emulator code.  */
 extern int screenshot_init(void);
 extern void screenshot_shutdown(void);
+extern int screenshot_resources_init(void);
+extern int screenshot_cmdline_options_init(void);
 extern int screenshot_save(const char *drvname, const char *filename,
                            struct video_canvas_s *canvas);
 extern int screenshot_record(void);
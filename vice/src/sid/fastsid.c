@@ -1071,11 +1071,6 @@ static void fastsid_reset(sound_t *psid, CLOCK cpu_clk)
     psid->laststoreclk = cpu_clk;
 }
 
-static void fastsid_prevent_clk_overflow(sound_t *psid, CLOCK sub)
-{
-    psid->laststoreclk -= sub;
-}
-
 static void fastsid_resid_state_read(sound_t *psid, sid_snapshot_state_t *sid_state)
 {
 }
@@ -1093,7 +1088,7 @@ sid_engine_t fastsid_hooks =
     fastsid_store,
     fastsid_reset,
     fastsid_calculate_samples,
-    fastsid_prevent_clk_overflow,
+    NULL,
     fastsid_dump_state,
     fastsid_resid_state_read,
     fastsid_resid_state_write
@@ -1124,7 +1119,7 @@ void fastsid_state_read(struct sound_s *psid, struct sid_fastsid_snapshot_state_
     sid_state->newsid = psid->newsid;
     sid_state->laststore = psid->laststore;
     sid_state->laststorebit = psid->laststorebit;
-    sid_state->laststoreclk = (uint32_t)psid->laststoreclk;
+    sid_state->laststoreclk = psid->laststoreclk;
     sid_state->emulatefilter = (uint32_t)psid->emulatefilter;
     sid_state->filterDy = (float)psid->filterDy;
     sid_state->filterResDy = (float)psid->filterResDy;
@@ -1213,7 +1208,7 @@ void fastsid_state_write(struct sound_s *psid, struct sid_fastsid_snapshot_state
     psid->newsid = sid_state->newsid;
     psid->laststore = sid_state->laststore;
     psid->laststorebit = sid_state->laststorebit;
-    psid->laststoreclk = (CLOCK)sid_state->laststoreclk;
+    psid->laststoreclk = sid_state->laststoreclk;
     psid->emulatefilter = (int)sid_state->emulatefilter;
     psid->filterDy = (vreal_t)sid_state->filterDy;
     psid->filterResDy = (vreal_t)sid_state->filterResDy;
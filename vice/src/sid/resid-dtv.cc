@@ -201,10 +201,6 @@ static int resid_calculate_samples(sound_t *psid, short *pbuf, int nr,
     return psid->sid->clock(*delta_t, pbuf, nr, interleave);
 }
 
-static void resid_prevent_clk_overflow(sound_t *psid, CLOCK sub)
-{
-}
-
 static char *resid_dump_state(sound_t *psid)
 {
     return lib_strdup("");
@@ -273,7 +269,7 @@ sid_engine_t resid_hooks =
     resid_store,
     resid_reset,
     resid_calculate_samples,
-    resid_prevent_clk_overflow,
+    NULL,
     resid_dump_state,
     resid_state_read,
     resid_state_write
@@ -60,6 +60,7 @@ extern char *strcpy(char *s1, char *s2);
 #endif
 
 #include "sid/sid.h" /* sid_engine_t */
+#include "archdep.h"
 #include "lib.h"
 #include "log.h"
 #include "resid.h"
@@ -83,34 +84,47 @@ struct sound_s
 
     /* resid sid implementation */
     reSID::SID *sid;
+
+    /* temporary buffer, per chip so several SIDs can be calculated in
+       parallel */
+    short *buf;
+    int blen;
 };
 
 typedef struct sound_s sound_t;
 
 /* manage temporary buffers. if the requested size is smaller or equal to the
  * size of the already allocated buffer, reuse it.  */
-static short *buf = NULL;
-static int blen = 0;
-
-static short *getbuf(int len)
+static short *getbuf(sound_t *psid, int len)
 {
-    if ((buf == NULL) || (blen < len)) {
-        if (buf) {
-            lib_free(buf);
+    if ((psid->buf == NULL) || (psid->blen < len)) {
+        if (psid->buf) {
+            lib_free(psid->buf);
         }
-        blen = len;
-        buf = (short *)lib_calloc(len, 1);
+        psid->blen = len;
+        psid->buf = (short *)lib_calloc(len, 1);
     }
-    return buf;
+    return psid->buf;
 }
 
+static int table_cache_dir_set = 0;
+
 static sound_t *resid_open(uint8_t *sidstate)
 {
     sound_t *psid;
     int i;
 
+    /* The filter tables are cached in the user cache dir, which lets all
+       VICE processes on the host share them.  */
+    if (!table_cache_dir_set) {
+        reSID::SID::set_table_cache_dir(archdep_user_cache_path());
+        table_cache_dir_set = 1;
+    }
+
     psid = new sound_t;
     psid->sid = new reSID::SID;
+    psid->buf = NULL;
+    psid->blen = 0;
 
     for (i = 0x00; i <= 0x18; i++) {
         psid->sid->write(i, sidstate[i]);
@@ -246,13 +260,12 @@ static int resid_init(sound_t *psid, int speed, int cycles_per_sec, int factor)
 
 static void resid_close(sound_t *psid)
 {
+    if (psid->buf) {
+        lib_free(psid->buf);
+    }
+
     delete psid->sid;
     delete psid;
-
-    if (buf) {
-        lib_free(buf);
-        buf = NULL;
-    }
 }
 
 static uint8_t resid_read(sound_t *psid, uint16_t addr)
@@ -279,14 +292,15 @@ static int resid_calculate_samples(sound_t *psid, short *pbuf, int nr,
     if (psid->factor == 1000) {
         return psid->sid->clock(*delta_t, pbuf, nr, interleave);
     }
-    tmp_buf = getbuf(2 * nr * psid->factor / 1000);
+    tmp_buf = getbuf(psid, 2 * nr * psid->factor / 1000);
     retval = psid->sid->clock(*delta_t, tmp_buf, nr * psid->factor / 1000, interleave) * 1000 / psid->factor;
     memcpy(pbuf, tmp_buf, 2 * nr);
     return retval;
 }
 
-static void resid_prevent_clk_overflow(sound_t *psid, CLOCK sub)
+static void resid_skip_samples(sound_t *psid, int delta_t)
 {
+    psid->sid->clock_silent(delta_t);
 }
 
 static char *resid_dump_state(sound_t *psid)
@@ -378,7 +392,7 @@ sid_engine_t resid_hooks =
     resid_store,
     resid_reset,
     resid_calculate_samples,
-    resid_prevent_clk_overflow,
+    resid_skip_samples,
     resid_dump_state,
     resid_state_read,
     resid_state_write
@@ -222,6 +222,9 @@ static cmdline_option_t stereo_cmdline_options[] =
     { "-sidquadaddress", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
       NULL, NULL, "SidQuadAddressStart", NULL,
       "<Base address>", NULL },
+    { "-sidworkers", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "SidWorkers", NULL,
+      "<amount>", "amount of threads synthesizing extra SID chips, 0 to use the emulation thread only. (0..3)" },
     CMDLINE_LIST_END
 };
 
@@ -64,6 +64,7 @@ static int sid_resid_8580_gain;
 static int sid_resid_8580_filter_bias;
 #endif
 int sid_stereo = 0;
+int sid_workers = 3;
 int checking_sid_stereo;
 unsigned int sid_stereo_address_start;
 unsigned int sid_stereo_address_end;
@@ -156,6 +157,15 @@ static int set_sid_stereo(int val, void *param)
     return 0;
 }
 
+static int set_sid_workers(int val, void *param)
+{
+    if (val < 0 || val > (SOUND_SIDS_MAX - 1)) {
+        return -1;
+    }
+    sid_workers = val;
+    return 0;
+}
+
 int sid_set_sid_stereo_address(int val, void *param)
 {
     unsigned int sid2_adr;
@@ -425,6 +435,8 @@ static const resource_int_t hardsid_resources_int[] = {
 static const resource_int_t stereo_resources_int[] = {
     { "SidStereo", 0, RES_EVENT_SAME, NULL,
       &sid_stereo, set_sid_stereo, NULL },
+    { "SidWorkers", 3, RES_EVENT_NO, NULL,
+      &sid_workers, set_sid_workers, NULL },
     RESOURCE_INT_LIST_END
 };
 
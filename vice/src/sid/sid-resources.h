@@ -41,6 +41,7 @@ extern int sid_set_sid_triple_address(int val, void *param);
 extern int sid_set_sid_quad_address(int val, void *param);
 
 extern int sid_stereo;
+extern int sid_workers;
 extern int checking_sid_stereo;
 extern unsigned int sid_stereo_address_start;
 extern unsigned int sid_stereo_address_end;
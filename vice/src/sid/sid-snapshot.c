@@ -374,7 +374,7 @@ fail:
    BYTE   | newsid          | new SID flag
    BYTE   | laststore       | last store
    BYTE   | laststorebit    | last store bit
-   DWORD  | laststoreclk    | CLOCK of the last store
+   CLOCK  | laststoreclk    | CLOCK of the last store
    DWORD  | emulatefilter   | emulate filters flag
    DOUBLE | filterDy        | filter Dy
    DOUBLE | filterResDy     | filter Res Dy
@@ -427,7 +427,7 @@ static int sid_snapshot_write_fastsid_module(snapshot_module_t *m, int sidnr)
         || SMW_B(m, sid_state.newsid) < 0
         || SMW_B(m, sid_state.laststore) < 0
         || SMW_B(m, sid_state.laststorebit) < 0
-        || SMW_DW(m, sid_state.laststoreclk) < 0
+        || SMW_CLOCK(m, sid_state.laststoreclk) < 0
         || SMW_DW(m, sid_state.emulatefilter) < 0
         || SMW_DB(m, (double)sid_state.filterDy) < 0
         || SMW_DB(m, (double)sid_state.filterResDy) < 0
@@ -503,7 +503,7 @@ static int sid_snapshot_read_fastsid_module(snapshot_module_t *m, int sidnr)
         || SMR_B(m, &sid_state.newsid) < 0
         || SMR_B(m, &sid_state.laststore) < 0
         || SMR_B(m, &sid_state.laststorebit) < 0
-        || SMR_DW(m, &sid_state.laststoreclk) < 0
+        || SMR_CLOCK(m, &sid_state.laststoreclk) < 0
         || SMR_DW(m, &sid_state.emulatefilter) < 0) {
         return -1;
     }
@@ -744,9 +744,9 @@ static int sid_snapshot_read_cw3_module(snapshot_module_t *m, int sidnr)
    type  | name               | version | description
    --------------------------------------------------
    ARRAY | registers          |   1.2+  | 32 BYTES of register data
-   DWORD | main clock         |   1.2+  | main clock
-   DWORD | alarm clock        |   1.2+  | alarm clock
-   DWORD | last access clock  |   1.2+  | last access clock
+   CLOCK | main clock         |   1.2+  | main clock
+   CLOCK | alarm clock        |   1.2+  | alarm clock
+   CLOCK | last access clock  |   1.2+  | last access clock
    DWORD | last access ms     |   1.2+  | last access ms
    DWORD | last access chipno |   1.2+  | last access chipno
    DWORD | chip used          |   1.2+  | chip used
@@ -763,9 +763,9 @@ static int sid_snapshot_write_hs_module(snapshot_module_t *m, int sidnr)
 
     if (0
         || SMW_BA(m, sid_state.regs, 32) < 0
-        || SMW_DW(m, sid_state.hsid_main_clk) < 0
-        || SMW_DW(m, sid_state.hsid_alarm_clk) < 0
-        || SMW_DW(m, sid_state.lastaccess_clk) < 0
+        || SMW_CLOCK(m, sid_state.hsid_main_clk) < 0
+        || SMW_CLOCK(m, sid_state.hsid_alarm_clk) < 0
+        || SMW_CLOCK(m, sid_state.lastaccess_clk) < 0
         || SMW_DW(m, sid_state.lastaccess_ms) < 0
         || SMW_DW(m, sid_state.lastaccess_chipno) < 0
         || SMW_DW(m, sid_state.chipused) < 0
@@ -781,9 +781,9 @@ static int sid_snapshot_read_hs_module(snapshot_module_t *m, int sidnr, uint8_t
 
     if (0
         || SMR_BA(m, sid_state.regs, 32) < 0
-        || SMR_DW(m, &sid_state.hsid_main_clk) < 0
-        || SMR_DW(m, &sid_state.hsid_alarm_clk) < 0
-        || SMR_DW(m, &sid_state.lastaccess_clk) < 0
+        || SMR_CLOCK(m, &sid_state.hsid_main_clk) < 0
+        || SMR_CLOCK(m, &sid_state.hsid_alarm_clk) < 0
+        || SMR_CLOCK(m, &sid_state.lastaccess_clk) < 0
         || SMR_DW(m, &sid_state.lastaccess_ms) < 0
         || SMR_DW(m, &sid_state.lastaccess_chipno) < 0
         || SMR_DW(m, &sid_state.chipused) < 0
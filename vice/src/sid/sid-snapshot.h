@@ -67,7 +67,7 @@ typedef struct sid_fastsid_snapshot_state_s {
     uint8_t newsid;
     uint8_t laststore;
     uint8_t laststorebit;
-    uint32_t laststoreclk;
+    CLOCK laststoreclk;
     uint32_t emulatefilter;
     float filterDy;
     float filterResDy;
@@ -110,9 +110,9 @@ typedef struct sid_cw3_snapshot_state_s {
 
 typedef struct sid_hs_snapshot_state_s {
     uint8_t regs[32];
-    uint32_t hsid_main_clk;
-    uint32_t hsid_alarm_clk;
-    uint32_t lastaccess_clk;
+    CLOCK hsid_main_clk;
+    CLOCK hsid_alarm_clk;
+    CLOCK lastaccess_clk;
     uint32_t lastaccess_ms;
     uint32_t lastaccess_chipno;
     uint32_t chipused;
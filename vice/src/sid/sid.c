@@ -48,6 +48,7 @@
 #include "sound.h"
 #include "ssi2001.h"
 #include "types.h"
+#include "workqueue.h"
 
 #ifdef HAVE_MOUSE
 #include "mouse.h"
@@ -381,6 +382,9 @@ static int blen1 = 0;
 static int blen2 = 0;
 static int blen3 = 0;
 
+/* Worker threads for synthesizing several SIDs at once.  */
+static workqueue_t *calc_workqueue = NULL;
+static int calc_workqueue_threads = 0;
 
 static int16_t *getbuf1(int len)
 {
@@ -456,6 +460,10 @@ void sid_sound_machine_close(sound_t *psid)
         blen3 = 0;
         buf3 = NULL;
     }
+    if (calc_workqueue) {
+        workqueue_destroy(calc_workqueue);
+        calc_workqueue = NULL;
+    }
 }
 
 uint8_t sid_sound_machine_read(sound_t *psid, uint16_t addr)
@@ -473,6 +481,101 @@ void sid_sound_machine_reset(sound_t *psid, CLOCK cpu_clk)
     sid_engine.reset(psid, cpu_clk);
 }
 
+/* Synthesis of one chip for the current block of samples.  Between two
+   register accesses the chips do not depend on each other, so the jobs of
+   one block can run on worker threads.  */
+typedef struct sid_calc_job_s {
+    sound_t *psid;
+    int16_t *pbuf;
+    int nr;
+    int interleave;
+    int delta_t;
+    int result;
+} sid_calc_job_t;
+
+static sid_calc_job_t calc_jobs[SOUND_SIDS_MAX];
+static int calc_num_jobs = 0;
+
+/* Blocks shorter than this are not worth handing to other threads; these
+   are mostly the short gaps between the register writes of a player.  */
+#define SID_CALC_PARALLEL_MIN_CYCLES 1000
+
+static void sid_calc_job(void *data)
+{
+    sid_calc_job_t *job = (sid_calc_job_t *)data;
+
+    job->result = sid_engine.calculate_samples(job->psid, job->pbuf, job->nr,
+                                               job->interleave, &job->delta_t);
+}
+
+static void sid_calc_add(sound_t *psid, int16_t *pbuf, int nr, int interleave,
+                         int delta_t)
+{
+    sid_calc_job_t *job = &calc_jobs[calc_num_jobs++];
+
+    job->psid = psid;
+    job->pbuf = pbuf;
+    job->nr = nr;
+    job->interleave = interleave;
+    job->delta_t = delta_t;
+}
+
+static workqueue_t *sid_calc_get_workqueue(void)
+{
+    int threads = sid_workers;
+
+    if (threads > workqueue_cpu_count() - 1) {
+        threads = workqueue_cpu_count() - 1;
+    }
+    if (threads > SOUND_SIDS_MAX - 1) {
+        threads = SOUND_SIDS_MAX - 1;
+    }
+    if (threads < 0) {
+        threads = 0;
+    }
+
+    if (calc_workqueue != NULL && calc_workqueue_threads != threads) {
+        workqueue_destroy(calc_workqueue);
+        calc_workqueue = NULL;
+    }
+    if (calc_workqueue == NULL && threads > 0) {
+        calc_workqueue = workqueue_create("SID", threads, SOUND_SIDS_MAX);
+        calc_workqueue_threads = threads;
+    }
+    return calc_workqueue;
+}
+
+/* Run the queued jobs. Like the sequential code did, the last job is the
+   one whose remaining delta_t and number of samples are passed back.  */
+static int sid_calc_run(int *delta_t)
+{
+    sid_calc_job_t *last = &calc_jobs[calc_num_jobs - 1];
+    workqueue_t *wq = NULL;
+    int i;
+
+    if (sidengine == SID_ENGINE_RESID
+        && calc_num_jobs > 1
+        && *delta_t >= SID_CALC_PARALLEL_MIN_CYCLES) {
+        wq = sid_calc_get_workqueue();
+    }
+
+    if (wq != NULL) {
+        for (i = 1; i < calc_num_jobs; i++) {
+            workqueue_submit(wq, sid_calc_job, &calc_jobs[i]);
+        }
+        sid_calc_job(&calc_jobs[0]);
+        workqueue_wait(wq);
+    } else {
+        for (i = 0; i < calc_num_jobs; i++) {
+            sid_calc_job(&calc_jobs[i]);
+        }
+    }
+
+    calc_num_jobs = 0;
+    *delta_t = last->delta_t;
+    return last->result;
+}
+
 int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, int soc, int scc, int *delta_t)
 {
     int i;
@@ -480,15 +583,15 @@ int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, i
     int16_t *tmp_buf2;
     int16_t *tmp_buf3;
     int tmp_nr = 0;
-    int tmp_delta_t = *delta_t;
 
     if (soc == 1 && scc == 1) {
         return sid_engine.calculate_samples(psid[0], pbuf, nr, 1, delta_t);
     }
     if (soc == 1 && scc == 2) {
         tmp_buf1 = getbuf1(2 * nr);
-        tmp_nr = sid_engine.calculate_samples(psid[0], tmp_buf1, nr, 1, &tmp_delta_t);
-        tmp_nr = sid_engine.calculate_samples(psid[1], pbuf, nr, 1, delta_t);
+        sid_calc_add(psid[0], tmp_buf1, nr, 1, *delta_t);
+        sid_calc_add(psid[1], pbuf, nr, 1, *delta_t);
+        tmp_nr = sid_calc_run(delta_t);
         for (i = 0; i < tmp_nr; i++) {
             pbuf[i] = sound_audio_mix(pbuf[i], tmp_buf1[i]);
         }
@@ -497,10 +600,10 @@ int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, i
     if (soc == 1 && scc == 3) {
         tmp_buf1 = getbuf1(2 * nr);
         tmp_buf2 = getbuf2(2 * nr);
-        tmp_nr = sid_engine.calculate_samples(psid[0], tmp_buf1, nr, 1, &tmp_delta_t);
-        tmp_delta_t = *delta_t;
-        tmp_nr = sid_engine.calculate_samples(psid[2], tmp_buf2, nr, 1, &tmp_delta_t);
-        tmp_nr = sid_engine.calculate_samples(psid[1], pbuf, nr, 1, delta_t);
+        sid_calc_add(psid[0], tmp_buf1, nr, 1, *delta_t);
+        sid_calc_add(psid[2], tmp_buf2, nr, 1, *delta_t);
+        sid_calc_add(psid[1], pbuf, nr, 1, *delta_t);
+        tmp_nr = sid_calc_run(delta_t);
         for (i = 0; i < tmp_nr; i++) {
             pbuf[i] = sound_audio_mix(pbuf[i], tmp_buf1[i]);
             pbuf[i] = sound_audio_mix(pbuf[i], tmp_buf2[i]);
@@ -511,12 +614,11 @@ int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, i
         tmp_buf1 = getbuf1(2 * nr);
         tmp_buf2 = getbuf2(2 * nr);
         tmp_buf3 = getbuf3(2 * nr);
-        tmp_nr = sid_engine.calculate_samples(psid[0], tmp_buf1, nr, 1, &tmp_delta_t);
-        tmp_delta_t = *delta_t;
-        tmp_nr = sid_engine.calculate_samples(psid[2], tmp_buf2, nr, 1, &tmp_delta_t);
-        tmp_delta_t = *delta_t;
-        tmp_nr = sid_engine.calculate_samples(psid[3], tmp_buf3, nr, 1, &tmp_delta_t);
-        tmp_nr = sid_engine.calculate_samples(psid[1], pbuf, nr, 1, delta_t);
+        sid_calc_add(psid[0], tmp_buf1, nr, 1, *delta_t);
+        sid_calc_add(psid[2], tmp_buf2, nr, 1, *delta_t);
+        sid_calc_add(psid[3], tmp_buf3, nr, 1, *delta_t);
+        sid_calc_add(psid[1], pbuf, nr, 1, *delta_t);
+        tmp_nr = sid_calc_run(delta_t);
         for (i = 0; i < tmp_nr; i++) {
             pbuf[i] = sound_audio_mix(pbuf[i], tmp_buf1[i]);
             pbuf[i] = sound_audio_mix(pbuf[i], tmp_buf2[i]);
@@ -532,16 +634,16 @@ int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, i
         return tmp_nr;
     }
     if (soc == 2 && scc == 2) {
-        tmp_nr = sid_engine.calculate_samples(psid[0], pbuf, nr, 2, &tmp_delta_t);
-        tmp_nr = sid_engine.calculate_samples(psid[1], pbuf + 1, nr, 2, delta_t);
-        return tmp_nr;
+        sid_calc_add(psid[0], pbuf, nr, 2, *delta_t);
+        sid_calc_add(psid[1], pbuf + 1, nr, 2, *delta_t);
+        return sid_calc_run(delta_t);
     }
     if (soc == 2 && scc == 3) {
         tmp_buf1 = getbuf1(2 * nr);
-        tmp_nr = sid_engine.calculate_samples(psid[2], tmp_buf1, nr, 1, &tmp_delta_t);
-        tmp_delta_t = *delta_t;
-        tmp_nr = sid_engine.calculate_samples(psid[0], pbuf, nr, 2, &tmp_delta_t);
-        tmp_nr = sid_engine.calculate_samples(psid[1], pbuf + 1, nr, 2, delta_t);
+        sid_calc_add(psid[2], tmp_buf1, nr, 1, *delta_t);
+        sid_calc_add(psid[0], pbuf, nr, 2, *delta_t);
+        sid_calc_add(psid[1], pbuf + 1, nr, 2, *delta_t);
+        tmp_nr = sid_calc_run(delta_t);
         for (i = 0; i < tmp_nr; i++) {
             pbuf[i * 2] = sound_audio_mix(pbuf[i * 2], tmp_buf1[i]);
             pbuf[(i * 2) + 1] = sound_audio_mix(pbuf[(i * 2) + 1], tmp_buf1[i]);
@@ -549,12 +651,11 @@ int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, i
     }
     if (soc == 2 && scc == 4) {
         tmp_buf1 = getbuf1(2 * nr);
-        tmp_nr = sid_engine.calculate_samples(psid[2], tmp_buf1, nr, 2, &tmp_delta_t);
-        tmp_delta_t = *delta_t;
-        tmp_nr = sid_engine.calculate_samples(psid[3], tmp_buf1 + 1, nr, 2, &tmp_delta_t);
-        tmp_delta_t = *delta_t;
-        tmp_nr = sid_engine.calculate_samples(psid[0], pbuf, nr, 2, &tmp_delta_t);
-        tmp_nr = sid_engine.calculate_samples(psid[1], pbuf + 1, nr, 2, delta_t);
+        sid_calc_add(psid[2], tmp_buf1, nr, 2, *delta_t);
+        sid_calc_add(psid[3], tmp_buf1 + 1, nr, 2, *delta_t);
+        sid_calc_add(psid[0], pbuf, nr, 2, *delta_t);
+        sid_calc_add(psid[1], pbuf + 1, nr, 2, *delta_t);
+        tmp_nr = sid_calc_run(delta_t);
         for (i = 0; i < tmp_nr; i++) {
             pbuf[i * 2] = sound_audio_mix(pbuf[i * 2], tmp_buf1[i * 2]);
             pbuf[(i * 2) + 1] = sound_audio_mix(pbuf[(i * 2) + 1], tmp_buf1[(i * 2) + 1]);
@@ -563,9 +664,19 @@ int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, i
     return tmp_nr;
 }
 
-void sid_sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub)
+/* Advance all SIDs by delta_t cycles without generating samples, used in
+   warp mode when nothing is recorded.  */
+void sid_sound_machine_skip_samples(sound_t **psid, int scc, int delta_t)
 {
-    sid_engine.prevent_clk_overflow(psid, sub);
+    int i;
+
+    if (sid_engine.skip_samples == NULL) {
+        return;
+    }
+
+    for (i = 0; i < scc; i++) {
+        sid_engine.skip_samples(psid[i], delta_t);
+    }
 }
 
 char *sid_sound_machine_dump_state(sound_t *psid)
@@ -129,7 +129,7 @@ struct sid_engine_s {
     void (*reset)(struct sound_s *psid, CLOCK cpu_clk);
     int (*calculate_samples)(struct sound_s *psid, short *pbuf, int nr,
                              int interleave, int *delta_t);
-    void (*prevent_clk_overflow)(struct sound_s *psid, CLOCK sub);
+    void (*skip_samples)(struct sound_s *psid, int delta_t);
     char *(*dump_state)(struct sound_s *psid);
     void (*state_read)(struct sound_s *psid,
                        struct sid_snapshot_state_s *sid_state);
@@ -153,7 +153,7 @@ extern uint8_t sid_sound_machine_read(sound_t *psid, uint16_t addr);
 extern void sid_sound_machine_store(sound_t *psid, uint16_t addr, uint8_t byte);
 extern void sid_sound_machine_reset(sound_t *psid, CLOCK cpu_clk);
 extern int sid_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, int sound_output_channels, int sound_chip_channels, int *delta_t);
-extern void sid_sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub);
+extern void sid_sound_machine_skip_samples(sound_t **psid, int sound_chip_channels, int delta_t);
 extern char *sid_sound_machine_dump_state(sound_t *psid);
 extern int sid_sound_machine_cycle_based(void);
 extern int sid_sound_machine_channels(void);
@@ -32,6 +32,7 @@
 #include <string.h>
 
 #include "archdep.h"
+#include "crc32.h"
 #include "lib.h"
 #include "ioutil.h"
 #include "log.h"
@@ -41,6 +42,7 @@
 #endif
 #include "types.h"
 #include "uiapi.h"
+#include "util.h"
 #include "version.h"
 #include "vsync.h"
 #include "zfile.h"
@@ -54,13 +56,40 @@ static char *current_filename = NULL;
 char snapshot_magic_string[] = "VICE Snapshot File\032";
 char snapshot_version_magic_string[] = "VICE Version\032";
 
+/* Empty module written first into every snapshot whose clocks are stored
+   with 64 bits.  Snapshots without it store clocks as dwords.  */
+static const char snapshot_clock64_module_name[] = "CLOCK64";
+
 #define SNAPSHOT_MAGIC_LEN              19
 #define SNAPSHOT_VERSION_MAGIC_LEN      13
 
-struct snapshot_module_s {
-    /* File descriptor.  */
+struct snapshot_memory_s {
+    /* Snapshot data.  */
+    uint8_t *data;
+
+    /* Number of bytes used.  */
+    size_t size;
+
+    /* Number of bytes allocated.  */
+    size_t max;
+};
+
+/* Snapshots are either files or memory buffers.  */
+typedef struct snapshot_stream_s {
+    /* File descriptor, NULL for memory snapshots.  */
     FILE *file;
 
+    /* Memory buffer.  */
+    snapshot_memory_t *mem;
+
+    /* Position in the memory buffer.  */
+    size_t pos;
+} snapshot_stream_t;
+
+struct snapshot_module_s {
+    /* Stream of the snapshot.  */
+    snapshot_stream_t *stream;
+
     /* Flag: are we writing it?  */
     int write_mode;
 
@@ -72,24 +101,98 @@ struct snapshot_module_s {
 
     /* Offset of the size field in the file.  */
     long size_offset;
+
+    /* Flag: are clocks stored with 64 bits?  */
+    int clock64;
 };
 
 struct snapshot_s {
-    /* File descriptor.  */
-    FILE *file;
+    /* File or memory buffer.  */
+    snapshot_stream_t stream;
 
     /* Offset of the first module.  */
     long first_module_offset;
 
     /* Flag: are we writing it?  */
     int write_mode;
+
+    /* Flag: are clocks stored with 64 bits?  */
+    int clock64;
 };
 
+/* Memory snapshot used instead of the named file, see
+   snapshot_memory_select().  */
+static snapshot_memory_t *selected_memory = NULL;
+
 /* ------------------------------------------------------------------------- */
 
-static int snapshot_write_byte(FILE *f, uint8_t data)
+static size_t snapshot_stream_write(snapshot_stream_t *f, const void *data, size_t num)
+{
+    snapshot_memory_t *mem = f->mem;
+
+    if (f->file != NULL) {
+        return fwrite(data, 1, num, f->file);
+    }
+
+    if (f->pos + num > mem->max) {
+        mem->max = (f->pos + num) * 2;
+        mem->data = lib_realloc(mem->data, mem->max);
+    }
+    if (f->pos > mem->size) {
+        memset(mem->data + mem->size, 0, f->pos - mem->size);
+    }
+    memcpy(mem->data + f->pos, data, num);
+    f->pos += num;
+    if (f->pos > mem->size) {
+        mem->size = f->pos;
+    }
+    return num;
+}
+
+static size_t snapshot_stream_read(snapshot_stream_t *f, void *data, size_t num)
 {
-    if (fputc(data, f) == EOF) {
+    snapshot_memory_t *mem = f->mem;
+
+    if (f->file != NULL) {
+        return fread(data, 1, num, f->file);
+    }
+
+    if (f->pos >= mem->size) {
+        return 0;
+    }
+    if (num > mem->size - f->pos) {
+        num = mem->size - f->pos;
+    }
+    memcpy(data, mem->data + f->pos, num);
+    f->pos += num;
+    return num;
+}
+
+static long snapshot_stream_tell(snapshot_stream_t *f)
+{
+    if (f->file != NULL) {
+        return ftell(f->file);
+    }
+    return (long)f->pos;
+}
+
+static int snapshot_stream_seek(snapshot_stream_t *f, long offset)
+{
+    if (f->file != NULL) {
+        return fseek(f->file, offset, SEEK_SET);
+    }
+    if (offset < 0) {
+        return -1;
+    }
+    f->pos = (size_t)offset;
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int snapshot_write_byte(snapshot_stream_t *f, uint8_t data)
+{
+    if (snapshot_stream_write(f, &data, 1) < 1) {
         snapshot_error = SNAPSHOT_WRITE_EOF_ERROR;
         return -1;
     }
@@ -97,7 +200,7 @@ static int snapshot_write_byte(FILE *f, uint8_t data)
     return 0;
 }
 
-static int snapshot_write_word(FILE *f, uint16_t data)
+static int snapshot_write_word(snapshot_stream_t *f, uint16_t data)
 {
     if (snapshot_write_byte(f, (uint8_t)(data & 0xff)) < 0
         || snapshot_write_byte(f, (uint8_t)(data >> 8)) < 0) {
@@ -107,7 +210,7 @@ static int snapshot_write_word(FILE *f, uint16_t data)
     return 0;
 }
 
-static int snapshot_write_dword(FILE *f, uint32_t data)
+static int snapshot_write_dword(snapshot_stream_t *f, uint32_t data)
 {
     if (snapshot_write_word(f, (uint16_t)(data & 0xffff)) < 0
         || snapshot_write_word(f, (uint16_t)(data >> 16)) < 0) {
@@ -117,7 +220,17 @@ static int snapshot_write_dword(FILE *f, uint32_t data)
     return 0;
 }
 
-static int snapshot_write_double(FILE *f, double data)
+static int snapshot_write_qword(snapshot_stream_t *f, uint64_t data)
+{
+    if (snapshot_write_dword(f, (uint32_t)(data & 0xffffffff)) < 0
+        || snapshot_write_dword(f, (uint32_t)(data >> 32)) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int snapshot_write_double(snapshot_stream_t *f, double data)
 {
     uint8_t *byte_data = (uint8_t *)&data;
     int i;
@@ -130,7 +243,7 @@ static int snapshot_write_double(FILE *f, double data)
     return 0;
 }
 
-static int snapshot_write_padded_string(FILE *f, const char *s, uint8_t pad_char,
+static int snapshot_write_padded_string(snapshot_stream_t *f, const char *s, uint8_t pad_char,
                                         int len)
 {
     int i, found_zero;
@@ -149,9 +262,9 @@ static int snapshot_write_padded_string(FILE *f, const char *s, uint8_t pad_char
     return 0;
 }
 
-static int snapshot_write_byte_array(FILE *f, const uint8_t *data, unsigned int num)
+static int snapshot_write_byte_array(snapshot_stream_t *f, const uint8_t *data, unsigned int num)
 {
-    if (num > 0 && fwrite(data, (size_t)num, 1, f) < 1) {
+    if (num > 0 && snapshot_stream_write(f, data, (size_t)num) < (size_t)num) {
         snapshot_error = SNAPSHOT_WRITE_BYTE_ARRAY_ERROR;
         return -1;
     }
@@ -159,7 +272,7 @@ static int snapshot_write_byte_array(FILE *f, const uint8_t *data, unsigned int
     return 0;
 }
 
-static int snapshot_write_word_array(FILE *f, const uint16_t *data, unsigned int num)
+static int snapshot_write_word_array(snapshot_stream_t *f, const uint16_t *data, unsigned int num)
 {
     unsigned int i;
 
@@ -172,7 +285,7 @@ static int snapshot_write_word_array(FILE *f, const uint16_t *data, unsigned int
     return 0;
 }
 
-static int snapshot_write_dword_array(FILE *f, const uint32_t *data, unsigned int num)
+static int snapshot_write_dword_array(snapshot_stream_t *f, const uint32_t *data, unsigned int num)
 {
     unsigned int i;
 
@@ -186,7 +299,7 @@ static int snapshot_write_dword_array(FILE *f, const uint32_t *data, unsigned in
 }
 
 
-static int snapshot_write_string(FILE *f, const char *s)
+static int snapshot_write_string(snapshot_stream_t *f, const char *s)
 {
     size_t len, i;
 
@@ -205,20 +318,16 @@ static int snapshot_write_string(FILE *f, const char *s)
     return (int)(len + sizeof(uint16_t));
 }
 
-static int snapshot_read_byte(FILE *f, uint8_t *b_return)
+static int snapshot_read_byte(snapshot_stream_t *f, uint8_t *b_return)
 {
-    int c;
-
-    c = fgetc(f);
-    if (c == EOF) {
+    if (snapshot_stream_read(f, b_return, 1) < 1) {
         snapshot_error = SNAPSHOT_READ_EOF_ERROR;
         return -1;
     }
-    *b_return = (uint8_t)c;
     return 0;
 }
 
-static int snapshot_read_word(FILE *f, uint16_t *w_return)
+static int snapshot_read_word(snapshot_stream_t *f, uint16_t *w_return)
 {
     uint8_t lo, hi;
 
@@ -230,7 +339,7 @@ static int snapshot_read_word(FILE *f, uint16_t *w_return)
     return 0;
 }
 
-static int snapshot_read_dword(FILE *f, uint32_t *dw_return)
+static int snapshot_read_dword(snapshot_stream_t *f, uint32_t *dw_return)
 {
     uint16_t lo, hi;
 
@@ -242,28 +351,33 @@ static int snapshot_read_dword(FILE *f, uint32_t *dw_return)
     return 0;
 }
 
-static int snapshot_read_double(FILE *f, double *d_return)
+static int snapshot_read_qword(snapshot_stream_t *f, uint64_t *qw_return)
+{
+    uint32_t lo, hi;
+
+    if (snapshot_read_dword(f, &lo) < 0 || snapshot_read_dword(f, &hi) < 0) {
+        return -1;
+    }
+
+    *qw_return = lo | ((uint64_t)hi << 32);
+    return 0;
+}
+
+static int snapshot_read_double(snapshot_stream_t *f, double *d_return)
 {
-    int i;
-    int c;
     double val;
-    uint8_t *byte_val = (uint8_t *)&val;
 
-    for (i = 0; i < sizeof(double); i++) {
-        c = fgetc(f);
-        if (c == EOF) {
-            snapshot_error = SNAPSHOT_READ_EOF_ERROR;
-            return -1;
-        }
-        byte_val[i] = (uint8_t)c;
+    if (snapshot_stream_read(f, &val, sizeof(double)) < sizeof(double)) {
+        snapshot_error = SNAPSHOT_READ_EOF_ERROR;
+        return -1;
     }
     *d_return = val;
     return 0;
 }
 
-static int snapshot_read_byte_array(FILE *f, uint8_t *b_return, unsigned int num)
+static int snapshot_read_byte_array(snapshot_stream_t *f, uint8_t *b_return, unsigned int num)
 {
-    if (num > 0 && fread(b_return, (size_t)num, 1, f) < 1) {
+    if (num > 0 && snapshot_stream_read(f, b_return, (size_t)num) < (size_t)num) {
         snapshot_error = SNAPSHOT_READ_BYTE_ARRAY_ERROR;
         return -1;
     }
@@ -271,7 +385,7 @@ static int snapshot_read_byte_array(FILE *f, uint8_t *b_return, unsigned int num
     return 0;
 }
 
-static int snapshot_read_word_array(FILE *f, uint16_t *w_return, unsigned int num)
+static int snapshot_read_word_array(snapshot_stream_t *f, uint16_t *w_return, unsigned int num)
 {
     unsigned int i;
 
@@ -284,7 +398,7 @@ static int snapshot_read_word_array(FILE *f, uint16_t *w_return, unsigned int nu
     return 0;
 }
 
-static int snapshot_read_dword_array(FILE *f, uint32_t *dw_return, unsigned int num)
+static int snapshot_read_dword_array(snapshot_stream_t *f, uint32_t *dw_return, unsigned int num)
 {
     unsigned int i;
 
@@ -297,7 +411,7 @@ static int snapshot_read_dword_array(FILE *f, uint32_t *dw_return, unsigned int
     return 0;
 }
 
-static int snapshot_read_string(FILE *f, char **s)
+static int snapshot_read_string(snapshot_stream_t *f, char **s)
 {
     int i, len;
     uint16_t w;
@@ -332,7 +446,7 @@ static int snapshot_read_string(FILE *f, char **s)
 
 int snapshot_module_write_byte(snapshot_module_t *m, uint8_t b)
 {
-    if (snapshot_write_byte(m->file, b) < 0) {
+    if (snapshot_write_byte(m->stream, b) < 0) {
         return -1;
     }
 
@@ -342,7 +456,7 @@ int snapshot_module_write_byte(snapshot_module_t *m, uint8_t b)
 
 int snapshot_module_write_word(snapshot_module_t *m, uint16_t w)
 {
-    if (snapshot_write_word(m->file, w) < 0) {
+    if (snapshot_write_word(m->stream, w) < 0) {
         return -1;
     }
 
@@ -352,7 +466,7 @@ int snapshot_module_write_word(snapshot_module_t *m, uint16_t w)
 
 int snapshot_module_write_dword(snapshot_module_t *m, uint32_t dw)
 {
-    if (snapshot_write_dword(m->file, dw) < 0) {
+    if (snapshot_write_dword(m->stream, dw) < 0) {
         return -1;
     }
 
@@ -360,9 +474,19 @@ int snapshot_module_write_dword(snapshot_module_t *m, uint32_t dw)
     return 0;
 }
 
+int snapshot_module_write_clock(snapshot_module_t *m, CLOCK clk)
+{
+    if (snapshot_write_qword(m->stream, (uint64_t)clk) < 0) {
+        return -1;
+    }
+
+    m->size += 8;
+    return 0;
+}
+
 int snapshot_module_write_double(snapshot_module_t *m, double db)
 {
-    if (snapshot_write_double(m->file, db) < 0) {
+    if (snapshot_write_double(m->stream, db) < 0) {
         return -1;
     }
 
@@ -372,7 +496,7 @@ int snapshot_module_write_double(snapshot_module_t *m, double db)
 
 int snapshot_module_write_padded_string(snapshot_module_t *m, const char *s, uint8_t pad_char, int len)
 {
-    if (snapshot_write_padded_string(m->file, s, (uint8_t)pad_char, len) < 0) {
+    if (snapshot_write_padded_string(m->stream, s, (uint8_t)pad_char, len) < 0) {
         return -1;
     }
 
@@ -382,7 +506,7 @@ int snapshot_module_write_padded_string(snapshot_module_t *m, const char *s, uin
 
 int snapshot_module_write_byte_array(snapshot_module_t *m, const uint8_t *b, unsigned int num)
 {
-    if (snapshot_write_byte_array(m->file, b, num) < 0) {
+    if (snapshot_write_byte_array(m->stream, b, num) < 0) {
         return -1;
     }
 
@@ -392,7 +516,7 @@ int snapshot_module_write_byte_array(snapshot_module_t *m, const uint8_t *b, uns
 
 int snapshot_module_write_word_array(snapshot_module_t *m, const uint16_t *w, unsigned int num)
 {
-    if (snapshot_write_word_array(m->file, w, num) < 0) {
+    if (snapshot_write_word_array(m->stream, w, num) < 0) {
         return -1;
     }
 
@@ -402,7 +526,7 @@ int snapshot_module_write_word_array(snapshot_module_t *m, const uint16_t *w, un
 
 int snapshot_module_write_dword_array(snapshot_module_t *m, const uint32_t *dw, unsigned int num)
 {
-    if (snapshot_write_dword_array(m->file, dw, num) < 0) {
+    if (snapshot_write_dword_array(m->stream, dw, num) < 0) {
         return -1;
     }
 
@@ -413,7 +537,7 @@ int snapshot_module_write_dword_array(snapshot_module_t *m, const uint32_t *dw,
 int snapshot_module_write_string(snapshot_module_t *m, const char *s)
 {
     int len;
-    len = snapshot_write_string(m->file, s);
+    len = snapshot_write_string(m->stream, s);
     if (len < 0) {
         snapshot_error = SNAPSHOT_ILLEGAL_STRING_LENGTH_ERROR;
         return -1;
@@ -427,82 +551,110 @@ int snapshot_module_write_string(snapshot_module_t *m, const char *s)
 
 int snapshot_module_read_byte(snapshot_module_t *m, uint8_t *b_return)
 {
-    if (ftell(m->file) + sizeof(uint8_t) > m->offset + m->size) {
+    if (snapshot_stream_tell(m->stream) + sizeof(uint8_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_byte(m->file, b_return);
+    return snapshot_read_byte(m->stream, b_return);
 }
 
 int snapshot_module_read_word(snapshot_module_t *m, uint16_t *w_return)
 {
-    if (ftell(m->file) + sizeof(uint16_t) > m->offset + m->size) {
+    if (snapshot_stream_tell(m->stream) + sizeof(uint16_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_word(m->file, w_return);
+    return snapshot_read_word(m->stream, w_return);
 }
 
 int snapshot_module_read_dword(snapshot_module_t *m, uint32_t *dw_return)
 {
-    if (ftell(m->file) + sizeof(uint32_t) > m->offset + m->size) {
+    if (snapshot_stream_tell(m->stream) + sizeof(uint32_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_dword(m->file, dw_return);
+    return snapshot_read_dword(m->stream, dw_return);
+}
+
+int snapshot_module_read_clock(snapshot_module_t *m, CLOCK *clk_return)
+{
+    uint64_t qw;
+    uint32_t dw;
+
+    if (m->clock64) {
+        if (snapshot_stream_tell(m->stream) + sizeof(uint64_t) > m->offset + m->size) {
+            snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
+            return -1;
+        }
+        if (snapshot_read_qword(m->stream, &qw) < 0) {
+            return -1;
+        }
+        *clk_return = (CLOCK)qw;
+    } else {
+        /* snapshot made with a 32 bit clock, keep "never" meaning never */
+        if (snapshot_stream_tell(m->stream) + sizeof(uint32_t) > m->offset + m->size) {
+            snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
+            return -1;
+        }
+        if (snapshot_read_dword(m->stream, &dw) < 0) {
+            return -1;
+        }
+        *clk_return = (dw == 0xffffffff) ? CLOCK_MAX : (CLOCK)dw;
+    }
+    return 0;
 }
 
 int snapshot_module_read_double(snapshot_module_t *m, double *db_return)
 {
-    if (ftell(m->file) + sizeof(double) > m->offset + m->size) {
+    if (snapshot_stream_tell(m->stream) + sizeof(double) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_double(m->file, db_return);
+    return snapshot_read_double(m->stream, db_return);
 }
 
 int snapshot_module_read_byte_array(snapshot_module_t *m, uint8_t *b_return, unsigned int num)
 {
-    if ((long)(ftell(m->file) + num) > (long)(m->offset + m->size)) {
+    if ((long)(snapshot_stream_tell(m->stream) + num) > (long)(m->offset + m->size)) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_byte_array(m->file, b_return, num);
+    return snapshot_read_byte_array(m->stream, b_return, num);
 }
 
 int snapshot_module_read_word_array(snapshot_module_t *m, uint16_t *w_return, unsigned int num)
 {
-    if ((long)(ftell(m->file) + num * sizeof(uint16_t)) > (long)(m->offset + m->size)) {
+    if ((long)(snapshot_stream_tell(m->stream) + num * sizeof(uint16_t)) > (long)(m->offset + m->size)) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_word_array(m->file, w_return, num);
+    return snapshot_read_word_array(m->stream, w_return, num);
 }
 
 int snapshot_module_read_dword_array(snapshot_module_t *m, uint32_t *dw_return, unsigned int num)
 {
-    if ((long)(ftell(m->file) + num * sizeof(uint32_t)) > (long)(m->offset + m->size)) {
+    if ((long)(snapshot_stream_tell(m->stream) + num * sizeof(uint32_t)) > (long)(m->offset + m->size)) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_dword_array(m->file, dw_return, num);
+    return snapshot_read_dword_array(m->stream, dw_return, num);
 }
 
 int snapshot_module_read_string(snapshot_module_t *m, char **charp_return)
 {
-    if (ftell(m->file) + sizeof(uint16_t) > m->offset + m->size) {
+    if (snapshot_stream_tell(m->stream) + sizeof(uint16_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_string(m->file, charp_return);
+    return snapshot_read_string(m->stream, charp_return);
 }
 
 int snapshot_module_read_byte_into_int(snapshot_module_t *m, int *value_return)
@@ -569,24 +721,25 @@ snapshot_module_t *snapshot_module_create(snapshot_t *s, const char *name, uint8
     current_module = (char *)name;
 
     m = lib_malloc(sizeof(snapshot_module_t));
-    m->file = s->file;
-    m->offset = ftell(s->file);
+    m->stream = &s->stream;
+    m->offset = snapshot_stream_tell(&s->stream);
     if (m->offset == -1) {
         snapshot_error = SNAPSHOT_ILLEGAL_OFFSET_ERROR;
         lib_free(m);
         return NULL;
     }
     m->write_mode = 1;
+    m->clock64 = s->clock64;
 
-    if (snapshot_write_padded_string(s->file, name, (uint8_t)0, SNAPSHOT_MODULE_NAME_LEN) < 0
-        || snapshot_write_byte(s->file, major_version) < 0
-        || snapshot_write_byte(s->file, minor_version) < 0
-        || snapshot_write_dword(s->file, 0) < 0) {
+    if (snapshot_write_padded_string(&s->stream, name, (uint8_t)0, SNAPSHOT_MODULE_NAME_LEN) < 0
+        || snapshot_write_byte(&s->stream, major_version) < 0
+        || snapshot_write_byte(&s->stream, minor_version) < 0
+        || snapshot_write_dword(&s->stream, 0) < 0) {
         return NULL;
     }
 
-    m->size = ftell(s->file) - m->offset;
-    m->size_offset = ftell(s->file) - sizeof(uint32_t);
+    m->size = snapshot_stream_tell(&s->stream) - m->offset;
+    m->size_offset = snapshot_stream_tell(&s->stream) - sizeof(uint32_t);
 
     return m;
 }
@@ -599,25 +752,26 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
 
     current_module = (char *)name;
 
-    if (fseek(s->file, s->first_module_offset, SEEK_SET) < 0) {
+    if (snapshot_stream_seek(&s->stream, s->first_module_offset) < 0) {
         snapshot_error = SNAPSHOT_FIRST_MODULE_NOT_FOUND_ERROR;
         return NULL;
     }
 
     m = lib_malloc(sizeof(snapshot_module_t));
-    m->file = s->file;
+    m->stream = &s->stream;
     m->write_mode = 0;
+    m->clock64 = s->clock64;
 
     m->offset = s->first_module_offset;
 
     /* Search for the module name.  This is quite inefficient, but I don't
        think we care.  */
     while (1) {
-        if (snapshot_read_byte_array(s->file, (uint8_t *)n,
+        if (snapshot_read_byte_array(&s->stream, (uint8_t *)n,
                                      SNAPSHOT_MODULE_NAME_LEN) < 0
-            || snapshot_read_byte(s->file, major_version_return) < 0
-            || snapshot_read_byte(s->file, minor_version_return) < 0
-            || snapshot_read_dword(s->file, &m->size)) {
+            || snapshot_read_byte(&s->stream, major_version_return) < 0
+            || snapshot_read_byte(&s->stream, minor_version_return) < 0
+            || snapshot_read_dword(&s->stream, &m->size)) {
             snapshot_error = SNAPSHOT_MODULE_HEADER_READ_ERROR;
             goto fail;
         }
@@ -629,18 +783,18 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
         }
 
         m->offset += m->size;
-        if (fseek(s->file, m->offset, SEEK_SET) < 0) {
+        if (snapshot_stream_seek(&s->stream, m->offset) < 0) {
             snapshot_error = SNAPSHOT_MODULE_NOT_FOUND_ERROR;
             goto fail;
         }
     }
 
-    m->size_offset = ftell(s->file) - sizeof(uint32_t);
+    m->size_offset = snapshot_stream_tell(&s->stream) - sizeof(uint32_t);
 
     return m;
 
 fail:
-    fseek(s->file, s->first_module_offset, SEEK_SET);
+    snapshot_stream_seek(&s->stream, s->first_module_offset);
     lib_free(m);
     return NULL;
 }
@@ -650,14 +804,14 @@ int snapshot_module_close(snapshot_module_t *m)
 
     /* Backpatch module size if writing.  */
     if (m->write_mode
-        && (fseek(m->file, m->size_offset, SEEK_SET) < 0
-            || snapshot_write_dword(m->file, m->size) < 0)) {
+        && (snapshot_stream_seek(m->stream, m->size_offset) < 0
+            || snapshot_write_dword(m->stream, m->size) < 0)) {
         snapshot_error = SNAPSHOT_MODULE_CLOSE_ERROR;
         return -1;
     }
 
     /* Skip module.  */
-    if (fseek(m->file, m->offset + m->size, SEEK_SET) < 0) {
+    if (snapshot_stream_seek(m->stream, m->offset + m->size) < 0) {
         snapshot_error = SNAPSHOT_MODULE_SKIP_ERROR;
         return -1;
     }
@@ -670,16 +824,24 @@ int snapshot_module_close(snapshot_module_t *m)
 
 snapshot_t *snapshot_create(const char *filename, uint8_t major_version, uint8_t minor_version, const char *snapshot_machine_name)
 {
-    FILE *f;
+    snapshot_stream_t stream;
+    snapshot_stream_t *f = &stream;
     snapshot_t *s;
+    snapshot_module_t *m;
     unsigned char viceversion[4] = { VERSION_RC_NUMBER };
 
     current_filename = (char *)filename;
 
-    f = fopen(filename, MODE_WRITE);
-    if (f == NULL) {
-        snapshot_error = SNAPSHOT_CANNOT_CREATE_SNAPSHOT_ERROR;
-        return NULL;
+    memset(f, 0, sizeof(snapshot_stream_t));
+    if (selected_memory != NULL) {
+        f->mem = selected_memory;
+        f->mem->size = 0;
+    } else {
+        f->file = fopen(filename, MODE_WRITE);
+        if (f->file == NULL) {
+            snapshot_error = SNAPSHOT_CANNOT_CREATE_SNAPSHOT_ERROR;
+            return NULL;
+        }
     }
 
     /* Magic string.  */
@@ -721,15 +883,25 @@ snapshot_t *snapshot_create(const char *filename, uint8_t major_version, uint8_t
     }
 
     s = lib_malloc(sizeof(snapshot_t));
-    s->file = f;
-    s->first_module_offset = ftell(f);
+    s->stream = stream;
+    s->first_module_offset = snapshot_stream_tell(f);
     s->write_mode = 1;
+    s->clock64 = 1;
+
+    m = snapshot_module_create(s, snapshot_clock64_module_name, 1, 0);
+    if (m == NULL || snapshot_module_close(m) < 0) {
+        lib_free(s);
+        snapshot_error = SNAPSHOT_CANNOT_WRITE_VERSION_ERROR;
+        goto fail;
+    }
 
     return s;
 
 fail:
-    fclose(f);
-    ioutil_remove(filename);
+    if (f->file != NULL) {
+        fclose(f->file);
+        ioutil_remove(filename);
+    }
     return NULL;
 }
 
@@ -739,8 +911,10 @@ static uint32_t snapshot_vicerevision;
 
 snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, uint8_t *minor_version_return, const char *snapshot_machine_name)
 {
-    FILE *f;
+    snapshot_stream_t stream;
+    snapshot_stream_t *f = &stream;
     char magic[SNAPSHOT_MAGIC_LEN];
+    char module_name[SNAPSHOT_MODULE_NAME_LEN + 1];
     snapshot_t *s = NULL;
     int machine_name_len;
     size_t offs;
@@ -749,10 +923,15 @@ snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, u
     current_filename = (char *)filename;
     current_module = NULL;
 
-    f = zfile_fopen(filename, MODE_READ);
-    if (f == NULL) {
-        snapshot_error = SNAPSHOT_CANNOT_OPEN_FOR_READ_ERROR;
-        return NULL;
+    memset(f, 0, sizeof(snapshot_stream_t));
+    if (selected_memory != NULL) {
+        f->mem = selected_memory;
+    } else {
+        f->file = zfile_fopen(filename, MODE_READ);
+        if (f->file == NULL) {
+            snapshot_error = SNAPSHOT_CANNOT_OPEN_FOR_READ_ERROR;
+            return NULL;
+        }
     }
 
     /* Magic string.  */
@@ -787,12 +966,12 @@ snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, u
     /* VICE version and revision */
     memset(snapshot_viceversion, 0, 4);
     snapshot_vicerevision = 0;
-    offs = ftell(f);
+    offs = snapshot_stream_tell(f);
 
     if (snapshot_read_byte_array(f, (uint8_t *)magic, SNAPSHOT_VERSION_MAGIC_LEN) < 0
         || memcmp(magic, snapshot_version_magic_string, SNAPSHOT_VERSION_MAGIC_LEN) != 0) {
         /* old snapshots do not contain VICE version */
-        fseek(f, offs, SEEK_SET);
+        snapshot_stream_seek(f, (long)offs);
         log_warning(LOG_DEFAULT, "attempting to load pre 2.4.30 snapshot");
     } else {
         /* actually read the version */
@@ -807,35 +986,47 @@ snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, u
     }
 
     s = lib_malloc(sizeof(snapshot_t));
-    s->file = f;
-    s->first_module_offset = ftell(f);
+    s->stream = stream;
+    s->first_module_offset = snapshot_stream_tell(f);
     s->write_mode = 0;
+    f = &s->stream;
+
+    /* the clock marker, if present, is always the first module */
+    memset(module_name, 0, sizeof(module_name));
+    if (snapshot_read_byte_array(f, (uint8_t *)module_name, SNAPSHOT_MODULE_NAME_LEN) == 0
+        && strcmp(module_name, snapshot_clock64_module_name) == 0) {
+        s->clock64 = 1;
+    } else {
+        s->clock64 = 0;
+    }
+    snapshot_stream_seek(f, s->first_module_offset);
 
     vsync_suspend_speed_eval();
     return s;
 
 fail:
-    fclose(f);
+    if (f->file != NULL) {
+        fclose(f->file);
+    }
     return NULL;
 }
 
 int snapshot_close(snapshot_t *s)
 {
-    int retval;
-
-    if (!s->write_mode) {
-        if (zfile_fclose(s->file) == EOF) {
-            snapshot_error = SNAPSHOT_READ_CLOSE_EOF_ERROR;
-            retval = -1;
-        } else {
-            retval = 0;
-        }
-    } else {
-        if (fclose(s->file) == EOF) {
-            snapshot_error = SNAPSHOT_WRITE_CLOSE_EOF_ERROR;
-            retval = -1;
+    int retval = 0;
+
+    /* memory snapshots keep their buffer */
+    if (s->stream.file != NULL) {
+        if (!s->write_mode) {
+            if (zfile_fclose(s->stream.file) == EOF) {
+                snapshot_error = SNAPSHOT_READ_CLOSE_EOF_ERROR;
+                retval = -1;
+            }
         } else {
-            retval = 0;
+            if (fclose(s->stream.file) == EOF) {
+                snapshot_error = SNAPSHOT_WRITE_CLOSE_EOF_ERROR;
+                retval = -1;
+            }
         }
     }
 
@@ -843,6 +1034,195 @@ int snapshot_close(snapshot_t *s)
     return retval;
 }
 
+/* ------------------------------------------------------------------------- */
+
+snapshot_memory_t *snapshot_memory_new(void)
+{
+    return lib_calloc(1, sizeof(snapshot_memory_t));
+}
+
+void snapshot_memory_free(snapshot_memory_t *mem)
+{
+    if (mem != NULL) {
+        lib_free(mem->data);
+        lib_free(mem);
+    }
+}
+
+const uint8_t *snapshot_memory_get_data(snapshot_memory_t *mem, size_t *size_return)
+{
+    *size_return = mem->size;
+    return mem->data;
+}
+
+void snapshot_memory_set_data(snapshot_memory_t *mem, const uint8_t *data, size_t size)
+{
+    if (size > mem->max) {
+        mem->max = size;
+        mem->data = lib_realloc(mem->data, mem->max);
+    }
+    if (size > 0) {
+        memcpy(mem->data, data, size);
+    }
+    mem->size = size;
+}
+
+void snapshot_memory_select(snapshot_memory_t *mem)
+{
+    selected_memory = mem;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Layout of a snapshot as written by this version, used to transfer only the
+   modules that differ from a snapshot the receiver already has.  A digest
+   holds the name and CRC of every module.  A delta is a snapshot in which
+   each module also found in the digest is replaced by its header with a size
+   of 0, followed by its CRC.  */
+#define SNAPSHOT_HEADER_LEN         (SNAPSHOT_MAGIC_LEN + 2 + SNAPSHOT_MACHINE_NAME_LEN \
+                                     + SNAPSHOT_VERSION_MAGIC_LEN + 4 + 4)
+#define SNAPSHOT_MODULE_HEADER_LEN  (SNAPSHOT_MODULE_NAME_LEN + 2 + 4)
+#define SNAPSHOT_DIGEST_ENTRY_LEN   (SNAPSHOT_MODULE_NAME_LEN + 4)
+
+static void snapshot_memory_append(snapshot_memory_t *mem, const uint8_t *data, size_t size)
+{
+    if (mem->size + size > mem->max) {
+        mem->max = (mem->size + size) * 2;
+        mem->data = lib_realloc(mem->data, mem->max);
+    }
+    memcpy(mem->data + mem->size, data, size);
+    mem->size += size;
+}
+
+/* Return the size of the module at `pos', or 0 if there is no valid one.  */
+static size_t snapshot_memory_module_size(const snapshot_memory_t *mem, size_t pos)
+{
+    size_t size;
+
+    if (pos + SNAPSHOT_MODULE_HEADER_LEN > mem->size) {
+        return 0;
+    }
+    size = util_le_buf_to_dword(mem->data + pos + SNAPSHOT_MODULE_NAME_LEN + 2);
+    if (size < SNAPSHOT_MODULE_HEADER_LEN || size > mem->size - pos) {
+        return 0;
+    }
+    return size;
+}
+
+static uint32_t snapshot_memory_module_crc(const snapshot_memory_t *mem, size_t pos, size_t size)
+{
+    return crc32_buf((const char *)mem->data + pos, (unsigned int)size);
+}
+
+int snapshot_memory_get_digest(snapshot_memory_t *mem, snapshot_memory_t *digest)
+{
+    uint8_t entry[SNAPSHOT_DIGEST_ENTRY_LEN];
+    size_t pos, size;
+
+    digest->size = 0;
+    if (mem->size < SNAPSHOT_HEADER_LEN) {
+        return -1;
+    }
+
+    for (pos = SNAPSHOT_HEADER_LEN;
+         (size = snapshot_memory_module_size(mem, pos)) > 0; pos += size) {
+        memcpy(entry, mem->data + pos, SNAPSHOT_MODULE_NAME_LEN);
+        util_dword_to_le_buf(entry + SNAPSHOT_MODULE_NAME_LEN,
+                             snapshot_memory_module_crc(mem, pos, size));
+        snapshot_memory_append(digest, entry, sizeof(entry));
+    }
+
+    return pos == mem->size ? 0 : -1;
+}
+
+int snapshot_memory_get_delta(snapshot_memory_t *mem, snapshot_memory_t *digest, snapshot_memory_t *delta)
+{
+    uint8_t marker[SNAPSHOT_MODULE_HEADER_LEN + 4];
+    size_t pos, size, i;
+    uint32_t crc;
+
+    delta->size = 0;
+    if (mem->size < SNAPSHOT_HEADER_LEN) {
+        return -1;
+    }
+    snapshot_memory_append(delta, mem->data, SNAPSHOT_HEADER_LEN);
+
+    for (pos = SNAPSHOT_HEADER_LEN;
+         (size = snapshot_memory_module_size(mem, pos)) > 0; pos += size) {
+        crc = snapshot_memory_module_crc(mem, pos, size);
+        for (i = 0; i + SNAPSHOT_DIGEST_ENTRY_LEN <= digest->size; i += SNAPSHOT_DIGEST_ENTRY_LEN) {
+            if (memcmp(digest->data + i, mem->data + pos, SNAPSHOT_MODULE_NAME_LEN) == 0
+                && util_le_buf_to_dword(digest->data + i + SNAPSHOT_MODULE_NAME_LEN) == crc) {
+                break;
+            }
+        }
+        if (i + SNAPSHOT_DIGEST_ENTRY_LEN <= digest->size) {
+            memcpy(marker, mem->data + pos, SNAPSHOT_MODULE_NAME_LEN + 2);
+            util_dword_to_le_buf(marker + SNAPSHOT_MODULE_NAME_LEN + 2, 0);
+            util_dword_to_le_buf(marker + SNAPSHOT_MODULE_HEADER_LEN, crc);
+            snapshot_memory_append(delta, marker, sizeof(marker));
+        } else {
+            snapshot_memory_append(delta, mem->data + pos, size);
+        }
+    }
+
+    return pos == mem->size ? 0 : -1;
+}
+
+int snapshot_memory_apply_delta(snapshot_memory_t *mem, snapshot_memory_t *delta)
+{
+    snapshot_memory_t result = { NULL, 0, 0 };
+    size_t pos, size, own_pos, own_size;
+    uint32_t crc;
+
+    if (delta->size < SNAPSHOT_HEADER_LEN) {
+        return -1;
+    }
+    snapshot_memory_append(&result, delta->data, SNAPSHOT_HEADER_LEN);
+
+    pos = SNAPSHOT_HEADER_LEN;
+    while (pos < delta->size) {
+        if (pos + SNAPSHOT_MODULE_HEADER_LEN > delta->size) {
+            goto fail;
+        }
+        size = util_le_buf_to_dword(delta->data + pos + SNAPSHOT_MODULE_NAME_LEN + 2);
+        if (size > 0) {
+            if (size < SNAPSHOT_MODULE_HEADER_LEN || size > delta->size - pos) {
+                goto fail;
+            }
+            snapshot_memory_append(&result, delta->data + pos, size);
+            pos += size;
+            continue;
+        }
+
+        /* unchanged module, take it from the old snapshot */
+        if (pos + SNAPSHOT_MODULE_HEADER_LEN + 4 > delta->size) {
+            goto fail;
+        }
+        crc = util_le_buf_to_dword(delta->data + pos + SNAPSHOT_MODULE_HEADER_LEN);
+        for (own_pos = SNAPSHOT_HEADER_LEN;
+             (own_size = snapshot_memory_module_size(mem, own_pos)) > 0; own_pos += own_size) {
+            if (memcmp(mem->data + own_pos, delta->data + pos, SNAPSHOT_MODULE_NAME_LEN) == 0
+                && snapshot_memory_module_crc(mem, own_pos, own_size) == crc) {
+                break;
+            }
+        }
+        if (own_size == 0) {
+            goto fail;
+        }
+        snapshot_memory_append(&result, mem->data + own_pos, own_size);
+        pos += SNAPSHOT_MODULE_HEADER_LEN + 4;
+    }
+
+    lib_free(mem->data);
+    *mem = result;
+    return 0;
+
+fail:
+    lib_free(result.data);
+    return -1;
+}
+
 static void display_error_with_vice_version(char *text, char *filename)
 {
     char *vmessage = lib_malloc(0x100);
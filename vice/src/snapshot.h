@@ -28,6 +28,8 @@
 #ifndef SNAPSHOT_H
 #define SNAPSHOT_H
 
+#include <stddef.h>
+
 #include "types.h"
 
 #define SNAPSHOT_MACHINE_NAME_LEN       16
@@ -65,12 +67,14 @@
 
 typedef struct snapshot_module_s snapshot_module_t;
 typedef struct snapshot_s snapshot_t;
+typedef struct snapshot_memory_s snapshot_memory_t;
 
 extern void snapshot_display_error(void);
 
 extern int snapshot_module_write_byte(snapshot_module_t *m, uint8_t data);
 extern int snapshot_module_write_word(snapshot_module_t *m, uint16_t data);
 extern int snapshot_module_write_dword(snapshot_module_t *m, uint32_t data);
+extern int snapshot_module_write_clock(snapshot_module_t *m, CLOCK clk);
 extern int snapshot_module_write_double(snapshot_module_t *m, double db);
 extern int snapshot_module_write_padded_string(snapshot_module_t *m,
                                                const char *s, uint8_t pad_char,
@@ -86,6 +90,7 @@ extern int snapshot_module_write_string(snapshot_module_t *m, const char *s);
 extern int snapshot_module_read_byte(snapshot_module_t *m, uint8_t *b_return);
 extern int snapshot_module_read_word(snapshot_module_t *m, uint16_t *w_return);
 extern int snapshot_module_read_dword(snapshot_module_t *m, uint32_t *dw_return);
+extern int snapshot_module_read_clock(snapshot_module_t *m, CLOCK *clk_return);
 extern int snapshot_module_read_double(snapshot_module_t *m, double *db_return);
 extern int snapshot_module_read_byte_array(snapshot_module_t *m,
                                            uint8_t *b_return, unsigned int num);
@@ -109,6 +114,7 @@ extern int snapshot_module_read_dword_into_uint(snapshot_module_t *m,
 #define SMW_B       snapshot_module_write_byte
 #define SMW_W       snapshot_module_write_word
 #define SMW_DW      snapshot_module_write_dword
+#define SMW_CLOCK   snapshot_module_write_clock
 #define SMW_DB      snapshot_module_write_double
 #define SMW_PSTR    snapshot_module_write_padded_string
 #define SMW_BA      snapshot_module_write_byte_array
@@ -118,6 +124,7 @@ extern int snapshot_module_read_dword_into_uint(snapshot_module_t *m,
 #define SMR_B       snapshot_module_read_byte
 #define SMR_W       snapshot_module_read_word
 #define SMR_DW      snapshot_module_read_dword
+#define SMR_CLOCK   snapshot_module_read_clock
 #define SMR_DB      snapshot_module_read_double
 #define SMR_BA      snapshot_module_read_byte_array
 #define SMR_WA      snapshot_module_read_word_array
@@ -148,6 +155,20 @@ extern snapshot_t *snapshot_open(const char *filename,
                                  const char *snapshot_machine_name);
 extern int snapshot_close(snapshot_t *s);
 
+/* Snapshots kept in memory.  While a memory snapshot is selected,
+   snapshot_create() and snapshot_open() use it instead of the named file.
+   The buffer is kept and reused when the snapshot is written again.  */
+extern snapshot_memory_t *snapshot_memory_new(void);
+extern void snapshot_memory_free(snapshot_memory_t *mem);
+extern const uint8_t *snapshot_memory_get_data(snapshot_memory_t *mem, size_t *size_return);
+extern void snapshot_memory_set_data(snapshot_memory_t *mem, const uint8_t *data, size_t size);
+extern void snapshot_memory_select(snapshot_memory_t *mem);
+
+/* Transfer of the modules that differ from a snapshot the receiver has.  */
+extern int snapshot_memory_get_digest(snapshot_memory_t *mem, snapshot_memory_t *digest);
+extern int snapshot_memory_get_delta(snapshot_memory_t *mem, snapshot_memory_t *digest, snapshot_memory_t *delta);
+extern int snapshot_memory_apply_delta(snapshot_memory_t *mem, snapshot_memory_t *delta);
+
 extern void snapshot_set_error(int error);
 extern int snapshot_get_error(void);
 
@@ -41,7 +41,6 @@
 #endif
 
 #include "archdep.h"
-#include "clkguard.h"
 #include "cmdline.h"
 #include "debug.h"
 #include "fixpoint.h"
@@ -56,6 +55,7 @@
 #include "uiapi.h"
 #include "util.h"
 #include "vsync.h"
+#include "workqueue.h"
 #include "math.h"
 #include "ui.h"
 
@@ -252,6 +252,36 @@ static int sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr
     return temp;
 }
 
+/* Samples can only be skipped if every active chip knows how to do it.  */
+static int sound_machine_can_skip_samples(void)
+{
+    int i;
+
+    if (!sound_calls[0]->skip_samples) {
+        return 0;
+    }
+
+    for (i = 1; i < (offset >> 5); i++) {
+        if (sound_calls[i]->chip_enabled && !sound_calls[i]->skip_samples) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void sound_machine_skip_samples(sound_t **psid, int scc, int delta_t)
+{
+    int i;
+
+    sound_calls[0]->skip_samples(psid, scc, delta_t);
+
+    for (i = 1; i < (offset >> 5); i++) {
+        if (sound_calls[i]->chip_enabled) {
+            sound_calls[i]->skip_samples(psid, scc, delta_t);
+        }
+    }
+}
+
 static void sound_machine_store(sound_t *psid, uint16_t addr, uint8_t val)
 {
     if (sound_calls[addr >> 5]->store) {
@@ -763,6 +793,107 @@ const char *sound_device_name(unsigned int num)
     return sound_devices[num]->name;
 }
 
+/* ------------------------------------------------------------------------- */
+
+/* Recording devices which set `async_record' are written to from a
+   background thread, so encoding doesn't slow down the emulation.  Each
+   write is copied into one of a fixed set of blocks.  The queue holds at
+   most SOUND_RECORD_QUEUE_LEN blocks and one more can be in the encoder,
+   so a block is never reused while it is still being read.  */
+#define SOUND_RECORD_QUEUE_LEN 16
+#define SOUND_RECORD_BLOCKS (SOUND_RECORD_QUEUE_LEN + 2)
+
+typedef struct sound_record_block_s {
+    int16_t *buf;
+    size_t nr;
+} sound_record_block_t;
+
+static workqueue_t *record_queue = NULL;
+static sound_record_block_t record_blocks[SOUND_RECORD_BLOCKS];
+static int record_next_block = 0;
+static int (*record_write)(int16_t *pbuf, size_t nr) = NULL;
+static volatile int record_failed = 0;
+
+static void sound_record_job(void *data)
+{
+    sound_record_block_t *block = (sound_record_block_t *)data;
+
+    if (!record_failed && record_write(block->buf, block->nr)) {
+        record_failed = 1;
+    }
+}
+
+static void sound_record_open(sound_device_t *rdev)
+{
+    int i;
+
+    if (!rdev->async_record) {
+        return;
+    }
+
+    record_queue = workqueue_create("Sound recording", 1, SOUND_RECORD_QUEUE_LEN);
+    if (workqueue_num_threads(record_queue) == 0) {
+        /* no threads, just write directly */
+        workqueue_destroy(record_queue);
+        record_queue = NULL;
+        return;
+    }
+
+    record_write = rdev->write;
+    record_failed = 0;
+    record_next_block = 0;
+    for (i = 0; i < SOUND_RECORD_BLOCKS; i++) {
+        record_blocks[i].buf = lib_malloc(SOUND_CHANNELS_MAX * SOUND_BUFSIZE * sizeof(int16_t));
+        record_blocks[i].nr = 0;
+    }
+}
+
+static int sound_record_write(int16_t *pbuf, size_t nr)
+{
+    sound_record_block_t *block;
+
+    if (record_queue == NULL) {
+        return snddata.recdev->write(pbuf, nr);
+    }
+
+    if (record_failed) {
+        return 1;
+    }
+
+    block = &record_blocks[record_next_block];
+    record_next_block = (record_next_block + 1) % SOUND_RECORD_BLOCKS;
+
+    memcpy(block->buf, pbuf, nr * sizeof(int16_t));
+    block->nr = nr;
+
+    /* waits if the encoder is too far behind */
+    workqueue_submit(record_queue, sound_record_job, block);
+
+    return 0;
+}
+
+/* Finish all pending writes, the device may be closed afterwards.  */
+static void sound_record_close(void)
+{
+    int i;
+
+    if (record_queue == NULL) {
+        return;
+    }
+
+    workqueue_destroy(record_queue);
+    record_queue = NULL;
+
+    if (record_failed) {
+        log_error(sound_log, "write to recording device failed.");
+    }
+
+    for (i = 0; i < SOUND_RECORD_BLOCKS; i++) {
+        lib_free(record_blocks[i].buf);
+        record_blocks[i].buf = NULL;
+    }
+}
+
 
 /* code to disable sid for a given number of seconds if needed */
 static time_t disabletime;
@@ -1038,6 +1169,10 @@ int sound_open(void)
             } else {
                 snddata.sound_output_channels = channels;
             }
+        } else {
+            /* devices without init (dummy) take whatever they get, a
+               recording device must still see the real channel count */
+            snddata.sound_output_channels = (channels <= pdev->max_channels) ? channels : 1;
         }
         snddata.issuspended = 0;
 
@@ -1125,6 +1260,7 @@ int sound_open(void)
                 resources_set_string("SoundRecordDeviceName", "");
             } else {
                 snddata.recdev = rdev;
+                sound_record_open(rdev);
                 log_message(sound_log, "Opened recording device device `%s'", rdev->name);
             }
         }
@@ -1145,6 +1281,7 @@ void sound_close(void)
 
     if (snddata.recdev) {
         log_message(sound_log, "Closing recording device `%s'", snddata.recdev->name);
+        sound_record_close();
         if (snddata.recdev->close) {
             snddata.recdev->close();
         }
@@ -1191,6 +1328,18 @@ static int sound_run_sound(void)
     /* Handling of cycle based sound engines. */
     if (cycle_based) {
         delta_t = maincpu_clk - snddata.lastclk;
+
+        /* In warp mode sound_flush() throws the samples away unless they
+           are recorded, so only keep the chip state up to date.  */
+        if (warp_mode_enabled && snddata.recdev == NULL
+            && sound_machine_can_skip_samples()) {
+            sound_machine_skip_samples(snddata.psid,
+                                       snddata.sound_chip_channels,
+                                       delta_t);
+            snddata.lastclk = maincpu_clk;
+            return 0;
+        }
+
         bufferptr = snddata.buffer + snddata.bufptr * snddata.sound_output_channels;
         nr = sound_machine_calculate_samples(snddata.psid,
                                              bufferptr,
@@ -1265,20 +1414,6 @@ void sound_reset(void)
     }
 }
 
-static void prevent_clk_overflow_callback(CLOCK sub, void *data)
-{
-    int c;
-
-    snddata.lastclk -= sub;
-    snddata.fclk -= SOUNDCLK_CONSTANT(sub);
-    snddata.wclk -= sub;
-    for (c = 0; c < snddata.sound_chip_channels; c++) {
-        if (snddata.psid[c]) {
-            sound_machine_prevent_clk_overflow(snddata.psid[c], sub);
-        }
-    }
-}
-
 /* flush all generated samples from buffer to sounddevice. adjust sid runspeed
    to match real running speed of program */
 double sound_flush()
@@ -1438,7 +1573,7 @@ double sound_flush()
         }
 
         if (snddata.recdev) {
-            if (snddata.recdev->write(snddata.buffer, nr * snddata.sound_output_channels)) {
+            if (sound_record_write(snddata.buffer, nr * snddata.sound_output_channels)) {
                 sound_error("write to sound device failed.");
                 return 0;
             }
@@ -1552,9 +1687,6 @@ void sound_init(unsigned int clock_rate, unsigned int ticks_per_frame)
     cycles_per_rfsh = ticks_per_frame;
     rfsh_per_sec = (1.0 / ((double)cycles_per_rfsh / (double)cycles_per_sec));
 
-    clk_guard_add_callback(maincpu_clk_guard, prevent_clk_overflow_callback,
-                           NULL);
-
     devlist = lib_strdup("");
 
     for (i = 0; sound_register_devices[i].name; i++) {
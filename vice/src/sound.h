@@ -116,6 +116,8 @@ typedef struct sound_device_s {
     int need_attenuation;
     /* maximum amount of channels */
     int max_channels;
+    /* write() may be called from a background thread when recording */
+    int async_record;
 } sound_device_t;
 
 static inline int16_t sound_audio_mix(int ch1, int ch2)
@@ -221,7 +223,6 @@ extern int sound_dump(int chipno);
 /* functions and structs implemented by each machine */
 typedef struct sound_s sound_t;
 extern char *sound_machine_dump_state(sound_t *psid);
-extern void sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub);
 extern void sound_machine_enable(int enable);
 
 extern unsigned int sound_device_num(void);
@@ -243,6 +244,10 @@ typedef struct sound_chip_s {
     /* sound chip calculate samples function */
     int (*calculate_samples)(sound_t **psid, int16_t *pbuf, int nr, int sound_output_channels, int sound_chip_channels, int *delta_t);
 
+    /* sound chip skip samples function, advances the chip state without
+       generating samples, NULL if the chip always has to be calculated */
+    void (*skip_samples)(sound_t **psid, int sound_chip_channels, int delta_t);
+
     /* sound chip store function */
     void (*store)(sound_t *psid, uint16_t addr, uint8_t val);
 
@@ -99,7 +99,8 @@ static sound_device_t ahi_device =
     _ahi_suspend,
     _ahi_resume,
     1,
-    2
+    2,
+    0
 };
 
 int sound_init_ahi_device(void)
@@ -37,6 +37,7 @@
 #include "debug.h"
 #include "log.h"
 #include "sound.h"
+#include "soundring.h"
 
 /* NetBSD doesn't define ESTRPIPE, this fix I noticed in gstreamer code */
 #ifndef ESTRPIPE
@@ -49,6 +50,15 @@ static int alsa_fragsize;
 static int alsa_channels;
 static int alsa_can_pause;
 
+/* Error of the last failed device write.  The writer thread must not log,
+   so alsa_write() reports it.  */
+static int alsa_write_error;
+
+/* Samples queued for the writer thread, NULL if writing directly.  */
+static sound_ring_t *alsa_ring = NULL;
+
+static int alsa_write_device(int16_t *pbuf, size_t nr);
+
 static int alsa_init(const char *param, int *speed, int *fragsize, int *fragnr, int *channels)
 {
     int err, dir;
@@ -113,14 +123,23 @@ static int alsa_init(const char *param, int *speed, int *fragsize, int *fragnr,
     /* number of periods according to the buffer size we wanted, nearest val */
     *fragnr = (alsa_bufsize + *fragsize / 2) / *fragsize;
 
+    /* With a writer thread the requested buffer is kept in the ring, the
+       device only needs to hold what the thread has just written.  */
     periods = (unsigned int)*fragnr;
+#ifdef HAVE_PTHREAD
+    if (periods > 2) {
+        periods = 2;
+    }
+#endif
     dir = 0;
     if ((err = snd_pcm_hw_params_set_periods_near(handle, hwparams, &periods, &dir)) < 0) {
         log_message(LOG_DEFAULT, "Unable to set periods %u for playback: %s",
                 periods, snd_strerror(err));
         goto fail;
     }
+#ifndef HAVE_PTHREAD
     *fragnr = (int)periods;
+#endif
 
     alsa_can_pause = snd_pcm_hw_params_can_pause(hwparams);
 
@@ -133,6 +152,13 @@ static int alsa_init(const char *param, int *speed, int *fragsize, int *fragnr,
     alsa_fragsize = *fragsize;
     alsa_channels = *channels;
 
+    alsa_ring = sound_ring_create((size_t)(alsa_bufsize * alsa_channels));
+    if (sound_ring_start_writer(alsa_ring, alsa_write_device,
+                                (size_t)(alsa_fragsize * alsa_channels)) < 0) {
+        sound_ring_destroy(alsa_ring);
+        alsa_ring = NULL;
+    }
+
     return 0;
 
 fail:
@@ -141,29 +167,26 @@ fail:
     return 1;
 }
 
+/* Returns 0 if the stream was recovered, else the error to report.  This
+   may run on the writer thread, so it doesn't log.  */
 static int xrun_recovery(snd_pcm_t *hnd, int err)
 {
     if (err == -EPIPE) {    /* under-run */
-        if ((err = snd_pcm_prepare(hnd)) < 0) {
-            log_message(LOG_DEFAULT, "Can't recover from underrun, prepare failed: %s", snd_strerror(err));
-        }
-        return 0;
+        return snd_pcm_prepare(hnd);
     } else if (err == -ESTRPIPE) {
         while ((err = snd_pcm_resume(hnd)) == -EAGAIN) {
-            log_message(LOG_DEFAULT, "xrun_recovery: %s", snd_strerror(err));
             sleep(1);       /* wait until the suspend flag is released */
         }
         if (err < 0) {
-            if ((err = snd_pcm_prepare(hnd)) < 0) {
-                log_message(LOG_DEFAULT, "Can't recover from suspend, prepare failed: %s", snd_strerror(err));
-            }
+            return snd_pcm_prepare(hnd);
         }
         return 0;
     }
     return err;
 }
 
-static int alsa_write(int16_t *pbuf, size_t nr)
+/* Blocking write, on the writer thread if there is one.  */
+static int alsa_write_device(int16_t *pbuf, size_t nr)
 {
     int err;
 
@@ -172,10 +195,9 @@ static int alsa_write(int16_t *pbuf, size_t nr)
     while (nr > 0) {
         err = (int)snd_pcm_writei(handle, pbuf, nr);
         if (err == -EAGAIN) {
-            log_message(LOG_DEFAULT, "Write error: %s", snd_strerror(err));
             continue;
         } else if (err < 0 && (err = xrun_recovery(handle, err)) < 0) {
-            log_message(LOG_DEFAULT, "Write error: %s", snd_strerror(err));
+            alsa_write_error = err;
             return 1;
         }
         pbuf += err * alsa_channels;
@@ -185,12 +207,34 @@ static int alsa_write(int16_t *pbuf, size_t nr)
     return 0;
 }
 
+static int alsa_write(int16_t *pbuf, size_t nr)
+{
+    if (alsa_ring == NULL) {
+        if (!alsa_write_device(pbuf, nr)) {
+            return 0;
+        }
+    } else if (!sound_ring_failed(alsa_ring)) {
+        /* sound_flush() never writes more than alsa_bufferspace() allows */
+        sound_ring_write(alsa_ring, pbuf, nr);
+        return 0;
+    }
+
+    log_message(LOG_DEFAULT, "Write error: %s", snd_strerror(alsa_write_error));
+    return 1;
+}
+
 static int alsa_bufferspace(void)
 {
+    snd_pcm_sframes_t space;
+
+    if (alsa_ring != NULL) {
+        return (int)(sound_ring_space(alsa_ring) / (size_t)alsa_channels);
+    }
+
 #ifdef HAVE_SND_PCM_AVAIL
-    snd_pcm_sframes_t space = snd_pcm_avail(handle);
+    space = snd_pcm_avail(handle);
 #else
-    snd_pcm_sframes_t space = snd_pcm_avail_update(handle);
+    space = snd_pcm_avail_update(handle);
 #endif
     /* keep alsa values real. Values < 0 mean errors, call to alsa_write
      * will resume. */
@@ -202,6 +246,10 @@ static int alsa_bufferspace(void)
 
 static void alsa_close(void)
 {
+    if (alsa_ring != NULL) {
+        sound_ring_destroy(alsa_ring);
+        alsa_ring = NULL;
+    }
     snd_pcm_close(handle);
     handle = NULL;
     alsa_bufsize = 0;
@@ -212,6 +260,15 @@ static int alsa_suspend(void)
 {
     int err;
 
+    /* Stopping the writer is enough to silence the device, it recovers
+       from the underrun on resume.  */
+    if (alsa_ring != NULL) {
+        sound_ring_pause(alsa_ring, 1);
+        if (!alsa_can_pause) {
+            return 0;
+        }
+    }
+
     if (!alsa_can_pause) {
         return 1;
     }
@@ -229,6 +286,10 @@ static int alsa_resume(void)
     int err;
 
     if (!alsa_can_pause) {
+        if (alsa_ring != NULL) {
+            sound_ring_pause(alsa_ring, 0);
+            return 0;
+        }
         return 1;
     }
 
@@ -237,6 +298,10 @@ static int alsa_resume(void)
         return 1;
     }
 
+    if (alsa_ring != NULL) {
+        sound_ring_pause(alsa_ring, 0);
+    }
+
     return 0;
 }
 
@@ -252,7 +317,8 @@ static sound_device_t alsa_device =
     alsa_suspend,
     alsa_resume,
     1,
-    2
+    2,
+    0
 };
 
 int sound_init_alsa_device(void)
@@ -856,7 +856,8 @@ static sound_device_t coreaudio_device =
     coreaudio_suspend,
     coreaudio_resume,
     1,
-    2
+    2,
+    0
 };
 
 int sound_init_coreaudio_device(void)
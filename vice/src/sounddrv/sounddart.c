@@ -624,7 +624,8 @@ static sound_device_t dart_device =
     dart_suspend,      /* dart_suspend */
     dart_resume,       /* dart_resume */
     1,
-    2
+    2,
+    0
 };
 
 #if 0
@@ -79,7 +79,8 @@ static sound_device_t dump_device =
     NULL,
     NULL,
     0,
-    1
+    1,
+    0
 };
 
 int sound_init_dump_device(void)
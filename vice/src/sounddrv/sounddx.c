@@ -586,7 +586,8 @@ static sound_device_t dx_device =
     dx_suspend,
     dx_resume,
     0,
-    2           /* FIXME: should account for mono and stereo devices */
+    2,          /* FIXME: should account for mono and stereo devices */
+    0
 };
 
 int sound_init_dx_device(void)
@@ -161,7 +161,8 @@ static sound_device_t flac_device =
     NULL,
     NULL,
     0,
-    2
+    2,
+    1
 };
 
 int sound_init_flac_device(void)
@@ -65,6 +65,7 @@ static sound_device_t fs_device =
     NULL,
     NULL,
     0,
+    1,
     1
 };
 
@@ -165,7 +165,8 @@ static sound_device_t iff_device =
     NULL,
     NULL,
     0,
-    2
+    2,
+    1
 };
 
 int sound_init_iff_device(void)
@@ -30,12 +30,21 @@
 
 #include "log.h"
 #include "sound.h"
+#include "soundring.h"
 
 #include <pulse/simple.h>
 #include <pulse/error.h>
 
 static pa_simple *s = NULL;
 
+/* Samples queued for the writer thread, NULL if writing directly.  */
+static sound_ring_t *pulse_ring = NULL;
+static int pulse_channels;
+
+/* Error of the last failed write.  The writer thread must not log, so
+   pulsedrv_write() reports it.  */
+static int pulse_write_error;
+
 
 /* XXX: gcc's -pedantic will warn about these initializations being invalid for
  *      C90, but PulseAudio uses C99 (it uses inttypes.h), so in this case
@@ -57,23 +66,56 @@ static pa_buffer_attr attr = {
 };
 
 
-/* This driver does not use the bufferspace function because it should be
- * unnecessary. Pulse is already going to do its own thing regarding latency
- * and hopefully just does the right thing for us without forcing us to
- * bother with our own timing code. */
+static sound_device_t pulsedrv_device;
+
+static int pulsedrv_bufferspace(void);
+
+/* Blocking write, on the writer thread if there is one.  */
+static int pulsedrv_write_device(int16_t *pbuf, size_t nr)
+{
+    int error = 0;
+    if (pa_simple_write(s, pbuf, nr * 2, &error)) {
+        pulse_write_error = error;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Without a writer thread this driver does not use the bufferspace
+ * function, as pulse does its own thing regarding latency and blocks in
+ * pa_simple_write().  With the writer thread, the server only gets a short
+ * buffer and the requested latency is kept in the ring, where the sound
+ * code can see the fill level. */
 static int pulsedrv_init(const char *param, int *speed, int *fragsize, int *fragnr, int *channels)
 {
     int error = 0;
+    int server_frags = *fragnr;
+
+    pulse_channels = *channels;
+    pulse_ring = sound_ring_create((size_t)(*fragsize * *fragnr * *channels));
+    if (sound_ring_start_writer(pulse_ring, pulsedrv_write_device,
+                                (size_t)(*fragsize * *channels)) < 0) {
+        sound_ring_destroy(pulse_ring);
+        pulse_ring = NULL;
+    } else if (server_frags > 2) {
+        server_frags = 2;
+    }
+    pulsedrv_device.bufferspace = pulse_ring != NULL ? pulsedrv_bufferspace : NULL;
 
     ss.rate = (uint32_t)*speed;
     ss.channels = (uint8_t)*channels;
 
     attr.fragsize = (uint32_t)(*fragsize * 2);
-    attr.tlength = (uint32_t)(*fragsize * *fragnr * 2);
+    attr.tlength = (uint32_t)(*fragsize * server_frags * 2);
 
     s = pa_simple_new(NULL, "VICE", PA_STREAM_PLAYBACK, NULL, "playback", &ss, NULL, &attr, &error);
     if (s == NULL) {
         log_error(LOG_DEFAULT, "pa_simple_new(): %s", pa_strerror(error));
+        if (pulse_ring != NULL) {
+            sound_ring_destroy(pulse_ring);
+            pulse_ring = NULL;
+        }
         return 1;
     }
 
@@ -82,18 +124,34 @@ static int pulsedrv_init(const char *param, int *speed, int *fragsize, int *frag
 
 static int pulsedrv_write(int16_t *pbuf, size_t nr)
 {
-    int error = 0;
-    if (pa_simple_write(s, pbuf, nr * 2, &error)) {
-        log_error(LOG_DEFAULT, "pa_simple_write(,%d): %s", (int)nr, pa_strerror(error));
-        return 1;
+    if (pulse_ring == NULL) {
+        if (!pulsedrv_write_device(pbuf, nr)) {
+            return 0;
+        }
+    } else if (!sound_ring_failed(pulse_ring)) {
+        /* sound_flush() never writes more than pulsedrv_bufferspace() allows */
+        sound_ring_write(pulse_ring, pbuf, nr);
+        return 0;
     }
 
-    return 0;
+    log_error(LOG_DEFAULT, "pa_simple_write(): %s", pa_strerror(pulse_write_error));
+    return 1;
+}
+
+static int pulsedrv_bufferspace(void)
+{
+    return (int)(sound_ring_space(pulse_ring) / (size_t)pulse_channels);
 }
 
 static int pulsedrv_suspend(void)
 {
     int error = 0;
+
+    /* keep the writer out of the way while flushing */
+    if (pulse_ring != NULL) {
+        sound_ring_pause(pulse_ring, 1);
+        sound_ring_clear(pulse_ring);
+    }
     if (pa_simple_flush(s, &error)) {
         log_error(LOG_DEFAULT, "pa_simple_flush(): %s", pa_strerror(error));
         return 1;
@@ -101,9 +159,22 @@ static int pulsedrv_suspend(void)
     return 0;
 }
 
+static int pulsedrv_resume(void)
+{
+    if (pulse_ring != NULL) {
+        sound_ring_pause(pulse_ring, 0);
+    }
+    return 0;
+}
+
 static void pulsedrv_close(void)
 {
     int error = 0;
+
+    if (pulse_ring != NULL) {
+        sound_ring_destroy(pulse_ring);
+        pulse_ring = NULL;
+    }
     if (pa_simple_flush(s, &error)) {
         log_error(LOG_DEFAULT, "pa_simple_flush(): %s", pa_strerror(error));
         /* don't stop */
@@ -119,12 +190,13 @@ static sound_device_t pulsedrv_device =
     pulsedrv_write,
     NULL,
     NULL,
-    NULL,
+    NULL,   /* set by pulsedrv_init() */
     pulsedrv_close,
     pulsedrv_suspend,
-    NULL,
+    pulsedrv_resume,
     1,
-    2
+    2,
+    0
 };
 
 int sound_init_pulse_device(void)
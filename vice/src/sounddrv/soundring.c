@@ -0,0 +1,296 @@
+/*
+ * soundring.c - Sample ring between the emulation and audio threads.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <string.h>
+
+#ifdef HAVE_PTHREAD
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+#endif
+
+#include "lib.h"
+#include "soundring.h"
+
+#if defined(__GNUC__)
+#define SOUND_RING_BARRIER() __sync_synchronize()
+#else
+#define SOUND_RING_BARRIER()
+#endif
+
+struct sound_ring_s {
+    int16_t *buf;
+    size_t mask;        /* allocated size - 1, a power of two */
+    size_t size;        /* usable size */
+
+    /* Free running counters, only written by the producer respectively
+       the consumer.  The difference is the fill level.  */
+    volatile size_t written;
+    volatile size_t read;
+
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+    int have_thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+    pthread_cond_t idle;
+    sound_ring_output_t output;
+    int16_t *chunk_buf;
+    size_t chunk;
+    volatile int waiting;   /* writer sleeps until a chunk is available */
+    int busy;               /* writer is inside output() */
+    int paused;
+    int quit;
+#endif
+    volatile int failed;
+};
+
+
+sound_ring_t *sound_ring_create(size_t size)
+{
+    sound_ring_t *ring = lib_calloc(1, sizeof(sound_ring_t));
+    size_t alloc = 1;
+
+    while (alloc < size) {
+        alloc <<= 1;
+    }
+    ring->buf = lib_calloc(alloc, sizeof(int16_t));
+    ring->mask = alloc - 1;
+    ring->size = size;
+
+    return ring;
+}
+
+void sound_ring_destroy(sound_ring_t *ring)
+{
+#ifdef HAVE_PTHREAD
+    if (ring->have_thread) {
+        pthread_mutex_lock(&ring->lock);
+        ring->quit = 1;
+        pthread_cond_signal(&ring->wakeup);
+        pthread_mutex_unlock(&ring->lock);
+        pthread_join(ring->thread, NULL);
+
+        pthread_cond_destroy(&ring->idle);
+        pthread_cond_destroy(&ring->wakeup);
+        pthread_mutex_destroy(&ring->lock);
+        lib_free(ring->chunk_buf);
+    }
+#endif
+    lib_free(ring->buf);
+    lib_free(ring);
+}
+
+size_t sound_ring_fill(sound_ring_t *ring)
+{
+    return ring->written - ring->read;
+}
+
+size_t sound_ring_space(sound_ring_t *ring)
+{
+    return ring->size - (ring->written - ring->read);
+}
+
+size_t sound_ring_write(sound_ring_t *ring, const int16_t *buf, size_t nr)
+{
+    size_t pos, part;
+    size_t space = sound_ring_space(ring);
+
+    if (nr > space) {
+        nr = space;
+    }
+
+    pos = ring->written & ring->mask;
+    part = ring->mask + 1 - pos;
+    if (part > nr) {
+        part = nr;
+    }
+    memcpy(ring->buf + pos, buf, part * sizeof(int16_t));
+    memcpy(ring->buf, buf + part, (nr - part) * sizeof(int16_t));
+
+    /* the samples must be visible before the counter */
+    SOUND_RING_BARRIER();
+    ring->written += nr;
+    SOUND_RING_BARRIER();
+
+#ifdef HAVE_PTHREAD
+    if (ring->waiting) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(&ring->wakeup);
+        pthread_mutex_unlock(&ring->lock);
+    }
+#endif
+
+    return nr;
+}
+
+size_t sound_ring_read(sound_ring_t *ring, int16_t *buf, size_t nr)
+{
+    size_t pos, part;
+    size_t fill = sound_ring_fill(ring);
+
+    if (nr > fill) {
+        nr = fill;
+    }
+
+    /* don't read samples older than the counter */
+    SOUND_RING_BARRIER();
+
+    pos = ring->read & ring->mask;
+    part = ring->mask + 1 - pos;
+    if (part > nr) {
+        part = nr;
+    }
+    memcpy(buf, ring->buf + pos, part * sizeof(int16_t));
+    memcpy(buf + part, ring->buf, (nr - part) * sizeof(int16_t));
+
+    /* the samples must be copied before the space is given back */
+    SOUND_RING_BARRIER();
+    ring->read += nr;
+
+    return nr;
+}
+
+void sound_ring_clear(sound_ring_t *ring)
+{
+    ring->read = ring->written;
+    SOUND_RING_BARRIER();
+}
+
+int sound_ring_failed(sound_ring_t *ring)
+{
+    return ring->failed;
+}
+
+#ifdef HAVE_PTHREAD
+
+/* Sleep until the producer has queued a chunk, or for at most 20ms so a
+   missed wakeup can't stall playback.  Called with the lock held.  */
+static void sound_ring_wait(sound_ring_t *ring)
+{
+    struct timeval now;
+    struct timespec until;
+
+    gettimeofday(&now, NULL);
+    until.tv_sec = now.tv_sec;
+    until.tv_nsec = now.tv_usec * 1000 + 20000000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+
+    ring->waiting = 1;
+    SOUND_RING_BARRIER();
+    if (sound_ring_fill(ring) < ring->chunk || ring->paused) {
+        pthread_cond_timedwait(&ring->wakeup, &ring->lock, &until);
+    }
+    ring->waiting = 0;
+}
+
+static void *sound_ring_thread(void *arg)
+{
+    sound_ring_t *ring = (sound_ring_t *)arg;
+    size_t nr;
+
+    pthread_mutex_lock(&ring->lock);
+    while (!ring->quit) {
+        if (ring->paused || sound_ring_fill(ring) < ring->chunk) {
+            sound_ring_wait(ring);
+            continue;
+        }
+
+        ring->busy = 1;
+        pthread_mutex_unlock(&ring->lock);
+
+        nr = sound_ring_read(ring, ring->chunk_buf, ring->chunk);
+        if (ring->output(ring->chunk_buf, nr)) {
+            ring->failed = 1;
+        }
+
+        pthread_mutex_lock(&ring->lock);
+        ring->busy = 0;
+        pthread_cond_broadcast(&ring->idle);
+        if (ring->failed) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    return NULL;
+}
+
+int sound_ring_start_writer(sound_ring_t *ring, sound_ring_output_t output, size_t chunk)
+{
+    ring->output = output;
+    ring->chunk = chunk < ring->size ? chunk : ring->size;
+    ring->chunk_buf = lib_malloc(ring->chunk * sizeof(int16_t));
+
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->wakeup, NULL);
+    pthread_cond_init(&ring->idle, NULL);
+
+    if (pthread_create(&ring->thread, NULL, sound_ring_thread, ring) != 0) {
+        pthread_cond_destroy(&ring->idle);
+        pthread_cond_destroy(&ring->wakeup);
+        pthread_mutex_destroy(&ring->lock);
+        lib_free(ring->chunk_buf);
+        ring->chunk_buf = NULL;
+        return -1;
+    }
+    ring->have_thread = 1;
+
+    return 0;
+}
+
+void sound_ring_pause(sound_ring_t *ring, int pause)
+{
+    if (!ring->have_thread) {
+        return;
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    ring->paused = pause;
+    if (pause) {
+        while (ring->busy) {
+            pthread_cond_wait(&ring->idle, &ring->lock);
+        }
+    } else {
+        pthread_cond_signal(&ring->wakeup);
+    }
+    pthread_mutex_unlock(&ring->lock);
+}
+
+#else /* !HAVE_PTHREAD */
+
+int sound_ring_start_writer(sound_ring_t *ring, sound_ring_output_t output, size_t chunk)
+{
+    return -1;
+}
+
+void sound_ring_pause(sound_ring_t *ring, int pause)
+{
+}
+
+#endif
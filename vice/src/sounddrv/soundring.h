@@ -0,0 +1,74 @@
+/*
+ * soundring.h - Sample ring between the emulation and audio threads.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_SOUNDRING_H
+#define VICE_SOUNDRING_H
+
+#include <stddef.h>
+
+#include "types.h"
+
+/* A single producer, single consumer ring of samples.  The emulation
+   thread writes whole fragments from the driver's write function, the
+   audio side reads them either from the API's callback or from a writer
+   thread that feeds a blocking device.  Neither side takes a lock to move
+   samples, so the emulation thread never waits for the audio device.
+
+   All sizes are in int16_t units, i.e. frames * channels.  */
+
+struct sound_ring_s;
+typedef struct sound_ring_s sound_ring_t;
+
+/* Blocking device write, called on the writer thread.  Returns nonzero
+   on a fatal error.  */
+typedef int (*sound_ring_output_t)(int16_t *buf, size_t nr);
+
+extern sound_ring_t *sound_ring_create(size_t size);
+extern void sound_ring_destroy(sound_ring_t *ring);
+
+/* Producer side.  Returns the number of samples actually queued.  */
+extern size_t sound_ring_write(sound_ring_t *ring, const int16_t *buf, size_t nr);
+extern size_t sound_ring_space(sound_ring_t *ring);
+
+/* Consumer side.  Returns the number of samples actually taken.  */
+extern size_t sound_ring_read(sound_ring_t *ring, int16_t *buf, size_t nr);
+extern size_t sound_ring_fill(sound_ring_t *ring);
+
+/* Drop all queued samples.  Only call this while the consumer is
+   stopped.  */
+extern void sound_ring_clear(sound_ring_t *ring);
+
+/* Start a thread that passes the ring to `output' in blocks of `chunk'
+   samples.  Returns -1 if there is no thread support, in which case the
+   driver has to write to the device directly.  */
+extern int sound_ring_start_writer(sound_ring_t *ring, sound_ring_output_t output, size_t chunk);
+
+/* Stop/restart feeding the device.  sound_ring_pause() returns once the
+   writer is outside of `output', so the device may be used directly
+   afterwards.  */
+extern void sound_ring_pause(sound_ring_t *ring, int pause);
+
+/* Nonzero once `output' has failed; the writer stops in that case.  */
+extern int sound_ring_failed(sound_ring_t *ring);
+
+#endif
@@ -39,25 +39,24 @@
 #include "lib.h"
 #include "log.h"
 #include "sound.h"
+#include "soundring.h"
 
 #ifdef ANDROID_COMPILE
 #include "loader.h"
 #endif
 
-static int16_t *sdl_buf = NULL;
+/* Filled by sdl_write(), emptied by the SDL audio callback.  */
+static sound_ring_t *sdl_ring = NULL;
 static SDL_AudioSpec sdl_spec;
-static volatile int sdl_inptr = 0;
-static volatile int sdl_outptr = 0;
-static volatile int sdl_full = 0;
-static int sdl_len = 0;
+static int sdl_channels = 0;
 
 static void sdl_callback(void *userdata, Uint8 *stream, int len)
 {
-    int amount, total;
-    total = 0;
+    size_t want = (size_t)len / sizeof(int16_t);
+    size_t total;
 
 #ifdef ANDROID_COMPILE
-    if ((!sdl_full) && (sdl_inptr == sdl_outptr)) {
+    if (sound_ring_fill(sdl_ring) == 0) {
         if (userdata) {
             *(short *)userdata = 0;
         }
@@ -65,35 +64,11 @@ static void sdl_callback(void *userdata, Uint8 *stream, int len)
     }
 #endif
 
-    while (total < (len / (int)sizeof(int16_t))) {
-        amount = sdl_inptr - sdl_outptr;
-        if (amount <= 0) {
-            amount = sdl_len - sdl_outptr;
-        }
-
-        if (amount + total > (len / (int)sizeof(int16_t))) {
-            amount = len / (int)sizeof(int16_t) - total;
-        }
-
-        sdl_full = 0;
-
-        if (!amount) {
-            memset(stream + total * (int)sizeof(int16_t), 0, (size_t)(len - total) * sizeof(int16_t));
-#ifdef ANDROID_COMPILE
-            if (userdata) {
-                *(short *)userdata = (short)(len / (int)sizeof(int16_t));
-            }
-#endif
-            return;
-        }
-
-        memcpy(stream + total * (int)sizeof(int16_t), sdl_buf + sdl_outptr, (size_t)amount * sizeof(int16_t));
-        total += amount;
-        sdl_outptr += amount;
-
-        if (sdl_outptr == sdl_len) {
-            sdl_outptr = 0;
-        }
+    total = sound_ring_read(sdl_ring, (int16_t *)stream, want);
+    if (total < want) {
+        /* underrun, play silence */
+        memset(stream + total * sizeof(int16_t), 0, (want - total) * sizeof(int16_t));
+        total = want;
     }
 #ifdef ANDROID_COMPILE
     if (userdata) {
@@ -171,14 +146,8 @@ static int sdl_init(const char *param, int *speed,
      * buffersize */
     nr = ((*fragnr) * (*fragsize)) / sdl_spec.samples;
 
-    sdl_len = sdl_spec.samples * nr;
-    sdl_inptr = sdl_outptr = sdl_full = 0;
-    sdl_buf = lib_calloc((size_t)sdl_len, sizeof(int16_t));
-
-    if (!sdl_buf) {
-        SDL_CloseAudio();
-        return 1;
-    }
+    sdl_channels = *channels;
+    sdl_ring = sound_ring_create((size_t)(sdl_spec.samples * nr * sdl_channels));
 
     *speed = sdl_spec.freq;
     *fragsize = sdl_spec.samples;
@@ -229,33 +198,24 @@ void swab(void *src, void *dst, size_t length)
 #ifdef ANDROID_COMPILE
 void loader_writebuffer()
 {
-    int total;
+    for (;;) {
+        size_t old_fill = sound_ring_fill(sdl_ring);
 
-    for(;;) {
-        int old_sdl_outptr = sdl_outptr;
-
-        total = sdl_inptr - sdl_outptr;
-        if (total <= 0) {
-            total = sdl_len - sdl_outptr + sdl_inptr;
-        }
-        if (total > (sdl_spec.samples << 1)) {
+        if (old_fill > (size_t)(sdl_spec.samples << 1)) {
             Android_AudioWriteBuffer();
         } else {
             break;
         }
 
-        if (sdl_outptr == old_sdl_outptr) {
+        if (sound_ring_fill(sdl_ring) == old_fill) {
             break;
         }
-    };
+    }
 }
 #endif
 
 static int sdl_write(int16_t *pbuf, size_t nr)
 {
-    int total, amount;
-    total = 0;
-
 #ifdef WORDS_BIGENDIAN
     if (sdl_spec.format != AUDIO_S16MSB) {
         /* Swap bytes if we're on a big-endian machine, like the Macintosh */
@@ -263,67 +223,30 @@ static int sdl_write(int16_t *pbuf, size_t nr)
     }
 #endif
 
-    while (total < (int)nr) {
-        amount = sdl_outptr - sdl_inptr;
-
-        if (amount <= 0) {
-            amount = sdl_len - sdl_inptr;
-        }
-
-        if (total + amount > (int)nr) {
-            amount = (int)nr - total;
-        }
-
-        if (amount <= 0) {
-            SDL_Delay(5);
-            continue;
-        }
-
-        memcpy(sdl_buf + sdl_inptr, pbuf + total, (size_t)amount * sizeof(int16_t));
-        sdl_inptr += amount;
-        total += amount;
-
-        if (sdl_inptr == sdl_len) {
-            sdl_inptr = 0;
-        }
-    }
-
-    if (sdl_inptr == sdl_outptr) {
-        sdl_full = 1;
-    }
+    /* sound_flush() never writes more than sdl_bufferspace() allows, so
+       this doesn't have to wait for the callback */
+    sound_ring_write(sdl_ring, pbuf, nr);
 
     return 0;
 }
 
 static int sdl_bufferspace(void)
 {
-    int amount;
-
-    if (sdl_full) {
-        amount = sdl_len;
-    } else {
-        amount = sdl_inptr - sdl_outptr;
-    }
-
-    if (amount < 0) {
-        amount += sdl_len;
-    }
-
-    return sdl_len - amount;
+    return (int)(sound_ring_space(sdl_ring) / (size_t)sdl_channels);
 }
 
 static void sdl_close(void)
 {
     SDL_CloseAudio();
-    lib_free(sdl_buf);
-    sdl_buf = NULL;
-    sdl_inptr = sdl_outptr = sdl_len = sdl_full = 0;
+    if (sdl_ring != NULL) {
+        sound_ring_destroy(sdl_ring);
+        sdl_ring = NULL;
+    }
 }
 
 static int sdl_suspend(void)
 {
     SDL_PauseAudio(1);
-    sdl_full = 0;
     return 0;
 }
 
@@ -345,7 +268,8 @@ static sound_device_t sdl_device =
     sdl_suspend,
     sdl_resume,
     1,
-    2
+    2,
+    0
 };
 
 int sound_init_sdl_device(void)
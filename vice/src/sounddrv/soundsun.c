@@ -242,7 +242,8 @@ static sound_device_t sun_device =
     1
 #else
     2
-#endif
+#endif,
+0
 };
 
 int sound_init_sun_device(void)
@@ -554,7 +554,8 @@ static sound_device_t wmm_device =
     wmm_suspend,
     wmm_resume,
     0,
-    2
+    2,
+    0
 };
 
 int sound_init_wmm_device(void)
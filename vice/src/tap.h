@@ -41,6 +41,7 @@
 
 struct tape_init_s;
 struct tape_file_record_s;
+struct tap_index_s;
 
 typedef struct tap_s {
     /* File name.  */
@@ -95,9 +96,22 @@ typedef struct tap_s {
 
     /* Has the tap changed? We correct the size then.  */
     int has_changed;
+
+    /* Whole image for the file parser and the datasette, reloaded when
+       the datasette has written to the file.  */
+    uint8_t *data;
+    long data_size;
+    int data_valid;
+
+    /* Position of the file parser in the image.  */
+    long data_pos;
+
+    /* Files found so far, shared by all opens of the same image.  */
+    struct tap_index_s *index;
 } tap_t;
 
 extern void tap_init(const struct tape_init_s *init);
+extern void tap_shutdown(void);
 extern tap_t *tap_open(const char *name, unsigned int *read_only);
 extern int tap_close(tap_t *tap);
 extern int tap_create(const char *name);
@@ -109,5 +123,6 @@ extern void tap_get_header(tap_t *tap, uint8_t *name);
 extern struct tape_file_record_s *tap_get_current_file_record(tap_t *tap);
 
 extern int tap_read(tap_t *tap, uint8_t *buf, size_t size);
+extern void tap_data_load(tap_t *tap);
 
 #endif
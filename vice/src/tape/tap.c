@@ -58,6 +58,9 @@
 
 #define MAX_ERRORS 30
 
+/* How many unused file indexes are kept around.  */
+#define TAP_INDEX_MAX 16
+
 #define PILOT_TYPE_ANY -1
 #define PILOT_TYPE_CBM 0
 #define PILOT_TYPE_TT  1
@@ -75,6 +78,152 @@ static int tap_pulse_tt_short_max = 0x22;
 static int tap_pulse_tt_long_min = 0x23;
 static int tap_pulse_tt_long_max = 0x36;
 
+/* Files found in an image, in the order tap_seek_to_next_file() finds
+   them when starting at the beginning of the tape.  Images are identified
+   by their contents, as the same TAP is usually opened again for every
+   directory listing.  */
+typedef struct tap_index_s {
+    /* Identification of the image.  */
+    long size;
+    uint64_t hash;
+    int behaviour;
+    int thresholds[6];
+
+    /* Number of open images using this index.  */
+    int refs;
+
+    /* Positions and records of the files found so far.  */
+    int count;
+    int allocated;
+    long *pos;
+    tape_file_record_t *records;
+
+    /* No more files behind the last one.  */
+    int complete;
+
+    struct tap_index_s *next;
+} tap_index_t;
+
+static tap_index_t *tap_index_list = NULL;
+
+/* ------------------------------------------------------------------------- */
+
+static void tap_index_free(tap_index_t *index)
+{
+    lib_free(index->pos);
+    lib_free(index->records);
+    lib_free(index);
+}
+
+static void tap_index_release(tap_t *tap)
+{
+    tap_index_t **prev, *index;
+    int unused = 0;
+
+    if (tap->index != NULL) {
+        tap->index->refs--;
+        tap->index = NULL;
+    }
+
+    /* drop the oldest unused indexes, the newest are at the front */
+    prev = &tap_index_list;
+    while ((index = *prev) != NULL) {
+        if (index->refs == 0 && ++unused > TAP_INDEX_MAX) {
+            *prev = index->next;
+            tap_index_free(index);
+        } else {
+            prev = &index->next;
+        }
+    }
+}
+
+static void tap_index_attach(tap_t *tap)
+{
+    tap_index_t *index, **prev;
+    uint64_t hash = 14695981039346656037ULL;
+    int thresholds[6];
+    int behaviour;
+    long i;
+
+    thresholds[0] = tap_pulse_short_min;
+    thresholds[1] = tap_pulse_short_max;
+    thresholds[2] = tap_pulse_middle_min;
+    thresholds[3] = tap_pulse_middle_max;
+    thresholds[4] = tap_pulse_long_min;
+    thresholds[5] = tap_pulse_long_max;
+    behaviour = machine_tape_behaviour();
+
+    /* FNV-1a */
+    for (i = 0; i < tap->data_size; i++) {
+        hash = (hash ^ tap->data[i]) * 1099511628211ULL;
+    }
+
+    prev = &tap_index_list;
+    while ((index = *prev) != NULL) {
+        if (index->size == tap->data_size
+            && index->hash == hash
+            && index->behaviour == behaviour
+            && !memcmp(index->thresholds, thresholds, sizeof(thresholds))) {
+            /* move to the front */
+            *prev = index->next;
+            break;
+        }
+        prev = &index->next;
+    }
+
+    if (index == NULL) {
+        index = lib_calloc(1, sizeof(tap_index_t));
+        index->size = tap->data_size;
+        index->hash = hash;
+        index->behaviour = behaviour;
+        memcpy(index->thresholds, thresholds, sizeof(thresholds));
+    }
+
+    index->next = tap_index_list;
+    tap_index_list = index;
+    index->refs++;
+    tap->index = index;
+}
+
+static void tap_index_add(tap_index_t *index, long pos, const tape_file_record_t *rec)
+{
+    if (index->count == index->allocated) {
+        index->allocated = index->allocated ? index->allocated * 2 : 16;
+        index->pos = lib_realloc(index->pos, index->allocated * sizeof(long));
+        index->records = lib_realloc(index->records,
+                                     index->allocated * sizeof(tape_file_record_t));
+    }
+    index->pos[index->count] = pos;
+    index->records[index->count] = *rec;
+    index->count++;
+}
+
+/* (Re)load the whole image into memory.  */
+void tap_data_load(tap_t *tap)
+{
+    long size, fpos;
+
+    if (tap->data_valid) {
+        return;
+    }
+
+    tap_index_release(tap);
+    lib_free(tap->data);
+    tap->data = NULL;
+    tap->data_size = 0;
+
+    fpos = ftell(tap->fd);
+    size = (long)util_file_length(tap->fd);
+    tap->data = lib_malloc(size + 1);
+    if (fseek(tap->fd, 0, SEEK_SET) == 0) {
+        tap->data_size = (long)fread(tap->data, 1, size, tap->fd);
+    }
+    fseek(tap->fd, fpos, SEEK_SET);
+
+    tap->data_valid = 1;
+    tap_index_attach(tap);
+}
+
 
 static int tap_header_read(tap_t *tap, FILE *fd)
 {
@@ -112,6 +261,9 @@ static tap_t *tap_new(void)
     tap->current_file_number = -1;
     tap->current_file_data = NULL;
     tap->current_file_size = 0;
+    tap->data = NULL;
+    tap->data_valid = 0;
+    tap->index = NULL;
 
     return tap;
 }
@@ -161,6 +313,7 @@ tap_t *tap_open(const char *name, unsigned int *read_only)
     new->current_file_number = -1;
     new->current_file_data = NULL;
     new->current_file_size = 0;
+    new->data_pos = new->offset;
 
     return new;
 }
@@ -181,6 +334,8 @@ int tap_close(tap_t *tap)
         retval = 0;
     }
 
+    tap_index_release(tap);
+    lib_free(tap->data);
     lib_free(tap->current_file_data);
     lib_free(tap->file_name);
     lib_free(tap->tap_file_record);
@@ -226,32 +381,41 @@ int tap_create(const char *name)
 
 static int tap_find_pilot(tap_t *tap, int type);
 
+inline static int tap_get_long_gap(tap_t *tap, uint32_t *pulse_length)
+{
+    const uint8_t *size;
+
+    if (tap->data_size - tap->data_pos < 3) {
+        tap->data_pos = tap->data_size;
+        return -1;
+    }
+    size = tap->data + tap->data_pos;
+    tap->data_pos += 3;
+
+    *pulse_length = ((size[2] << 16) | (size[1] << 8) | size[0]) >> 3;
+    return 0;
+}
+
 inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
 {
     uint8_t data;
     uint32_t pulse_length = 0;
-    size_t res;
+    long start = tap->data_pos;
 
     *pos_advance = 0;
-    res = fread(&data, 1, 1, tap->fd);
 
-    if (res == 0) {
+    if (tap->data_pos >= tap->data_size) {
         return -1;
     }
-
-    *pos_advance += (int)res;
+    data = tap->data[tap->data_pos++];
 
     if (data == 0) {
         if (tap->version == 0) {
             pulse_length = 256;
         } else if ((tap->version == 1) || (tap->version == 2)) {
-            uint8_t size[3];
-            res = fread(size, 3, 1, tap->fd);
-            if (res == 0) {
+            if (tap_get_long_gap(tap, &pulse_length) < 0) {
                 return -1;
             }
-            *pos_advance += 3;
-            pulse_length = ((size[2] << 16) | (size[1] << 8) | size[0]) >> 3;
         }
     } else {
         pulse_length = data;
@@ -261,20 +425,15 @@ inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
     if (tap->version == 2) {
         uint32_t pulse_length2;
 
-        res = fread(&data, 1, 1, tap->fd);
-
-        if (res == 0) {
+        if (tap->data_pos >= tap->data_size) {
             return -1;
         }
-        *pos_advance += (int)res;
+        data = tap->data[tap->data_pos++];
+
         if (data == 0) {
-            uint8_t size[3];
-            res = fread(size, 3, 1, tap->fd);
-            if (res == 0) {
+            if (tap_get_long_gap(tap, &pulse_length2) < 0) {
                 return -1;
             }
-            *pos_advance += 3;
-            pulse_length2 = ((size[2] << 16) | (size[1] << 8) | size[0]) >> 3;
         } else {
             pulse_length2 = data;
         }
@@ -283,6 +442,8 @@ inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
         pulse_length += pulse_length2;
     }
 
+    *pos_advance = (int)(tap->data_pos - start);
+
 #if TAP_DEBUG > 2
     if (TAP_PULSE_SHORT(data)) {
         log_debug("s");
@@ -377,22 +538,18 @@ static int tap_cbm_skip_pilot(tap_t *tap)
     int data, errors;
     long fpos, counter;
     long fpos2;
-    long current_filepos;
     int pos_advance;
 
     errors = 0;
     counter = 0;
-    current_filepos = ftell(tap->fd);
     while (1) {
         /*  Save file position */
-        fpos = current_filepos;
+        fpos = tap->data_pos;
         data = tap_get_pulse(tap, &pos_advance);
-        current_filepos += pos_advance;
-        fpos2 = current_filepos;
+        fpos2 = tap->data_pos;
         if (TAP_PULSE_LONG(data)) {
             /* found an L pulse, try to read a byte */
-            fseek(tap->fd, fpos, SEEK_SET);
-            current_filepos = fpos;
+            tap->data_pos = fpos;
             data = tap_cbm_read_byte(tap);
             if (data == -1) {
                 /* end-of-tape */
@@ -404,13 +561,11 @@ static int tap_cbm_skip_pilot(tap_t *tap)
                 }
 
                 /* Start over after the L pulse */
-                fseek(tap->fd, fpos2, SEEK_SET);
-                current_filepos = fpos2;
+                tap->data_pos = fpos2;
                 counter = 0;
             } else {
                 /* success.  Go back to start of byte and return */
-                fseek(tap->fd, fpos, SEEK_SET);
-                current_filepos = fpos;
+                tap->data_pos = fpos;
                 return 0;
             }
         } else if (data < 0) {
@@ -766,13 +921,13 @@ static int tap_cbm_skip_file(tap_t *tap)
         int ret;
 
         while (1) {
-            fpos = ftell(tap->fd);
+            fpos = tap->data_pos;
 
             /* find next pilot */
             ret = tap_find_pilot(tap, PILOT_TYPE_CBM);
             if (ret < 0) {
                 /* no more pilot found => end of data */
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 break;
             }
 
@@ -780,7 +935,7 @@ static int tap_cbm_skip_file(tap_t *tap)
             ret = tap_cbm_read_block(tap, buffer, 193);
             if (ret < 1 || buffer[0] != 2) {
                 /* next block is not a data continuation block => end of data */
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 break;
             }
         }
@@ -847,7 +1002,7 @@ static int tap_tt_skip_pilot(tap_t *tap)
     int data;
 
 #if TAP_DEBUG > 1
-    log_debug("\nTAP_TT_SKIP_PILOT(0x%X", ftell(tap->fd));
+    log_debug("\nTAP_TT_SKIP_PILOT(0x%lX", tap->data_pos);
 #endif
 
     /* turbo-tape pilot is just repeats of value 0x02 */
@@ -860,12 +1015,12 @@ static int tap_tt_skip_pilot(tap_t *tap)
         if (data != 2) {
             /* value != 0x02, we found the end of the pilot.  Go back
                so byte can be read again */
-            fseek(tap->fd, -8, SEEK_CUR);
+            tap->data_pos -= 8;
         }
     } while (data == 2);
 
 #if TAP_DEBUG > 1
-    log_debug("-0x%X) ", ftell(tap->fd));
+    log_debug("-0x%lX) ", tap->data_pos);
 #endif
 
     return 0;
@@ -1087,11 +1242,9 @@ static int tap_determine_pilot_type(tap_t *tap)
 
 static int tap_find_pilot(tap_t *tap, int type)
 {
-    int i, countCBM, countTT, startCBM, startTT, minCBM;
-    int count;
-    int data[256];
-    long pos[257];
-    uint8_t buffer[256];
+    int countCBM, countTT, minCBM;
+    int data, pos_advance;
+    long pos, next_pos, startCBM, startTT;
 
     /* when looking for any pilot type, require CBM pilot to be longer
        than when specifically looking for CBM pilot.  A TurboTape L pulse
@@ -1103,7 +1256,7 @@ static int tap_find_pilot(tap_t *tap, int type)
        file */
     minCBM = (type == PILOT_TYPE_ANY) ? 1000 : PILOT_MIN_LENGTH_CBM;
 
-    startCBM = ftell(tap->fd);
+    startCBM = tap->data_pos;
     startTT = startCBM;
     countCBM = 0;
     countTT = 0;
@@ -1113,140 +1266,60 @@ static int tap_find_pilot(tap_t *tap, int type)
 #endif
 
     while ((countCBM < minCBM) && (countTT < PILOT_MIN_LENGTH_TT * 8)) {
-/*        count = fread(&data, 1, 256, tap->fd); */
-        int startpos = ftell(tap->fd);
-        int readlen = (int)fread(buffer, 1, 256, tap->fd);
-        uint32_t pulse_length = 0;
-        int j = 0;
-        int needed;
-        int res;
-        for (i = 0; i < readlen; ) {
-            pos[j] = startpos + i;
-            if (buffer[i] == 0) {
-                if (tap->version == 0) {
-                    pulse_length = 256;
-                    i++;
-                } else if ((tap->version == 1) || (tap->version == 2)) {
-                    int still_in_buffer = readlen - (i + 1);
-                    needed = 3 - still_in_buffer;
-                    if (needed <= 0) {
-                        pulse_length = ((buffer[i + 3] << 16) | (buffer[i + 2] << 8) | buffer[i + 1]) >> 3;
-                        i += 4;
-                    } else {
-                        /* There is not enough in the buffer
-                           Read some more */
-                        memcpy(buffer, buffer + i + 1, still_in_buffer);
-                        res = (int)fread(buffer + still_in_buffer, 1, needed, tap->fd);
-                        i = readlen;
-                        if (res == 0) {
-                            continue;
-                        }
-                        pulse_length = ((buffer[2] << 16) | (buffer[1] << 8) | buffer[0]) >> 3;
-                    }
-                }
+        pos = tap->data_pos;
+        data = tap_get_pulse(tap, &pos_advance);
+        if (data < 0) {
+            return -1;
+        }
+        next_pos = tap->data_pos;
+
+        if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_CBM) {
+            /* cbm pilot is at least PILOT_MIN_LENGTH_CBM consecutive short pulses */
+            if (TAP_PULSE_SHORT(data)) {
+                countCBM++;
             } else {
-                pulse_length = buffer[i];
-                i++;
-            }
-            data[j] = pulse_length;
-
-            if (tap->version == 2) {
-                uint32_t pulse_length2;
-                /*  Read one more byte if run out of buffer */
-                if (i == readlen) {
-                    readlen = (int)fread(buffer, 1, 1, tap->fd);
-                    if (readlen == 0) {
-                        continue;
-                    }
-                    i = 0;
-                }
-                if (buffer[i] == 0) {
-                    int still_in_buffer = readlen - (i + 1);
-                    needed = 3 - still_in_buffer;
-                    if (needed <= 0) {
-                        pulse_length2 = ((buffer[i + 3] << 16) | (buffer[i + 2] << 8) | buffer[i + 1]) >> 3;
-                        i += 4;
-                    } else {
-                        /* There is not enough in the buffer
-                           Read some more */
-                        memcpy(buffer, buffer + i + 1, still_in_buffer);
-                        res = (int)fread(buffer + still_in_buffer, 1, needed, tap->fd);
-                        i = readlen;
-                        if (res == 0) {
-                            continue;
-                        }
-                        pulse_length2 = ((buffer[2] << 16) | (buffer[1] << 8) | buffer[0]) >> 3;
-                    }
-                } else {
-                    pulse_length2 = buffer[i];
-                    i++;
-                }
-                data[j] += pulse_length2;
+                startCBM = next_pos;
+                countCBM = 0;
             }
-            j++;
-        }
-        count = j;
-        pos[j] = ftell(tap->fd);
 
-/*        for (i = 0, count = 0; i < 256; i++, count++) {
-            pos[i] = ftell(tap->fd);
-            data[i] = tap_get_pulse(tap);
-            if (data[i] < 0) break;
-        }
-        pos[i] = ftell(tap->fd);*/
-        if (count < 1) {
-            return -1;
+/*                  { startCBM+=countCBM+1; countCBM = 0; } */
         }
 
-        for (i = 0; (i < count) && (countCBM < minCBM) && (countTT < PILOT_MIN_LENGTH_TT * 8); i++) {
-            if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_CBM) {
-                /* cbm pilot is at least PILOT_MIN_LENGTH_CBM consecutive short pulses */
-                if (TAP_PULSE_SHORT(data[i])) {
-                    countCBM++;
+        if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_TT) {
+            /* TurboTape pilot is PILOT_MIN_LENGTH_TT or more repeats of the value 0x02.
+               Accept any long bit sequence of 1000000010000000100...
+               Trust that reading the header will fail if we detect a wrong
+               sequence (in that case we come back here) */
+            if ((countTT & 7) == 0) {
+                if (TAP_PULSE_TT_LONG(data)) {
+                    countTT++;
                 } else {
-                    startCBM = pos[i + 1];
-                    countCBM = 0;
+                    startTT = next_pos;
+                    countTT = 0;
                 }
-
-/*                  { startCBM+=countCBM+1; countCBM = 0; } */
-            }
-
-            if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_TT) {
-                /* TurboTape pilot is PILOT_MIN_LENGTH_TT or more repeats of the value 0x02.
-                   Accept any long bit sequence of 1000000010000000100...
-                   Trust that reading the header will fail if we detect a wrong
-                   sequence (in that case we come back here) */
-                if ((countTT & 7) == 0) {
-                    if (TAP_PULSE_TT_LONG(data[i])) {
-                        countTT++;
-                    } else {
-                        startTT = pos[i + 1];
-                        countTT = 0;
-                    }
 /*                      { startTT+=countTT+1; countTT = 0; } */
-                } else {
-                    if (TAP_PULSE_TT_SHORT(data[i])) {
-                        countTT++;
-                    } else if (TAP_PULSE_TT_LONG(data[i])) {
-                        startTT = pos[i];
-                        countTT = 1;
-                    }
+            } else {
+                if (TAP_PULSE_TT_SHORT(data)) {
+                    countTT++;
+                } else if (TAP_PULSE_TT_LONG(data)) {
+                    startTT = pos;
+                    countTT = 1;
+                }
 /*                      { startTT+=countTT; countTT = 1; } */
-                    else {
-                        startTT = pos[i + 1];
-                        countTT = 0;
-                    }
-/*                      { startTT+=countTT+1; countTT = 0; } */
+                else {
+                    startTT = next_pos;
+                    countTT = 0;
                 }
+/*                      { startTT+=countTT+1; countTT = 0; } */
             }
         }
     }
 
 #if TAP_DEBUG > 0
     if (countTT >= PILOT_MIN_LENGTH_TT * 8) {
-        log_debug(" found TT pilot(0x%X)", startTT + 2);
+        log_debug(" found TT pilot(0x%lX)", startTT + 2);
     } else {
-        log_debug(" found CBM pilot(0x%X)", startCBM);
+        log_debug(" found CBM pilot(0x%lX)", startCBM);
     }
 #endif
 
@@ -1254,10 +1327,10 @@ static int tap_find_pilot(tap_t *tap, int type)
         /* startTT points to a '1' bit which we assume to be part of the
            value 00000010.  Skip over the 1 and following 0 so we start
            at the beginning of a 00000010 sequence */
-        fseek(tap->fd, startTT + 2, SEEK_SET);
+        tap->data_pos = startTT + 2;
         return 1;
     } else {
-        fseek(tap->fd, startCBM, SEEK_SET);
+        tap->data_pos = startCBM;
         return 0;
     }
 }
@@ -1277,21 +1350,21 @@ static int tap_find_header(tap_t *tap)
         }
 
         /* store current position in TAP file */
-        fpos = ftell(tap->fd);
+        fpos = tap->data_pos;
 
         /* try to read a header */
         if (type == PILOT_TYPE_CBM) {
             res = tap_cbm_read_header(tap);
             if (res < 0) {
                 int pos_advance;
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 while (TAP_PULSE_SHORT(tap_get_pulse(tap, &pos_advance))) {
                 }
             }
         } else if (type == PILOT_TYPE_TT) {
             res = tap_tt_read_header(tap);
             if (res < 0) {
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 tap_tt_skip_pilot(tap);
             }
         } else {
@@ -1305,7 +1378,7 @@ static int tap_find_header(tap_t *tap)
             }
 
             /* success.  Rewind to start of header and return. */
-            fseek(tap->fd, fpos, SEEK_SET);
+            tap->data_pos = fpos;
             tap->current_file_seek_position = fpos;
             return type;
         }
@@ -1323,7 +1396,7 @@ static int tap_read_file(tap_t *tap)
 #endif
 
     /* store current position in TAP file */
-    fpos = ftell(tap->fd);
+    fpos = tap->data_pos;
 
     /* clear old file data */
     tap->current_file_size = 0;
@@ -1349,7 +1422,7 @@ static int tap_read_file(tap_t *tap)
     }
 
     /* go back to previous position in TAP file */
-    fseek(tap->fd, fpos, SEEK_SET);
+    tap->data_pos = fpos;
 
 #if TAP_DEBUG > 0
     log_debug("\nTAP_READ_FILE(END%i)\n", ret);
@@ -1407,6 +1480,7 @@ int tap_seek_start(tap_t *tap)
 
     tap->current_file_number = -1;
     tap->current_file_seek_position = 0;
+    tap->data_pos = tap->offset;
     fseek(tap->fd, tap->offset, SEEK_SET);
     return 0;
 }
@@ -1423,17 +1497,27 @@ int tap_seek_to_file(tap_t *tap, unsigned int file_number)
     return 0;
 }
 
-int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
+/* Find the header of the next file, using the index when the parser is
+   still where the previous file from the index was found.  */
+static int tap_find_next_header(tap_t *tap)
 {
-    if (tap == NULL) {
+    tap_index_t *index = tap->index;
+    int next = tap->current_file_number + 1;
+    int indexed;
+
+    indexed = (next <= index->count)
+              && (tap->data_pos == (next ? index->pos[next - 1] : tap->offset));
+
+    if (indexed && next < index->count) {
+        tap->data_pos = index->pos[next];
+        tap->current_file_seek_position = (int)index->pos[next];
+        *tap->tap_file_record = index->records[next];
+        return 0;
+    }
+    if (indexed && index->complete) {
         return -1;
     }
 
-    /* clear old file content buffer */
-    tap->current_file_size = 0;
-    lib_free(tap->current_file_data);
-    tap->current_file_data = NULL;
-
     /* skip over current and find NEXT pilot
        (only if not at beginning of tape) */
     if (tap->current_file_number >= 0) {
@@ -1441,9 +1525,35 @@ int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
     }
 
     if (tap_find_header(tap) < 0) {
+        if (indexed) {
+            index->complete = 1;
+        }
+        return -1;
+    }
+
+    if (indexed) {
+        tap_index_add(index, tap->data_pos, tap->tap_file_record);
+    }
+    return 0;
+}
+
+int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
+{
+    if (tap == NULL) {
+        return -1;
+    }
+
+    tap_data_load(tap);
+
+    /* clear old file content buffer */
+    tap->current_file_size = 0;
+    lib_free(tap->current_file_data);
+    tap->current_file_data = NULL;
+
+    if (tap_find_next_header(tap) < 0) {
         if (allow_rewind) {
             tap_seek_start(tap);
-            if (tap_find_header(tap) < 0) {
+            if (tap_find_next_header(tap) < 0) {
                 return -1;
             }
         } else {
@@ -1469,6 +1579,7 @@ int tap_read(tap_t *tap, uint8_t *buf, size_t size)
                 }
             }
 
+            tap_data_load(tap);
             if (tap_read_file(tap) < 0) {
                 return -1; /* reading the file failed */
             } else {
@@ -1507,3 +1618,19 @@ void tap_init(const tape_init_t *init)
     tap_pulse_long_min = init->pulse_long_min / 8;
     tap_pulse_long_max = init->pulse_long_max / 8;
 }
+
+void tap_shutdown(void)
+{
+    tap_index_t **prev, *index;
+
+    /* indexes still used by open images are left alone */
+    prev = &tap_index_list;
+    while ((index = *prev) != NULL) {
+        if (index->refs == 0) {
+            *prev = index->next;
+            tap_index_free(index);
+        } else {
+            prev = &index->next;
+        }
+    }
+}
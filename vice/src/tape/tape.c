@@ -171,6 +171,7 @@ int tape_reinit(const tape_init_t *init)
 
 void tape_shutdown(void)
 {
+    tap_shutdown();
     lib_free(tape_image_dev1);
 }
 
@@ -83,6 +83,7 @@ static sound_chip_t userport_dac_sound_chip = {
     userport_dac_sound_machine_init,              /* sound chip init function */
     NULL,                                         /* NO sound chip close function */
     userport_dac_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                         /* NO sound chip skip samples function */
     userport_dac_sound_machine_store,             /* sound chip store function */
     userport_dac_sound_machine_read,              /* sound chip read function */
     userport_dac_sound_reset,                     /* sound chip reset function */
@@ -43,6 +43,7 @@
 #include "cbmdos.h"
 #include "diskconstants.h"
 #include "diskimage.h"
+#include "lib.h"
 #include "log.h"
 #include "types.h"
 #include "vdrive-bam.h"
@@ -79,6 +80,179 @@ static int vdrive_calculate_disk_half(vdrive_t *vdrive)
     return -1;
 }
 
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Free sector map.
+ *
+ * Looking for a free sector probes the BAM sector by sector, which becomes
+ * slow on nearly full images with many sectors per track.  The map holds the
+ * free sectors of each track as 32 bit words (in logical sector order, with
+ * the bit swapping of the 4000 BAM undone) plus the number of free sectors
+ * per track, so full tracks are skipped and free sectors are found a word at
+ * a time.  It is built from the BAM on demand and kept in sync by
+ * vdrive_bam_allocate_sector() and vdrive_bam_free_sector(); anything that
+ * replaces the BAM contents drops it.
+ */
+
+typedef struct vdrive_bam_map_s {
+    unsigned int tracks;    /* Number of tracks in the map */
+    unsigned int words;     /* Words per track */
+    uint32_t *free;         /* Free sector bits, `words' per track */
+    unsigned int *count;    /* Free sectors per track, indexed by track */
+} vdrive_bam_map_t;
+
+static unsigned int vdrive_bam_popcount(uint32_t w)
+{
+    w = w - ((w >> 1) & 0x55555555);
+    w = (w & 0x33333333) + ((w >> 2) & 0x33333333);
+    return (((w + (w >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+}
+
+/* Index of the lowest set bit, `w' must not be 0 */
+static unsigned int vdrive_bam_lowest_bit(uint32_t w)
+{
+    static const uint8_t debruijn[32] = {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+
+    return debruijn[((w & (~w + 1)) * 0x077cb531U) >> 27];
+}
+
+void vdrive_bam_map_free(vdrive_t *vdrive)
+{
+    vdrive_bam_map_t *map = vdrive->bam_map;
+
+    if (map != NULL) {
+        lib_free(map->free);
+        lib_free(map->count);
+        lib_free(map);
+        vdrive->bam_map = NULL;
+    }
+}
+
+static vdrive_bam_map_t *vdrive_bam_map_get(vdrive_t *vdrive)
+{
+    vdrive_bam_map_t *map = vdrive->bam_map;
+    uint8_t *bamp;
+    uint32_t *w;
+    unsigned int t, s, i;
+    int max_sector;
+
+    if (map != NULL) {
+        return map;
+    }
+
+    map = lib_calloc(1, sizeof(vdrive_bam_map_t));
+    map->tracks = vdrive->num_tracks;
+    map->words = 1;
+    for (t = 1; t <= map->tracks; t++) {
+        max_sector = vdrive_get_max_sectors(vdrive, t);
+        if (max_sector > (int)map->words * 32) {
+            map->words = ((unsigned int)max_sector + 31) / 32;
+        }
+    }
+    map->free = lib_calloc(map->tracks * map->words + 1, sizeof(uint32_t));
+    map->count = lib_calloc(map->tracks + 1, sizeof(unsigned int));
+
+    for (t = 1; t <= map->tracks; t++) {
+        /* Tracks > 70 don't go into the (regular) BAM on 1571 */
+        if ((t > NUM_TRACKS_1571) && (vdrive->image_format == VDRIVE_IMAGE_FORMAT_1571)) {
+            continue;
+        }
+        bamp = vdrive_bam_get_track_entry(vdrive, t);
+        if (bamp == NULL) {
+            continue;
+        }
+        w = map->free + (t - 1) * map->words;
+        max_sector = vdrive_get_max_sectors(vdrive, t);
+        for (s = 0; (int)s < max_sector; s++) {
+            i = (vdrive->image_format == VDRIVE_IMAGE_FORMAT_4000) ? s ^ 7 : s;
+            if (vdrive_bam_isset(bamp, i)) {
+                w[s / 32] |= 1U << (s % 32);
+            }
+        }
+        for (i = 0; i < map->words; i++) {
+            map->count[t] += vdrive_bam_popcount(w[i]);
+        }
+    }
+
+    vdrive->bam_map = map;
+    return map;
+}
+
+/* `sector' is the BAM bit number, as used by vdrive_bam_isset() */
+static void vdrive_bam_map_update(vdrive_t *vdrive, unsigned int track,
+                                  unsigned int sector, int is_free)
+{
+    vdrive_bam_map_t *map = vdrive->bam_map;
+    uint32_t *w, bit;
+
+    if (vdrive->image_format == VDRIVE_IMAGE_FORMAT_4000) {
+        sector ^= 7;
+    }
+
+    if (map == NULL || track < 1 || track > map->tracks
+        || sector >= map->words * 32) {
+        return;
+    }
+
+    w = map->free + (track - 1) * map->words + sector / 32;
+    bit = 1U << (sector % 32);
+    if (is_free && !(*w & bit)) {
+        *w |= bit;
+        map->count[track]++;
+    } else if (!is_free && (*w & bit)) {
+        *w &= ~bit;
+        map->count[track]--;
+    }
+}
+
+/* Returns the first free sector `from' <= s < `to' on `track', or -1 */
+static int vdrive_bam_find_free(vdrive_t *vdrive, unsigned int track,
+                                unsigned int from, unsigned int to)
+{
+    vdrive_bam_map_t *map = vdrive_bam_map_get(vdrive);
+    uint32_t *w, bits;
+    unsigned int s;
+
+    if (track < 1 || track > map->tracks || map->count[track] == 0) {
+        return -1;
+    }
+    if (to > map->words * 32) {
+        to = map->words * 32;
+    }
+
+    w = map->free + (track - 1) * map->words;
+    while (from < to) {
+        bits = w[from / 32] & (0xffffffffU << (from % 32));
+        if (bits) {
+            s = (from & ~31U) + vdrive_bam_lowest_bit(bits);
+            return (s < to) ? (int)s : -1;
+        }
+        from = (from & ~31U) + 32;
+    }
+    return -1;
+}
+
+/* Allocate the first free sector `from' <= s < `to' on `track' */
+static int vdrive_bam_alloc_in_range(vdrive_t *vdrive, unsigned int track,
+                                     unsigned int from, unsigned int to,
+                                     unsigned int *sector)
+{
+    int s;
+
+    while ((s = vdrive_bam_find_free(vdrive, track, from, to)) >= 0) {
+        if (vdrive_bam_allocate_sector(vdrive, track, (unsigned int)s)) {
+            *sector = (unsigned int)s;
+            return 0;
+        }
+        from = (unsigned int)s + 1;
+    }
+    return -1;
+}
+
 /*
     FIXME: partition support
 */
@@ -99,16 +273,14 @@ int vdrive_bam_alloc_first_free_sector(vdrive_t *vdrive,
 #endif
         if (d && t >= 1) {
             max_sector = vdrive_get_max_sectors(vdrive, t);
-            for (s = 0; s < (unsigned int)max_sector; s++) {
-                if (vdrive_bam_allocate_sector(vdrive, t, s)) {
-                    *track = t;
-                    *sector = s;
+            if (vdrive_bam_alloc_in_range(vdrive, t, 0, max_sector, &s) == 0) {
+                *track = t;
+                *sector = s;
 #ifdef DEBUG_DRIVE
-                    log_message(LOG_DEFAULT,
-                              "Allocate first free sector: %d,%u.", t, s);
+                log_message(LOG_DEFAULT,
+                          "Allocate first free sector: %d,%u.", t, s);
 #endif
-                    return 0;
-                }
+                return 0;
             }
         }
         t = vdrive->Dir_Track + d;
@@ -124,16 +296,14 @@ int vdrive_bam_alloc_first_free_sector(vdrive_t *vdrive,
             } else {
                 s = max_sector; /* skip bam track */
             }
-            for (; s < (unsigned int)max_sector; s++) {
-                if (vdrive_bam_allocate_sector(vdrive, t, s)) {
-                    *track = t;
-                    *sector = s;
+            if (vdrive_bam_alloc_in_range(vdrive, t, s, max_sector, &s) == 0) {
+                *track = t;
+                *sector = s;
 #ifdef DEBUG_DRIVE
-                    log_message(LOG_DEFAULT,
-                              "Allocate first free sector: %d,%u.", t, s);
+                log_message(LOG_DEFAULT,
+                          "Allocate first free sector: %d,%u.", t, s);
 #endif
-                    return 0;
-                }
+                return 0;
             }
         }
     }
@@ -147,12 +317,10 @@ static int vdrive_bam_alloc_down(vdrive_t *vdrive,
 
     for (t = *track; t >= 1; t--) {
         max_sector = vdrive_get_max_sectors(vdrive, t);
-        for (s = 0; s < max_sector; s++) {
-            if (vdrive_bam_allocate_sector(vdrive, t, s)) {
-                *track = t;
-                *sector = s;
-                return 0;
-            }
+        if (vdrive_bam_alloc_in_range(vdrive, t, 0, max_sector, &s) == 0) {
+            *track = t;
+            *sector = s;
+            return 0;
         }
     }
     return -1;
@@ -165,12 +333,10 @@ static int vdrive_bam_alloc_up(vdrive_t *vdrive,
 
     for (t = *track; t <= vdrive->num_tracks; t++) {
         max_sector = vdrive_get_max_sectors(vdrive, t);
-        for (s = 0; s < max_sector; s++) {
-            if (vdrive_bam_allocate_sector(vdrive, t, s)) {
-                *track = t;
-                *sector = s;
-                return 0;
-            }
+        if (vdrive_bam_alloc_in_range(vdrive, t, 0, max_sector, &s) == 0) {
+            *track = t;
+            *sector = s;
+            return 0;
         }
     }
     return -1;
@@ -183,7 +349,7 @@ int vdrive_bam_alloc_next_free_sector(vdrive_t *vdrive,
                                       unsigned int *track,
                                       unsigned int *sector)
 {
-    unsigned int max_sector, i, t, s;
+    unsigned int max_sector, first, t, s;
 
     if (*track == vdrive->Bam_Track) {
         if (vdrive->image_format != VDRIVE_IMAGE_FORMAT_4000 || *sector < 64) {
@@ -201,20 +367,19 @@ int vdrive_bam_alloc_next_free_sector(vdrive_t *vdrive,
             s--;
         }
     }
-    /* Look for a sector on the same track */
-    for (i = 0; i < max_sector; i++) {
-        if (vdrive->image_format == VDRIVE_IMAGE_FORMAT_4000 && *track == vdrive->Bam_Track && s < 64) {
-            s = 64;
-        }
-        if (vdrive_bam_allocate_sector(vdrive, t, s)) {
-            *track = t;
-            *sector = s;
-            return 0;
-        }
-        s++;
-        if (s >= max_sector) {
-            s = 0;
-        }
+    /* Look for a sector on the same track, from s up and then wrapping
+       around to the start of the track */
+    first = 0;
+    if (vdrive->image_format == VDRIVE_IMAGE_FORMAT_4000 && *track == vdrive->Bam_Track) {
+        first = 64;
+    }
+    if (s < first || s >= max_sector) {
+        s = first;
+    }
+    if (vdrive_bam_alloc_in_range(vdrive, t, s, max_sector, sector) == 0
+        || vdrive_bam_alloc_in_range(vdrive, t, first, s, sector) == 0) {
+        *track = t;
+        return 0;
     }
     if (vdrive->image_format == VDRIVE_IMAGE_FORMAT_4000 && *track == vdrive->Bam_Track) {
         (*track)++;
@@ -416,6 +581,7 @@ int vdrive_bam_allocate_sector(vdrive_t *vdrive,
     if (vdrive_bam_isset(bamp, sector)) {
         vdrive_bam_sector_free(vdrive, bamp, track, -1);
         vdrive_bam_clr(bamp, sector);
+        vdrive_bam_map_update(vdrive, track, sector, 0);
         return 1;
     }
     return 0;
@@ -438,6 +604,7 @@ int vdrive_bam_free_sector(vdrive_t *vdrive, unsigned int track,
     if (!(vdrive_bam_isset(bamp, sector))) {
         vdrive_bam_set(bamp, sector);
         vdrive_bam_sector_free(vdrive, bamp, track, 1);
+        vdrive_bam_map_update(vdrive, track, sector, 1);
         return 1;
     }
     return 0;
@@ -447,6 +614,8 @@ void vdrive_bam_clear_all(vdrive_t *vdrive)
 {
     uint8_t *bam = vdrive->bam;
 
+    vdrive_bam_map_free(vdrive);
+
     switch (vdrive->image_format) {
         case VDRIVE_IMAGE_FORMAT_1541:
             memset(bam + BAM_EXT_BIT_MAP_1541, 0, 4 * 5);
@@ -504,6 +673,7 @@ static uint8_t *mystrncpy(uint8_t *d, const uint8_t *s, size_t n)
 void vdrive_bam_create_empty_bam(vdrive_t *vdrive, const char *name, uint8_t *id)
 {
     /* Create Disk Format for 1541/1571/1581/2040/4000 disks.  */
+    vdrive_bam_map_free(vdrive);
     memset(vdrive->bam, 0, vdrive->bam_size);
     if (vdrive->image_format != VDRIVE_IMAGE_FORMAT_8050
         && vdrive->image_format != VDRIVE_IMAGE_FORMAT_8250) {
@@ -699,6 +869,11 @@ int vdrive_bam_read_bam(vdrive_t *vdrive)
 {
     int err = -1, i;
 
+    /* The image may have been changed behind our back, so the cached
+       directory has to go as well.  */
+    vdrive_bam_map_free(vdrive);
+    vdrive_dir_index_free(vdrive);
+
     switch (vdrive->image_format) {
         case VDRIVE_IMAGE_FORMAT_2040:
         case VDRIVE_IMAGE_FORMAT_1541:
@@ -831,6 +1006,7 @@ unsigned int vdrive_bam_free_block_count(vdrive_t *vdrive)
     unsigned int blocks;
     unsigned int i;
     unsigned int j; /* FIXME: j looks a lot like i or l */
+    vdrive_bam_map_t *map;
 
     for (blocks = 0, i = 1; i <= vdrive->num_tracks; i++) {
         switch (vdrive->image_format) {
@@ -877,8 +1053,12 @@ unsigned int vdrive_bam_free_block_count(vdrive_t *vdrive)
                 }
                 break;
             case VDRIVE_IMAGE_FORMAT_4000:
-                for (j = ((i == vdrive->Bam_Track) ? 64 : 0); j < 256; j++) {
-                    blocks += (vdrive->bam[BAM_BIT_MAP_4000 + 256 + 32 * (i - 1) + j / 8] >> (j % 8)) & 1;
+                map = vdrive_bam_map_get(vdrive);
+                blocks += map->count[i];
+                if (i == vdrive->Bam_Track) {
+                    /* sectors 0-63 hold the BAM and root directory */
+                    blocks -= vdrive_bam_popcount(map->free[(i - 1) * map->words])
+                              + vdrive_bam_popcount(map->free[(i - 1) * map->words + 1]);
                 }
                 break;
             default:
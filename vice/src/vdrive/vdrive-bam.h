@@ -70,6 +70,8 @@ extern int vdrive_bam_reread_bam(unsigned int unit, unsigned int drive);
 extern int vdrive_bam_write_bam(struct vdrive_s *vdrive);
 extern int vdrive_bam_get_interleave(unsigned int type);
 
+extern void vdrive_bam_map_free(struct vdrive_s *vdrive);
+
 extern int vdrive_bam_isset(uint8_t *bamp, unsigned int sector);
 extern uint8_t *vdrive_bam_get_track_entry(struct vdrive_s *vdrive, unsigned int track);
 
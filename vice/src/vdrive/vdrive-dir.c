@@ -102,6 +102,366 @@ static unsigned int vdrive_dir_name_match(uint8_t *slot, uint8_t *nslot, int len
     return cbmdos_parse_wildcard_compare(nslot, &slot[SLOT_NAME_OFFSET]);
 }
 
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Directory index.
+ *
+ * Looking up a file means walking the whole directory chain and comparing
+ * every slot, which gets slow on D81/D1M/D2M/D4M images holding thousands of
+ * files.  The index keeps a copy of each sector of the current directory
+ * chain together with the numbers of all used slots (sector * 8 + slot)
+ * ordered by name, so that the literal part of a pattern (everything up to
+ * the first wildcard) can be looked up by binary search.
+ *
+ * The index is built on the first lookup after the BAM has been read and is
+ * kept in sync by vdrive_write_sector().  Writes to the image from outside
+ * the vdrive are covered the same way as for the BAM: whoever does them has
+ * to re-read the BAM, which drops the index.
+ */
+
+typedef struct vdrive_dir_index_s {
+    unsigned int dir_track;     /* First directory sector of the chain */
+    unsigned int dir_sector;
+    int usable;                 /* 0 if the chain could not be followed */
+    unsigned int sectors;       /* Number of sectors in the chain */
+    unsigned int allocated;
+    unsigned int *location;     /* (track << 8) | sector of each sector */
+    uint8_t *data;              /* Contents of each sector */
+    unsigned int used;          /* Number of entries in sorted[] */
+    unsigned int *sorted;       /* Used slots, ordered by name */
+    uint8_t map[0x10000 / 8];   /* Track/sector pairs in the chain */
+} vdrive_dir_index_t;
+
+#define DIR_INDEX_MAP(t, s) (((t) << 8) | (s))
+
+static uint8_t *vdrive_dir_index_slot(const vdrive_dir_index_t *index,
+                                      unsigned int n)
+{
+    return index->data + (n >> 3) * 256 + (n & 7) * 32;
+}
+
+/* Find where slot `n' is, or would be, in sorted[] */
+static unsigned int vdrive_dir_index_lower_bound(const vdrive_dir_index_t *index,
+                                                 unsigned int n)
+{
+    const uint8_t *name = vdrive_dir_index_slot(index, n) + SLOT_NAME_OFFSET;
+    unsigned int lo = 0, hi = index->used, mid;
+    int c;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        c = memcmp(vdrive_dir_index_slot(index, index->sorted[mid])
+                   + SLOT_NAME_OFFSET, name, CBMDOS_SLOT_NAME_LENGTH);
+        if (c < 0 || (c == 0 && index->sorted[mid] < n)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void vdrive_dir_index_set_slot(vdrive_dir_index_t *index,
+                                      unsigned int n, const uint8_t *slot)
+{
+    uint8_t *p = vdrive_dir_index_slot(index, n);
+    unsigned int i;
+
+    if (p[SLOT_TYPE_OFFSET] && slot[SLOT_TYPE_OFFSET]
+        && !memcmp(p + SLOT_NAME_OFFSET, slot + SLOT_NAME_OFFSET,
+                   CBMDOS_SLOT_NAME_LENGTH)) {
+        memcpy(p, slot, 32);
+        return;
+    }
+
+    if (p[SLOT_TYPE_OFFSET]) {
+        i = vdrive_dir_index_lower_bound(index, n);
+        index->used--;
+        memmove(&index->sorted[i], &index->sorted[i + 1],
+                (index->used - i) * sizeof(unsigned int));
+    }
+
+    memcpy(p, slot, 32);
+
+    if (p[SLOT_TYPE_OFFSET]) {
+        i = vdrive_dir_index_lower_bound(index, n);
+        memmove(&index->sorted[i + 1], &index->sorted[i],
+                (index->used - i) * sizeof(unsigned int));
+        index->sorted[i] = n;
+        index->used++;
+    }
+}
+
+static void vdrive_dir_index_append(vdrive_dir_index_t *index,
+                                    unsigned int track, unsigned int sector,
+                                    const uint8_t *buf)
+{
+    unsigned int n, i;
+
+    if (index->sectors == index->allocated) {
+        index->allocated = index->allocated ? index->allocated * 2 : 16;
+        index->location = lib_realloc(index->location,
+                                      index->allocated * sizeof(unsigned int));
+        index->data = lib_realloc(index->data, index->allocated * 256);
+        index->sorted = lib_realloc(index->sorted,
+                                    index->allocated * 8 * sizeof(unsigned int));
+    }
+
+    n = index->sectors++;
+    index->location[n] = DIR_INDEX_MAP(track, sector);
+    index->map[DIR_INDEX_MAP(track, sector) >> 3] |= 1 << (sector & 7);
+    memset(index->data + n * 256, 0, 256);
+
+    for (i = 0; i < 8; i++) {
+        vdrive_dir_index_set_slot(index, n * 8 + i, buf + i * 32);
+    }
+}
+
+/* Drop all sectors from `count' on */
+static void vdrive_dir_index_truncate(vdrive_dir_index_t *index,
+                                      unsigned int count)
+{
+    static const uint8_t empty[32];
+    unsigned int n, i;
+
+    while (index->sectors > count) {
+        n = --index->sectors;
+        index->map[index->location[n] >> 3] &= ~(1 << (index->location[n] & 7));
+        for (i = 0; i < 8; i++) {
+            vdrive_dir_index_set_slot(index, n * 8 + i, empty);
+        }
+    }
+}
+
+/* Follow the chain from the last sector in the index */
+static void vdrive_dir_index_extend(vdrive_t *vdrive, vdrive_dir_index_t *index)
+{
+    uint8_t buffer[256];
+    unsigned int track, sector;
+
+    track = index->data[(index->sectors - 1) * 256];
+    sector = index->data[(index->sectors - 1) * 256 + 1];
+
+    while (track != 0) {
+        /* Circular chains would make the plain walk loop as well */
+        if ((index->map[DIR_INDEX_MAP(track, sector) >> 3] & (1 << (sector & 7)))
+            || vdrive_read_sector(vdrive, buffer, track, sector) != 0) {
+            index->usable = 0;
+            return;
+        }
+        vdrive_dir_index_append(index, track, sector, buffer);
+        track = buffer[0];
+        sector = buffer[1];
+    }
+}
+
+static vdrive_dir_index_t *vdrive_dir_index_get(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+    uint8_t buffer[256];
+
+    /* Entering a subdirectory or partition moves the chain */
+    if (index != NULL && (index->dir_track != vdrive->Dir_Track
+                          || index->dir_sector != vdrive->Dir_Sector)) {
+        vdrive_dir_index_free(vdrive);
+        index = NULL;
+    }
+
+    if (index == NULL) {
+        index = lib_calloc(1, sizeof(vdrive_dir_index_t));
+        index->dir_track = vdrive->Dir_Track;
+        index->dir_sector = vdrive->Dir_Sector;
+        vdrive->dir_index = index;
+
+        if (vdrive->Dir_Track > 255 || vdrive->Dir_Sector > 255
+            || vdrive_read_sector(vdrive, buffer, vdrive->Dir_Track,
+                                  vdrive->Dir_Sector) != 0) {
+            return NULL;
+        }
+        index->usable = 1;
+        vdrive_dir_index_append(index, vdrive->Dir_Track, vdrive->Dir_Sector,
+                                buffer);
+        vdrive_dir_index_extend(vdrive, index);
+    }
+
+    return index->usable ? index : NULL;
+}
+
+void vdrive_dir_index_free(vdrive_t *vdrive)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+
+    if (index != NULL) {
+        lib_free(index->location);
+        lib_free(index->data);
+        lib_free(index->sorted);
+        lib_free(index);
+        vdrive->dir_index = NULL;
+    }
+}
+
+/*
+ * Called for every sector written by the vdrive.
+ */
+void vdrive_dir_index_update(vdrive_t *vdrive, const uint8_t *buf,
+                             unsigned int track, unsigned int sector)
+{
+    vdrive_dir_index_t *index = vdrive->dir_index;
+    unsigned int n, i;
+    int relink;
+
+    if (index == NULL) {
+        return;
+    }
+
+    if (track > 255 || sector > 255
+        || !(index->map[DIR_INDEX_MAP(track, sector) >> 3] & (1 << (sector & 7)))) {
+        /* This might be the sector the chain could not be followed to */
+        if (!index->usable) {
+            vdrive_dir_index_free(vdrive);
+        }
+        return;
+    }
+
+    for (n = 0; index->location[n] != DIR_INDEX_MAP(track, sector); n++) {
+    }
+
+    relink = index->data[n * 256] != buf[0]
+             || (buf[0] != 0 && index->data[n * 256 + 1] != buf[1]);
+
+    for (i = 0; i < 8; i++) {
+        vdrive_dir_index_set_slot(index, n * 8 + i, buf + i * 32);
+    }
+
+    if (relink) {
+        vdrive_dir_index_truncate(index, n + 1);
+        index->usable = 1;
+        vdrive_dir_index_extend(vdrive, index);
+    }
+}
+
+/* Returns the first slot after `current' matching the search of `dir', or
+   -1 if there is none */
+static int vdrive_dir_index_search(const vdrive_dir_index_t *index,
+                                   vdrive_dir_context_t *dir, int current)
+{
+    unsigned int length = 0, lo, hi, mid, i;
+    int n, best = -1;
+
+    /* Names matching the pattern all start with its literal part */
+    if (dir->find_length > 0) {
+        while (length < CBMDOS_SLOT_NAME_LENGTH
+               && dir->find_nslot[length] != '*'
+               && dir->find_nslot[length] != '?') {
+            if (dir->find_nslot[length++] == 0xa0) {
+                break;
+            }
+        }
+    }
+
+    if (length == 0) {
+        for (n = current + 1; n < (int)index->sectors * 8; n++) {
+            if (vdrive_dir_name_match(vdrive_dir_index_slot(index, n),
+                                      dir->find_nslot, dir->find_length,
+                                      dir->find_type)) {
+                return n;
+            }
+        }
+        return -1;
+    }
+
+    lo = 0;
+    hi = index->used;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (memcmp(vdrive_dir_index_slot(index, index->sorted[mid])
+                   + SLOT_NAME_OFFSET, dir->find_nslot, length) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (i = lo; i < index->used; i++) {
+        uint8_t *slot = vdrive_dir_index_slot(index, index->sorted[i]);
+
+        if (memcmp(slot + SLOT_NAME_OFFSET, dir->find_nslot, length) != 0) {
+            break;
+        }
+        n = (int)index->sorted[i];
+        if (n > current && (best < 0 || n < best)
+            && vdrive_dir_name_match(slot, dir->find_nslot, dir->find_length,
+                                     dir->find_type)) {
+            best = n;
+        }
+    }
+    return best;
+}
+
+/*
+ * Move `dir' to the next matching slot using the index.  Returns 1 if a slot
+ * was found, 0 at the end of the directory (`dir' is then left on the last
+ * sector, just like the plain walk does), -1 if the index cannot be used and
+ * -2 on read errors.
+ */
+static int vdrive_dir_index_next(vdrive_dir_context_t *dir)
+{
+    vdrive_t *vdrive = dir->vdrive;
+    vdrive_dir_index_t *index;
+    unsigned int i, slot;
+    int current, n;
+
+    while ((index = vdrive_dir_index_get(vdrive)) != NULL) {
+        if (dir->track == vdrive->Header_Track
+            && dir->sector == vdrive->Header_Sector && dir->slot == 7) {
+            current = -1;
+        } else {
+            for (i = 0; i < index->sectors; i++) {
+                if (index->location[i] == DIR_INDEX_MAP(dir->track, dir->sector)) {
+                    break;
+                }
+            }
+            if (i == index->sectors) {
+                return -1;
+            }
+            current = (int)(i * 8 + (dir->slot < 8 ? dir->slot : 7));
+        }
+
+        n = vdrive_dir_index_search(index, dir, current);
+        if (n < 0) {
+            i = index->sectors - 1;
+            slot = 8;
+        } else {
+            i = (unsigned int)n / 8;
+            slot = (unsigned int)n & 7;
+        }
+
+        if (index->location[i] != DIR_INDEX_MAP(dir->track, dir->sector)
+            || current < 0) {
+            dir->track = index->location[i] >> 8;
+            dir->sector = index->location[i] & 0xff;
+            if (vdrive_read_sector(vdrive, dir->buffer, dir->track, dir->sector) != 0) {
+                return -2;
+            }
+        }
+        dir->slot = slot;
+
+        if (n < 0) {
+            return 0;
+        }
+        if (vdrive_dir_name_match(&dir->buffer[slot * 32], dir->find_nslot,
+                                  dir->find_length, dir->find_type)) {
+            return 1;
+        }
+
+        /* The sector changed behind our back, resync it and try again */
+        vdrive_dir_index_update(vdrive, dir->buffer, dir->track, dir->sector);
+    }
+
+    return -1;
+}
+
 void vdrive_dir_free_chain(vdrive_t *vdrive, int t, int s)
 {
     uint8_t buf[256];
@@ -236,16 +596,28 @@ uint8_t *vdrive_dir_find_next_slot(vdrive_dir_context_t *dir)
 {
     static uint8_t return_slot[32];
     vdrive_t *vdrive = dir->vdrive;
+    int rc;
 
 #ifdef DEBUG_DRIVE
     log_debug("DIR: vdrive_dir_find_next_slot start (t:%u/s:%u) #%u",
             dir->track, dir->sector, dir->slot);
 #endif
+
+    rc = vdrive_dir_index_next(dir);
+    if (rc < -1) {
+        return NULL; /* error */
+    }
+    if (rc > 0) {
+        memcpy(return_slot, &dir->buffer[dir->slot * 32], 32);
+        return return_slot;
+    }
+
     /*
-     * Loop all directory blocks starting from track 18, sector 1 (1541).
+     * Without an index loop all directory blocks starting from track 18,
+     * sector 1 (1541).
      */
 
-    do {
+    while (rc < 0) {
         /*
          * Load next(first) directory block ?
          */
@@ -275,7 +647,7 @@ uint8_t *vdrive_dir_find_next_slot(vdrive_dir_context_t *dir)
             memcpy(return_slot, &dir->buffer[dir->slot * 32], 32);
             return return_slot;
         }
-    } while (1);
+    }
 
 #ifdef DEBUG_DRIVE
     log_debug("DIR: vdrive_dir_find_next_slot (t:%u/s:%u) #%u",
@@ -76,5 +76,7 @@ extern int vdrive_dir_filetype(const char *name, int length);
 extern void vdrive_dir_remove_slot(vdrive_dir_context_t *dir);
 extern void vdrive_dir_create_slot(struct bufferinfo_s *p, char *realname, int reallength, int filetype);
 extern void vdrive_dir_free_chain(struct vdrive_s *vdrive, int t, int s);
+extern void vdrive_dir_index_update(struct vdrive_s *vdrive, const uint8_t *buf, unsigned int track, unsigned int sector);
+extern void vdrive_dir_index_free(struct vdrive_s *vdrive);
 
 #endif
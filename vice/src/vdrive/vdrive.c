@@ -153,6 +153,8 @@ void vdrive_device_shutdown(vdrive_t *vdrive)
             vdrive_free_buffer(p);
             lib_free(p->buffer);
         }
+        vdrive_dir_index_free(vdrive);
+        vdrive_bam_map_free(vdrive);
     }
 }
 
@@ -226,6 +228,8 @@ void vdrive_detach_image(disk_image_t *image, unsigned int unit,
 
     disk_image_detach_log(image, vdrive_log, unit, drive);
     vdrive_close_all_channels(vdrive);
+    vdrive_dir_index_free(vdrive);
+    vdrive_bam_map_free(vdrive);
     lib_free(vdrive->bam);
     vdrive->bam = NULL;
     vdrive->image = NULL;
@@ -446,7 +450,13 @@ int vdrive_read_sector(vdrive_t *vdrive, uint8_t *buf, unsigned int track, unsig
 int vdrive_write_sector(vdrive_t *vdrive, const uint8_t *buf, unsigned int track, unsigned int sector)
 {
     disk_addr_t dadr;
+    int rc;
+
     dadr.track = track;
     dadr.sector = sector;
-    return disk_image_write_sector(vdrive->image, buf, &dadr);
+    rc = disk_image_write_sector(vdrive->image, buf, &dadr);
+    if (rc == 0) {
+        vdrive_dir_index_update(vdrive, buf, track, sector);
+    }
+    return rc;
 }
@@ -110,6 +110,8 @@ typedef struct bufferinfo_s {
 } bufferinfo_t;
 
 struct disk_image_s;
+struct vdrive_bam_map_s;
+struct vdrive_dir_index_s;
 
 /* Run-time data struct for each drive. */
 typedef struct vdrive_s {
@@ -136,8 +138,12 @@ typedef struct vdrive_s {
 
     unsigned int bam_size;
     uint8_t *bam;
+    struct vdrive_bam_map_s *bam_map; /* Free sectors, see vdrive-bam.c */
     bufferinfo_t buffers[16];
 
+    /* In-memory copy of the current directory, see vdrive-dir.c.  */
+    struct vdrive_dir_index_s *dir_index;
+
     /* Memory read command buffer.  */
     uint8_t mem_buf[256];
     unsigned int mem_length;
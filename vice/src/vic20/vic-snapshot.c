@@ -78,7 +78,7 @@ int vic_snapshot_write_module(snapshot_t *s)
         || SMW_DW(m, (uint32_t)vic.light_pen.x) < 0
         || SMW_DW(m, (uint32_t)vic.light_pen.y) < 0
         || SMW_DW(m, (uint32_t)vic.light_pen.x_extra_bits) < 0
-        || SMW_DW(m, (uint32_t)vic.light_pen.trigger_cycle) < 0
+        || SMW_CLOCK(m, vic.light_pen.trigger_cycle) < 0
         || (SMW_B(m, vic.vbuf) < 0)) {
         goto fail;
     }
@@ -171,7 +171,7 @@ int vic_snapshot_read_module(snapshot_t *s)
         || SMR_DW_INT(m, &vic.light_pen.x) < 0
         || SMR_DW_INT(m, &vic.light_pen.y) < 0
         || SMR_DW_INT(m, &vic.light_pen.x_extra_bits) < 0
-        || SMR_DW(m, &vic.light_pen.trigger_cycle) < 0
+        || SMR_CLOCK(m, &vic.light_pen.trigger_cycle) < 0
         || (SMR_B(m, &vic.vbuf) < 0)) {
         goto fail;
     }
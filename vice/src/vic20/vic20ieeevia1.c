@@ -161,7 +161,7 @@ static uint8_t read_prb(via_context_t *via_context)
 void ieeevia1_init(via_context_t *via_context)
 {
     viacore_init(machine_context.ieeevia1, maincpu_alarm_context,
-                 maincpu_int_status, maincpu_clk_guard);
+                 maincpu_int_status);
 }
 
 void vic20ieeevia1_setup_context(machine_context_t *machinecontext)
@@ -66,6 +66,7 @@ static sound_chip_t vic_sound_chip = {
     vic_sound_machine_init,              /* sound chip init function */
     NULL,                                /* NO sound chip close function */
     vic_sound_machine_calculate_samples, /* sound chip calculate samples function */
+    NULL,                                /* NO sound chip skip samples function */
     vic_sound_machine_store,             /* sound chip store function */
     NULL,                                /* NO sound chip read function */
     vic_sound_reset,                     /* sound chip reset function */
@@ -469,11 +470,6 @@ static int vic_sound_machine_init(sound_t *psid, int speed, int cycles_per_sec)
     return 1;
 }
 
-void sound_machine_prevent_clk_overflow(sound_t *psid, CLOCK sub)
-{
-    sid_sound_machine_prevent_clk_overflow(psid, sub);
-}
-
 char *sound_machine_dump_state(sound_t *psid)
 {
     return sid_sound_machine_dump_state(psid);
@@ -191,7 +191,7 @@ static uint8_t read_prb(via_context_t *via_context)
 void via1_init(via_context_t *via_context)
 {
     viacore_init(machine_context.via1, maincpu_alarm_context,
-                 maincpu_int_status, maincpu_clk_guard);
+                 maincpu_int_status);
 }
 
 void vic20via1_setup_context(machine_context_t *machinecontext)
@@ -27,6 +27,8 @@
 #ifndef VICE_EVENT_H
 #define VICE_EVENT_H
 
+#include <stddef.h>
+
 #include "types.h"
 
 #define EVENT_LIST_END          0
@@ -40,30 +42,35 @@
 #define EVENT_RESETCPU          8
 #define EVENT_TIMESTAMP         9
 #define EVENT_ATTACHIMAGE       10
-#define EVENT_OVERFLOW          11
+#define EVENT_OVERFLOW          11  /* only in histories with a 32 bit clock */
 #define EVENT_KEYBOARD_DELAY    12
 #define EVENT_JOYSTICK_DELAY    13
 #define EVENT_SYNC_TEST         14
 #define EVENT_KEYBOARD_CLEAR    15
 #define EVENT_RESOURCE          16
+#define EVENT_KEYFRAME          17
 
 #define EVENT_START_MODE_FILE_SAVE 0
 #define EVENT_START_MODE_FILE_LOAD 1
 #define EVENT_START_MODE_RESET     2
 #define EVENT_START_MODE_PLAYBACK  3
 
+/* An event list is a growable buffer of packed records: an event_list_t
+   header followed by `size' bytes of data, padded to 8 bytes.  The list
+   always ends with an EVENT_LIST_END record.  Pointers to records are only
+   valid until the list is changed.  */
 struct event_list_s {
-    unsigned int type;
     CLOCK clk;
+    unsigned int type;
     unsigned int size;
-    void *data;
-    struct event_list_s *next;
 };
 typedef struct event_list_s event_list_t;
 
 struct event_list_state_s {
-    event_list_t *base;
-    event_list_t *current;
+    uint8_t *base;      /* the records */
+    size_t size;        /* bytes in use */
+    size_t max;         /* bytes allocated */
+    size_t current;     /* offset of the record being recorded or played */
 };
 typedef struct event_list_state_s event_list_state_t;
 
@@ -77,12 +84,18 @@ extern void event_register_event_list(event_list_state_t *list);
 extern void event_init_image_list(void);
 extern void event_destroy_image_list(void);
 extern void event_clear_list(event_list_state_t *list);
+extern void event_reset_list(event_list_state_t *list);
 extern void event_playback_event_list(event_list_state_t *list);
 
+extern event_list_t *event_list_first(event_list_state_t *list);
+extern event_list_t *event_list_next(event_list_t *event);
+extern void *event_list_data(event_list_t *event);
+
 extern int event_record_start(void);
 extern int event_record_stop(void);
 extern int event_playback_start(void);
 extern int event_playback_stop(void);
+extern int event_playback_seek(unsigned int seconds);
 extern int event_record_active(void);
 extern int event_playback_active(void);
 extern int event_record_set_milestone(void);
@@ -111,7 +111,7 @@ int vicii_snapshot_write_module(snapshot_t *s)
         || SMW_DW(m, (uint32_t)vicii.light_pen.x) < 0
         || SMW_DW(m, (uint32_t)vicii.light_pen.y) < 0
         || SMW_DW(m, (uint32_t)vicii.light_pen.x_extra_bits) < 0
-        || SMW_DW(m, (uint32_t)vicii.light_pen.trigger_cycle) < 0
+        || SMW_CLOCK(m, vicii.light_pen.trigger_cycle) < 0
         /* vbank_phi[12] updated from elsewhere */
         /* log is initialized at startup */
         || SMW_B(m, vicii.reg11_delay) < 0
@@ -224,7 +224,7 @@ int vicii_snapshot_read_module(snapshot_t *s)
         || SMR_DW_INT(m, &vicii.light_pen.x) < 0
         || SMR_DW_INT(m, &vicii.light_pen.y) < 0
         || SMR_DW_INT(m, &vicii.light_pen.x_extra_bits) < 0
-        || SMR_DW(m, &vicii.light_pen.trigger_cycle) < 0
+        || SMR_CLOCK(m, &vicii.light_pen.trigger_cycle) < 0
         /* vbank_phi[12] updated from elsewhere */
         /* log is initialized at startup */
         || SMR_B(m, &vicii.reg11_delay) < 0
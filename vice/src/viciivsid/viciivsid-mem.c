@@ -1347,6 +1347,38 @@ inline static uint8_t d019_peek(void)
     return vicii.irq_status;
 }
 
+/* Return the clock up to which reading `addr' keeps giving the same value
+   without side effects, or 0 if it may not.  For the busy loop detection
+   of the CPU.  */
+CLOCK vicii_idle_read(uint16_t addr)
+{
+    CLOCK line_clk;
+
+    addr &= 0x3f;
+
+    switch (addr) {
+        case 0x11:
+        case 0x12:
+            /* until the raster counter moves on, see read_raster_y() */
+            line_clk = VICII_LINE_START_CLK(maincpu_clk);
+            if (VICII_RASTER_Y(maincpu_clk) == 0
+                && VICII_RASTER_CYCLE(maincpu_clk) == 0) {
+                return line_clk + 1;
+            }
+            return line_clk + vicii.cycles_per_line;
+        case 0x13:
+        case 0x14:
+        case 0x19:
+        case 0x1e:
+        case 0x1f:
+            /* light pen, interrupt flags and collisions */
+            return 0;
+        default:
+            /* everything else only changes with a write */
+            return addr < 0x2f ? CLOCK_MAX : 0;
+    }
+}
+
 uint8_t vicii_peek(uint16_t addr)
 {
     addr &= 0x3f;
@@ -51,7 +51,6 @@
 #include "cartridge.h"
 #include "c64cart.h"
 #include "c64cartmem.h"
-#include "clkguard.h"
 #include "dma.h"
 #include "lib.h"
 #include "log.h"
@@ -136,15 +135,6 @@ vicii_t vicii;
 
 static void vicii_set_geometry(void);
 
-static void clk_overflow_callback(CLOCK sub, void *unused_data)
-{
-    vicii.raster_irq_clk -= sub;
-    vicii.last_emulate_line_clk -= sub;
-    vicii.fetch_clk -= sub;
-    vicii.draw_clk -= sub;
-    vicii.sprite_fetch_clk -= sub;
-}
-
 void vicii_change_timing(machine_timing_t *machine_timing)
 {
     vicii_timing_set(machine_timing);
@@ -195,6 +185,12 @@ inline void vicii_handle_pending_alarms(int num_write_cycles)
            cannot take us here and we would not be able to handle JSR
            correctly anyway, so we don't care about them...  */
 
+        /* The registers are also written on reset, before the CPU has
+           executed anything.  */
+        if ((CLOCK)num_write_cycles > maincpu_clk) {
+            num_write_cycles = (int)maincpu_clk;
+        }
+
         /* Go back to the time when the read accesses happened and serve VIC
          events.  */
         maincpu_clk -= num_write_cycles;
@@ -381,8 +377,6 @@ raster_t *vicii_init(unsigned int flag)
 
     vicii.initialized = 1;
 
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
-
     return &vicii.raster;
 }
 
@@ -51,7 +51,6 @@ int vsync_frame_counter;
 #include <limits.h>
 #endif
 
-#include "clkguard.h"
 #include "cmdline.h"
 #include "debug.h"
 #include "log.h"
@@ -81,6 +80,9 @@ static int refresh_rate;
 /* "Warp mode".  If nonzero, attempt to run as fast as possible. */
 static int warp_mode_enabled;
 
+/* Like warp mode, but not a resource.  See vsync_set_catch_up().  */
+static int catch_up_enabled;
+
 
 static int set_relative_speed(int val, void *param)
 {
@@ -106,7 +108,7 @@ static int set_warp_mode(int val, void *param)
 {
     warp_mode_enabled = val ? 1 : 0;
 
-    sound_set_warp_mode(warp_mode_enabled);
+    sound_set_warp_mode(warp_mode_enabled || catch_up_enabled);
     set_timer_speed(relative_speed);
 
     return 0;
@@ -261,11 +263,6 @@ static void display_speed(int num_frames)
     speed_eval_prev_clk = maincpu_clk;
 }
 
-static void clk_overflow_callback(CLOCK amount, void *data)
-{
-    speed_eval_prev_clk -= amount;
-}
-
 /* ------------------------------------------------------------------------- */
 
 void vsync_set_machine_parameter(double refresh, long cycles)
@@ -280,11 +277,32 @@ double vsync_get_refresh_frequency(void)
     return refresh_frequency;
 }
 
+int vsync_get_warp_mode(void)
+{
+    return warp_mode_enabled;
+}
+
+/* Run as fast as possible and without sound until switched off again, to
+   re-emulate frames after a netplay rollback.  The WarpMode resource can't
+   be changed while netplay is active.  */
+void vsync_set_catch_up(int enable)
+{
+    enable = enable ? 1 : 0;
+    if (catch_up_enabled == enable) {
+        return;
+    }
+    catch_up_enabled = enable;
+
+    sound_set_warp_mode(warp_mode_enabled || catch_up_enabled);
+    if (!catch_up_enabled) {
+        vsync_suspend_speed_eval();
+    }
+}
+
 void vsync_init(void (*hook)(void))
 {
     vsync_hook = hook;
     vsync_suspend_speed_eval();
-    clk_guard_add_callback(maincpu_clk_guard, clk_overflow_callback, NULL);
 
     vsyncarch_init();
 
@@ -453,7 +471,8 @@ int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
      * We could optimize by sleeping only if a frame is to be output.
      */
     /*log_debug("vsync_do_vsync: sound_delay=%f  frame_ticks=%d  delay=%d", sound_delay, frame_ticks, delay);*/
-    if (!warp_mode_enabled && timer_speed && (skipped_redraw == 0) && (delay < 0)) {
+    if (!warp_mode_enabled && !catch_up_enabled
+        && timer_speed && (skipped_redraw == 0) && (delay < 0)) {
         /* FIXME: this is likely implemented as a regular sleep(), which means
            it will wait *at least* the given time (but may just as well wait
            much longer. its doomed to break on those archs - we should instead
@@ -484,7 +503,7 @@ int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
               + ((frame_ticks_remainder * 3 * timer_speed) / 100);
 
     if ((skipped_redraw < MAX_SKIPPED_FRAMES)
-        && (warp_mode_enabled
+        && (warp_mode_enabled || catch_up_enabled
             || (skipped_redraw < (refresh_rate - 1))
             || ((!timer_speed || delay > compval) && !refresh_rate))
         ) {
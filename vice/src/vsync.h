@@ -44,6 +44,8 @@ extern int vsync_cmdline_options_init(void);
 extern void vsync_init(void (*hook)(void));
 extern void vsync_set_machine_parameter(double refresh_rate, long cycles);
 extern double vsync_get_refresh_frequency(void);
+extern int vsync_get_warp_mode(void);
+extern void vsync_set_catch_up(int enable);
 extern int vsync_do_vsync(struct video_canvas_s *c, int been_skipped);
 extern int vsync_disable_timer(void);
 
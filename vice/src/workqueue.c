@@ -0,0 +1,293 @@
+/*
+ * workqueue.c - Background worker threads.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "lib.h"
+#include "log.h"
+#include "workqueue.h"
+
+
+typedef struct workqueue_job_s {
+    workqueue_func_t func;
+    void *data;
+} workqueue_job_t;
+
+struct workqueue_s {
+    char *name;
+
+    /* Ring of queued jobs.  */
+    workqueue_job_t *jobs;
+    int max_pending;
+    int head;
+    int queued;
+
+    /* Jobs taken by a worker but not finished yet.  */
+    int running;
+
+    int num_threads;
+#ifdef HAVE_PTHREAD
+    pthread_t *threads;
+    pthread_mutex_t lock;
+    pthread_cond_t job_available;
+    pthread_cond_t slot_available;
+    pthread_cond_t idle;
+    int quit;
+#endif
+};
+
+
+int workqueue_cpu_count(void)
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (n > 0) {
+        return (int)n;
+    }
+#endif
+    return 1;
+}
+
+#ifdef HAVE_PTHREAD
+
+static void *workqueue_thread(void *arg)
+{
+    workqueue_t *wq = (workqueue_t *)arg;
+    workqueue_job_t job;
+
+    pthread_mutex_lock(&wq->lock);
+    while (1) {
+        while (wq->queued == 0 && !wq->quit) {
+            pthread_cond_wait(&wq->job_available, &wq->lock);
+        }
+        if (wq->queued == 0) {
+            /* quit requested and nothing left to do */
+            break;
+        }
+
+        job = wq->jobs[wq->head];
+        wq->head = (wq->head + 1) % wq->max_pending;
+        wq->queued--;
+        wq->running++;
+        pthread_cond_signal(&wq->slot_available);
+        pthread_mutex_unlock(&wq->lock);
+
+        job.func(job.data);
+
+        pthread_mutex_lock(&wq->lock);
+        wq->running--;
+        if (wq->queued == 0 && wq->running == 0) {
+            pthread_cond_broadcast(&wq->idle);
+        }
+    }
+    pthread_mutex_unlock(&wq->lock);
+
+    return NULL;
+}
+
+workqueue_t *workqueue_create(const char *name, int num_threads,
+                              int max_pending)
+{
+    workqueue_t *wq;
+    int i;
+
+    wq = lib_calloc(1, sizeof(workqueue_t));
+    wq->name = lib_strdup(name);
+    wq->max_pending = max_pending > 0 ? max_pending : 1;
+    wq->jobs = lib_malloc(sizeof(workqueue_job_t) * (size_t)wq->max_pending);
+
+    if (num_threads <= 0) {
+        return wq;
+    }
+
+    pthread_mutex_init(&wq->lock, NULL);
+    pthread_cond_init(&wq->job_available, NULL);
+    pthread_cond_init(&wq->slot_available, NULL);
+    pthread_cond_init(&wq->idle, NULL);
+
+    wq->threads = lib_malloc(sizeof(pthread_t) * (size_t)num_threads);
+    for (i = 0; i < num_threads; i++) {
+        if (pthread_create(&wq->threads[i], NULL, workqueue_thread, wq) != 0) {
+            log_warning(LOG_DEFAULT, "workqueue: %s: could only start %d of %d threads.",
+                        wq->name, i, num_threads);
+            break;
+        }
+    }
+    wq->num_threads = i;
+
+    return wq;
+}
+
+void workqueue_destroy(workqueue_t *wq)
+{
+    int i;
+
+    if (wq == NULL) {
+        return;
+    }
+
+    if (wq->threads != NULL) {
+        pthread_mutex_lock(&wq->lock);
+        wq->quit = 1;
+        pthread_cond_broadcast(&wq->job_available);
+        pthread_mutex_unlock(&wq->lock);
+
+        for (i = 0; i < wq->num_threads; i++) {
+            pthread_join(wq->threads[i], NULL);
+        }
+        lib_free(wq->threads);
+
+        pthread_cond_destroy(&wq->idle);
+        pthread_cond_destroy(&wq->slot_available);
+        pthread_cond_destroy(&wq->job_available);
+        pthread_mutex_destroy(&wq->lock);
+    }
+
+    lib_free(wq->jobs);
+    lib_free(wq->name);
+    lib_free(wq);
+}
+
+static int workqueue_queue(workqueue_t *wq, workqueue_func_t func, void *data,
+                           int wait)
+{
+    workqueue_job_t *job;
+
+    if (wq->num_threads == 0) {
+        func(data);
+        return 0;
+    }
+
+    pthread_mutex_lock(&wq->lock);
+    while (wq->queued == wq->max_pending) {
+        if (!wait) {
+            pthread_mutex_unlock(&wq->lock);
+            return -1;
+        }
+        pthread_cond_wait(&wq->slot_available, &wq->lock);
+    }
+
+    job = &wq->jobs[(wq->head + wq->queued) % wq->max_pending];
+    job->func = func;
+    job->data = data;
+    wq->queued++;
+    pthread_cond_signal(&wq->job_available);
+    pthread_mutex_unlock(&wq->lock);
+
+    return 0;
+}
+
+void workqueue_wait(workqueue_t *wq)
+{
+    if (wq == NULL || wq->num_threads == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&wq->lock);
+    while (wq->queued > 0 || wq->running > 0) {
+        pthread_cond_wait(&wq->idle, &wq->lock);
+    }
+    pthread_mutex_unlock(&wq->lock);
+}
+
+int workqueue_pending(workqueue_t *wq)
+{
+    int pending;
+
+    if (wq == NULL || wq->num_threads == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&wq->lock);
+    pending = wq->queued + wq->running;
+    pthread_mutex_unlock(&wq->lock);
+
+    return pending;
+}
+
+#else /* !HAVE_PTHREAD */
+
+workqueue_t *workqueue_create(const char *name, int num_threads,
+                              int max_pending)
+{
+    workqueue_t *wq;
+
+    wq = lib_calloc(1, sizeof(workqueue_t));
+    wq->name = lib_strdup(name);
+
+    return wq;
+}
+
+void workqueue_destroy(workqueue_t *wq)
+{
+    if (wq == NULL) {
+        return;
+    }
+    lib_free(wq->name);
+    lib_free(wq);
+}
+
+static int workqueue_queue(workqueue_t *wq, workqueue_func_t func, void *data,
+                           int wait)
+{
+    func(data);
+    return 0;
+}
+
+void workqueue_wait(workqueue_t *wq)
+{
+}
+
+int workqueue_pending(workqueue_t *wq)
+{
+    return 0;
+}
+
+#endif
+
+int workqueue_submit(workqueue_t *wq, workqueue_func_t func, void *data)
+{
+    return workqueue_queue(wq, func, data, 1);
+}
+
+int workqueue_try_submit(workqueue_t *wq, workqueue_func_t func, void *data)
+{
+    return workqueue_queue(wq, func, data, 0);
+}
+
+int workqueue_num_threads(workqueue_t *wq)
+{
+    return wq != NULL ? wq->num_threads : 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * workqueue.h - Background worker threads.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_WORKQUEUE_H
+#define VICE_WORKQUEUE_H
+
+/* A work queue is a bounded FIFO of jobs executed by a fixed number of
+   worker threads.  Jobs must only touch the data they were handed and must
+   never call back into the emulation.  Without thread support, jobs are
+   run synchronously at submit time.  */
+
+typedef void (*workqueue_func_t)(void *data);
+
+struct workqueue_s;
+typedef struct workqueue_s workqueue_t;
+
+extern workqueue_t *workqueue_create(const char *name, int num_threads,
+                                     int max_pending);
+extern void workqueue_destroy(workqueue_t *wq);
+
+/* Queue a job, waiting for a free slot if the queue is full.  */
+extern int workqueue_submit(workqueue_t *wq, workqueue_func_t func, void *data);
+
+/* Queue a job, returns -1 if the queue is full.  */
+extern int workqueue_try_submit(workqueue_t *wq, workqueue_func_t func,
+                                void *data);
+
+/* Wait until all queued jobs have finished.  */
+extern void workqueue_wait(workqueue_t *wq);
+
+/* Number of jobs queued or running.  */
+extern int workqueue_pending(workqueue_t *wq);
+
+/* Number of worker threads, 0 if jobs run synchronously.  */
+extern int workqueue_num_threads(workqueue_t *wq);
+
+/* Number of online host CPUs (at least 1).  */
+extern int workqueue_cpu_count(void);
+
+#endif